@@ -483,167 +483,402 @@ void CG_AddFragmentedDecal( vec3_t origin, vec3_t dir, float orient, float radiu
 /*
 ==============================================================
 
-PARTICLE MANAGEMENT
+PLAYER TRAILS
 
 ==============================================================
 */
 
-typedef struct particle_s
-{
-	float time;
+// racesow - player trails
+#define MAX_TRAIL_POINTS			128
+#define MAX_TRAIL_MESH_VERTS		16384
+#define TRAIL_RESET_DISTANCE		512
 
+typedef struct
+{
 	vec3_t org;
-	vec3_t vel;
-	vec3_t accel;
-	vec3_t color;
-	float alpha;
-	float alphavel;
-	float scale;
-	bool fog;
-
-	poly_t poly;
-	vec4_t pVerts[4];
-	vec2_t pStcoords[4];
-	byte_vec4_t pColor[4];
-
-	struct shader_s	*shader;
-} cparticle_t;
-
-#define	PARTICLE_GRAVITY    250
+	unsigned int time;
+	byte_vec4_t color;
+} ctrailpoint_t;
 
-#define MAX_PARTICLES	    2048
+typedef struct
+{
+	int head;                       // index of the newest sampled point
+	int numpoints;
+	unsigned int lastSampleTime;
+	ctrailpoint_t points[MAX_TRAIL_POINTS];
+} ctrail_t;
 
-static vec3_t avelocities[NUMVERTEXNORMALS];
+typedef struct
+{
+	bool valid;
+	bool perPlayerColor;
+	float color[3];                 // negative components are randomized per sample
+	float alpha;
+	float size;
+} ctrailsettings_t;
 
-cparticle_t particles[MAX_PARTICLES];
-int cg_numparticles;
+static const float cg_trailPlayerColors[][3] =
+{
+	{ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 0.0f },
+	{ 1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 0.5f, 0.0f },
+	{ 1.0f, 0.0f, 0.5f }, { 0.25f, 0.0f, 0.5f }, { 1.0f, 0.25f, 0.25f }, { 0.0f, 0.0f, 0.25f },
+	{ 0.0f, 0.5f, 0.0f }, { 0.5f, 0.0f, 0.0f }, { 0.25f, 0.5f, 1.0f }, { 0.0f, 0.0f, 0.0f }
+};
+
+static ctrail_t cg_trails[MAX_CLIENTS];
+static ctrailsettings_t cg_trailSettings;
+
+// ribbon meshes are rebuilt every frame into a shared pool, texture coordinates
+// and the triangle strip layout are the same for every trail
+static vec4_t cg_trailVerts[MAX_TRAIL_MESH_VERTS];
+static byte_vec4_t cg_trailColors[MAX_TRAIL_MESH_VERTS];
+static vec2_t cg_trailStcoords[( MAX_TRAIL_POINTS+1 )*2];
+static unsigned short cg_trailElems[MAX_TRAIL_POINTS*6];
+static int cg_numTrailVerts;
+static int cg_trailMeshFrame;
 
 /*
-* CG_ClearParticles
+* CG_ClearPlayerTrails
 */
-static void CG_ClearParticles( void )
+static void CG_ClearPlayerTrails( void )
 {
 	int i;
-	cparticle_t *p;
 
-	cg_numparticles = 0;
-	memset( particles, 0, sizeof( cparticle_t ) * MAX_PARTICLES );
+	memset( cg_trails, 0, sizeof( cg_trails ) );
+	memset( &cg_trailSettings, 0, sizeof( cg_trailSettings ) );
+	cg_numTrailVerts = 0;
+	cg_trailMeshFrame = -1;
 
-	for( i = 0, p = particles; i < MAX_PARTICLES; i++, p++ )
+	for( i = 0; i < MAX_TRAIL_POINTS+1; i++ )
 	{
-		p->pStcoords[0][0] = 0; p->pStcoords[0][1] = 1;
-		p->pStcoords[1][0] = 0; p->pStcoords[1][1] = 0;
-		p->pStcoords[2][0] = 1; p->pStcoords[2][1] = 0;
-		p->pStcoords[3][0] = 1; p->pStcoords[3][1] = 1;
+		Vector2Set( cg_trailStcoords[i*2+0], 0.5f, 0 );
+		Vector2Set( cg_trailStcoords[i*2+1], 0.5f, 1 );
 	}
-}
 
-#define CG_InitParticle( p, s, a, r, g, b, h ) \
-	( \
-	( p )->time = cg.time, \
-	( p )->scale = ( s ), \
-	( p )->alpha = ( a ), \
-	( p )->color[0] = ( r ), \
-	( p )->color[1] = ( g ), \
-	( p )->color[2] = ( b ), \
-	( p )->shader = ( h ), \
-	( p )->fog = true \
-	)
+	for( i = 0; i < MAX_TRAIL_POINTS; i++ )
+	{
+		cg_trailElems[i*6+0] = i*2+0;
+		cg_trailElems[i*6+1] = i*2+1;
+		cg_trailElems[i*6+2] = i*2+2;
+		cg_trailElems[i*6+3] = i*2+2;
+		cg_trailElems[i*6+4] = i*2+1;
+		cg_trailElems[i*6+5] = i*2+3;
+	}
+}
 
-// racesow - player trails
-/**
- * CG_AddLinearTrail
- * Add a partical trail following the given entity
- * @param cent The entity to follow
- * @param lifetime How long the particles should last in seconds (?? verify)
- */
-void CG_AddLinearTrail( centity_t *cent, float lifetime )
+/*
+* CG_UpdateTrailSettings
+* 
+* Only parse the trail cvars when they have been changed
+*/
+static void CG_UpdateTrailSettings( void )
 {
-	cparticle_t *p;
+	ctrailsettings_t *ts = &cg_trailSettings;
 	float r, g, b, a, s;
 
-	if( cg_numparticles + 1 > MAX_PARTICLES )
+	if( ts->valid && !cg_playerTrailsColor->modified && !cg_playerTrailsAlpha->modified && !cg_playerTrailsSize->modified )
 		return;
 
-	if( cg_playerTrailsColor->string != NULL &&
-	    sscanf( cg_playerTrailsColor->string, "%f %f %f", &r, &g, &b ) == 3 )
+	ts->perPlayerColor = false;
+	if( sscanf( cg_playerTrailsColor->string, "%f %f %f", &r, &g, &b ) == 3 )
 	{
-		if( r == -1.0f )
-			r = (float) rand()/RAND_MAX;
-
-		if( g == -1.0f )
-			g = (float) rand()/RAND_MAX;
-
-		if( b == -1.0f )
-			b = (float) rand()/RAND_MAX;
-
-		r = r < 0.0f ? 0.0f :
-		    r > 1.0f ? 1.0f : r;
-		g = g < 0.0f ? 0.0f :
-		    g > 1.0f ? 1.0f : g;
-		b = b < 0.0f ? 0.0f :
-		    b > 1.0f ? 1.0f : b;
-	} else if(cg_playerTrailsColor->integer == 1)
+		// -1 requests a random value for that component
+		VectorSet( ts->color,
+			r == -1.0f ? -1.0f : bound( 0.0f, r, 1.0f ),
+			g == -1.0f ? -1.0f : bound( 0.0f, g, 1.0f ),
+			b == -1.0f ? -1.0f : bound( 0.0f, b, 1.0f ) );
+	}
+	else if( cg_playerTrailsColor->integer == 1 )
 	{
-		switch( cent->current.number )
-		{
-			case 1:  r = 1.0f;  g = 0.0f;  b = 0.0f;  break;
-			case 2:  r = 0.0f;  g = 1.0f;  b = 0.0f;  break;
-			case 3:  r = 0.0f;  g = 0.0f;  b = 1.0f;  break;
-			case 4:  r = 1.0f;  g = 1.0f;  b = 0.0f;  break;
-			case 5:  r = 1.0f;  g = 0.0f;  b = 1.0f;  break;
-			case 6:  r = 0.0f;  g = 1.0f;  b = 1.0f;  break;
-			case 7:  r = 1.0f;  g = 1.0f;  b = 1.0f;  break;
-			case 8:  r = 1.0f;  g = 0.5f;  b = 0.0f;  break;
-			case 9:  r = 1.0f;  g = 0.0f;  b = 0.5f;  break;
-			case 10: r = 0.25f; g = 0.0f;  b = 0.5f;  break;
-			case 11: r = 1.0f;  g = 0.25f; b = 0.25f; break;
-			case 12: r = 0.0f;  g = 0.0f;  b = 0.25f; break;
-			case 13: r = 0.0f;  g = 0.5f;  b = 0.0f;  break;
-			case 14: r = 0.5f;  g = 0.0f;  b = 0.0f;  break;
-			case 15: r = 0.25f; g = 0.5f;  b = 1.0f;  break;
-			case 16: r = 0.0f;  g = 0.0f;  b = 0.0f;  break;
-		}
+		ts->perPlayerColor = true;
 	}
 	else
 	{
-		r = 0.0f;
-		g = 1.0f;
-		b = 0.0f;
+		VectorSet( ts->color, 0.0f, 1.0f, 0.0f );
 	}
 
-	if( cg_playerTrailsAlpha->string != NULL &&
-	    sscanf( cg_playerTrailsAlpha->string, "%f", &a ) == 1 )
+	if( sscanf( cg_playerTrailsAlpha->string, "%f", &a ) == 1 )
+		ts->alpha = bound( 0.0f, a, 1.0f );
+	else
+		ts->alpha = 1.0f;
+
+	if( sscanf( cg_playerTrailsSize->string, "%f", &s ) == 1 )
+		ts->size = s < 0.0f ? 0.0f : ( s > 100.0f ? 1.0f : s );
+	else
+		ts->size = 1.0f;
+
+	cg_playerTrailsColor->modified = qfalse;
+	cg_playerTrailsAlpha->modified = qfalse;
+	cg_playerTrailsSize->modified = qfalse;
+	ts->valid = true;
+}
+
+/*
+* CG_TrailPointColor
+*/
+static void CG_TrailPointColor( int entNum, byte_vec4_t color )
+{
+	int i;
+	float c;
+	const float *rgb;
+
+	if( cg_trailSettings.perPlayerColor )
 	{
-		a = a < 0.0f ? 0.0f :
-		    a > 1.0f ? 1.0f : a;
+		rgb = cg_trailPlayerColors[( entNum - 1 ) % ( sizeof( cg_trailPlayerColors ) / sizeof( cg_trailPlayerColors[0] ) )];
+		for( i = 0; i < 3; i++ )
+			color[i] = ( qbyte )( rgb[i] * 255 );
 	}
 	else
 	{
-		a = 1.0f;
+		for( i = 0; i < 3; i++ )
+		{
+			c = cg_trailSettings.color[i];
+			if( c < 0 )
+				c = random();
+			color[i] = ( qbyte )( c * 255 );
+		}
 	}
+	color[3] = 255;
+}
+
+/*
+* CG_SampleTrail
+*/
+static void CG_SampleTrail( ctrail_t *trail, centity_t *cent, unsigned int interval )
+{
+	ctrailpoint_t *pt;
 
-	if( cg_playerTrailsSize->string != NULL &&
-	    sscanf( cg_playerTrailsSize->string, "%f", &s ) == 1 )
+	if( trail->numpoints )
 	{
-		s = s < 0.0f ? 0.0f :
-		    s > 100.0f ? 1.0f : s;
+		pt = &trail->points[trail->head];
+
+		// restart the ribbon instead of stretching it across teleports
+		// or gaps where the entity wasn't visible
+		if( cent->current.teleported || cg.time - pt->time > interval * MAX_TRAIL_POINTS
+			|| DistanceSquared( pt->org, cent->ent.origin ) > TRAIL_RESET_DISTANCE * TRAIL_RESET_DISTANCE )
+			trail->numpoints = 0;
+		else if( cg.time - trail->lastSampleTime < interval )
+			return;
 	}
-	else
+
+	trail->head = ( trail->head + 1 ) % MAX_TRAIL_POINTS;
+	if( trail->numpoints < MAX_TRAIL_POINTS )
+		trail->numpoints++;
+	trail->lastSampleTime = cg.time;
+
+	pt = &trail->points[trail->head];
+	VectorCopy( cent->ent.origin, pt->org );
+	pt->time = cg.time;
+	CG_TrailPointColor( cent->current.number, pt->color );
+}
+
+/*
+* CG_AddLinearTrail
+* 
+* Samples the entity position into its ring buffer and adds the whole
+* trail as a single camera facing ribbon. The newest vertex pair is always
+* attached to the current entity origin.
+*/
+void CG_AddLinearTrail( centity_t *cent, float lifetime )
+{
+	int i, k, idx, numpoints, numverts;
+	unsigned int interval;
+	float age, alpha, halfwidth;
+	ctrail_t *trail;
+	ctrailpoint_t *pt;
+	vec3_t *org, tangent, toview, side;
+	vec3_t orgs[MAX_TRAIL_POINTS+1];
+	qbyte *colors[MAX_TRAIL_POINTS+1];
+	float alphas[MAX_TRAIL_POINTS+1];
+	vec4_t *verts;
+	byte_vec4_t *vcolors;
+	poly_t poly;
+
+	if( cent->current.number < 1 || cent->current.number > MAX_CLIENTS )
+		return;
+	if( lifetime <= 0 )
+		return;
+
+	CG_UpdateTrailSettings();
+
+	trail = &cg_trails[cent->current.number - 1];
+
+	// spread the samples so the ring always covers the whole lifetime
+	interval = (unsigned int)( lifetime * 1000.0f / ( MAX_TRAIL_POINTS - 1 ) );
+	if( !interval )
+		interval = 1;
+
+	CG_SampleTrail( trail, cent, interval );
+
+	// expire old samples and collect the live ones, newest first
+	numpoints = 0;
+	VectorCopy( cent->ent.origin, orgs[numpoints] );
+	colors[numpoints] = trail->points[trail->head].color;
+	alphas[numpoints] = cg_trailSettings.alpha;
+	numpoints++;
+
+	for( i = 0; i < trail->numpoints; i++ )
 	{
-		s = 1.0f;
+		idx = ( trail->head - i + MAX_TRAIL_POINTS ) % MAX_TRAIL_POINTS;
+		pt = &trail->points[idx];
+
+		age = ( cg.time - pt->time ) * 0.001f;
+		alpha = cg_trailSettings.alpha - age / lifetime;
+		if( alpha <= 0 )
+		{
+			trail->numpoints = i;
+			break;
+		}
+
+		VectorCopy( pt->org, orgs[numpoints] );
+		colors[numpoints] = pt->color;
+		alphas[numpoints] = alpha;
+		numpoints++;
 	}
 
-	// Own player trail shows up when looking straight down
-	// maybe move particle a bit behind player
-	// maybe don't show own trail at all
-	p = &particles[cg_numparticles++];
-	CG_InitParticle( p, s, a, r, g, b, NULL );
-	VectorCopy( cent->ent.origin, p->org );
-	p->alphavel = -( 1.0f / lifetime );
+	if( numpoints < 2 || cg_trailSettings.size <= 0 )
+		return;
+
+	if( cg_trailMeshFrame != cg.frameCount )
+	{
+		cg_trailMeshFrame = cg.frameCount;
+		cg_numTrailVerts = 0;
+	}
+
+	numverts = numpoints * 2;
+	if( cg_numTrailVerts + numverts > MAX_TRAIL_MESH_VERTS )
+		return;
+
+	verts = &cg_trailVerts[cg_numTrailVerts];
+	vcolors = &cg_trailColors[cg_numTrailVerts];
+	cg_numTrailVerts += numverts;
+
+	halfwidth = 0.5f * cg_trailSettings.size;
+
+	for( i = 0; i < numpoints; i++ )
+	{
+		org = &orgs[i];
+
+		VectorSubtract( orgs[i > 0 ? i - 1 : i], orgs[i < numpoints - 1 ? i + 1 : i], tangent );
+		VectorSubtract( cg.view.origin, *org, toview );
+		CrossProduct( tangent, toview, side );
+		if( !VectorNormalize( side ) )
+			VectorCopy( &cg.view.axis[AXIS_RIGHT], side );
+		VectorScale( side, halfwidth, side );
+
+		VectorAdd( *org, side, verts[i*2+0] );
+		VectorSubtract( *org, side, verts[i*2+1] );
+		verts[i*2+0][3] = verts[i*2+1][3] = 1;
+
+		for( k = 0; k < 3; k++ )
+			vcolors[i*2+0][k] = vcolors[i*2+1][k] = colors[i][k];
+		vcolors[i*2+0][3] = vcolors[i*2+1][3] = ( qbyte )( bound( 0, alphas[i], 1.0f ) * 255 );
+	}
+
+	memset( &poly, 0, sizeof( poly ) );
+	poly.numverts = numverts;
+	poly.verts = verts;
+	poly.stcoords = cg_trailStcoords;
+	poly.colors = vcolors;
+	poly.elems = cg_trailElems;
+	poly.numelems = ( numpoints - 1 ) * 6;
+	poly.fognum = 0;
+	poly.shader = CG_MediaShader( cgs.media.shaderParticle );
+
+	trap_R_AddPolyToScene( &poly );
 }
 // !racesow
 
+/*
+==============================================================
+
+PARTICLE MANAGEMENT
+
+==============================================================
+*/
+
+#define	PARTICLE_GRAVITY    250
+
+#define MAX_PARTICLES	    MAX_POLY_QUADS
+
+// particles are stored as structure of arrays so the per-frame
+// integration and fading passes run over flat float arrays
+typedef struct
+{
+	int numParticles;
+
+	float time[MAX_PARTICLES];
+	float org[3][MAX_PARTICLES];
+	float vel[3][MAX_PARTICLES];
+	float accel[3][MAX_PARTICLES];
+	float color[3][MAX_PARTICLES];
+	float alpha[MAX_PARTICLES];
+	float alphavel[MAX_PARTICLES];
+	float scale[MAX_PARTICLES];
+	struct shader_s *shader[MAX_PARTICLES];
+} cparticles_t;
+
+static vec3_t avelocities[NUMVERTEXNORMALS];
+
+static cparticles_t particles;
+
+// quads for all live particles, grouped by shader and submitted in batches
+static vec4_t cg_particleVerts[MAX_PARTICLES*4];
+static vec2_t cg_particleStcoords[MAX_PARTICLES*4];
+static byte_vec4_t cg_particleColors[MAX_PARTICLES*4];
+
+/*
+* CG_ClearParticles
+*/
+static void CG_ClearParticles( void )
+{
+	int i;
+
+	memset( &particles, 0, sizeof( particles ) );
+
+	for( i = 0; i < MAX_PARTICLES; i++ )
+	{
+		Vector2Set( cg_particleStcoords[i*4+0], 0, 1 );
+		Vector2Set( cg_particleStcoords[i*4+1], 0, 0 );
+		Vector2Set( cg_particleStcoords[i*4+2], 1, 0 );
+		Vector2Set( cg_particleStcoords[i*4+3], 1, 1 );
+	}
+}
+
+/*
+* CG_AllocParticles
+* 
+* Returns the index of the first new particle, count is clamped to the free space
+*/
+static int CG_AllocParticles( int *count )
+{
+	int first = particles.numParticles;
+
+	if( first + *count > MAX_PARTICLES )
+		*count = MAX_PARTICLES - first;
+	if( *count < 0 )
+		*count = 0;
+
+	particles.numParticles += *count;
+	return first;
+}
+
+#define CG_SetParticleVector( v, i, x, y, z ) \
+	( \
+	( v )[0][i] = ( x ), \
+	( v )[1][i] = ( y ), \
+	( v )[2][i] = ( z ) \
+	)
+
+#define CG_InitParticle( i, s, a, r, g, b, h ) \
+	( \
+	particles.time[i] = cg.time, \
+	particles.scale[i] = ( s ), \
+	particles.alpha[i] = ( a ), \
+	CG_SetParticleVector( particles.color, i, r, g, b ), \
+	particles.shader[i] = ( h ) \
+	)
+
 /*
 * CG_ParticleEffect
 * 
@@ -651,29 +886,25 @@ void CG_AddLinearTrail( centity_t *cent, float lifetime )
 */
 void CG_ParticleEffect( vec3_t org, vec3_t dir, float r, float g, float b, int count )
 {
-	int j;
-	cparticle_t *p;
+	int i, j;
 	float d;
 
 	if( !cg_particles->integer )
 		return;
 
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, 1, 1, r + random()*0.1, g + random()*0.1, b + random()*0.1, NULL );
+		CG_InitParticle( i, 1, 1, r + random()*0.1, g + random()*0.1, b + random()*0.1, NULL );
 
 		d = rand() & 31;
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 20;
+			particles.org[j][i] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
+			particles.vel[j][i] = crandom() * 20;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleVector( particles.accel, i, 0, 0, -PARTICLE_GRAVITY );
+		particles.alphavel[i] = -1.0 / ( 0.5 + random() * 0.3 );
 	}
 }
 
@@ -682,29 +913,25 @@ void CG_ParticleEffect( vec3_t org, vec3_t dir, float r, float g, float b, int c
 */
 void CG_ParticleEffect2( vec3_t org, vec3_t dir, float r, float g, float b, int count )
 {
-	int j;
+	int i, j;
 	float d;
-	cparticle_t *p;
 
 	if( !cg_particles->integer )
 		return;
 
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, 1, 1, r, g, b, NULL );
+		CG_InitParticle( i, 1, 1, r, g, b, NULL );
 
 		d = rand()&7;
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 20;
+			particles.org[j][i] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
+			particles.vel[j][i] = crandom() * 20;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleVector( particles.accel, i, 0, 0, -PARTICLE_GRAVITY );
+		particles.alphavel[i] = -1.0 / ( 0.5 + random() * 0.3 );
 	}
 }
 
@@ -713,29 +940,25 @@ void CG_ParticleEffect2( vec3_t org, vec3_t dir, float r, float g, float b, int
 */
 void CG_ParticleExplosionEffect( vec3_t org, vec3_t dir, float r, float g, float b, int count )
 {
-	int j;
-	cparticle_t *p;
+	int i, j;
 	float d;
 
 	if( !cg_particles->integer )
 		return;
 
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, 1, 1, r + random()*0.1, g + random()*0.1, b + random()*0.1, NULL );
+		CG_InitParticle( i, 1, 1, r + random()*0.1, g + random()*0.1, b + random()*0.1, NULL );
 
 		d = rand() & 31;
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 200;
+			particles.org[j][i] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
+			particles.vel[j][i] = crandom() * 200;
 		}
 
-		//p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.7 + random() * 0.25 );
+		CG_SetParticleVector( particles.accel, i, 0, 0, -PARTICLE_GRAVITY );
+		particles.alphavel[i] = -1.0 / ( 0.7 + random() * 0.25 );
 	}
 }
 
@@ -745,12 +968,11 @@ void CG_ParticleExplosionEffect( vec3_t org, vec3_t dir, float r, float g, float
 */
 void CG_BlasterTrail( vec3_t start, vec3_t end )
 {
-	int j, count;
+	int i, j, count;
 	vec3_t move, vec;
 	float len;
 	//const float	dec = 5.0f;
 	const float dec = 3.0f;
-	cparticle_t *p;
 
 	if( !cg_particles->integer )
 		return;
@@ -761,20 +983,18 @@ void CG_BlasterTrail( vec3_t start, vec3_t end )
 	VectorScale( vec, dec, vec );
 
 	count = (int)( len / dec ) + 1;
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, 2.5f, 0.25f, 1.0f, 0.85f, 0, NULL );
+		CG_InitParticle( i, 2.5f, 0.25f, 1.0f, 0.85f, 0, NULL );
 
-		p->alphavel = -1.0 / ( 0.1 + random() * 0.2 );
+		particles.alphavel[i] = -1.0 / ( 0.1 + random() * 0.2 );
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = move[j] + crandom();
-			p->vel[j] = crandom() * 5;
+			particles.org[j][i] = move[j] + crandom();
+			particles.vel[j][i] = crandom() * 5;
 		}
 
-		VectorClear( p->accel );
+		CG_SetParticleVector( particles.accel, i, 0, 0, 0 );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -784,11 +1004,10 @@ void CG_BlasterTrail( vec3_t start, vec3_t end )
 */
 void CG_ElectroWeakTrail( vec3_t start, vec3_t end, vec4_t color )
 {
-	int j, count;
+	int i, j, count;
 	vec3_t move, vec;
 	float len;
 	const float dec = 5;
-	cparticle_t *p;
 	vec4_t ucolor = { 1.0f, 1.0f, 1.0f, 0.8f };
 
 	if( color )
@@ -803,22 +1022,19 @@ void CG_ElectroWeakTrail( vec3_t start, vec3_t end, vec4_t color )
 	VectorScale( vec, dec, vec );
 
 	count = (int)( len / dec ) + 1;
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		//CG_InitParticle( p, 2.0f, 0.8f, 1.0f, 1.0f, 1.0f, NULL );
-		CG_InitParticle( p, 2.0f, ucolor[3], ucolor[0], ucolor[1], ucolor[2], NULL );
+		//CG_InitParticle( i, 2.0f, 0.8f, 1.0f, 1.0f, 1.0f, NULL );
+		CG_InitParticle( i, 2.0f, ucolor[3], ucolor[0], ucolor[1], ucolor[2], NULL );
 
-		p->alphavel = -1.0 / ( 0.2 + random() * 0.1 );
+		particles.alphavel[i] = -1.0 / ( 0.2 + random() * 0.1 );
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = move[j] + random();/* + crandom();*/
-			p->vel[j] = crandom() * 2;
+			particles.org[j][i] = move[j] + random();/* + crandom();*/
+			particles.vel[j][i] = crandom() * 2;
 		}
 
-		VectorClear( p->accel );
+		CG_SetParticleVector( particles.accel, i, 0, 0, 0 );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -829,29 +1045,25 @@ void CG_ElectroWeakTrail( vec3_t start, vec3_t end, vec4_t color )
 */
 void CG_ImpactPuffParticles( vec3_t org, vec3_t dir, int count, float scale, float r, float g, float b, float a, struct shader_s *shader )
 {
-	int j;
+	int i, j;
 	float d;
-	cparticle_t *p;
 
 	if( !cg_particles->integer )
 		return;
 
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, scale, a, r, g, b, shader );
+		CG_InitParticle( i, scale, a, r, g, b, shader );
 
 		d = rand() & 15;
 		for( j = 0; j < 3; j++ )
 		{
-			p->org[j] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
-			p->vel[j] = dir[j] * 90 + crandom() * 40;
+			particles.org[j][i] = org[j] + ( ( rand()&7 ) - 4 ) + d * dir[j];
+			particles.vel[j][i] = dir[j] * 90 + crandom() * 40;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleVector( particles.accel, i, 0, 0, -PARTICLE_GRAVITY );
+		particles.alphavel[i] = -1.0 / ( 0.5 + random() * 0.3 );
 	}
 }
 
@@ -861,11 +1073,10 @@ void CG_ImpactPuffParticles( vec3_t org, vec3_t dir, int count, float scale, flo
 void CG_ElectroIonsTrail( vec3_t start, vec3_t end )
 {
 #define MAX_BOLT_IONS 48
-	int i, count;
+	int i, j, count;
 	vec3_t move, vec;
 	float len;
 	float dec2 = 24.0f;
-	cparticle_t *p;
 
 	if( !cg_particles->integer )
 		return;
@@ -882,19 +1093,17 @@ void CG_ElectroIonsTrail( vec3_t start, vec3_t end )
 	VectorScale( vec, dec2, vec );
 	VectorCopy( start, move );
 
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ )
 	{
-		CG_InitParticle( p, 1.2f, 1, 0.8f + crandom()*0.1, 0.8f + crandom()*0.1, 0.8f + crandom()*0.1, NULL );
+		CG_InitParticle( i, 1.2f, 1, 0.8f + crandom()*0.1, 0.8f + crandom()*0.1, 0.8f + crandom()*0.1, NULL );
 
-		for( i = 0; i < 3; i++ )
+		for( j = 0; j < 3; j++ )
 		{
-			p->org[i] = move[i];
-			p->vel[i] = crandom()*4;
+			particles.org[j][i] = move[j];
+			particles.vel[j][i] = crandom()*4;
 		}
-		p->alphavel = -1.0 / ( 0.6 + random()*0.6 );
-		VectorClear( p->accel );
+		particles.alphavel[i] = -1.0 / ( 0.6 + random()*0.6 );
+		CG_SetParticleVector( particles.accel, i, 0, 0, 0 );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -906,11 +1115,10 @@ void CG_ElectroIonsTrail( vec3_t start, vec3_t end )
 */
 static void CG_FlyParticles( vec3_t origin, int count )
 {
-	int i, j;
+	int i, j, k;
 	float angle, sp, sy, cp, cy;
 	vec3_t forward, dir;
 	float dist, ltime;
-	cparticle_t *p;
 
 	if( !cg_particles->integer )
 		return;
@@ -929,11 +1137,9 @@ static void CG_FlyParticles( vec3_t origin, int count )
 	ltime = (float)cg.time / 1000.0;
 
 	count /= 2;
-	if( cg_numparticles + count > MAX_PARTICLES )
-		count = MAX_PARTICLES - cg_numparticles;
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ )
+	for( k = CG_AllocParticles( &count ); count > 0; count--, k++ )
 	{
-		CG_InitParticle( p, 1, 1, 0, 0, 0, NULL );
+		CG_InitParticle( k, 1, 1, 0, 0, 0, NULL );
 
 		angle = ltime * avelocities[i][0];
 		sy = sin( angle );
@@ -948,13 +1154,12 @@ static void CG_FlyParticles( vec3_t origin, int count )
 
 		dist = sin( ltime + i ) * 64;
 		ByteToDir( i, dir );
-		p->org[0] = origin[0] + dir[0]*dist + forward[0]*BEAMLENGTH;
-		p->org[1] = origin[1] + dir[1]*dist + forward[1]*BEAMLENGTH;
-		p->org[2] = origin[2] + dir[2]*dist + forward[2]*BEAMLENGTH;
+		for( j = 0; j < 3; j++ )
+			particles.org[j][k] = origin[j] + dir[j]*dist + forward[j]*BEAMLENGTH;
 
-		VectorClear( p->vel );
-		VectorClear( p->accel );
-		p->alphavel = -100;
+		CG_SetParticleVector( particles.vel, k, 0, 0, 0 );
+		CG_SetParticleVector( particles.accel, k, 0, 0, 0 );
+		particles.alphavel[k] = -100;
 
 		i += 2;
 	}
@@ -1007,86 +1212,119 @@ void CG_FlyEffect( centity_t *ent, vec3_t origin )
 */
 void CG_AddParticles( void )
 {
-	int i, j, k;
-	float alpha;
-	float time, time2;
-	vec3_t org;
-	vec3_t corner;
+	int i, j, k, numParticles, numverts, firstvert;
+	float scale, now;
+	float *x, *y, *z;
 	byte_vec4_t color;
-	int maxparticle, activeparticles;
-	float alphaValues[MAX_PARTICLES];
-	cparticle_t *p, *free_particles[MAX_PARTICLES];
+	poly_t poly;
+	struct shader_s *shader, *defaultShader;
+	static float dt[MAX_PARTICLES], alpha[MAX_PARTICLES];
+	static float xyz[3][MAX_PARTICLES];
+	static struct shader_s *batchShaders[MAX_PARTICLES];
 
-	if( !cg_numparticles )
+	numParticles = particles.numParticles;
+	if( !numParticles )
 		return;
 
-	j = 0;
-	maxparticle = -1;
-	activeparticles = 0;
+	// integrate and fade every particle, these loops only touch flat
+	// float arrays so the compiler can vectorize them
+	now = cg.time;
+	for( i = 0; i < numParticles; i++ )
+		dt[i] = ( now - particles.time[i] ) * 0.001f;
+
+	for( i = 0; i < numParticles; i++ )
+		alpha[i] = particles.alpha[i] + dt[i] * particles.alphavel[i];
 
-	for( i = 0, p = particles; i < cg_numparticles; i++, p++ )
+	for( j = 0; j < 3; j++ )
 	{
-		time = ( cg.time - p->time ) * 0.001f;
-		alpha = alphaValues[i] = p->alpha + time * p->alphavel;
+		const float *org = particles.org[j], *vel = particles.vel[j], *accel = particles.accel[j];
+		float *out = xyz[j];
 
-		if( alpha <= 0 )
-		{               // faded out
-			free_particles[j++] = p;
+		for( i = 0; i < numParticles; i++ )
+			out[i] = org[i] + vel[i] * dt[i] + accel[i] * dt[i] * dt[i] * 0.5f;
+	}
+
+	// drop faded out particles, keeping the live ones in spawn order
+	for( i = 0, k = 0; i < numParticles; i++ )
+	{
+		if( alpha[i] <= 0 )
 			continue;
+
+		if( k != i )
+		{
+			particles.time[k] = particles.time[i];
+			particles.alpha[k] = particles.alpha[i];
+			particles.alphavel[k] = particles.alphavel[i];
+			particles.scale[k] = particles.scale[i];
+			particles.shader[k] = particles.shader[i];
+			for( j = 0; j < 3; j++ )
+			{
+				particles.org[j][k] = particles.org[j][i];
+				particles.vel[j][k] = particles.vel[j][i];
+				particles.accel[j][k] = particles.accel[j][i];
+				particles.color[j][k] = particles.color[j][i];
+				xyz[j][k] = xyz[j][i];
+			}
+			alpha[k] = alpha[i];
 		}
+		k++;
+	}
 
-		maxparticle = i;
-		activeparticles++;
+	particles.numParticles = numParticles = k;
+	if( !numParticles )
+		return;
 
-		time2 = time * time * 0.5f;
+	defaultShader = CG_MediaShader( cgs.media.shaderParticle );
+	for( i = 0; i < numParticles; i++ )
+		batchShaders[i] = particles.shader[i] ? particles.shader[i] : defaultShader;
 
-		org[0] = p->org[0] + p->vel[0]*time + p->accel[0]*time2;
-		org[1] = p->org[1] + p->vel[1]*time + p->accel[1]*time2;
-		org[2] = p->org[2] + p->vel[2]*time + p->accel[2]*time2;
+	memset( &poly, 0, sizeof( poly ) );
+	poly.stcoords = cg_particleStcoords;
+	poly.fognum = 0;	// the renderer finds the fog of each quad
 
-		color[0] = (qbyte)( bound( 0, p->color[0], 1.0f ) * 255 );
-		color[1] = (qbyte)( bound( 0, p->color[1], 1.0f ) * 255 );
-		color[2] = (qbyte)( bound( 0, p->color[2], 1.0f ) * 255 );
-		color[3] = (qbyte)( bound( 0, alpha, 1.0f ) * 255 );
+	x = xyz[0];
+	y = xyz[1];
+	z = xyz[2];
 
-		corner[0] = org[0];
-		corner[1] = org[1] - 0.5f * p->scale;
-		corner[2] = org[2] - 0.5f * p->scale;
+	// build one batch of quads per shader
+	numverts = 0;
+	for( k = 0; k < numParticles; k++ )
+	{
+		shader = batchShaders[k];
+		if( !shader )
+			continue;
 
-		Vector4Set( p->pVerts[0], corner[0], corner[1] + p->scale, corner[2] + p->scale, 1 );
-		Vector4Set( p->pVerts[1], corner[0], corner[1], corner[2] + p->scale, 1 );
-		Vector4Set( p->pVerts[2], corner[0], corner[1], corner[2], 1 );
-		Vector4Set( p->pVerts[3], corner[0], corner[1] + p->scale, corner[2], 1 );
-		for( k = 0; k < 4; k++ )
+		firstvert = numverts;
+		for( i = k; i < numParticles; i++ )
 		{
-			Vector4Copy( color, p->pColor[k] );
+			if( batchShaders[i] != shader )
+				continue;
+			batchShaders[i] = NULL;
+
+			scale = particles.scale[i];
+
+			color[0] = (qbyte)( bound( 0, particles.color[0][i], 1.0f ) * 255 );
+			color[1] = (qbyte)( bound( 0, particles.color[1][i], 1.0f ) * 255 );
+			color[2] = (qbyte)( bound( 0, particles.color[2][i], 1.0f ) * 255 );
+			color[3] = (qbyte)( bound( 0, alpha[i], 1.0f ) * 255 );
+
+			Vector4Set( cg_particleVerts[numverts+0], x[i], y[i] + 0.5f * scale, z[i] + 0.5f * scale, 1 );
+			Vector4Set( cg_particleVerts[numverts+1], x[i], y[i] - 0.5f * scale, z[i] + 0.5f * scale, 1 );
+			Vector4Set( cg_particleVerts[numverts+2], x[i], y[i] - 0.5f * scale, z[i] - 0.5f * scale, 1 );
+			Vector4Set( cg_particleVerts[numverts+3], x[i], y[i] + 0.5f * scale, z[i] - 0.5f * scale, 1 );
+			for( j = 0; j < 4; j++ )
+				Vector4Copy( color, cg_particleColors[numverts+j] );
+			numverts += 4;
 		}
 
-		p->poly.numverts = 4;
-		p->poly.verts = p->pVerts;
-		p->poly.stcoords = p->pStcoords;
-		p->poly.colors = p->pColor;
-		p->poly.fognum = p->fog ? 0 : -1;
-		p->poly.shader = ( p->shader == NULL ) ? CG_MediaShader( cgs.media.shaderParticle ) : p->shader;
-
-		trap_R_AddPolyToScene( &p->poly );
-	}
-
-	i = 0;
-	while( maxparticle >= activeparticles )
-	{
-		*free_particles[i++] = particles[maxparticle--];
+		poly.numverts = numverts - firstvert;
+		poly.verts = &cg_particleVerts[firstvert];
+		poly.stcoords = &cg_particleStcoords[firstvert];
+		poly.colors = &cg_particleColors[firstvert];
+		poly.shader = shader;
 
-		while( maxparticle >= activeparticles )
-		{
-			if( alphaValues[maxparticle] <= 0 )
-				maxparticle--;
-			else
-				break;
-		}
+		trap_R_AddQuadsToScene( &poly );
 	}
-
-	cg_numparticles = activeparticles;
 }
 
 /*
@@ -1096,6 +1334,7 @@ void CG_ClearEffects( void )
 {
 	CG_ClearFragmentedDecals();
 	CG_ClearParticles();
+	CG_ClearPlayerTrails();
 	CG_ClearDlights();
 	CG_ClearLightStyles();
 	CG_ClearShadeBoxes();
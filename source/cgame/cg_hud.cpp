@@ -2850,6 +2850,27 @@ static const char *CG_GetStringArg( struct cg_layoutnode_s **argumentsnode )
 	return anode->string;
 }
 
+/*
+* CG_GetNumericReference
+* each reference is evaluated only once per HUD pass, no matter how many nodes use it
+*/
+#define NUM_LAYOUT_REFERENCES ( sizeof( cg_numeric_references ) / sizeof( cg_numeric_references[0] ) )
+
+static unsigned int layout_pass;
+static unsigned int layout_reference_pass[NUM_LAYOUT_REFERENCES];
+static int layout_reference_value[NUM_LAYOUT_REFERENCES];
+
+static int CG_GetNumericReference( int index )
+{
+	if( layout_reference_pass[index] != layout_pass || !layout_pass )
+	{
+		layout_reference_value[index] = cg_numeric_references[index].func( cg_numeric_references[index].parameter );
+		layout_reference_pass[index] = layout_pass;
+	}
+
+	return layout_reference_value[index];
+}
+
 /*
 * CG_GetNumericArg
 * can use recursion for mathematical operations
@@ -2868,7 +2889,7 @@ static float CG_GetNumericArg( struct cg_layoutnode_s **argumentsnode )
 	*argumentsnode = anode->next;
 	if( anode->type == LNODE_REFERENCE_NUMERIC )
 	{
-		value = cg_numeric_references[anode->integer].func( cg_numeric_references[anode->integer].parameter );
+		value = CG_GetNumericReference( anode->integer );
 	}
 	else
 	{
@@ -3369,39 +3390,107 @@ static void CG_RecursePrintLayoutThread( cg_layoutnode_t *rootnode, int level )
 }
 #endif
 
+//=============================================================================
+
 /*
-* CG_ParseLayoutScript
+* Compiled layout programs
+*
+* The parsed script is a tree of linked nodes. At load time it's flattened
+* into an array of instructions, each one a command with its arguments laid
+* out next to each other and the number of instructions its "if" block takes,
+* so a false condition skips them in one step. Argument counts are checked
+* once here instead of every frame.
+*
+* Operators are right associative, so any constant tail of an expression is
+* folded into a single value, and "if" blocks with constant conditions are
+* either inlined or dropped. What's left to evaluate per frame are the
+* numeric references, which are computed once per pass and shared by all the
+* nodes using them (see CG_GetNumericReference).
 */
-static void CG_ParseLayoutScript( char *string, cg_layoutnode_t *rootnode )
+
+typedef struct
 {
+	cg_layoutnode_t *command;
+	cg_layoutnode_t *arguments;		// points into the program arguments
+	int numArguments;
+	int skip;						// instructions of the "if" block following this one
+} cg_layoutinstr_t;
 
-	CG_RecurseFreeLayoutThread( cg.statusBar );
-	cg.statusBar = CG_RecurseParseLayoutScript( &string, 0 );
+typedef struct cg_layoutprogram_s
+{
+	cg_layoutnode_t *tree;			// owns the commands and the strings
+	cg_layoutinstr_t *instrs;
+	int numInstrs;
+	cg_layoutnode_t *args;
+	int numArgs;
+} cg_layoutprogram_t;
 
-#if 0
-	CG_RecursePrintLayoutThread( cg_layoutRootNode, 0 );
-#endif
+/*
+* CG_CountLayoutNodes
+*/
+static void CG_CountLayoutNodes( cg_layoutnode_t *rootnode, int *numCommands, int *numArguments )
+{
+	cg_layoutnode_t *node;
+
+	for( node = rootnode; node; node = node->parent )
+	{
+		if( node->type == LNODE_COMMAND )
+			( *numCommands )++;
+		else
+			( *numArguments )++;
+
+		if( node->ifthread )
+			CG_CountLayoutNodes( node->ifthread, numCommands, numArguments );
+	}
 }
 
-//=============================================================================
+/*
+* CG_CompileLayoutArguments
+* copies the arguments from node up to end and folds the constant expressions
+*/
+static void CG_CompileLayoutArguments( cg_layoutprogram_t *program, cg_layoutnode_t *node, cg_layoutnode_t *end )
+{
+	int i, first = program->numArgs;
+	cg_layoutnode_t *arg;
 
-//=============================================================================
+	for( ; node != end; node = node->next )
+		program->args[program->numArgs++] = *node;
+
+	// backwards, so a chain of constants keeps collapsing into its first node
+	for( i = program->numArgs - 2; i >= first; i-- )
+	{
+		arg = &program->args[i];
+		if( !arg->opFunc || arg->type != LNODE_NUMERIC )
+			continue;
+		if( arg[1].opFunc || arg[1].type != LNODE_NUMERIC )
+			continue;
+
+		arg->value = arg->opFunc( arg->value, arg[1].value );
+		arg->integer = (int)arg->value;
+		arg->opFunc = NULL;
+
+		memmove( arg + 1, arg + 2, sizeof( *arg ) * ( program->numArgs - i - 2 ) );
+		program->numArgs--;
+	}
+
+	for( i = first; i < program->numArgs; i++ )
+	{
+		arg = &program->args[i];
+		arg->next = ( i + 1 < program->numArgs ) ? arg + 1 : NULL;
+		arg->parent = NULL;
+		arg->ifthread = NULL;
+	}
+}
 
 /*
-* CG_RecurseExecuteLayoutThread
-* Execution works like this: First node (on backwards) is expected to be the command, followed by arguments nodes.
-* we keep a pointer to the command and run the tree counting arguments until we reach the next command,
-* then we call the command function sending the pointer to first argument and the pointer to the command.
-* At return we advance one node (we stopped at last argument node) so it starts again from the next command (if any).
-* 
-* When finding an "if" command with a subtree, we execute the "if" command. In the case it
-* returns any value, we recurse execute the subtree
+* CG_RecurseCompileLayoutThread
+* recursive for compiling "if" subtrees
 */
-static void CG_RecurseExecuteLayoutThread( cg_layoutnode_t *rootnode )
+static void CG_RecurseCompileLayoutThread( cg_layoutprogram_t *program, cg_layoutnode_t *rootnode )
 {
-	cg_layoutnode_t	*argumentnode = NULL;
-	cg_layoutnode_t	*commandnode = NULL;
-	int numArguments;
+	cg_layoutnode_t *commandnode, *node, *cond;
+	cg_layoutinstr_t *instr;
+	int numArguments, first;
 
 	if( !rootnode )
 		return;
@@ -3409,64 +3498,137 @@ static void CG_RecurseExecuteLayoutThread( cg_layoutnode_t *rootnode )
 	// run until the real root
 	commandnode = rootnode;
 	while( commandnode->parent )
-	{
 		commandnode = commandnode->parent;
-	}
 
-	// now run backwards up to the next command node
 	while( commandnode )
 	{
-		argumentnode = commandnode->next;
-
-		// we could trust the parser, but I prefer counting the arguments here
 		numArguments = 0;
-		while( argumentnode )
-		{
-			if( argumentnode->type == LNODE_COMMAND )
-				break;
-
-			argumentnode = argumentnode->next;
+		for( node = commandnode->next; node && node->type != LNODE_COMMAND; node = node->next )
 			numArguments++;
-		}
 
-		// reset
-		argumentnode = commandnode->next;
-
-		// Execute the command node
 		if( commandnode->integer != numArguments )
 		{
 			CG_Printf( "ERROR: Layout command %s: invalid argument count (expecting %i, found %i)\n", commandnode->string, commandnode->integer, numArguments );
 			return;
 		}
+
 		if( commandnode->func )
 		{
-			//special case for if commands
-			if( commandnode->func( commandnode, argumentnode, numArguments ) )
+			first = program->numArgs;
+			CG_CompileLayoutArguments( program, commandnode->next, node );
+
+			cond = &program->args[first];
+			if( commandnode->func == CG_LFuncIf && program->numArgs == first + 1 && cond->type == LNODE_NUMERIC && !cond->opFunc )
 			{
-				// execute the "if" thread when command returns a value
-				if( commandnode->ifthread )
-					CG_RecurseExecuteLayoutThread( commandnode->ifthread );
+				// constant condition, the block is either always or never there
+				program->numArgs = first;
+				if( (int)cond->value != 0 )
+					CG_RecurseCompileLayoutThread( program, commandnode->ifthread );
 			}
-		}
-
-		//move up to next command node
-		commandnode = argumentnode;
-		if( commandnode == rootnode )
-			return;
+			else
+			{
+				instr = &program->instrs[program->numInstrs++];
+				instr->command = commandnode;
+				instr->arguments = program->numArgs > first ? &program->args[first] : NULL;
+				instr->numArguments = program->numArgs - first;
 
-		while( commandnode && commandnode->type != LNODE_COMMAND )
-		{
-			commandnode = commandnode->next;
+				CG_RecurseCompileLayoutThread( program, commandnode->ifthread );
+				instr->skip = program->instrs + program->numInstrs - instr - 1;
+			}
 		}
+
+		// move on to the next command node
+		commandnode = node;
 	}
 }
 
+/*
+* CG_CompileLayoutProgram
+*/
+static cg_layoutprogram_t *CG_CompileLayoutProgram( cg_layoutnode_t *rootnode )
+{
+	int numCommands = 0, numArguments = 0;
+	cg_layoutprogram_t *program;
+
+	if( !rootnode )
+		return NULL;
+
+	CG_CountLayoutNodes( rootnode, &numCommands, &numArguments );
+
+	program = ( cg_layoutprogram_t * )CG_Malloc( sizeof( cg_layoutprogram_t ) );
+	program->tree = rootnode;
+	program->instrs = ( cg_layoutinstr_t * )CG_Malloc( sizeof( cg_layoutinstr_t ) * max( numCommands, 1 ) );
+	program->args = ( cg_layoutnode_t * )CG_Malloc( sizeof( cg_layoutnode_t ) * max( numArguments, 1 ) );
+
+	CG_RecurseCompileLayoutThread( program, rootnode );
+
+	if( cg_debugHUD && cg_debugHUD->integer )
+		CG_Printf( "HUD: compiled %i commands, %i arguments into %i instructions, %i arguments\n",
+			numCommands, numArguments, program->numInstrs, program->numArgs );
+
+	return program;
+}
+
+/*
+* CG_FreeLayoutProgram
+*/
+static void CG_FreeLayoutProgram( cg_layoutprogram_t *program )
+{
+	if( !program )
+		return;
+
+	CG_RecurseFreeLayoutThread( program->tree );
+	CG_Free( program->instrs );
+	CG_Free( program->args );
+	CG_Free( program );
+}
+
+/*
+* CG_ParseLayoutScript
+*/
+static void CG_ParseLayoutScript( char *string )
+{
+	cg_layoutnode_t *rootnode;
+
+	CG_FreeLayoutProgram( cg.statusBar );
+	cg.statusBar = NULL;
+
+	// precache calls evaluate their arguments without a running pass
+	layout_pass = 0;
+	rootnode = CG_RecurseParseLayoutScript( &string, 0 );
+
+#if 0
+	CG_RecursePrintLayoutThread( rootnode, 0 );
+#endif
+
+	cg.statusBar = CG_CompileLayoutProgram( rootnode );
+}
+
+//=============================================================================
+
 /*
 * CG_ExecuteLayoutProgram
+* runs the instructions in order. When a command returns false, which "if"
+* commands do for a false condition, the instructions of its block are skipped
 */
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode )
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program )
 {
-	CG_RecurseExecuteLayoutThread( rootnode );
+	int i;
+	cg_layoutinstr_t *instr;
+
+	if( !program )
+		return;
+
+	// a new pass, the references are evaluated again
+	if( !++layout_pass )
+		layout_pass = 1;
+
+	for( i = 0; i < program->numInstrs; i++ )
+	{
+		instr = &program->instrs[i];
+		if( !instr->command->func( instr->command, instr->arguments, instr->numArguments ) )
+			i += instr->skip;
+	}
 }
 
 //=============================================================================
@@ -3873,7 +4035,7 @@ static void CG_LoadStatusBarFile( char *path )
 		return;
 	}
 	// load the new status bar program
-	CG_ParseLayoutScript( opt, cg.statusBar );
+	CG_ParseLayoutScript( opt );
 	// Free the opt buffer!
 	CG_Free( opt );
 
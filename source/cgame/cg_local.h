@@ -597,7 +597,7 @@ typedef struct
 	int checkpoints[MAX_CHECKPOINTS]; // racesow
 
 	// statusbar program
-	struct cg_layoutnode_s *statusBar;
+	struct cg_layoutprogram_s *statusBar;
 
 	cg_viewweapon_t weapon;
 	cg_viewdef_t view;
@@ -750,7 +750,7 @@ extern cvar_t *cg_strafeHUD;
 
 void CG_SC_Obituary( void );
 void Cmd_CG_PrintHudHelp_f( void );
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode );
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program );
 
 // racesow
 void CG_CheckpointsClear( void );
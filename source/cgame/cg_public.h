@@ -30,7 +30,7 @@ typedef unsigned int (*cg_get_raw_samples_cb_t)(void*);
 
 // cg_public.h -- client game dll information visible to engine
 
-#define	CGAME_API_VERSION   65
+#define	CGAME_API_VERSION   67
 
 //
 // structs and variables shared with the main engine
@@ -168,6 +168,7 @@ typedef struct
 	void ( *R_AddEntityToScene )( const struct entity_s *ent );
 	void ( *R_AddLightToScene )( const vec3_t org, float intensity, float r, float g, float b );
 	void ( *R_AddPolyToScene )( const struct poly_s *poly );
+	void ( *R_AddQuadsToScene )( const struct poly_s *poly );
 	void ( *R_AddLightStyleToScene )( int style, float r, float g, float b );
 	void ( *R_RenderScene )( const struct refdef_s *fd );
 	const char *( *R_SpeedsMessage )( char *out, size_t size );
@@ -307,6 +307,11 @@ static inline void trap_R_AddPolyToScene( const poly_t *poly )
 	CGAME_IMPORT.R_AddPolyToScene( poly );
 }
 
+static inline void trap_R_AddQuadsToScene( const poly_t *poly )
+{
+	CGAME_IMPORT.R_AddQuadsToScene( poly );
+}
+
 static inline void trap_R_AddLightStyleToScene( int style, float r, float g, float b )
 {
 	CGAME_IMPORT.R_AddLightStyleToScene( style, r, g, b );
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define	MAX_ENTITIES			2048
 #define MAX_POLY_VERTS			3000
 #define MAX_POLYS				2048
+#define MAX_POLY_QUADS			2048	// per AddQuadsToScene batch
 
 // entity_state_t->renderfx flags
 #define	RF_MINLIGHT				0x1       // always have some light (viewmodel)
@@ -85,6 +86,8 @@ typedef struct poly_s
 	byte_vec4_t *colors;
 	struct shader_s	*shader;
 	int fognum;
+	unsigned short *elems;				// optional triangle list, the polygon is
+	int numelems;						// treated as a triangle fan if NULL
 } poly_t;
 
 typedef struct
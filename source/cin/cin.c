@@ -49,6 +49,7 @@ typedef struct
 	qboolean ( *need_next_frame )( cinematics_t *cin );
 	qbyte *( *read_next_frame )( cinematics_t *cin, qboolean *redraw );
 	cin_yuv_t *( *read_next_frame_yuv )( cinematics_t *cin, qboolean *redraw );
+	void ( *get_stats )( cinematics_t *cin, cin_stats_t *stats );
 } cin_type_t;
 
 static const cin_type_t cin_types[] = 
@@ -65,7 +66,8 @@ static const cin_type_t cin_types[] =
 #else
 		NULL,
 #endif
-		Theora_ReadNextFrameYUV_CIN
+		Theora_ReadNextFrameYUV_CIN,
+		Theora_GetStats_CIN
 	},
 
 	// RoQ - http://wiki.multimedia.cx/index.php?title=ROQ
@@ -76,7 +78,8 @@ static const cin_type_t cin_types[] =
 		RoQ_Reset_CIN,
 		RoQ_NeedNextFrame_CIN,
 		NULL,
-		RoQ_ReadNextFrameYUV_CIN
+		RoQ_ReadNextFrameYUV_CIN,
+		NULL
 	},
 
 	// NULL safe guard
@@ -87,6 +90,7 @@ static const cin_type_t cin_types[] =
 		NULL,
 		NULL,
 		NULL,
+		NULL,
 		NULL
 	}
 };
@@ -435,3 +439,21 @@ void CIN_Close( cinematics_t *cin )
 	CIN_Free( cin );
 	CIN_FreePool( &mempool );
 }
+
+/*
+* CIN_GetStats
+*/
+void CIN_GetStats( cinematics_t *cin, cin_stats_t *stats )
+{
+	const cin_type_t *type;
+
+	memset( stats, 0, sizeof( *stats ) );
+	if( !cin )
+		return;
+
+	assert( cin->type > CIN_TYPE_NONE && cin->type < CIN_NUM_TYPES );
+
+	type = &cin_types[cin->type];
+	if( type->get_stats )
+		type->get_stats( cin, stats );
+}
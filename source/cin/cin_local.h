@@ -82,6 +82,8 @@ typedef struct cinematics_s
 	struct mempool_s *mempool;
 } cinematics_t;
 
+extern cvar_t *cin_decodethread;
+
 void Com_DPrintf( const char *format, ... );
 
 int CIN_API( void );
@@ -114,4 +116,6 @@ void CIN_Reset( cinematics_t *cin, unsigned int cur_time );
 
 void CIN_Close( cinematics_t *cin );
 
+void CIN_GetStats( cinematics_t *cin, cin_stats_t *stats );
+
 #endif
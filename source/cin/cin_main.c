@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 struct mempool_s *cinPool;
 
+cvar_t *cin_decodethread;
+
 /*
 * CIN_API
 */
@@ -36,6 +38,8 @@ int CIN_API( void )
 qboolean CIN_Init( qboolean verbose )
 {
 	cinPool = CIN_AllocPool( "Generic pool" );
+
+	cin_decodethread = trap_Cvar_Get( "cin_decodethread", "1", CVAR_ARCHIVE );
 	return qtrue;
 }
 
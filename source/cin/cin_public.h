@@ -24,11 +24,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 // cin_public.h -- cinematics playback as a separate dll, making the engine
 // container- and format- agnostic
 
-#define	CIN_API_VERSION				5
+#define	CIN_API_VERSION				6
 
 //===============================================================
 
 struct cinematics_s;
+struct qthread_s;
+struct qmutex_s;
+struct qcondvar_s;
 
 typedef struct {
 	// MUST MATCH ref_img_plane_t
@@ -67,6 +70,15 @@ typedef struct {
 	//===============================
 } cin_yuv_t;
 
+typedef struct {
+	int queued_frames;				// decoded frames waiting for their presentation time
+	int max_queued_frames;
+	unsigned int decoded_frames;
+	unsigned int dropped_frames;	// late frames that were skipped or never shown
+	unsigned int decode_usec;		// average time spent decoding a frame
+	unsigned int max_decode_usec;
+} cin_stats_t;
+
 typedef void (*cin_raw_samples_cb_t)(void*,unsigned int, unsigned int, 
 	unsigned short, unsigned short, const qbyte *);
 typedef unsigned int (*cin_get_raw_samples_cb_t)(void*);
@@ -122,6 +134,18 @@ typedef struct
 	unsigned int	( *Milliseconds )( void );
 	quint64			( *Microseconds )( void );
 
+	// threads
+	struct qthread_s *( *Thread_Create )( void *( *routine )( void * ), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
+	struct qmutex_s *( *Mutex_Create )( void );
+	void ( *Mutex_Destroy )( struct qmutex_s **pmutex );
+	void ( *Mutex_Lock )( struct qmutex_s *mutex );
+	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+	struct qcondvar_s *( *CondVar_Create )( void );
+	void ( *CondVar_Destroy )( struct qcondvar_s **pcond );
+	void ( *CondVar_Wait )( struct qcondvar_s *cond, struct qmutex_s *mutex );
+	void ( *CondVar_WakeAll )( struct qcondvar_s *cond );
+
 	// managed memory allocation
 	struct mempool_s *( *Mem_AllocPool )( const char *name, const char *filename, int fileline );
 	void *( *Mem_Alloc )( struct mempool_s *pool, size_t size, const char *filename, int fileline );
@@ -149,6 +173,7 @@ typedef struct
 	qboolean ( *AddRawSamplesListener )( struct cinematics_s *cin, void *listener, cin_raw_samples_cb_t rs, cin_get_raw_samples_cb_t grs );
 	void ( *Reset )( struct cinematics_s *cin, unsigned int cur_time );
 	void ( *Close )( struct cinematics_s *cin );
+	void ( *GetStats )( struct cinematics_s *cin, cin_stats_t *stats );
 } cin_export_t;
 
 #endif
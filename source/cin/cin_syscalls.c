@@ -45,6 +45,7 @@ QF_DLL_EXPORT cin_export_t *GetCinematicsAPI( cin_import_t *import )
 	globals.AddRawSamplesListener = &CIN_AddRawSamplesListener;
 	globals.Reset = &CIN_Reset;
 	globals.Close = &CIN_Close;
+	globals.GetStats = &CIN_GetStats;
 
 	return &globals;
 }
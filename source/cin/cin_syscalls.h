@@ -171,6 +171,57 @@ static inline quint64 trap_Microseconds( void )
 	return CIN_IMPORT.Microseconds();
 }
 
+// threads
+static inline struct qthread_s *trap_Thread_Create( void *( *routine )( void * ), void *param )
+{
+	return CIN_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread )
+{
+	CIN_IMPORT.Thread_Join( thread );
+}
+
+static inline struct qmutex_s *trap_Mutex_Create( void )
+{
+	return CIN_IMPORT.Mutex_Create();
+}
+
+static inline void trap_Mutex_Destroy( struct qmutex_s **pmutex )
+{
+	CIN_IMPORT.Mutex_Destroy( pmutex );
+}
+
+static inline void trap_Mutex_Lock( struct qmutex_s *mutex )
+{
+	CIN_IMPORT.Mutex_Lock( mutex );
+}
+
+static inline void trap_Mutex_Unlock( struct qmutex_s *mutex )
+{
+	CIN_IMPORT.Mutex_Unlock( mutex );
+}
+
+static inline struct qcondvar_s *trap_CondVar_Create( void )
+{
+	return CIN_IMPORT.CondVar_Create();
+}
+
+static inline void trap_CondVar_Destroy( struct qcondvar_s **pcond )
+{
+	CIN_IMPORT.CondVar_Destroy( pcond );
+}
+
+static inline void trap_CondVar_Wait( struct qcondvar_s *cond, struct qmutex_s *mutex )
+{
+	CIN_IMPORT.CondVar_Wait( cond, mutex );
+}
+
+static inline void trap_CondVar_WakeAll( struct qcondvar_s *cond )
+{
+	CIN_IMPORT.CondVar_WakeAll( cond );
+}
+
 // memory
 static inline struct mempool_s *trap_MemAllocPool( const char *name, const char *filename, int fileline )
 {
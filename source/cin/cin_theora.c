@@ -33,6 +33,37 @@ OGG THEORA FORMAT PLAYBACK
 
 #define OGG_BUFFER_SIZE		4*1024
 
+/*
+* Video packets are decoded ahead of time, on a thread of their own unless
+* cin_decodethread is 0. The reading side demuxes the file, decodes audio
+* for the listeners and queues copies of the video packets. The decoder
+* turns them into pictures, copied out of libtheora's buffers into a small
+* ring of frames tagged with their frame numbers. Reading then shows the
+* newest frame that is due according to the audio clock, frames that are
+* already late by then are skipped.
+*
+* One frame slot is always left for the frame being shown, so the decoder
+* never writes over the picture returned by the last read.
+*/
+
+#define TH_MAX_QUEUED_PACKETS	32
+#define TH_NUM_FRAME_SLOTS		6
+
+typedef struct
+{
+	unsigned char	*data;
+	long			bytes;
+	ogg_int64_t		granulepos;
+	ogg_int64_t		packetno;
+} qtheora_packet_t;
+
+typedef struct
+{
+	unsigned int	frame;
+	cin_yuv_t		yuv;
+	qbyte			*data;
+} qtheora_frame_t;
+
 typedef struct
 {
 	qboolean		 a_stream;
@@ -56,13 +87,35 @@ typedef struct
 	th_dec_ctx		*tctx;
 	th_comment		tc;
 	th_info			ti;
-	ogg_int64_t		th_granulepos;
+	ogg_int64_t		th_granulepos;				/* owned by the decoder */
 	unsigned int	th_granulemsec;
-	th_ycbcr_buffer th_yuv;
 	cin_yuv_t		pub_yuv;
 	unsigned int	th_seek_msec_to;
 	qboolean		th_seek_to_keyframe;
 	unsigned int	th_max_keyframe_interval;	/* maximum time between keyframes in msecs */
+	ogg_int64_t		th_feed_granulepos;			/* granule position of the last packet read */
+	qboolean		th_feed_resync;				/* packets have been skipped, tell the decoder where we are */
+
+	struct qthread_s *th_thread;
+	struct qmutex_s	*th_lock;
+	struct qcondvar_s *th_cond;					/* wakes up both sides */
+	qboolean		th_quit;
+
+	/* all of the below is protected by th_lock when the thread is running */
+	qtheora_packet_t th_packets[TH_MAX_QUEUED_PACKETS];
+	unsigned int	th_packet_free;				/* packets before this one have been freed */
+	unsigned int	th_packet_read;				/* packets before this one have been decoded */
+	unsigned int	th_packet_write;
+
+	qtheora_frame_t	th_frames[TH_NUM_FRAME_SLOTS];
+	int				th_frame_head;
+	int				th_num_frames;
+
+	int				th_max_queued_frames;
+	unsigned int	th_decoded_frames;
+	unsigned int	th_dropped_frames;
+	quint64			th_decode_usec;
+	unsigned int	th_max_decode_usec;
 } qtheora_info_t;
 
 /*
@@ -247,26 +300,273 @@ static qboolean OggTheora_NeedVideoData( cinematics_t *cin )
 }
 
 /*
-* OggTheora_LoadVideoFrame
+* OggTheora_Lock
+*/
+static inline void OggTheora_Lock( qtheora_info_t *qth )
+{
+	if( qth->th_thread ) {
+		trap_Mutex_Lock( qth->th_lock );
+	}
+}
+
+/*
+* OggTheora_Unlock
+*/
+static inline void OggTheora_Unlock( qtheora_info_t *qth )
+{
+	if( qth->th_thread ) {
+		trap_Mutex_Unlock( qth->th_lock );
+	}
+}
+
+/*
+* OggTheora_CanDecode
 *
-* Return qtrue if a new video frame has been successfully loaded
+* Whether there's a packet to decode and a free slot for the picture
+*/
+static inline qboolean OggTheora_CanDecode( qtheora_info_t *qth )
+{
+	return qth->th_packet_read != qth->th_packet_write 
+		&& qth->th_num_frames < TH_NUM_FRAME_SLOTS - 1;
+}
+
+/*
+* OggTheora_DecodePacket
+*
+* Decodes the next queued packet into the next free frame slot.
+* Returns qtrue if there's a new picture in the slot
+*/
+static qboolean OggTheora_DecodePacket( qtheora_info_t *qth, qtheora_packet_t *packet, qtheora_frame_t *frame )
+{
+	int i, row, error;
+	int width, height;
+	ogg_packet op;
+	th_ycbcr_buffer yuv;
+	cin_img_plane_t *plane;
+
+	memset( &op, 0, sizeof( op ) );
+	op.packet = packet->data;
+	op.bytes = packet->bytes;
+	op.granulepos = packet->granulepos;
+	op.packetno = packet->packetno;
+
+	if( op.granulepos >= 0 ) {
+		th_decode_ctl( qth->tctx, TH_DECCTL_SET_GRANPOS, &op.granulepos, sizeof( op.granulepos ) );
+	}
+
+	error = th_decode_packetin( qth->tctx, &op, &qth->th_granulepos );
+	if( error < 0 ) {
+		// bad packet
+		return qfalse;
+	}
+
+	if( error == TH_DUPFRAME ) {
+		// same picture as before, keep showing the last one
+		return qfalse;
+	}
+
+	if( th_decode_ycbcr_out( qth->tctx, yuv ) != 0 ) {
+		// error
+		return qfalse;
+	}
+
+	// the decoder reuses its buffers for the next packet
+	for( i = 0; i < 3; i++ ) {
+		plane = &frame->yuv.yuv[i];
+		width = min( yuv[i].width, plane->width );
+		height = min( yuv[i].height, plane->height );
+
+		for( row = 0; row < height; row++ ) {
+			memcpy( plane->data + row * plane->stride, yuv[i].data + row * yuv[i].stride, width );
+		}
+	}
+
+	frame->frame = th_granule_frame( qth->tctx, qth->th_granulepos );
+
+	return qtrue;
+}
+
+/*
+* OggTheora_NextPacket
+*/
+static inline qtheora_packet_t *OggTheora_NextPacket( qtheora_info_t *qth )
+{
+	return &qth->th_packets[qth->th_packet_read % TH_MAX_QUEUED_PACKETS];
+}
+
+/*
+* OggTheora_NextFreeFrame
+*/
+static inline qtheora_frame_t *OggTheora_NextFreeFrame( qtheora_info_t *qth )
+{
+	return &qth->th_frames[( qth->th_frame_head + qth->th_num_frames ) % TH_NUM_FRAME_SLOTS];
+}
+
+/*
+* OggTheora_PacketDecoded
+*/
+static void OggTheora_PacketDecoded( qtheora_info_t *qth, qboolean haveFrame, unsigned int usec )
+{
+	qth->th_packet_read++;
+
+	if( !haveFrame ) {
+		return;
+	}
+
+	qth->th_num_frames++;
+	qth->th_max_queued_frames = max( qth->th_max_queued_frames, qth->th_num_frames );
+	qth->th_decoded_frames++;
+	qth->th_decode_usec += usec;
+	qth->th_max_decode_usec = max( qth->th_max_decode_usec, usec );
+}
+
+/*
+* OggTheora_DecoderThreadProc
+*/
+static void *OggTheora_DecoderThreadProc( void *param )
+{
+	qboolean haveFrame;
+	quint64 usec;
+	qtheora_packet_t *packet;
+	qtheora_frame_t *frame;
+	qtheora_info_t *qth = param;
+
+	trap_Mutex_Lock( qth->th_lock );
+
+	while( 1 ) {
+		while( !qth->th_quit && !OggTheora_CanDecode( qth ) ) {
+			trap_CondVar_Wait( qth->th_cond, qth->th_lock );
+		}
+		if( qth->th_quit ) {
+			break;
+		}
+
+		// the packet and the slot are ours until the packet is marked as read
+		packet = OggTheora_NextPacket( qth );
+		frame = OggTheora_NextFreeFrame( qth );
+
+		trap_Mutex_Unlock( qth->th_lock );
+
+		usec = trap_Microseconds();
+		haveFrame = OggTheora_DecodePacket( qth, packet, frame );
+		usec = trap_Microseconds() - usec;
+
+		trap_Mutex_Lock( qth->th_lock );
+
+		OggTheora_PacketDecoded( qth, haveFrame, usec );
+		trap_CondVar_WakeAll( qth->th_cond );
+	}
+
+	trap_Mutex_Unlock( qth->th_lock );
+
+	return NULL;
+}
+
+/*
+* OggTheora_DecodePackets
+*
+* Gets the decoder going on the queued packets
+*/
+static void OggTheora_DecodePackets( qtheora_info_t *qth )
+{
+	qboolean haveFrame;
+	quint64 usec;
+
+	if( qth->th_thread ) {
+		trap_Mutex_Lock( qth->th_lock );
+		trap_CondVar_WakeAll( qth->th_cond );
+		trap_Mutex_Unlock( qth->th_lock );
+		return;
+	}
+
+	while( OggTheora_CanDecode( qth ) ) {
+		usec = trap_Microseconds();
+		haveFrame = OggTheora_DecodePacket( qth, OggTheora_NextPacket( qth ), OggTheora_NextFreeFrame( qth ) );
+		OggTheora_PacketDecoded( qth, haveFrame, trap_Microseconds() - usec );
+	}
+}
+
+/*
+* OggTheora_FreeDecodedPackets
+*/
+static void OggTheora_FreeDecodedPackets( qtheora_info_t *qth )
+{
+	unsigned int read;
+
+	OggTheora_Lock( qth );
+	read = qth->th_packet_read;
+	OggTheora_Unlock( qth );
+
+	for( ; qth->th_packet_free != read; qth->th_packet_free++ ) {
+		qtheora_packet_t *packet = &qth->th_packets[qth->th_packet_free % TH_MAX_QUEUED_PACKETS];
+
+		CIN_Free( packet->data );
+		packet->data = NULL;
+	}
+}
+
+/*
+* OggTheora_NeedVideoPackets
+*/
+static qboolean OggTheora_NeedVideoPackets( qtheora_info_t *qth )
+{
+	if( qth->v_eos ) {
+		return qfalse;
+	}
+	return qth->th_packet_write - qth->th_packet_free < TH_MAX_QUEUED_PACKETS;
+}
+
+/*
+* OggTheora_AdvanceGranulepos
+*
+* Keeps track of the granule position of packets that don't carry one
+*/
+static void OggTheora_AdvanceGranulepos( qtheora_info_t *qth, ogg_packet *op )
+{
+	int shift = qth->ti.keyframe_granule_shift;
+	ogg_int64_t iframe, pframe;
+
+	if( op->granulepos >= 0 ) {
+		qth->th_feed_granulepos = op->granulepos;
+		return;
+	}
+
+	if( qth->th_feed_granulepos < 0 ) {
+		return;
+	}
+
+	if( th_packet_iskeyframe( op ) > 0 ) {
+		iframe = qth->th_feed_granulepos >> shift;
+		pframe = qth->th_feed_granulepos - ( iframe << shift );
+		qth->th_feed_granulepos = ( iframe + pframe + 1 ) << shift;
+	}
+	else {
+		qth->th_feed_granulepos++;
+	}
+}
+
+/*
+* OggTheora_LoadVideoPackets
+*
+* Queues video packets for the decoder. Returns qtrue if no additional
+* packets are needed
 */
 #define VIDEO_LAG_TOLERANCE_MSEC	500
 
-static qboolean OggTheora_LoadVideoFrame( cinematics_t *cin )
+static qboolean OggTheora_LoadVideoPackets( cinematics_t *cin )
 {
-	int i;
 	ogg_packet op;
+	qtheora_packet_t *packet;
 	qtheora_info_t *qth = cin->fdata;
-	th_ycbcr_buffer yuv;
 	unsigned int sync_time = qth->s_sound_time;
 	
 	memset( &op, 0, sizeof( op ) );
 
-	while( ogg_stream_packetout( &qth->os_video, &op ) )
+	while( OggTheora_NeedVideoPackets( qth ) )
 	{
-		int error;
-		int width, height;
+		if( !ogg_stream_packetout( &qth->os_video, &op ) ) {
+			return qfalse;
+		}
 
 		if( op.e_o_s ) {
 			// we've encountered end of stream packet
@@ -274,9 +574,15 @@ static qboolean OggTheora_LoadVideoFrame( cinematics_t *cin )
 			break;
 		}
 
+		if( th_packet_isheader( &op ) ) {
+			// header packet, skip
+			continue;
+		}
+
+		OggTheora_AdvanceGranulepos( qth, &op );
+
 		if( op.granulepos >= 0 ) {
 			qth->th_granulemsec = th_granule_time( qth->tctx, op.granulepos ) * 1000.0;
-			th_decode_ctl( qth->tctx, TH_DECCTL_SET_GRANPOS, &op.granulepos, sizeof( op.granulepos ) );
 		}
 
 		// if lagging behind audio, seek forward to max_keyframe_interval before the target,
@@ -299,6 +605,8 @@ static qboolean OggTheora_LoadVideoFrame( cinematics_t *cin )
 			else
 			{
 				Com_DPrintf( "Dropped frame %i\n", cin->frame );
+				qth->th_dropped_frames++;
+				qth->th_feed_resync = qtrue;
 				continue;
 			}
 		}
@@ -307,71 +615,127 @@ static qboolean OggTheora_LoadVideoFrame( cinematics_t *cin )
 		if( qth->th_seek_to_keyframe ) {
 			if( !th_packet_iskeyframe( &op ) ) {
 				Com_DPrintf( "Dropped frame %i\n", cin->frame );
+				qth->th_dropped_frames++;
+				qth->th_feed_resync = qtrue;
 				continue;
 			}
 			qth->th_seek_to_keyframe = qfalse;
 		}
 
-		error = th_decode_packetin( qth->tctx, &op, &qth->th_granulepos );
-		if( error < 0 ) {
-			// bad packet
-			continue;
+		packet = &qth->th_packets[qth->th_packet_write % TH_MAX_QUEUED_PACKETS];
+		packet->data = CIN_Alloc( cin->mempool, op.bytes + 1 );
+		memcpy( packet->data, op.packet, op.bytes );
+		packet->bytes = op.bytes;
+		packet->packetno = op.packetno;
+		packet->granulepos = op.granulepos;
+
+		// the decoder hasn't seen the skipped packets, so it can't count frames on its own
+		if( qth->th_feed_resync && packet->granulepos < 0 ) {
+			packet->granulepos = qth->th_feed_granulepos;
 		}
+		qth->th_feed_resync = qfalse;
 
-		if( th_packet_isheader( &op ) ) {
-			// header packet, skip
-			continue;
+		OggTheora_Lock( qth );
+		qth->th_packet_write++;
+		OggTheora_Unlock( qth );
+	}
+
+	return qtrue;
+}
+
+/*
+* OggTheora_ShowFrame
+*
+* Picks the newest decoded frame that is due. Returns qtrue if there's a
+* new picture to show
+*/
+static qboolean OggTheora_ShowFrame( cinematics_t *cin )
+{
+	int width, height;
+	unsigned int realframe;
+	qtheora_frame_t *frame, *next;
+	qtheora_info_t *qth = cin->fdata;
+
+	// sync to audio timer
+	realframe = qth->s_sound_time * cin->framerate / 1000.0;
+
+	OggTheora_Lock( qth );
+
+	if( !cin->width ) {
+		// need at least one valid frame, wait for the decoder to get through the queue
+		while( qth->th_thread && !qth->th_num_frames && qth->th_packet_read != qth->th_packet_write ) {
+			trap_CondVar_Wait( qth->th_cond, qth->th_lock );
 		}
+	}
 
-		if( error == TH_DUPFRAME ) {
-			return qtrue;
+	frame = NULL;
+	while( qth->th_num_frames ) {
+		next = &qth->th_frames[qth->th_frame_head];
+		if( ( frame || cin->width ) && next->frame > realframe ) {
+			break;
 		}
 
-		if( th_decode_ycbcr_out( qth->tctx, yuv ) != 0 ) {
-			// error
-			continue;
+		if( frame ) {
+			// late, the next one is due as well
+			Com_DPrintf( "Dropped frame %i\n", frame->frame );
+			qth->th_dropped_frames++;
 		}
 
-		memcpy( &qth->th_yuv, &yuv, sizeof( yuv ) );
+		frame = next;
+		qth->th_frame_head = ( qth->th_frame_head + 1 ) % TH_NUM_FRAME_SLOTS;
+		qth->th_num_frames--;
+	}
 
-		for( i = 0; i < 3; i++ ) {
-			qth->pub_yuv.yuv[i].stride = yuv[i].stride;
-			qth->pub_yuv.yuv[i].width = yuv[i].width;
-			qth->pub_yuv.yuv[i].height = yuv[i].height;
-			qth->pub_yuv.yuv[i].data = yuv[i].data;
-		}
+	if( frame && qth->th_thread ) {
+		// there are free slots now
+		trap_CondVar_WakeAll( qth->th_cond );
+	}
 
-		width  = qth->ti.pic_width & ~1;
-		height = qth->ti.pic_height & ~1;
+	OggTheora_Unlock( qth );
 
-		qth->pub_yuv.width  = width;
-		qth->pub_yuv.height = height;
-		qth->pub_yuv.x_offset = qth->ti.pic_x & ~1;
-		qth->pub_yuv.y_offset = qth->ti.pic_y & ~1;
-		qth->pub_yuv.image_width = max( abs( yuv[0].stride ), (int)qth->ti.frame_width );
-		qth->pub_yuv.image_height = qth->ti.frame_height;
+	if( !frame ) {
+		return qfalse;
+	}
 
-		if( cin->width != width || cin->height != height ) {
-			size_t size;
+	qth->pub_yuv = frame->yuv;
 
-			if( cin->vid_buffer ) {
-				CIN_Free( cin->vid_buffer );
-			}
+	width = qth->pub_yuv.width;
+	height = qth->pub_yuv.height;
 
-			cin->width = width;
-			cin->height = height;
+	if( cin->width != width || cin->height != height ) {
+		size_t size;
 
-			size = cin->width * cin->height * 3;
-			cin->vid_buffer = CIN_Alloc( cin->mempool, size );
-			memset( cin->vid_buffer, 0xFF, size );
+		if( cin->vid_buffer ) {
+			CIN_Free( cin->vid_buffer );
 		}
-			
-		cin->frame = th_granule_frame( qth->tctx, qth->th_granulepos );
 
-		return qtrue;
+		cin->width = width;
+		cin->height = height;
+
+		size = cin->width * cin->height * 3;
+		cin->vid_buffer = CIN_Alloc( cin->mempool, size );
+		memset( cin->vid_buffer, 0xFF, size );
 	}
 
-	return qfalse;
+	cin->frame = frame->frame;
+
+	return qtrue;
+}
+
+/*
+* OggTheora_Drained
+*
+* Whether all queued packets have been decoded and all frames shown
+*/
+static qboolean OggTheora_Drained( qtheora_info_t *qth )
+{
+	qboolean drained;
+
+	OggTheora_Lock( qth );
+	drained = qth->th_packet_read == qth->th_packet_write && !qth->th_num_frames;
+	OggTheora_Unlock( qth );
+
+	return drained;
 }
 
 /*
@@ -380,61 +744,68 @@ static qboolean OggTheora_LoadVideoFrame( cinematics_t *cin )
 static qboolean Theora_ReadNextFrame_CIN_( cinematics_t *cin, qboolean *redraw, qboolean *eos )
 {
 	unsigned int bytes, pages = 0;
-	qboolean redraw_ = qfalse;
 	qtheora_info_t *qth = cin->fdata;
 	qboolean haveAudio = qfalse, haveVideo = qfalse;
 
 	*eos = qfalse;
+	*redraw = qfalse;
 
-	while( 1 )
+	do
 	{
-		ogg_page og;
-		qboolean needAudio, needVideo;
+		while( 1 )
+		{
+			ogg_page og;
+			qboolean needAudio, needVideo;
 
-		needAudio = !haveAudio && OggVorbis_NeedAudioData( cin );
-		needVideo = !haveVideo && OggTheora_NeedVideoData( cin );
-		redraw_ = redraw_ || needVideo;
+			OggTheora_FreeDecodedPackets( qth );
 
-		if( !needAudio && !needVideo ) {
-			break;
-		}
+			needAudio = !haveAudio && OggVorbis_NeedAudioData( cin );
+			needVideo = OggTheora_NeedVideoPackets( qth );
 
-		if( needAudio ) {
-			haveAudio = OggVorbis_LoadAudioFrame( cin );
-			needAudio = !haveAudio;
-		}
-		if( needVideo ) {
-			haveVideo = OggTheora_LoadVideoFrame( cin );
-			needVideo = !haveVideo;
-		}
+			if( !needAudio && !needVideo ) {
+				break;
+			}
 
-		if( qth->v_eos ) {
-			// end of video stream
-			*eos = qtrue;
-			return qfalse;
-		}
+			if( needAudio ) {
+				haveAudio = OggVorbis_LoadAudioFrame( cin );
+				needAudio = !haveAudio;
+			}
+			if( needVideo ) {
+				needVideo = !OggTheora_LoadVideoPackets( cin );
+			}
 
-		if( !needAudio && !needVideo ) {
-			break;
-		}
+			if( !needAudio && !needVideo ) {
+				break;
+			}
 
-		bytes = Ogg_LoadBlockToSync( cin ); // returns 0 if EOF
+			bytes = Ogg_LoadBlockToSync( cin ); // returns 0 if EOF
 
-		// process all read pages
-		pages = 0;
-		while( ogg_sync_pageout( &qth->oy, &og ) > 0 ) {
-			pages++;
-			Ogg_LoadPagesToStreams( qth, &og );
-		}
+			// process all read pages
+			pages = 0;
+			while( ogg_sync_pageout( &qth->oy, &og ) > 0 ) {
+				pages++;
+				Ogg_LoadPagesToStreams( qth, &og );
+			}
 
-		if( !bytes && !pages ) {
-			// end of FILE, no pages remaining
-			*eos = qtrue;
-			return qfalse;
+			if( !bytes && !pages ) {
+				// end of FILE, no pages remaining
+				qth->v_eos = qtrue;
+				break;
+			}
 		}
+
+		OggTheora_DecodePackets( qth );
+
+		haveVideo = OggTheora_ShowFrame( cin );
+	} while( !cin->width && !qth->v_eos );
+
+	if( !haveVideo && qth->v_eos && OggTheora_Drained( qth ) ) {
+		// end of video stream
+		*eos = qtrue;
+		return qfalse;
 	}
 
-	*redraw = redraw_;
+	*redraw = haveVideo;
 	return haveVideo;
 }
 
@@ -708,6 +1079,111 @@ cin_yuv_t *Theora_ReadNextFrameYUV_CIN( cinematics_t *cin, qboolean *redraw )
 	return cin->width ? &qth->pub_yuv : NULL;
 }
 
+/*
+* OggTheora_InitDecoder
+*
+* Allocates the frame slots and starts the decoding thread
+*/
+static void OggTheora_InitDecoder( cinematics_t *cin )
+{
+	int i, j;
+	int width, height;
+	size_t size;
+	qbyte *data;
+	cin_yuv_t *yuv;
+	qtheora_info_t *qth = cin->fdata;
+
+	qth->th_feed_granulepos = -1;
+
+	for( i = 0; i < TH_NUM_FRAME_SLOTS; i++ ) {
+		yuv = &qth->th_frames[i].yuv;
+
+		yuv->image_width = qth->ti.frame_width;
+		yuv->image_height = qth->ti.frame_height;
+		yuv->width = qth->ti.pic_width & ~1;
+		yuv->height = qth->ti.pic_height & ~1;
+		yuv->x_offset = qth->ti.pic_x & ~1;
+		yuv->y_offset = qth->ti.pic_y & ~1;
+
+		size = 0;
+		for( j = 0; j < 3; j++ ) {
+			width = qth->ti.frame_width;
+			height = qth->ti.frame_height;
+			if( j && qth->ti.pixel_fmt != TH_PF_444 ) {
+				width >>= 1;
+			}
+			if( j && qth->ti.pixel_fmt == TH_PF_420 ) {
+				height >>= 1;
+			}
+
+			yuv->yuv[j].width = width;
+			yuv->yuv[j].height = height;
+			yuv->yuv[j].stride = width;
+			size += width * height;
+		}
+
+		data = qth->th_frames[i].data = CIN_Alloc( cin->mempool, size );
+		for( j = 0; j < 3; j++ ) {
+			yuv->yuv[j].data = data;
+			data += yuv->yuv[j].width * yuv->yuv[j].height;
+		}
+	}
+
+	if( !cin_decodethread->integer ) {
+		return;
+	}
+
+	qth->th_lock = trap_Mutex_Create();
+	qth->th_cond = trap_CondVar_Create();
+	if( qth->th_lock && qth->th_cond ) {
+		qth->th_thread = trap_Thread_Create( OggTheora_DecoderThreadProc, qth );
+	}
+
+	if( !qth->th_thread ) {
+		// decode on the reading side then
+		if( qth->th_cond ) {
+			trap_CondVar_Destroy( &qth->th_cond );
+		}
+		if( qth->th_lock ) {
+			trap_Mutex_Destroy( &qth->th_lock );
+		}
+	}
+}
+
+/*
+* OggTheora_ShutdownDecoder
+*/
+static void OggTheora_ShutdownDecoder( cinematics_t *cin )
+{
+	int i;
+	qtheora_info_t *qth = cin->fdata;
+
+	if( qth->th_thread ) {
+		trap_Mutex_Lock( qth->th_lock );
+		qth->th_quit = qtrue;
+		trap_CondVar_WakeAll( qth->th_cond );
+		trap_Mutex_Unlock( qth->th_lock );
+
+		trap_Thread_Join( qth->th_thread );
+		qth->th_thread = NULL;
+
+		trap_CondVar_Destroy( &qth->th_cond );
+		trap_Mutex_Destroy( &qth->th_lock );
+	}
+
+	// decoded or not, nobody is going to look at the queued packets anymore
+	qth->th_packet_read = qth->th_packet_write;
+	OggTheora_FreeDecodedPackets( qth );
+
+	for( i = 0; i < TH_NUM_FRAME_SLOTS; i++ ) {
+		if( qth->th_frames[i].data ) {
+			CIN_Free( qth->th_frames[i].data );
+			qth->th_frames[i].data = NULL;
+		}
+	}
+	qth->th_num_frames = 0;
+}
+
 /*
 * Theora_Init_CIN
 */
@@ -893,6 +1369,8 @@ qboolean Theora_Init_CIN( cinematics_t *cin )
 	cin->headerlen = trap_FS_Tell( cin->file );
 	cin->yuv = qtrue;
 
+	OggTheora_InitDecoder( cin );
+
 	return qtrue;
 }
 
@@ -903,6 +1381,8 @@ void Theora_Shutdown_CIN( cinematics_t *cin )
 {
 	qtheora_info_t *qth = cin->fdata;
 
+	OggTheora_ShutdownDecoder( cin );
+
 	if( qth->v_stream )
 	{
 		qth->v_stream = qfalse;
@@ -965,3 +1445,26 @@ qboolean Theora_NeedNextFrame_CIN( cinematics_t *cin )
 	return OggVorbis_NeedAudioData( cin ) 
 		|| OggTheora_NeedVideoData( cin );
 }
+
+/*
+* Theora_GetStats_CIN
+*/
+void Theora_GetStats_CIN( cinematics_t *cin, cin_stats_t *stats )
+{
+	qtheora_info_t *qth = cin->fdata;
+
+	if( !qth ) {
+		return;
+	}
+
+	OggTheora_Lock( qth );
+
+	stats->queued_frames = qth->th_num_frames;
+	stats->max_queued_frames = qth->th_max_queued_frames;
+	stats->decoded_frames = qth->th_decoded_frames;
+	stats->dropped_frames = qth->th_dropped_frames;
+	stats->decode_usec = qth->th_decoded_frames ? qth->th_decode_usec / qth->th_decoded_frames : 0;
+	stats->max_decode_usec = qth->th_max_decode_usec;
+
+	OggTheora_Unlock( qth );
+}
@@ -32,5 +32,6 @@ void Theora_Reset_CIN( cinematics_t *cin );
 qboolean Theora_NeedNextFrame_CIN( cinematics_t *cin );
 qbyte *Theora_ReadNextFrame_CIN( cinematics_t *cin, qboolean *redraw );
 cin_yuv_t *Theora_ReadNextFrameYUV_CIN( cinematics_t *cin, qboolean *redraw );
+void Theora_GetStats_CIN( cinematics_t *cin, cin_stats_t *stats );
 
 #endif
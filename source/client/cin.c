@@ -128,6 +128,17 @@ void CIN_LoadLibrary( qboolean verbose )
 	import.Milliseconds = &Sys_Milliseconds;
 	import.Microseconds = &Sys_Microseconds;
 
+	import.Thread_Create = &QThread_Create;
+	import.Thread_Join = &QThread_Join;
+	import.Mutex_Create = &QMutex_Create;
+	import.Mutex_Destroy = &QMutex_Destroy;
+	import.Mutex_Lock = &QMutex_Lock;
+	import.Mutex_Unlock = &QMutex_Unlock;
+	import.CondVar_Create = &QCondVar_Create;
+	import.CondVar_Destroy = &QCondVar_Destroy;
+	import.CondVar_Wait = &QCondVar_Wait;
+	import.CondVar_WakeAll = &QCondVar_WakeAll;
+
 	import.Mem_AllocPool = &CL_CinModule_MemAllocPool;
 	import.Mem_Alloc = &CL_CinModule_MemAlloc;
 	import.Mem_Free = &CL_CinModule_MemFree;
@@ -275,3 +286,12 @@ void CIN_Close( struct cinematics_s *cin )
 		cin_export->Close( cin );
 	}
 }
+
+void CIN_GetStats( struct cinematics_s *cin, cin_stats_t *stats )
+{
+	if( cin_export ) {
+		cin_export->GetStats( cin, stats );
+		return;
+	}
+	memset( stats, 0, sizeof( *stats ) );
+}
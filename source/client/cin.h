@@ -40,3 +40,5 @@ qboolean CIN_AddRawSamplesListener( struct cinematics_s *cin, void *listener,
 void CIN_Reset( struct cinematics_s *cin, unsigned int cur_time );
 
 void CIN_Close( struct cinematics_s *cin );
+
+void CIN_GetStats( struct cinematics_s *cin, cin_stats_t *stats );
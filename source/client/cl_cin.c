@@ -37,9 +37,17 @@ ROQ PLAYING
 */
 void SCR_StopCinematic( void )
 {
+	cin_stats_t stats;
+
 	if( !cl.cin.h )
 		return;
 
+	CIN_GetStats( cl.cin.h, &stats );
+	if( stats.decoded_frames ) {
+		Com_DPrintf( "Cinematic: %i frames decoded, %i dropped, %i usec per frame (%i max), %i frames queued at most\n",
+			stats.decoded_frames, stats.dropped_frames, stats.decode_usec, stats.max_decode_usec, stats.max_queued_frames );
+	}
+
 	CIN_Close( cl.cin.h );
 	memset( &cl.cin, 0, sizeof( cl.cin ) );
 }
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "client.h"
 
 static void CL_PauseDemo( qboolean paused );
+static void CL_EntBenchFinish( void );
 
 /*
 * CL_WriteDemoMessage
@@ -258,6 +259,8 @@ void CL_DemoCompleted( void )
 	if( cls.demo.avi )
 		CL_StopDemoAviDump();
 
+	CL_EntBenchFinish();
+
 	if( demofilehandle )
 	{
 		FS_FCloseFile( demofilehandle );
@@ -560,6 +563,269 @@ void CL_PlayDemoToAvi_f( void )
 	}
 }
 
+/*
+=======================================================================
+
+ENTITY CODEC BENCHMARK
+
+Every snapshot of the demo is encoded again with the byte aligned and with
+the packed entities, delta'd from the snapshot before, and decoded back.
+Best run with timedemo 1.
+
+=======================================================================
+*/
+
+enum { ENTBENCH_CLASSIC, ENTBENCH_PACKED, ENTBENCH_NUMCODECS };
+
+static const char * const cl_entbenchNames[ENTBENCH_NUMCODECS] = { "classic", "packed" };
+
+typedef struct
+{
+	qboolean active;
+	int lastFrame, prevFrame;		// the snapshots benchmarked before
+	int snapshots, entities, mismatches;
+	quint64 bytes[ENTBENCH_NUMCODECS];
+	quint64 encodeTime[ENTBENCH_NUMCODECS];
+	quint64 decodeTime[ENTBENCH_NUMCODECS];
+	snapshot_t *decoded[ENTBENCH_NUMCODECS];
+} entbench_t;
+
+static entbench_t cl_entbench;
+
+#define ENTBENCH_ENTITY( frame, index ) ( &( frame )->parsedEntities[( index ) & ( MAX_PARSE_ENTITIES-1 )] )
+
+/*
+* CL_EntBenchWrite
+*
+* SNAP_EmitPacketEntities and SNAP_EmitPackedEntities for client snapshots
+*/
+static void CL_EntBenchWrite( msg_t *msg, snapshot_t *from, snapshot_t *prev, snapshot_t *to, qboolean packed )
+{
+	entity_state_t *oldent, *newent, *prevent;
+	int oldindex, newindex, previndex;
+	int oldnum, newnum, lastnum;
+	int from_num_entities;
+	int predicted[3];
+	const int *pred;
+	msg_bits_t bits;
+
+	MSG_WriteByte( msg, svc_packetentities );
+	if( packed )
+		MSG_BeginWritingBits( &bits, msg );
+
+	from_num_entities = from ? from->numEntities : 0;
+
+	newindex = oldindex = previndex = 0;
+	lastnum = 0;
+	while( newindex < to->numEntities || oldindex < from_num_entities )
+	{
+		newent = newindex < to->numEntities ? ENTBENCH_ENTITY( to, newindex ) : NULL;
+		newnum = newent ? newent->number : 9999;
+		oldent = oldindex < from_num_entities ? ENTBENCH_ENTITY( from, oldindex ) : NULL;
+		oldnum = oldent ? oldent->number : 9999;
+
+		if( newnum == oldnum )
+		{
+			if( packed )
+			{
+				pred = NULL;
+				for( prevent = NULL; prev && previndex < prev->numEntities; previndex++ )
+				{
+					prevent = ENTBENCH_ENTITY( prev, previndex );
+					if( prevent->number >= newnum )
+						break;
+				}
+				if( prevent && prevent->number == newnum && MSG_ExtrapolateEntityOrigin( oldent, prevent,
+					to->serverFrame - from->serverFrame, from->serverFrame - prev->serverFrame, predicted ) )
+					pred = predicted;
+
+				if( MSG_WritePackedDeltaEntity( &bits, lastnum, oldent, newent, pred, qfalse, qtrue ) )
+					lastnum = newnum;
+			}
+			else
+			{
+				MSG_WriteDeltaEntity( oldent, newent, msg, qfalse, qtrue );
+			}
+			oldindex++;
+			newindex++;
+		}
+		else if( newnum < oldnum )
+		{
+			if( packed )
+				MSG_WritePackedDeltaEntity( &bits, lastnum, &cl_baselines[newnum], newent, NULL, qtrue, qtrue );
+			else
+				MSG_WriteDeltaEntity( &cl_baselines[newnum], newent, msg, qtrue, qtrue );
+			lastnum = newnum;
+			newindex++;
+		}
+		else
+		{
+			if( packed )
+			{
+				MSG_WritePackedEntityRemove( &bits, lastnum, oldnum );
+			}
+			else
+			{
+				MSG_WriteByte( msg, U_REMOVE | ( oldnum >= 256 ? U_MOREBITS1 : 0 ) );
+				if( oldnum >= 256 )
+				{
+					MSG_WriteByte( msg, U_NUMBER16 >> 8 );
+					MSG_WriteShort( msg, oldnum );
+				}
+				else
+				{
+					MSG_WriteByte( msg, oldnum );
+				}
+			}
+			lastnum = oldnum;
+			oldindex++;
+		}
+	}
+
+	if( packed )
+	{
+		MSG_WriteBits( &bits, 0, 1 );
+		MSG_EndWritingBits( &bits );
+	}
+	else
+	{
+		MSG_WriteShort( msg, 0 );
+	}
+}
+
+/*
+* CL_EntBenchFrame
+*
+* Called for every valid snapshot parsed
+*/
+void CL_EntBenchFrame( snapshot_t *frame )
+{
+	static qbyte msgbuf[MAX_MSGLEN];
+	int i, c;
+	quint64 time;
+	msg_t msg;
+	snapshot_t *from, *prev;
+
+	if( !cl_entbench.active || !cls.demo.playing )
+		return;
+
+	from = prev = NULL;
+	if( cl_entbench.lastFrame > 0 && frame->serverFrame - cl_entbench.lastFrame < UPDATE_MASK )
+	{
+		from = &cl.snapShots[cl_entbench.lastFrame & UPDATE_MASK];
+		if( !from->valid || from->serverFrame != cl_entbench.lastFrame )
+			from = NULL;
+	}
+	if( from && cl_entbench.prevFrame > 0 && frame->serverFrame - cl_entbench.prevFrame < UPDATE_MASK )
+	{
+		prev = &cl.snapShots[cl_entbench.prevFrame & UPDATE_MASK];
+		if( !prev->valid || prev->serverFrame != cl_entbench.prevFrame )
+			prev = NULL;
+	}
+
+	for( c = 0; c < ENTBENCH_NUMCODECS; c++ )
+	{
+		MSG_Init( &msg, msgbuf, sizeof( msgbuf ) );
+
+		time = Sys_Microseconds();
+		CL_EntBenchWrite( &msg, from, prev, frame, c == ENTBENCH_PACKED );
+		cl_entbench.encodeTime[c] += Sys_Microseconds() - time;
+		cl_entbench.bytes[c] += msg.cursize;
+
+		MSG_BeginReading( &msg );
+		cl_entbench.decoded[c]->serverFrame = frame->serverFrame;
+
+		time = Sys_Microseconds();
+		MSG_ReadByte( &msg );
+		SNAP_ReadPacketEntities( &msg, from, prev, cl_entbench.decoded[c], cl_baselines, c == ENTBENCH_PACKED, 0 );
+		cl_entbench.decodeTime[c] += Sys_Microseconds() - time;
+	}
+
+	// both have to give the same entities
+	if( cl_entbench.decoded[ENTBENCH_CLASSIC]->numEntities != cl_entbench.decoded[ENTBENCH_PACKED]->numEntities )
+	{
+		cl_entbench.mismatches++;
+	}
+	else
+	{
+		for( i = 0; i < frame->numEntities; i++ )
+		{
+			if( memcmp( ENTBENCH_ENTITY( cl_entbench.decoded[ENTBENCH_CLASSIC], i ),
+				ENTBENCH_ENTITY( cl_entbench.decoded[ENTBENCH_PACKED], i ), sizeof( entity_state_t ) ) )
+			{
+				cl_entbench.mismatches++;
+				break;
+			}
+		}
+	}
+
+	cl_entbench.snapshots++;
+	cl_entbench.entities += frame->numEntities;
+	cl_entbench.prevFrame = from ? cl_entbench.lastFrame : 0;
+	cl_entbench.lastFrame = frame->serverFrame;
+}
+
+/*
+* CL_EntBenchFinish
+*/
+static void CL_EntBenchFinish( void )
+{
+	int c, n;
+
+	if( !cl_entbench.active )
+		return;
+
+	n = cl_entbench.snapshots;
+	if( n )
+	{
+		Com_Printf( "%i snapshots, %.1f entities per snapshot\n", n, (float)cl_entbench.entities / n );
+		for( c = 0; c < ENTBENCH_NUMCODECS; c++ )
+		{
+			Com_Printf( "%-8s %7.1f bytes/snap (%5.1f%%), encode %6.2f usec, decode %6.2f usec\n",
+				cl_entbenchNames[c], (double)cl_entbench.bytes[c] / n,
+				100.0 * cl_entbench.bytes[c] / max( cl_entbench.bytes[ENTBENCH_CLASSIC], 1 ),
+				(double)cl_entbench.encodeTime[c] / n, (double)cl_entbench.decodeTime[c] / n );
+		}
+		if( cl_entbench.mismatches )
+			Com_Printf( S_COLOR_RED "%i snapshots decoded differently\n", cl_entbench.mismatches );
+	}
+	else
+	{
+		Com_Printf( "entbench: no snapshots\n" );
+	}
+
+	for( c = 0; c < ENTBENCH_NUMCODECS; c++ )
+		Mem_ZoneFree( cl_entbench.decoded[c] );
+	memset( &cl_entbench, 0, sizeof( cl_entbench ) );
+}
+
+/*
+* CL_EntBench_f
+*
+* entbench <demoname>
+*/
+void CL_EntBench_f( void )
+{
+	int c;
+
+	if( Cmd_Argc() != 2 )
+	{
+		Com_Printf( "Usage: %sentbench <demoname>%s\n", S_COLOR_YELLOW, S_COLOR_WHITE );
+		return;
+	}
+
+	CL_StartDemo( Cmd_Argv( 1 ) );
+	if( !cls.demo.playing )
+		return;
+
+	CL_EntBenchFinish();
+
+	memset( &cl_entbench, 0, sizeof( cl_entbench ) );
+	for( c = 0; c < ENTBENCH_NUMCODECS; c++ )
+		cl_entbench.decoded[c] = Mem_ZoneMalloc( sizeof( snapshot_t ) );
+	cl_entbench.active = qtrue;
+}
+
 /*
 * CL_ReadDemoMetaData
 */
@@ -595,19 +861,20 @@ size_t CL_ReadDemoMetaData( const char *demopath, char *meta_data, size_t meta_d
 		Q_snprintfz( name, name_size, "demos/%s", servername );
 		COM_DefaultExtension( name, APP_DEMO_EXTENSION_STR, name_size );
 
-		demolength = FS_FOpenFile( name, &demofile, FS_READ|SNAP_DEMO_GZ );
+		// demos in the demo directories go through the index
+		meta_data_realsize = DI_GetMetaData( name, meta_data, meta_data_size );
 
-		if( !demofile || demolength < 1 ) {
+		if( !meta_data_realsize ) {
 			// relative filename didn't work, try launching a demo from absolute path
 			Q_snprintfz( name, name_size, "%s", servername );
 			COM_DefaultExtension( name, APP_DEMO_EXTENSION_STR, name_size );
 			demolength = FS_FOpenAbsoluteFile( name, &demofile, FS_READ );
-		}
 
-		if( demolength > 0 ) {
-			meta_data_realsize = SNAP_ReadDemoMetaData( demofile, meta_data, meta_data_size );
+			if( demolength > 0 ) {
+				meta_data_realsize = SNAP_ReadDemoMetaData( demofile, meta_data, meta_data_size );
+			}
+			FS_FCloseFile( demofile );
 		}
-		FS_FCloseFile( demofile );
 
 		Mem_TempFree( name );
 	}
@@ -459,6 +459,7 @@ void CL_GameModule_Init( void )
 	import.R_AddEntityToScene = re.AddEntityToScene;
 	import.R_AddLightToScene = re.AddLightToScene;
 	import.R_AddPolyToScene = re.AddPolyToScene;
+	import.R_AddQuadsToScene = re.AddQuadsToScene;
 	import.R_AddLightStyleToScene = re.AddLightStyleToScene;
 	import.R_RenderScene = re.RenderScene;
 	import.R_SpeedsMessage = re.SpeedsMessage;
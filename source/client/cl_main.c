@@ -37,6 +37,7 @@ cvar_t *cl_sleep;
 #endif
 cvar_t *cl_pps;
 cvar_t *cl_compresspackets;
+cvar_t *cl_packedentities;
 cvar_t *cl_shownet;
 
 cvar_t *cl_extrapolationTime;
@@ -220,15 +221,21 @@ static void CL_Quit_f( void )
 */
 static void CL_SendConnectPacket( void )
 {
+	int flags;
+
 	userinfo_modified = qfalse;
 
+	flags = 0;
+	if( cl_packedentities->integer )
+		flags |= CONNECT_FLAG_PACKEDENTITIES;
+
 	Com_DPrintf("CL_MM_Initialized: %d, cls.mm_ticket: %u\n", CL_MM_Initialized(), cls.mm_ticket );
 	if( CL_MM_Initialized() && cls.mm_ticket != 0 )
 		Netchan_OutOfBandPrint( cls.socket, &cls.serveraddress, "connect %i %i %i \"%s\" %i %u\n",
-				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), 0, cls.mm_ticket );
+				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), flags, cls.mm_ticket );
 	else
 		Netchan_OutOfBandPrint( cls.socket, &cls.serveraddress, "connect %i %i %i \"%s\" %i\n",
-				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), 0 );
+				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), flags );
 }
 
 /*
@@ -1672,6 +1679,13 @@ void CL_RequestNextDownload( void )
 */
 void CL_Precache_f( void )
 {
+	// the gamestate message was lost, ask for it again
+	if( cl.gamestatePending && !cls.demo.playing )
+	{
+		CL_AddReliableCommand( va( "gamestate %i", cl.servercount ) );
+		return;
+	}
+
 	FS_RemovePurePaks();
 
 	if( cls.demo.playing )
@@ -2001,6 +2015,7 @@ static void CL_InitLocal( void )
 #endif
 	cl_pps =		Cvar_Get( "cl_pps", "40", CVAR_ARCHIVE );
 	cl_compresspackets =	Cvar_Get( "cl_compresspackets", "1", CVAR_ARCHIVE );
+	cl_packedentities =	Cvar_Get( "cl_packedentities", "1", CVAR_ARCHIVE );
 
 	cl_extrapolationTime =	Cvar_Get( "cl_extrapolationTime", "0", CVAR_DEVELOPER );
 	cl_extrapolate = Cvar_Get( "cl_extrapolate", "1", CVAR_ARCHIVE );
@@ -2100,6 +2115,7 @@ static void CL_InitLocal( void )
 	Cmd_AddCommand( "showip", CL_ShowIP_f ); // jal : wsw : print our ip
 	Cmd_AddCommand( "demo", CL_PlayDemo_f );
 	Cmd_AddCommand( "demoavi", CL_PlayDemoToAvi_f );
+	Cmd_AddCommand( "entbench", CL_EntBench_f );
 	Cmd_AddCommand( "next", CL_SetNext_f );
 	Cmd_AddCommand( "pingserver", CL_PingServer_f );
 	Cmd_AddCommand( "demopause", CL_PauseDemo_f );
@@ -2110,6 +2126,7 @@ static void CL_InitLocal( void )
 
 	Cmd_SetCompletionFunc( "demo", CL_DemoComplete );
 	Cmd_SetCompletionFunc( "demoavi", CL_DemoComplete );
+	Cmd_SetCompletionFunc( "entbench", CL_DemoComplete );
 }
 
 /*
@@ -2140,6 +2157,7 @@ static void CL_ShutdownLocal( void )
 	Cmd_RemoveCommand( "showip" );
 	Cmd_RemoveCommand( "demo" );
 	Cmd_RemoveCommand( "demoavi" );
+	Cmd_RemoveCommand( "entbench" );
 	Cmd_RemoveCommand( "next" );
 	Cmd_RemoveCommand( "pingserver" );
 	Cmd_RemoveCommand( "demopause" );
@@ -3023,6 +3041,8 @@ void CL_Init( void )
 
 	ML_Init();
 
+	DI_Init();
+
 	CL_Mumble_Init();
 
 	cl_initialized = qtrue;
@@ -3049,6 +3069,7 @@ void CL_Shutdown( void )
 
 	CL_SoundModule_StopAllSounds();
 
+	DI_Shutdown();
 	ML_Shutdown();
 	CL_MM_Shutdown( qtrue );
 	CL_ShutDownServerList();
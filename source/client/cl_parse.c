@@ -909,11 +909,20 @@ static void CL_ParseServerData( msg_t *msg )
 
 	//assert( numpure == 0 );
 
-	// get the configstrings request
-	CL_AddReliableCommand( va( "configstrings %i 0", cl.servercount ) );
+	// get the configstrings and baselines in one message if the server can send them so
+	if( ( sv_bitflags & SV_BITFLAGS_GAMESTATE ) && !cls.demo.playing )
+	{
+		cl.gamestatePending = qtrue;
+		CL_AddReliableCommand( va( "gamestate %i", cl.servercount ) );
+	}
+	else
+	{
+		CL_AddReliableCommand( va( "configstrings %i 0", cl.servercount ) );
+	}
 
 	cls.sv_pure = ( sv_bitflags & SV_BITFLAGS_PURE ) != 0;
 	cls.sv_tv = ( sv_bitflags & SV_BITFLAGS_TVSERVER ) != 0;
+	cls.packedentities = ( sv_bitflags & SV_BITFLAGS_PACKEDENTITIES ) != 0;
 
 #ifdef PURE_CHEAT
 	cls.sv_pure = qfalse;
@@ -942,11 +951,13 @@ static void CL_ParseFrame( msg_t *msg )
 
 	oldSnap = ( cl.receivedSnapNum > 0 ) ? &cl.snapShots[cl.receivedSnapNum & UPDATE_MASK] : NULL;
 
-	snap = SNAP_ParseFrame( msg, oldSnap, &cl.suppressCount, cl.snapShots, cl_baselines, cl_shownet->integer );
+	snap = SNAP_ParseFrame( msg, oldSnap, &cl.suppressCount, cl.snapShots, cl_baselines, cls.packedentities, cl_shownet->integer );
 	if( snap->valid )
 	{
 		cl.receivedSnapNum = snap->serverFrame;
 
+		CL_EntBenchFrame( snap );
+
 		if( cls.demo.recording )
 		{
 			if( cls.demo.waiting && !snap->delta )
@@ -960,7 +971,7 @@ static void CL_ParseFrame( msg_t *msg )
 
 				// write out messages to hold the startup information
 				SNAP_BeginDemoRecording( cls.demo.file, 0x10000 + cl.servercount, cl.snapFrameTime, 
-					cl.servermessage, cls.reliable ? SV_BITFLAGS_RELIABLE : 0, cls.purelist, 
+					cl.servermessage, ( cls.reliable ? SV_BITFLAGS_RELIABLE : 0 ) | ( cls.packedentities ? SV_BITFLAGS_PACKEDENTITIES : 0 ), cls.purelist, 
 					cl.configstrings[0], cl_baselines );
 
 				// the rest of the demo file will be individual frames
@@ -1117,6 +1128,54 @@ static void CL_ParseConfigstringCommand( void )
 	}
 }
 
+/*
+* CL_ParseGamestate
+*/
+static void CL_ParseGamestate( msg_t *msg, int len )
+{
+	int idx, size, length;
+	qbyte *data;
+	msg_t gamestate;
+
+	size = MSG_ReadLong( msg );
+	len -= 4;
+	if( size <= 0 || size > (int)MAX_GAMESTATE_SIZE || len <= 0 || msg->readcount + len > msg->cursize )
+		Com_Error( ERR_DROP, "CL_ParseGamestate: bad size" );
+
+	// padded, the baseline reader doesn't check for the end of the data
+	data = Mem_TempMalloc( size + 256 );
+	length = Netchan_DecompressChunk( msg->data + msg->readcount, len, data, size );
+	MSG_SkipData( msg, len );
+	if( length != size )
+	{
+		Mem_TempFree( data );
+		Com_Error( ERR_DROP, "CL_ParseGamestate: decompression failed" );
+	}
+
+	MSG_Init( &gamestate, data, size );
+	gamestate.cursize = size;
+
+	while( 1 )
+	{
+		idx = MSG_ReadShort( &gamestate );
+		if( gamestate.readcount > gamestate.cursize )
+		{
+			Mem_TempFree( data );
+			Com_Error( ERR_DROP, "CL_ParseGamestate: bad configstrings" );
+		}
+		if( idx == -1 )
+			break;
+		CL_UpdateConfigString( idx, MSG_ReadString( &gamestate ) );
+	}
+
+	while( gamestate.readcount < gamestate.cursize )
+		SNAP_ParseBaseline( &gamestate, cl_baselines );
+
+	Mem_TempFree( data );
+
+	cl.gamestatePending = qfalse;
+}
+
 typedef struct
 {
 	char *name;
@@ -1335,6 +1394,9 @@ void CL_ParseServerMessage( msg_t *msg )
 
 				switch( ext )
 				{
+				case SVC_EXT_GAMESTATE:
+					CL_ParseGamestate( msg, len );
+					break;
 				default:
 					// unsupported
 					MSG_SkipData( msg, len );
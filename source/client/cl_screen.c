@@ -708,6 +708,7 @@ void SCR_UpdateScreen( void )
 
 	for( i = 0; i < numframes; i++ )
 	{
+		FTLIB_BeginFrame();
 		re.BeginFrame( separation[i], forceclear, cinematic );
 
 		if( scr_draw_loading == 2 )
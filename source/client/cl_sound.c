@@ -254,8 +254,18 @@ void CL_SoundModule_Init( qboolean verbose )
 	import.FS_IsUrl = FS_IsUrl;
 
 	import.Milliseconds = Sys_Milliseconds;
+	import.Microseconds = Sys_Microseconds;
+	import.Sleep = Sys_Sleep;
 	import.PageInMemory = Com_PageInMemory;
 
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+	import.Mutex_Create = QMutex_Create;
+	import.Mutex_Destroy = QMutex_Destroy;
+	import.Mutex_Lock = QMutex_Lock;
+	import.Mutex_Unlock = QMutex_Unlock;
+	import.Atomic_Add = QAtomic_Add;
+
 	import.Mem_Alloc = CL_SoundModule_MemAlloc;
 	import.Mem_Free = CL_SoundModule_MemFree;
 	import.Mem_AllocPool = CL_SoundModule_MemAllocPool;
@@ -230,6 +230,7 @@ void CL_UIModule_Init( void )
 	import.CL_FreeClipboardData = CL_FreeClipboardData;
 	import.CL_OpenURLInBrowser = CL_OpenURLInBrowser;
 	import.CL_ReadDemoMetaData = CL_ReadDemoMetaData;
+	import.DI_GetFileList = DI_GetFileList;
 	import.CL_PlayerNum = CL_UIModule_PlayerNum;
 
 	import.Key_ClearStates = Key_ClearStates;
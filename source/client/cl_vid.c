@@ -387,6 +387,8 @@ static qboolean VID_LoadRefresh( const char *name )
 
 	import.Sys_Milliseconds = &Sys_Milliseconds;
 	import.Sys_Microseconds = &Sys_Microseconds;
+	import.Sys_NumberOfProcessors = &Sys_NumberOfProcessors;
+	import.Com_CPUFeatures = &COM_CPUFeatures;
 
 	import.Cvar_Get = &Cvar_Get;
 	import.Cvar_Set = &Cvar_Set;
@@ -440,6 +442,19 @@ static qboolean VID_LoadRefresh( const char *name )
 	import.Mem_Realloc = &_Mem_Realloc;
 	import.Mem_PoolTotalSize = &Mem_PoolTotalSize;
 
+	import.Thread_Create = &QThread_Create;
+	import.Thread_Join = &QThread_Join;
+	import.Mutex_Create = &QMutex_Create;
+	import.Mutex_Destroy = &QMutex_Destroy;
+	import.Mutex_Lock = &QMutex_Lock;
+	import.Mutex_Unlock = &QMutex_Unlock;
+	import.CondVar_Create = &QCondVar_Create;
+	import.CondVar_Destroy = &QCondVar_Destroy;
+	import.CondVar_Wait = &QCondVar_Wait;
+	import.CondVar_Wake = &QCondVar_Wake;
+	import.CondVar_WakeAll = &QCondVar_WakeAll;
+	import.Atomic_Add = &QAtomic_Add;
+
 	// load dynamic library
 	Com_Printf( "Loading refresh module %s... ", name );
 	funcs[0].name = "GetRefAPI";
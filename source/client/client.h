@@ -110,6 +110,7 @@ typedef struct
 	//
 	int servercount;        // server identification for prespawns
 	int playernum;
+	qboolean gamestatePending;	// asked for the gamestate message and haven't got it yet
 
 	char servermessage[MAX_STRING_CHARS];
 	char configstrings[MAX_CONFIGSTRINGS][MAX_CONFIGSTRING_CHARS];
@@ -234,6 +235,7 @@ typedef struct
 	socket_t *socket;               // socket used by current connection
 	qboolean reliable;
 	qboolean mv;
+	qboolean packedentities;        // packetentities come as a bitstream
 
 	netadr_t rconaddress;       // address where we are sending rcon messages, to ignore other print packets
 
@@ -311,6 +313,7 @@ extern cvar_t *cl_run;
 extern cvar_t *cl_anglespeedkey;
 
 extern cvar_t *cl_compresspackets;
+extern cvar_t *cl_packedentities;
 extern cvar_t *cl_shownet;
 
 extern cvar_t *cl_extrapolationTime;
@@ -512,6 +515,8 @@ void CL_WriteDemoMessage( msg_t *msg );
 void CL_DemoCompleted( void );
 void CL_PlayDemo_f( void );
 void CL_PlayDemoToAvi_f( void );
+void CL_EntBench_f( void );
+void CL_EntBenchFrame( snapshot_t *frame );
 void CL_ReadDemoPackets( void );
 void CL_Stop_f( void );
 void CL_Record_f( void );
@@ -70,6 +70,11 @@ static struct shader_s *CL_FTLibModule_RegisterRawPic( const char *name, int wid
 	return re.RegisterRawPic( name, width, height, data );
 }
 
+static void CL_FTLibModule_ReplaceRawSubPic( struct shader_s *shader, int x, int y, int width, int height, qbyte *data )
+{
+	re.ReplaceRawSubPic( shader, x, y, width, height, data );
+}
+
 static void CL_FTLibModule_DrawStretchPic( int x, int y, int w, int h, float s1, float t1, float s2, float t2, const vec4_t color, const struct shader_s *shader )
 {
 	re.DrawStretchPic( x, y, w, h, s1, t1, s2, t2, color, shader );
@@ -131,6 +136,7 @@ void FTLIB_LoadLibrary( qboolean verbose )
 
 	import.R_RegisterPic = &CL_FTLibModule_RegisterPic;
 	import.R_RegisterRawPic = &CL_FTLibModule_RegisterRawPic;
+	import.R_ReplaceRawSubPic = &CL_FTLibModule_ReplaceRawSubPic;
 	import.R_DrawStretchPic = &CL_FTLibModule_DrawStretchPic;
 	import.R_Scissor = &CL_FTLibModule_Scissor;
 	import.R_GetScissor = &CL_FTLibModule_GetScissor;
@@ -274,6 +280,16 @@ void FTLIB_FreeFonts( qboolean verbose )
 	}
 }
 
+/*
+* FTLIB_BeginFrame
+*/
+void FTLIB_BeginFrame( void )
+{
+	if( ftlib_export ) {
+		ftlib_export->BeginFrame();
+	}
+}
+
 // drawing functions
 
 /*
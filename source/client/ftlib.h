@@ -27,6 +27,7 @@ void FTLIB_TouchFont( struct qfontface_s *qfont );
 void FTLIB_TouchAllFonts( void );
 void FTLIB_PrecacheFonts( qboolean verbose );
 void FTLIB_FreeFonts( qboolean verbose );
+void FTLIB_BeginFrame( void );
 
 // drawing functions
 
@@ -20,13 +20,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // snd_public.h -- sound dll information visible to engine
 
-#define	SOUND_API_VERSION   33
+#define	SOUND_API_VERSION   34
 
 #define	ATTN_NONE 0
 
 //===============================================================
 
 struct sfx_s;
+struct qthread_s;
+struct qmutex_s;
 
 //
 // functions provided by the main engine
@@ -76,8 +78,19 @@ typedef struct
 	qboolean ( *FS_IsUrl )( const char *url );
 
 	unsigned int ( *Milliseconds )( void );
+	quint64 ( *Microseconds )( void );
+	void ( *Sleep )( unsigned int millis );
 	void ( *PageInMemory )( qbyte *buffer, int size );
 
+	// threads
+	struct qthread_s *( *Thread_Create )( void *( *routine )( void * ), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
+	struct qmutex_s *( *Mutex_Create )( void );
+	void ( *Mutex_Destroy )( struct qmutex_s **pmutex );
+	void ( *Mutex_Lock )( struct qmutex_s *mutex );
+	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+	int ( *Atomic_Add )( volatile int *value, int add );
+
 	// managed memory allocation
 	struct mempool_s *( *Mem_AllocPool )( const char *name, const char *filename, int fileline );
 	void *( *Mem_Alloc )( struct mempool_s *pool, int size, const char *filename, int fileline );
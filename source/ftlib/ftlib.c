@@ -40,16 +40,28 @@ static qfontface_t fontFaces[FTLIB_MAX_FONT_FACES];
 #define FT_FILE_EXTENSION_TRUETYPE	".ttf"
 #define FT_FILE_EXTENSION_OPENTYPE	".otf"
 
-#define TTF_BITMAP_MARGIN		3
-
 FT_Library ftLibrary = NULL;
 
 typedef struct
 {
 	FT_Face ftface;
-	FT_UInt *gindices;
+	int ascent;
 } qttface_t;
 
+/*
+* QFT_GlyphIndex
+*/
+static FT_UInt QFT_GlyphIndex( qttface_t *qttf, unsigned int num )
+{
+	FT_UInt gindex;
+
+	gindex = FT_Get_Char_Index( qttf->ftface, num );
+	if( !gindex && num == FTLIB_REPLACEMENT_GLYPH ) {
+		gindex = FT_Get_Char_Index( qttf->ftface, '?' );
+	}
+	return gindex;
+}
+
 /*
 * QFT_GetKerning
 */
@@ -67,8 +79,8 @@ static short QFT_GetKerning( qfontface_t *qfont, unsigned int char1, unsigned in
 		return 0;
 	}
 
-	gi1 = qttf->gindices[char1];
-	gi2 = qttf->gindices[char2];
+	gi1 = FT_Get_Char_Index( qttf->ftface, char1 );
+	gi2 = FT_Get_Char_Index( qttf->ftface, char2 );
 	if( !gi1 || !gi2 ) {
 		return 0;
 	}
@@ -77,35 +89,128 @@ static short QFT_GetKerning( qfontface_t *qfont, unsigned int char1, unsigned in
 	return kvec.x >> 6;
 }
 
+/*
+* QFT_LoadGlyph
+*
+* Only the advance is needed to measure strings, so the glyph isn't rendered
+*/
+static void QFT_LoadGlyph( qfontface_t *qfont, unsigned int num, qglyph_t *qglyph )
+{
+	qttface_t *qttf = ( qttface_t * )qfont->facedata;
+	FT_UInt gindex;
+	FT_Pos advance;
+
+	qglyph->flags = QGLYPH_LOADED;
+
+	gindex = QFT_GlyphIndex( qttf, num );
+	if( !gindex || FT_Load_Glyph( qttf->ftface, gindex, FT_LOAD_DEFAULT ) != 0 ) {
+		if( num == FTLIB_REPLACEMENT_GLYPH ) {
+			qglyph->flags |= QGLYPH_EMPTY;
+		} else {
+			qglyph->flags |= QGLYPH_MISSING;
+		}
+		return;
+	}
+
+	advance = qttf->ftface->glyph->advance.x;
+	qglyph->x_advance = ( advance >> 6 ) + ( advance & 0x3F ? 1 : 0 );
+}
+
+/*
+* QFT_RenderGlyph
+*/
+static void QFT_RenderGlyph( qfontface_t *qfont, unsigned int num, qglyph_t *qglyph )
+{
+	qttface_t *qttf = ( qttface_t * )qfont->facedata;
+	FT_Face ftface = qttf->ftface;
+	FT_UInt gindex;
+	FT_Bitmap *bitmap;
+	unsigned int x, y, width, height;
+	qbyte *src, *dst, *image;
+
+	if( qglyph->flags & ( QGLYPH_EMPTY|QGLYPH_MISSING ) ) {
+		return;
+	}
+
+	// don't rasterize anything that can't be stored this frame
+	if( FTLIB_AtlasIsFull() ) {
+		return;
+	}
+
+	gindex = QFT_GlyphIndex( qttf, num );
+	if( !gindex || FT_Load_Glyph( ftface, gindex, FT_LOAD_DEFAULT ) != 0 
+		|| FT_Render_Glyph( ftface->glyph, FT_RENDER_MODE_NORMAL ) != 0 ) {
+		qglyph->flags |= QGLYPH_EMPTY;
+		return;
+	}
+
+	bitmap = &ftface->glyph->bitmap;
+	width = bitmap->width;
+	height = qfont->height;
+	if( !width || width + FTLIB_ATLAS_MARGIN > FTLIB_ATLAS_WIDTH ) {
+		qglyph->flags |= QGLYPH_EMPTY;
+		return;
+	}
+
+	qglyph->width = width;
+	qglyph->x_offset = ftface->glyph->bitmap_left;
+	qglyph->y_offset = qttf->ascent - ftface->glyph->bitmap_top;
+
+	// copy the coverage into the alpha channel of a white image
+	image = ( qbyte * )FTLIB_Alloc( ftlibPool, width * height * 4 );
+	src = bitmap->buffer;
+	dst = image;
+	for( y = 0; y < height && y < (unsigned)bitmap->rows; y++ ) {
+		for( x = 0; x < width; x++ ) {
+			qbyte alpha;
+
+			switch( bitmap->pixel_mode ) {
+				case FT_PIXEL_MODE_MONO:
+					alpha = src[x >> 3] & ( 0x80 >> ( x & 7 ) ) ? 255 : 0;
+					break;
+				case FT_PIXEL_MODE_GRAY2:
+					alpha = ( ( src[x >> 2] >> ( 6 - ( ( x & 3 ) << 1 ) ) ) & 3 ) * 0x55;
+					break;
+				case FT_PIXEL_MODE_GRAY4:
+					alpha = ( ( src[x >> 1] >> ( 4 - ( ( x & 1 ) << 2 ) ) ) & 15 ) * 0x11;
+					break;
+				case FT_PIXEL_MODE_GRAY:
+					alpha = src[x];
+					break;
+				default:
+					alpha = 0;
+					break;
+			}
+
+			dst[0] = dst[1] = dst[2] = 255;
+			dst[3] = alpha;
+			dst += 4;
+		}
+
+		src += bitmap->pitch;
+	}
+
+	FTLIB_AddAtlasGlyph( qglyph, width, height, image );
+
+	FTLIB_Free( image );
+}
+
 /*
 * QFT_LoadFace
 *
-* FIXME: this is waaaaaaaay too complex...
+* Glyphs are loaded and rasterized on first use, see QFT_LoadGlyph and QFT_RenderGlyph
 */
 static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size, unsigned int lastChar, 
 	const void *data, size_t dataSize )
 {
-	unsigned int i, j, x, y;
+	unsigned int i;
 	unsigned int faceIndex;
 	int fontHeight;
 	unsigned int minChar, maxChar, numGlyphs;
-	int lastStartChar;
 	int error;
 	FT_Face ftface;
 	FT_ULong charcode;
 	FT_UInt gindex;
-	FT_Pos advance;
-	const int margin = TTF_BITMAP_MARGIN;
-	const int imageWidth = FTLIB_FONT_IMAGE_WIDTH;
-	int imageHeight, imagePitch;
-	int xOffset, yOffset;
-	int maxUp;
-	int line, numLines;
-	int linesPerImage;
-	int numImages, imageNum;
-	qbyte *tempRGBA = NULL;
-	qboolean clearImage;
-	qboolean hasKerning;
 	qttface_t *qttf = NULL;
 	qfontface_t *qfont = NULL;
 
@@ -134,47 +239,17 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size, unsi
 	// set the font size
 	FT_Set_Pixel_Sizes( ftface, size, 0 );
 
-	hasKerning = FT_HAS_KERNING( ftface ) ? qtrue : qfalse;
-
-	// go over all characters to find the max ascent values, which
-	// corresponds to the amount of space required above the baseline
-	maxUp = 0;
-
-	// track available chars
+	// track available chars, the character map is enough for that
 	minChar = FTLIB_LAST_FONT_CHAR + 1;
 	maxChar = FTLIB_FIRST_FONT_CHAR - 1;
 
-	numLines = 1;
-
-	advance = 0;
-	xOffset = 0;
-	for( i = FTLIB_FIRST_FONT_CHAR; i <= lastChar; i++ ) {
-		// render glyph for this char
-		charcode = i;
-		gindex = FT_Get_Char_Index( ftface, charcode );
-		if( gindex > 0 ) {
-			FT_Load_Glyph( ftface, gindex, FT_LOAD_DEFAULT );
-			FT_Render_Glyph( ftface->glyph, FT_RENDER_MODE_NORMAL );
-
-			xOffset += advance;
-			advance = ftface->glyph->bitmap.width + margin;
-
-			// if the char doesn't fit, start on the next line
-			if( xOffset + advance > imageWidth ) {
-				xOffset = 0;
-				numLines++;
-			}
-
-			if( i < minChar ) {
-				minChar = i;
-			}
-			if( i > maxChar ) {
-				maxChar = i;
-			}
-
-			// track line and font height
-			maxUp = max( maxUp, ftface->glyph->bitmap_top );
+	charcode = FT_Get_First_Char( ftface, &gindex );
+	while( gindex != 0 && charcode <= lastChar ) {
+		if( charcode >= FTLIB_FIRST_FONT_CHAR ) {
+			minChar = min( minChar, charcode );
+			maxChar = max( maxChar, charcode );
 		}
+		charcode = FT_Get_Next_Char( ftface, charcode, &gindex );
 	}
 
 	// validate
@@ -187,26 +262,24 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size, unsi
 		maxChar = FTLIB_REPLACEMENT_GLYPH;
 	}
 
-	// we are going to need this for kerning
-	qttf = FTLIB_Alloc( ftlibPool, sizeof( *qttf ) + (maxChar+1) * sizeof( FT_UInt ) );
-	qttf->gindices = ( FT_UInt * )( ( qbyte * )qttf + sizeof( *qttf ) );
+	// use scaled version of the original design text height (the vertical 
+	// distance from one baseline to the next) as font height
+	fontHeight = ftface->size->metrics.height >> 6;
+	if( fontHeight + FTLIB_ATLAS_MARGIN > FTLIB_ATLAS_HEIGHT ) {
+		Com_Printf( S_COLOR_YELLOW "Warning: Font height limit exceeded for '%s' %i\n", family->name, size );
+		goto done;
+	}
+
+	qttf = FTLIB_Alloc( ftlibPool, sizeof( *qttf ) );
 	qttf->ftface = ftface;
+	qttf->ascent = ( ftface->size->metrics.ascender + 63 ) >> 6;
 
 	// failed to find an unused slot, take a new one
 	if( faceIndex == numFontFaces ) {
 		numFontFaces++;
 	}
 
-	// use scaled version of the original design text height (the vertical 
-	// distance from one baseline to the next) as font height
-	fontHeight = ftface->size->metrics.height >> 6;
 	numGlyphs = maxChar + 1;
-	linesPerImage = FTLIB_MAX_FONT_IMAGE_HEIGHT / (fontHeight + margin);
-	if( linesPerImage < 1 ) {
-		Com_Printf( S_COLOR_YELLOW "Warning: Font height limit exceeded for '%s' %i\n", family->name, size );
-		goto done;
-	}
-	numImages = numLines / linesPerImage + 1;
 
 	// store font info
 	qfont = & fontFaces[faceIndex];
@@ -218,211 +291,18 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size, unsi
 	qfont->maxChar = maxChar;
 	qfont->lastChar = lastChar;
 	qfont->glyphs = ( qglyph_t *)(FTLIB_Alloc( ftlibPool, numGlyphs * sizeof( *qfont->glyphs ) ));
-	qfont->numShaders = numImages;
-	qfont->shaders = ( shader_t ** )FTLIB_Alloc( ftlibPool, numImages * sizeof( *qfont->shaders ) );
-	qfont->shaderNames = ( char ** )FTLIB_Alloc( ftlibPool, numImages * sizeof( *qfont->shaderNames ) );
-	qfont->hasKerning = hasKerning;
+	qfont->hasKerning = FT_HAS_KERNING( ftface ) ? qtrue : qfalse;
 	qfont->facedata = ( void * )qttf;
 	qfont->getKerning = & QFT_GetKerning;
-
-	// render glyphs onto RGBA images
-	imageNum = 0;
-	imageHeight = 0;
-	imagePitch = imageWidth * 4;
-	tempRGBA = ( qbyte * )FTLIB_Alloc( ftlibPool, imagePitch * FTLIB_MAX_FONT_IMAGE_HEIGHT );
-	clearImage = qtrue;
-	lastStartChar = minChar;
-
-	line = 0;
-	advance = 0;
-	xOffset = 0;
-	yOffset = 0;
-	for( i = minChar; i <= maxChar + 1; i++ ) {
-		qglyph_t *qglyph = &qfont->glyphs[i];
-		qboolean uploadNow = i > maxChar && imageHeight > 0 ? qtrue : qfalse;
-
-upload_image:
-		if( uploadNow )
-		{
-			unsigned int lastEndChar;
-			int uploadWidth, uploadHeight;
-			char shaderName[MAX_QPATH];
-			shader_t *shader;
-			
-			assert( imageNum < numImages );
-
-			clearImage = qtrue;
-
-			// round to nearest greater power of two
-			uploadWidth = imageWidth;
-			uploadHeight = 1;
-			for( ; uploadHeight < imageHeight; uploadHeight <<= 1 );
-
-			Q_snprintfz( shaderName, sizeof( shaderName ), 
-				"%s %i %i (%i)", 
-				family->name, size, family->style, imageNum );
-			shader = trap_R_RegisterRawPic( shaderName, uploadWidth, uploadHeight, tempRGBA );
-
-			qfont->shaderNames[imageNum] = FTLIB_CopyString( shaderName );
-			qfont->shaders[imageNum] = shader;
-			imageNum++;
-
-			// update glyphs texture coordinates and set shader pointer
-			lastEndChar = min( i, maxChar );
-			for( j = lastStartChar; j <= lastEndChar; j++ ) {
-				qglyph_t *qglyph = &qfont->glyphs[j];
-				qglyph->s1 = (float)qglyph->s1 / (float)uploadWidth;
-				qglyph->t1 = (float)qglyph->t1 / (float)uploadHeight;
-				qglyph->s2 = (float)qglyph->s2 / (float)uploadWidth;
-				qglyph->t2 = (float)qglyph->t2 / (float)uploadHeight;
-				qglyph->shader = shader;
-			}
-		}
-
-		if( i > maxChar ) {
-			break;
-		}
-				
-		if( clearImage ) {
-			clearImage = qfalse;
-			memset( tempRGBA, 0, imagePitch * FTLIB_MAX_FONT_IMAGE_HEIGHT );
-			lastStartChar = i;
-			imageHeight = 0;
-		}
-
-		// render glyph for this char
-		charcode = i;
-		gindex = FT_Get_Char_Index( ftface, charcode );
-		qttf->gindices[charcode] = gindex;
-		if( gindex > 0 ) {
-			qbyte *dst, *src;
-			qbyte *dst_p, *src_p;
-			FT_Bitmap *bitmap;
-			unsigned int bitmap_width, bitmap_height;
-			unsigned int bitmap_left, bitmap_top;
-			unsigned int bitmap_pixmode, bitmap_pitch;
-			
-			FT_Load_Glyph( ftface, gindex, FT_LOAD_DEFAULT );
-			FT_Render_Glyph( ftface->glyph, FT_RENDER_MODE_NORMAL );
-
-			// copy bitmap
-			bitmap = &ftface->glyph->bitmap;
-			bitmap_left = ftface->glyph->bitmap_left;
-			bitmap_top = ftface->glyph->bitmap_top;
-			bitmap_width = bitmap->width;
-			bitmap_height = bitmap->rows;
-			bitmap_pixmode = bitmap->pixel_mode;
-			bitmap_pitch = bitmap->pitch;
-
-			xOffset += advance;
-			advance = bitmap_width + margin;
-			if( xOffset + advance > imageWidth ) {
-				xOffset = 0;
-				yOffset += fontHeight + margin;
-				line++;
-
-				if( yOffset + fontHeight + margin > FTLIB_MAX_FONT_IMAGE_HEIGHT ) {
-					// ran out of room, start with new image
-					advance = 0;
-					yOffset = 0;
-					uploadNow = qtrue;
-					goto upload_image;
-				}
-			}
-
-			if( !xOffset ) {
-				assert( imageNum < numImages );
-				imageHeight += fontHeight + margin;
-			}
-
-			src = bitmap->buffer;
-			dst = tempRGBA + yOffset * imagePitch + xOffset * 4;
-
-			for( y = 0; y < bitmap_height; y++ ) {
-				src_p = src;
-				dst_p = dst;
-
-				switch( bitmap_pixmode ) {
-					case FT_PIXEL_MODE_MONO:
-						for( x = 0; x < bitmap_width; x += 8 ) {
-							unsigned char ch = *src_p++;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x80) >> 7); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x40) >> 6); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x20) >> 5); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x10) >> 4); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x08) >> 3); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x04) >> 2); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x02) >> 1); dst_p += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = 255 * !!((ch & 0x01) >> 0); dst_p += 4;
-						}
-						break;
-					case FT_PIXEL_MODE_GRAY2:
-						for( x = 0; x < bitmap_width; x += 4 ) {
-							unsigned char ch = *src_p++;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0xA0) >> 6) * 0x55 ); ch <<= 2; dst += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0xA0) >> 6) * 0x55 ); ch <<= 2; dst += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0xA0) >> 6) * 0x55 ); ch <<= 2; dst += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0xA0) >> 6) * 0x55 ); ch <<= 2; dst += 4;
-						}
-						break;
-					case FT_PIXEL_MODE_GRAY4:
-						for( x = 0; x < bitmap_width; x += 2 ) {
-							unsigned char ch = *src_p++;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0xF0) >> 4) * 0x11); dst += 4;
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = ( ((ch & 0x0F) ) * 0x11); dst += 4;
-						}
-						break;
-					case FT_PIXEL_MODE_GRAY:
-						// in this case pitch should equal width
-
-						// copy the grey value into the alpha bytes
-						for( x = 0; x < bitmap_width; x++ ) {
-							dst_p[0] = dst_p[1] = dst_p[2] = 255; dst_p[3] = *src_p++; dst_p += 4;
-						}
-						break;
-					default:
-						break;
-				}
-
-				src += bitmap_pitch;
-				dst += imagePitch;
-			}
-
-			// store glyph info
-			qglyph->width = bitmap_width;
-			qglyph->x_advance = (ftface->glyph->advance.x >> 6) + (ftface->glyph->advance.x & 0x3F ? 1 : 0);
-			qglyph->s1 = xOffset;
-			qglyph->t1 = yOffset;
-			qglyph->s2 = xOffset + bitmap_width;
-			qglyph->t2 = yOffset + fontHeight;
-			qglyph->x_offset = bitmap_left;
-			qglyph->y_offset = maxUp - bitmap_top;
-		}
-	}
-
-	// make sure the replacement glyph is always present
-	if( !qfont->glyphs[FTLIB_REPLACEMENT_GLYPH].shader ) {
-		qfont->glyphs[FTLIB_REPLACEMENT_GLYPH] = qfont->glyphs['?'];
-	}
-
-	// ummm, replace missing glyphs with some sane one
-	assert( qfont->glyphs[FTLIB_REPLACEMENT_GLYPH].shader != NULL );	
-	for( i = minChar; i <= maxChar; i++ ) {
-		qglyph_t *qglyph = &qfont->glyphs[i];
-		if( !qglyph->shader ) {
-			*qglyph = qfont->glyphs[FTLIB_REPLACEMENT_GLYPH];
-		}
-	}
+	qfont->loadGlyph = & QFT_LoadGlyph;
+	qfont->renderGlyph = & QFT_RenderGlyph;
 
 done:
-	if( tempRGBA ) {
-		FTLIB_Free( tempRGBA );
-	}
-	if( !qfont && qttf ) {
-		if( qttf->ftface ) {
-			FT_Done_Face( qttf->ftface );
+	if( !qfont ) {
+		if( qttf ) {
+			FTLIB_Free( qttf );
 		}
-		FTLIB_Free( qttf );
+		FT_Done_Face( ftface );
 	}
 	return qfont;
 }
@@ -617,6 +497,8 @@ static void QFT_Shutdown( void )
 void FTLIB_InitSubsystems( qboolean verbose )
 {
 	QFT_Init( verbose );
+
+	FTLIB_InitAtlas();
 }
 
 /*
@@ -695,15 +577,8 @@ qfontface_t *FTLIB_RegisterFont( const char *family, int style, unsigned int siz
 */
 void FTLIB_TouchFont( qfontface_t *qfont )
 {
-	unsigned int i;
-
-	if( !qfont->shaders ) {
-		return;
-	}
-
-	for( i = 0; i < qfont->numShaders; i++ ) {
-		trap_R_RegisterPic( qfont->shaderNames[i] ); 
-	}
+	// all faces share the atlas
+	FTLIB_TouchAtlas();
 }
 
 /*
@@ -711,21 +586,7 @@ void FTLIB_TouchFont( qfontface_t *qfont )
 */
 void FTLIB_TouchAllFonts( void )
 {
-	unsigned int i, j;
-	qfontfamily_t *qfamily;
-	qfontface_t *qface;
-
-	// unload all font families
-	for( i = 0; i < numFontFamilies; i++ ) {
-		qfamily = &fontFamilies[i];
-
-		// unload all faces for this family
-		for( j = 0; j < qfamily->numFaces; j++ ) {
-			qface = qfamily->faces[j];
-
-			FTLIB_TouchFont( qface );
-		}
-	}
+	FTLIB_TouchAtlas();
 }
 
 /*
@@ -733,10 +594,13 @@ void FTLIB_TouchAllFonts( void )
 */
 void FTLIB_FreeFonts( qboolean verbose )
 {
-	unsigned int i, j, k;
+	unsigned int i, j;
 	qfontfamily_t *qfamily;
 	qfontface_t *qface;
 
+	// the glyphs go away with their faces
+	FTLIB_FreeAtlas();
+
 	// unload all font families
 	for( i = 0; i < numFontFamilies; i++ ) {
 		qfamily = &fontFamilies[i];
@@ -749,15 +613,6 @@ void FTLIB_FreeFonts( qboolean verbose )
 				qfamily->unloadFace( qface );
 			}
 
-			if( qface->shaderNames ) {
-				for( k = 0; k < qface->numShaders; k++ ) {
-					FTLIB_Free( qface->shaderNames[k] );
-				}
-				FTLIB_Free( qface->shaderNames );
-			}
-			if( qface->shaders ) {
-				FTLIB_Free( qface->shaders );
-			}
 			if( qface->glyphs ) {
 				FTLIB_Free( qface->glyphs );
 			}
@@ -808,8 +663,8 @@ void FTLIB_PrintFontList( void )
 		for( j = 0; j < qfamily->numFaces; j++ ) {
 			qface = qfamily->faces[j];
 
-			Com_Printf( "  face %i: size:%ipt, glyphs:%i, height:%ipx, images:%i\n", 
-				j, qface->size, qface->numGlyphs, qface->height, qface->numShaders );
+			Com_Printf( "  face %i: size:%ipt, glyphs:%i, height:%ipx\n", 
+				j, qface->size, qface->numGlyphs, qface->height );
 		}
 	}
 }
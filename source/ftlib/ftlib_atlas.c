@@ -0,0 +1,439 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "ftlib_local.h"
+
+/*
+* Glyph atlas
+*
+* All font faces share a few atlas images. Glyphs are rasterized when they
+* are first drawn and stored on shelves: rows of the atlas holding glyphs of
+* the same height, filled from left to right. Shelves are kept in LRU order.
+* When there's no room for a new glyph, the least recently used shelf that is
+* tall enough is emptied, or a whole image if the shelves don't fit. Glyphs
+* drawn in the current frame are never evicted since the renderer may still
+* have them queued, so a glyph that doesn't fit is simply not drawn until the
+* next frame.
+*/
+
+typedef struct qfontshelf_s
+{
+	int page;
+	int y, height;					// rows of the image taken by the shelf
+	int glyphHeight;				// height of the glyphs it holds
+	int x;							// first free column
+	unsigned int lastFrame;
+	qglyph_t *glyphs;
+	struct qfontshelf_s *prev, *next;
+} qfontshelf_t;
+
+typedef struct
+{
+	shader_t *shader;
+	char name[MAX_QPATH];
+	int height;						// rows taken by shelves
+} qfontpage_t;
+
+static int numAtlasPages;
+static qfontpage_t atlasPages[FTLIB_ATLAS_MAX_PAGES];
+
+static qfontshelf_t atlasShelves[FTLIB_ATLAS_MAX_SHELVES];
+static qfontshelf_t atlasUsedShelves;	// most recently used first
+static qfontshelf_t *atlasFreeShelves;
+
+static unsigned int atlasFrame;
+static unsigned int atlasFullFrame;
+
+static qbyte *atlasUploadBuffer;
+static size_t atlasUploadBufferSize;
+
+// statistics
+static unsigned int atlasRasterized, atlasLastRasterized, atlasMaxRasterized;
+static unsigned int atlasTotalRasterized, atlasEvictedGlyphs, atlasEvictedShelves, atlasMisses;
+
+/*
+* FTLIB_InitAtlas
+*/
+void FTLIB_InitAtlas( void )
+{
+	int i;
+
+	numAtlasPages = 0;
+	memset( atlasPages, 0, sizeof( atlasPages ) );
+
+	atlasUsedShelves.prev = atlasUsedShelves.next = &atlasUsedShelves;
+	atlasFreeShelves = NULL;
+	for( i = FTLIB_ATLAS_MAX_SHELVES - 1; i >= 0; i-- ) {
+		atlasShelves[i].next = atlasFreeShelves;
+		atlasFreeShelves = &atlasShelves[i];
+	}
+
+	atlasUploadBuffer = NULL;
+	atlasUploadBufferSize = 0;
+
+	atlasFrame = 1;
+	atlasFullFrame = 0;
+	atlasRasterized = atlasLastRasterized = atlasMaxRasterized = 0;
+	atlasTotalRasterized = atlasEvictedGlyphs = atlasEvictedShelves = atlasMisses = 0;
+}
+
+/*
+* FTLIB_FreeAtlas
+*
+* The glyphs must be freed by the caller
+*/
+void FTLIB_FreeAtlas( void )
+{
+	if( atlasUploadBuffer ) {
+		FTLIB_Free( atlasUploadBuffer );
+	}
+
+	FTLIB_InitAtlas();
+}
+
+/*
+* FTLIB_BeginFrame
+*/
+void FTLIB_BeginFrame( void )
+{
+	atlasFrame++;
+
+	atlasLastRasterized = atlasRasterized;
+	if( atlasRasterized > atlasMaxRasterized ) {
+		atlasMaxRasterized = atlasRasterized;
+	}
+	atlasRasterized = 0;
+}
+
+/*
+* FTLIB_TouchAtlas
+*
+* Keeps the atlas images registered
+*/
+void FTLIB_TouchAtlas( void )
+{
+	int i;
+
+	for( i = 0; i < numAtlasPages; i++ ) {
+		trap_R_RegisterPic( atlasPages[i].name );
+	}
+}
+
+/*
+* FTLIB_AtlasIsFull
+*
+* Whether a glyph couldn't be added in this frame already
+*/
+qboolean FTLIB_AtlasIsFull( void )
+{
+	return atlasFullFrame == atlasFrame ? qtrue : qfalse;
+}
+
+/*
+* FTLIB_LinkShelf
+*/
+static void FTLIB_LinkShelf( qfontshelf_t *shelf )
+{
+	shelf->prev = &atlasUsedShelves;
+	shelf->next = atlasUsedShelves.next;
+	shelf->next->prev = shelf;
+	atlasUsedShelves.next = shelf;
+}
+
+/*
+* FTLIB_UnlinkShelf
+*/
+static void FTLIB_UnlinkShelf( qfontshelf_t *shelf )
+{
+	shelf->prev->next = shelf->next;
+	shelf->next->prev = shelf->prev;
+}
+
+/*
+* FTLIB_TouchAtlasGlyph
+*/
+void FTLIB_TouchAtlasGlyph( qglyph_t *glyph )
+{
+	qfontshelf_t *shelf = glyph->shelf;
+
+	if( !shelf || shelf->lastFrame == atlasFrame ) {
+		return;
+	}
+
+	shelf->lastFrame = atlasFrame;
+	FTLIB_UnlinkShelf( shelf );
+	FTLIB_LinkShelf( shelf );
+}
+
+/*
+* FTLIB_EmptyShelf
+*/
+static void FTLIB_EmptyShelf( qfontshelf_t *shelf )
+{
+	qglyph_t *glyph, *next;
+
+	for( glyph = shelf->glyphs; glyph; glyph = next ) {
+		next = glyph->nextInShelf;
+		glyph->shader = NULL;
+		glyph->shelf = NULL;
+		glyph->nextInShelf = NULL;
+		atlasEvictedGlyphs++;
+	}
+
+	shelf->glyphs = NULL;
+	shelf->x = 0;
+	atlasEvictedShelves++;
+}
+
+/*
+* FTLIB_AddPage
+*/
+static qboolean FTLIB_AddPage( void )
+{
+	qbyte *data;
+	qfontpage_t *page;
+
+	if( numAtlasPages == FTLIB_ATLAS_MAX_PAGES ) {
+		return qfalse;
+	}
+
+	page = &atlasPages[numAtlasPages];
+	Q_snprintfz( page->name, sizeof( page->name ), "ftlib atlas %i", numAtlasPages );
+
+	data = ( qbyte * )FTLIB_Alloc( ftlibPool, FTLIB_ATLAS_WIDTH * FTLIB_ATLAS_HEIGHT * 4 );
+	page->shader = trap_R_RegisterRawPic( page->name, FTLIB_ATLAS_WIDTH, FTLIB_ATLAS_HEIGHT, data );
+	FTLIB_Free( data );
+
+	if( !page->shader ) {
+		return qfalse;
+	}
+
+	page->height = 0;
+	numAtlasPages++;
+	return qtrue;
+}
+
+/*
+* FTLIB_NewShelf
+*/
+static qfontshelf_t *FTLIB_NewShelf( int page, int height )
+{
+	qfontshelf_t *shelf;
+
+	if( !atlasFreeShelves || atlasPages[page].height + height > FTLIB_ATLAS_HEIGHT ) {
+		return NULL;
+	}
+
+	shelf = atlasFreeShelves;
+	atlasFreeShelves = shelf->next;
+
+	shelf->page = page;
+	shelf->y = atlasPages[page].height;
+	shelf->height = height;
+	shelf->glyphHeight = height;
+	shelf->x = 0;
+	shelf->lastFrame = 0;
+	shelf->glyphs = NULL;
+	FTLIB_LinkShelf( shelf );
+
+	atlasPages[page].height += height;
+	return shelf;
+}
+
+/*
+* FTLIB_ResetPage
+*
+* Empties all shelves of the least recently used image
+*/
+static int FTLIB_ResetPage( void )
+{
+	int i, best;
+	unsigned int lastFrame[FTLIB_ATLAS_MAX_PAGES];
+	qfontshelf_t *shelf, *next;
+
+	memset( lastFrame, 0, sizeof( lastFrame ) );
+	for( shelf = atlasUsedShelves.next; shelf != &atlasUsedShelves; shelf = shelf->next ) {
+		lastFrame[shelf->page] = max( lastFrame[shelf->page], shelf->lastFrame );
+	}
+
+	best = -1;
+	for( i = 0; i < numAtlasPages; i++ ) {
+		if( lastFrame[i] == atlasFrame ) {
+			continue;
+		}
+		if( best < 0 || lastFrame[i] < lastFrame[best] ) {
+			best = i;
+		}
+	}
+
+	if( best < 0 ) {
+		return -1;
+	}
+
+	for( shelf = atlasUsedShelves.next; shelf != &atlasUsedShelves; shelf = next ) {
+		next = shelf->next;
+		if( shelf->page != best ) {
+			continue;
+		}
+
+		FTLIB_EmptyShelf( shelf );
+		FTLIB_UnlinkShelf( shelf );
+		shelf->next = atlasFreeShelves;
+		atlasFreeShelves = shelf;
+	}
+
+	atlasPages[best].height = 0;
+	return best;
+}
+
+/*
+* FTLIB_FindShelf
+*/
+static qfontshelf_t *FTLIB_FindShelf( int width, int height )
+{
+	int i;
+	qfontshelf_t *shelf;
+
+	// a shelf for glyphs of this height with room left
+	for( shelf = atlasUsedShelves.next; shelf != &atlasUsedShelves; shelf = shelf->next ) {
+		if( shelf->glyphHeight == height && shelf->x + width <= FTLIB_ATLAS_WIDTH ) {
+			return shelf;
+		}
+	}
+
+	// open a new shelf
+	for( i = 0; i < numAtlasPages; i++ ) {
+		if( ( shelf = FTLIB_NewShelf( i, height ) ) != NULL ) {
+			return shelf;
+		}
+	}
+	if( FTLIB_AddPage() ) {
+		return FTLIB_NewShelf( numAtlasPages - 1, height );
+	}
+
+	// reuse the least recently used shelf that is tall enough
+	for( shelf = atlasUsedShelves.prev; shelf != &atlasUsedShelves; shelf = shelf->prev ) {
+		if( shelf->lastFrame == atlasFrame ) {
+			break;
+		}
+		if( shelf->height >= height && shelf->height <= height * 2 ) {
+			FTLIB_EmptyShelf( shelf );
+			shelf->glyphHeight = height;
+			return shelf;
+		}
+	}
+
+	// the shelves are too fragmented, start over with a whole image
+	i = FTLIB_ResetPage();
+	if( i < 0 ) {
+		return NULL;
+	}
+	return FTLIB_NewShelf( i, height );
+}
+
+/*
+* FTLIB_AddAtlasGlyph
+*
+* Uploads the rasterized glyph, width x height RGBA pixels
+*/
+qboolean FTLIB_AddAtlasGlyph( qglyph_t *glyph, int width, int height, const qbyte *data )
+{
+	int y;
+	int cellWidth = width + FTLIB_ATLAS_MARGIN, cellHeight = height + FTLIB_ATLAS_MARGIN;
+	size_t size;
+	qfontshelf_t *shelf;
+	qfontpage_t *page;
+
+	atlasRasterized++;
+	atlasTotalRasterized++;
+
+	if( cellWidth > FTLIB_ATLAS_WIDTH || cellHeight > FTLIB_ATLAS_HEIGHT ) {
+		return qfalse;
+	}
+
+	shelf = FTLIB_FindShelf( cellWidth, cellHeight );
+	if( !shelf ) {
+		atlasFullFrame = atlasFrame;
+		atlasMisses++;
+		return qfalse;
+	}
+
+	// the margins are cleared too, an evicted glyph may have left something there
+	size = cellWidth * cellHeight * 4;
+	if( size > atlasUploadBufferSize ) {
+		if( atlasUploadBuffer ) {
+			FTLIB_Free( atlasUploadBuffer );
+		}
+		atlasUploadBuffer = ( qbyte * )FTLIB_Alloc( ftlibPool, size );
+		atlasUploadBufferSize = size;
+	}
+
+	memset( atlasUploadBuffer, 0, size );
+	for( y = 0; y < height; y++ ) {
+		memcpy( atlasUploadBuffer + y * cellWidth * 4, data + y * width * 4, width * 4 );
+	}
+
+	page = &atlasPages[shelf->page];
+	trap_R_ReplaceRawSubPic( page->shader, shelf->x, shelf->y, cellWidth, cellHeight, atlasUploadBuffer );
+
+	glyph->shader = page->shader;
+	glyph->s1 = (float)shelf->x / FTLIB_ATLAS_WIDTH;
+	glyph->t1 = (float)shelf->y / FTLIB_ATLAS_HEIGHT;
+	glyph->s2 = (float)( shelf->x + width ) / FTLIB_ATLAS_WIDTH;
+	glyph->t2 = (float)( shelf->y + height ) / FTLIB_ATLAS_HEIGHT;
+	glyph->shelf = shelf;
+	glyph->nextInShelf = shelf->glyphs;
+	shelf->glyphs = glyph;
+	shelf->x += cellWidth;
+
+	FTLIB_TouchAtlasGlyph( glyph );
+	return qtrue;
+}
+
+/*
+* FTLIB_PrintAtlasStats
+*/
+void FTLIB_PrintAtlasStats( void )
+{
+	int numShelves = 0, numGlyphs = 0;
+	size_t shelfArea = 0, glyphArea = 0, totalArea;
+	qfontshelf_t *shelf;
+	qglyph_t *glyph;
+
+	for( shelf = atlasUsedShelves.next; shelf != &atlasUsedShelves; shelf = shelf->next ) {
+		numShelves++;
+		shelfArea += shelf->height * FTLIB_ATLAS_WIDTH;
+		glyphArea += shelf->x * shelf->glyphHeight;
+		for( glyph = shelf->glyphs; glyph; glyph = glyph->nextInShelf ) {
+			numGlyphs++;
+		}
+	}
+
+	totalArea = numAtlasPages * FTLIB_ATLAS_WIDTH * FTLIB_ATLAS_HEIGHT;
+
+	Com_Printf( "Glyph atlas: %i/%i images of %ix%i, %i shelves, %i glyphs\n",
+		numAtlasPages, FTLIB_ATLAS_MAX_PAGES, FTLIB_ATLAS_WIDTH, FTLIB_ATLAS_HEIGHT, numShelves, numGlyphs );
+	if( totalArea ) {
+		Com_Printf( "occupancy: %.1f%% in shelves, %.1f%% in glyphs\n",
+			100.0 * shelfArea / totalArea, 100.0 * glyphArea / totalArea );
+	}
+	Com_Printf( "rasterized: %u last frame, %u max per frame, %u total\n",
+		atlasLastRasterized, atlasMaxRasterized, atlasTotalRasterized );
+	Com_Printf( "evicted: %u glyphs in %u shelves, %u glyphs didn't fit\n",
+		atlasEvictedGlyphs, atlasEvictedShelves, atlasMisses );
+}
@@ -25,6 +25,28 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 //STRINGS HELPERS
 //===============================================================================
 
+/*
+* FTLIB_GetGlyph
+* loads the glyph on first use, characters missing from the font give the replacement glyph
+*/
+qglyph_t *FTLIB_GetGlyph( qfontface_t *font, qwchar num )
+{
+	qglyph_t *glyph = &font->glyphs[num];
+
+	if( !( glyph->flags & QGLYPH_LOADED ) ) {
+		font->loadGlyph( font, num, glyph );
+	}
+
+	if( glyph->flags & QGLYPH_MISSING ) {
+		glyph = &font->glyphs[FTLIB_REPLACEMENT_GLYPH];
+		if( !( glyph->flags & QGLYPH_LOADED ) ) {
+			font->loadGlyph( font, FTLIB_REPLACEMENT_GLYPH, glyph );
+		}
+	}
+
+	return glyph;
+}
+
 /*
 * FTLIB_fontHeight
 */
@@ -71,7 +93,7 @@ size_t FTLIB_strWidth( const char *str, qfontface_t *font, size_t maxlen )
 				}
 			}
 
-			width += font->glyphs[num].x_advance;
+			width += FTLIB_GetGlyph( font, num )->x_advance;
 			break;
 
 		case GRABCHAR_COLOR:
@@ -121,7 +143,7 @@ size_t FTLIB_StrlenForWidth( const char *str, qfontface_t *font, size_t maxwidth
 			if( num < font->minChar || num > font->maxChar )
 				num = FTLIB_REPLACEMENT_GLYPH;
 
-			advance = font->glyphs[num].x_advance;
+			advance = FTLIB_GetGlyph( font, num )->x_advance;
 			if( prev_num ) {
 				if( font->hasKerning ) {
 					advance += font->getKerning( font, prev_num, num );
@@ -172,7 +194,15 @@ void FTLIB_DrawRawChar( int x, int y, qwchar num, qfontface_t *font, vec4_t colo
 	if( num < font->minChar || num > font->maxChar )
 		num = FTLIB_REPLACEMENT_GLYPH;
 
-	glyph = &font->glyphs[num];
+	glyph = FTLIB_GetGlyph( font, num );
+	if( !glyph->shader ) {
+		// first use or evicted from the atlas
+		font->renderGlyph( font, glyph - font->glyphs, glyph );
+		if( !glyph->shader )
+			return;
+	}
+	FTLIB_TouchAtlasGlyph( glyph );
+
 	trap_R_DrawStretchPic( x + glyph->x_offset, y + glyph->y_offset, 
 		glyph->width, font->height,
 		glyph->s1, glyph->t1, glyph->s2, glyph->t2,
@@ -219,7 +249,7 @@ void FTLIB_DrawClampString( int x, int y, const char *str, int xmin, int ymin, i
 				continue;
 
 			if( prev_num ) {
-				xoffset += font->glyphs[prev_num].x_advance;
+				xoffset += FTLIB_GetGlyph( font, prev_num )->x_advance;
 				if( font->hasKerning ) {
 					xoffset += font->getKerning( font, prev_num, num );
 				}
@@ -278,14 +308,14 @@ size_t FTLIB_DrawRawString( int x, int y, const char *str, size_t maxwidth, qfon
 			if( num < font->minChar || num > font->maxChar )
 				continue;
 
-			if( maxwidth && ( ( xoffset + font->glyphs[num].x_advance ) > maxwidth ) )
+			if( maxwidth && ( ( xoffset + FTLIB_GetGlyph( font, num )->x_advance ) > maxwidth ) )
 			{
 				s = olds;
 				break;
 			}
 
 			if( prev_num ) {
-				xoffset += font->glyphs[prev_num].x_advance;
+				xoffset += FTLIB_GetGlyph( font, prev_num )->x_advance;
 				if( font->hasKerning ) {
 					xoffset += font->getKerning( font, prev_num, num );
 				}
@@ -43,8 +43,11 @@ typedef struct shader_s shader_t;
 
 #define FTLIB_REPLACEMENT_GLYPH		127
 
-#define FTLIB_FONT_IMAGE_WIDTH		1024
-#define FTLIB_MAX_FONT_IMAGE_HEIGHT	1024
+#define FTLIB_ATLAS_WIDTH			1024
+#define FTLIB_ATLAS_HEIGHT			1024
+#define FTLIB_ATLAS_MAX_PAGES		4
+#define FTLIB_ATLAS_MAX_SHELVES		512
+#define FTLIB_ATLAS_MARGIN			3
 
 #define FTLIB_MAX_FONT_FAMILIES		64
 #define FTLIB_MAX_FONT_FACES		128
@@ -53,13 +56,20 @@ typedef struct shader_s shader_t;
 #define FTLIB_LAST_FONT_CHAR		0x9FCC
 #define FTLIB_MAX_FONT_CHARS		( FTLIB_LAST_FONT_CHAR - FTLIB_FIRST_FONT_CHAR + 1 )
 
-typedef struct
+#define QGLYPH_LOADED				1	// x_advance is valid
+#define QGLYPH_MISSING				2	// not in the font, drawn as the replacement glyph
+#define QGLYPH_EMPTY				4	// nothing to draw
+
+typedef struct qglyph_s
 {
+	int flags;
 	unsigned short width;
 	unsigned short x_advance;
 	short x_offset, y_offset;
-	struct shader_s	*shader;
+	struct shader_s	*shader;		// NULL while not in the atlas
 	float s1, t1, s2, t2;
+	struct qfontshelf_s *shelf;
+	struct qglyph_s *nextInShelf;
 } qglyph_t;
 
 typedef struct qfontface_s
@@ -70,11 +80,6 @@ typedef struct qfontface_s
 	unsigned int size;
 	int height;
 
-	// a font may not fit into single image
-	unsigned int numShaders;
-	shader_t **shaders;
-	char **shaderNames;
-
 	// range of characters contained within the font
 	unsigned int minChar, maxChar;
 
@@ -90,6 +95,12 @@ typedef struct qfontface_s
 	// offsets between adjacent characters
 	short ( *getKerning )( struct qfontface_s *, unsigned int char1, unsigned int char2 );
 
+	// loads the glyph metrics on first use
+	void ( *loadGlyph )( struct qfontface_s *, unsigned int num, qglyph_t *glyph );
+
+	// rasterizes the glyph into the atlas
+	void ( *renderGlyph )( struct qfontface_s *, unsigned int num, qglyph_t *glyph );
+
 	void *facedata;
 } qfontface_t;
 
@@ -130,7 +141,18 @@ void FTLIB_TouchAllFonts( void );
 void FTLIB_FreeFonts( qboolean verbose );
 void FTLIB_PrintFontList( void );
 
+// ftlib_atlas.c
+void FTLIB_InitAtlas( void );
+void FTLIB_FreeAtlas( void );
+void FTLIB_BeginFrame( void );
+void FTLIB_TouchAtlas( void );
+qboolean FTLIB_AtlasIsFull( void );
+void FTLIB_TouchAtlasGlyph( qglyph_t *glyph );
+qboolean FTLIB_AddAtlasGlyph( qglyph_t *glyph, int width, int height, const qbyte *data );
+void FTLIB_PrintAtlasStats( void );
+
 // ftlib_draw.c
+qglyph_t *FTLIB_GetGlyph( qfontface_t *font, qwchar num );
 size_t FTLIB_fontHeight( qfontface_t *font );
 size_t FTLIB_strWidth( const char *str, qfontface_t *font, size_t maxlen );
 size_t FTLIB_StrlenForWidth( const char *str, qfontface_t *font, size_t maxwidth );
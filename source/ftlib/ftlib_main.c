@@ -40,6 +40,7 @@ qboolean FTLIB_Init( qboolean verbose )
 	FTLIB_InitSubsystems( verbose );
 
 	trap_Cmd_AddCommand( "fontlist", &FTLIB_PrintFontList );
+	trap_Cmd_AddCommand( "fontatlas", &FTLIB_PrintAtlasStats );
 
 	return qtrue;
 }
@@ -54,6 +55,7 @@ void FTLIB_Shutdown( qboolean verbose )
 	FTLIB_FreePool( &ftlibPool );
 
 	trap_Cmd_RemoveCommand( "fontlist" );
+	trap_Cmd_RemoveCommand( "fontatlas" );
 }
 
 /*
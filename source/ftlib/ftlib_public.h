@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // ftlib_public.h - font provider subsystem
 
-#define	FTLIB_API_VERSION			2
+#define	FTLIB_API_VERSION			3
 
 //===============================================================
 
@@ -84,6 +84,7 @@ typedef struct
 	// renderer
 	struct shader_s *( *R_RegisterPic )( const char *name );
 	struct shader_s * ( *R_RegisterRawPic )( const char *name, int width, int height, qbyte *data );
+	void ( *R_ReplaceRawSubPic )( struct shader_s *shader, int x, int y, int width, int height, qbyte *data );
 	void ( *R_DrawStretchPic )( int x, int y, int w, int h, float s1, float t1, float s2, float t2, const vec4_t color, const struct shader_s *shader );
 	void ( *R_Scissor )( int x, int y, int w, int h );
 	void ( *R_GetScissor )( int *x, int *y, int *w, int *h );
@@ -117,6 +118,7 @@ typedef struct
 	void ( *TouchFont )( struct qfontface_s *qfont );
 	void ( *TouchAllFonts )( void );
 	void ( *FreeFonts )( qboolean verbose );
+	void ( *BeginFrame )( void );
 
 	// drawing functions
 	size_t ( *FontHeight )( struct qfontface_s *font );
@@ -43,6 +43,7 @@ QF_DLL_EXPORT ftlib_export_t *GetFTLibAPI( ftlib_import_t *import )
 	globals.TouchFont = &FTLIB_TouchFont;
 	globals.TouchAllFonts = &FTLIB_TouchAllFonts;
 	globals.FreeFonts = &FTLIB_FreeFonts;
+	globals.BeginFrame = &FTLIB_BeginFrame;
 
 	globals.FontHeight = &FTLIB_fontHeight;
 	globals.StringWidth = &FTLIB_strWidth;
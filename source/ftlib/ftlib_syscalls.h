@@ -182,6 +182,11 @@ static inline struct shader_s *trap_R_RegisterRawPic( const char *name, int widt
 	return FTLIB_IMPORT.R_RegisterRawPic( name, width, height, data );
 }
 
+static inline void trap_R_ReplaceRawSubPic( struct shader_s *shader, int x, int y, int width, int height, qbyte *data )
+{
+	FTLIB_IMPORT.R_ReplaceRawSubPic( shader, x, y, width, height, data );
+}
+
 static inline void trap_R_DrawStretchPic( int x, int y, int w, int h, float s1, float t1, float s2, float t2, vec4_t color, struct shader_s *shader ) {
 	FTLIB_IMPORT.R_DrawStretchPic( x, y, w, h, s1, t1, s2, t2, color, shader );
 }
@@ -1504,7 +1504,7 @@ static void BOT_DMClass_BlockedTimeout( edict_t *self )
 	self->ai->blocked_timeout = level.time + 15000;
 	self->die( self, self, self, 100000, vec3_origin );
 	G_Killed( self, self, self, 999, vec3_origin, MOD_SUICIDE );
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 }
 
 //==========================================
@@ -1518,7 +1518,7 @@ static void BOT_DMclass_GhostingFrame( edict_t *self )
 	AI_ClearGoal( self );
 
 	self->ai->blocked_timeout = level.time + 15000;
-	self->nextThink = level.time + 100;
+	G_SetNextThink( self, level.time + 100 );
 
 	// wait 4 seconds after entering the level
 	if( self->r.client->level.timeStamp + 4000 > level.time || !level.canSpawnEntities )
@@ -1532,9 +1532,9 @@ static void BOT_DMclass_GhostingFrame( edict_t *self )
 			G_Teams_JoinAnyTeam( self, false );
 
 		if( self->r.client->team == TEAM_SPECTATOR ) // couldn't join, delay the next think
-			self->nextThink = level.time + 2000 + (int)( 4000 * random() );
+			G_SetNextThink( self, level.time + 2000 + (int)( 4000 * random() ) );
 		else
-			self->nextThink = level.time + 1;
+			G_SetNextThink( self, level.time + 1 );
 		return;
 	}
 
@@ -1622,7 +1622,7 @@ static void BOT_DMclass_RunFrame( edict_t *self )
 	clamp( ucmd.upfrac, -1, 1 );
 
 	ClientThink( self, &ucmd, 0 );
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 
 	BOT_DMclass_VSAYmessages( self );
 }
@@ -1638,6 +1638,7 @@ void BOT_DMclass_InitPersistant( edict_t *self )
 	int i, w;
 
 	self->classname = "dmbot";
+	G_UpdateEntityIndex( self );
 
 	if( self->r.client->netname )
 		self->ai->pers.netname = self->r.client->netname;
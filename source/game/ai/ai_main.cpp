@@ -553,7 +553,7 @@ void AI_Think( edict_t *self )
 
 	if( level.spawnedTimeStamp + 5000 > game.realtime || !level.canSpawnEntities )
 	{
-		self->nextThink = level.time + game.snapFrameTime;
+		G_SetNextThink( self, level.time + game.snapFrameTime );
 		return;
 	}
 
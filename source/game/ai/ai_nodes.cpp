@@ -91,9 +91,10 @@ static void AI_JumpadGuess_ShowPoint( vec3_t origin, char *modelname )
 	VectorClear( ent->r.mins );
 	VectorClear( ent->r.maxs );
 	ent->s.modelindex = trap_ModelIndex( modelname );
-	ent->nextThink = level.time + 20000000;
+	G_SetNextThink( ent, level.time + 20000000 );
 	ent->think = G_FreeEdict;
 	ent->classname = "checkent";
+	G_UpdateEntityIndex( ent );
 	ent->r.svflags &= ~SVF_NOCLIENT;
 
 	GClip_LinkEntity( ent );
@@ -360,9 +360,10 @@ static void BOT_InitPersistant( edict_t *self )
 	float sv_skill;
 	//standard stuff
 	self->think = NULL;
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 	self->ai->type = AI_ISBOT;
 	self->classname = "bot";
+	G_UpdateEntityIndex( self );
 	self->yaw_speed = AI_DEFAULT_YAW_SPEED;
 	self->die = player_die;
 
@@ -434,7 +435,7 @@ static void BOT_DoSpawnBot( void )
 	BOT_Respawn( ent );
 
 	//stay as spectator, give random time for joining
-	ent->nextThink = level.time + random() * 8000;
+	G_SetNextThink( ent, level.time + random() * 8000 );
 }
 
 //==========================================
@@ -475,7 +476,7 @@ void BOT_SpawnBot( const char *team_name )
 	if( team != -1 )
 		spawner->s.team = team;
 
-	spawner->nextThink = level.time + random() * 3000;
+	G_SetNextThink( spawner, level.time + random() * 3000 );
 	spawner->movetype = MOVETYPE_NONE;
 	spawner->r.solid = SOLID_NOT;
 	spawner->r.svflags |= SVF_NOCLIENT;
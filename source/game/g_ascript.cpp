@@ -2248,6 +2248,7 @@ static asstring_t *objectGameEntity_getTargetname( edict_t *self )
 static void objectGameEntity_setTargetname( asstring_t *targetname, edict_t *self )
 {
 	self->targetname = G_RegisterLevelString( targetname->buffer );
+	G_UpdateEntityIndex( self );
 }
 
 static asstring_t *objectGameEntity_getTarget( edict_t *self )
@@ -2258,6 +2259,7 @@ static asstring_t *objectGameEntity_getTarget( edict_t *self )
 static void objectGameEntity_setTarget( asstring_t *target, edict_t *self )
 {
 	self->target = G_RegisterLevelString( target->buffer );
+	G_UpdateEntityIndex( self );
 }
 
 static asstring_t *objectGameEntity_getMap( edict_t *self )
@@ -2273,6 +2275,7 @@ static asstring_t *objectGameEntity_getSoundName( edict_t *self )
 static void objectGameEntity_setClassname( asstring_t *classname, edict_t *self )
 {
 	self->classname = G_RegisterLevelString( classname->buffer );
+	G_UpdateEntityIndex( self );
 }
 
 static void objectGameEntity_setMap( asstring_t *map, edict_t *self )
@@ -2280,6 +2283,27 @@ static void objectGameEntity_setMap( asstring_t *map, edict_t *self )
 	self->map = G_RegisterLevelString( map->buffer );
 }
 
+static int objectGameEntity_getMoveType( edict_t *self )
+{
+	return self->movetype;
+}
+
+static void objectGameEntity_setMoveType( int movetype, edict_t *self )
+{
+	self->movetype = movetype;
+	G_Schedule_Wake( self );
+}
+
+static unsigned int objectGameEntity_getNextThink( edict_t *self )
+{
+	return self->nextThink;
+}
+
+static void objectGameEntity_setNextThink( unsigned int nextThink, edict_t *self )
+{
+	G_SetNextThink( self, nextThink );
+}
+
 static void objectGameEntity_GhostClient( edict_t *self )
 {
 	if( self->r.client )
@@ -2488,6 +2512,10 @@ static const asMethod_t gedict_Methods[] =
 	{ ASLIB_FUNCTION_DECL(void, set_targetname, ( const String &in )), asFUNCTION(objectGameEntity_setTargetname), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, set_classname, ( const String &in )), asFUNCTION(objectGameEntity_setClassname), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, set_map, ( const String &in )), asFUNCTION(objectGameEntity_setMap), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(int, get_moveType, () const), asFUNCTION(objectGameEntity_getMoveType), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(void, set_moveType, ( int )), asFUNCTION(objectGameEntity_setMoveType), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(uint, get_nextThink, () const), asFUNCTION(objectGameEntity_getNextThink), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(void, set_nextThink, ( uint )), asFUNCTION(objectGameEntity_setNextThink), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, ghost, ()), asFUNCTION(objectGameEntity_GhostClient), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, spawnqueueAdd, ()), asFUNCTION(G_SpawnQueue_AddClient), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, teleportEffect, ( bool )), asFUNCTION(objectGameEntity_TeleportEffect), asCALL_CDECL_OBJLAST },
@@ -2533,8 +2561,6 @@ static const asProperty_t gedict_Properties[] =
 	{ ASLIB_PROPERTY_DECL(int, clipMask), ASLIB_FOFFSET(edict_t, r.clipmask) },
 	{ ASLIB_PROPERTY_DECL(int, spawnFlags), ASLIB_FOFFSET(edict_t, spawnflags) },
 	{ ASLIB_PROPERTY_DECL(int, style), ASLIB_FOFFSET(edict_t, style) },
-	{ ASLIB_PROPERTY_DECL(int, moveType), ASLIB_FOFFSET(edict_t, movetype) },
-	{ ASLIB_PROPERTY_DECL(uint, nextThink), ASLIB_FOFFSET(edict_t, nextThink) },
 	{ ASLIB_PROPERTY_DECL(float, health), ASLIB_FOFFSET(edict_t, health) },
 	{ ASLIB_PROPERTY_DECL(int, maxHealth), ASLIB_FOFFSET(edict_t, max_health) },
 	{ ASLIB_PROPERTY_DECL(int, viewHeight), ASLIB_FOFFSET(edict_t, viewheight) },
@@ -2780,6 +2806,7 @@ static edict_t *asFunc_G_Spawn( asstring_t *classname )
 
 	if( classname && classname->len ) {
 		ent->classname = G_RegisterLevelString( classname->buffer );
+		G_UpdateEntityIndex( ent );
 	}
 
 	ent->scriptSpawned = true;
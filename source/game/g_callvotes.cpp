@@ -154,20 +154,12 @@ static http_response_code_t G_PlayerlistWebRequest( http_query_method_t method,
 
 static void G_VoteMapExtraHelp( edict_t *ent )
 {
-	char *s;
+	const char *s, *pattern;
 	char buffer[MAX_STRING_CHARS];
 	char message[MAX_STRING_CHARS / 4 * 3];    // use buffer to send only one print message
-	int nummaps, i, start;
+	int i, start, argn, next, count;
 	size_t length, msglength;
 
-	// racesow - point them to the 'maplist' command
-	if( rs_statsEnabled->integer )
-	{
-		G_PrintMsg( ent, "Use the `maplist` command to see available maps\n" );
-		return;
-	}
-	// !racesow
-
 	// update the maplist
 	trap_ML_Update ();
 
@@ -177,31 +169,42 @@ static void G_VoteMapExtraHelp( edict_t *ent )
 		return;
 	}
 
-	// don't use Q_strncatz and Q_strncpyz below because we
-	// check length of the message string manually
-
-	memset( message, 0, sizeof( message ) );
-	strcpy( message, "- Available maps:" );
-
-	for( nummaps = 0; trap_ML_GetMapByNum( nummaps, NULL, 0 ); nummaps++ )
-		;
+	// callvote map [pattern] [start]
+	argn = 2;
+	pattern = "";
+	if( trap_Cmd_Argc() > argn && !Q_isdigit( trap_Cmd_Argv( argn ) ) )
+		pattern = trap_Cmd_Argv( argn++ );
 
-	if( trap_Cmd_Argc() > 2 )
+	start = 0;
+	if( trap_Cmd_Argc() > argn )
 	{
-		start = atoi( trap_Cmd_Argv( 2 ) ) - 1;
+		start = atoi( trap_Cmd_Argv( argn ) ) - 1;
 		if( start < 0 )
 			start = 0;
 	}
-	else
+
+	// racesow - without a pattern or a page point them to the 'maplist' command
+	if( rs_statsEnabled->integer && trap_Cmd_Argc() <= 2 )
 	{
-		start = 0;
+		G_PrintMsg( ent, "Use the `maplist` command to see available maps, or `callvote map <pattern> [start]`\n" );
+		return;
 	}
+	// !racesow
 
-	i = start;
+	// don't use Q_strncatz and Q_strncpyz below because we
+	// check length of the message string manually
+
+	memset( message, 0, sizeof( message ) );
+	if( *pattern )
+		Q_snprintfz( message, sizeof( message ), "- Maps matching '%s':", pattern );
+	else
+		strcpy( message, "- Available maps:" );
+
+	count = 0;
 	msglength = strlen( message );
-	while( trap_ML_GetMapByNum( i, buffer, sizeof( buffer ) ) )
+	for( i = trap_ML_FindMap( pattern, start ); i >= 0; i = trap_ML_FindMap( pattern, i + 1 ) )
 	{
-		i++;
+		trap_ML_GetMapByNum( i, buffer, sizeof( buffer ) );
 		s = buffer;
 		length = strlen( s );
 		if( msglength + length + 3 >= sizeof( message ) )
@@ -211,16 +214,38 @@ static void G_VoteMapExtraHelp( edict_t *ent )
 		strcat( message, s );
 
 		msglength += length + 1;
+		count++;
 	}
+	next = i;
 
-	if( i == start )
+	if( !count )
 		strcat( message, "\nNone" );
 
 	G_PrintMsg( ent, "%s", message );
 	G_PrintMsg( ent, "\n", message );
 
-	if( i < nummaps )
-		G_PrintMsg( ent, "Type 'callvote map %i' for more maps\n", i+1 );
+	if( next >= 0 )
+		G_PrintMsg( ent, "Type 'callvote map %s%s%i' for more maps\n", pattern, *pattern ? " " : "", next+1 );
+}
+
+static void G_VoteMapSuggest( edict_t *ent, const char *mapname )
+{
+	int i, count;
+	char buffer[MAX_STRING_CHARS];
+	char message[MAX_STRING_CHARS];
+
+	message[0] = '\0';
+	count = 0;
+	for( i = trap_ML_FindMap( mapname, 0 ); i >= 0 && count < 5; i = trap_ML_FindMap( mapname, i + 1 ) )
+	{
+		trap_ML_GetMapByNum( i, buffer, sizeof( buffer ) );
+		Q_strncatz( message, " ", sizeof( message ) );
+		Q_strncatz( message, buffer, sizeof( message ) );
+		count++;
+	}
+
+	if( count )
+		G_PrintMsg( ent, "Did you mean:%s%s\n", message, i >= 0 ? " ..." : "" );
 }
 
 static bool G_VoteMapValidate( callvotedata_t *data, bool first )
@@ -285,6 +310,7 @@ static bool G_VoteMapValidate( callvotedata_t *data, bool first )
 	}
 
 	G_PrintMsg( data->caller, "%sNo such map available on this server\n", S_COLOR_RED );
+	G_VoteMapSuggest( data->caller, mapname );
 
 	return false;
 }
@@ -56,14 +56,16 @@ typedef struct
 	vec3_t mins;
 	vec3_t maxs;
 	vec3_t size;
-	int marknumber;
-	// since the areagrid can have multiple references to one entity,
-	// we should avoid extensive checking on entities already encountered
-	int entmarknumber[MAX_EDICTS];
 } areagrid_t;
 
 static areagrid_t g_areagrid;
 
+// since the areagrid can have multiple references to one entity,
+// we should avoid extensive checking on entities already encountered.
+// The marks are per-thread so that area queries can run concurrently
+static THREADLOCAL int g_areagrid_marknumber;
+static THREADLOCAL int g_areagrid_entmarknumber[MAX_EDICTS];
+
 extern cvar_t *g_antilag;
 extern cvar_t *g_antilag_maxtimedelta;
 
@@ -126,10 +128,10 @@ void GClip_BackUpCollisionFrame( void )
 
 static c4clipedict_t *GClip_GetClipEdictForDeltaTime( int entNum, int deltaTime )
 {
-	static int index = 0;
-	static c4clipedict_t clipEnts[8];
-	static c4clipedict_t *clipent;
-	static c4clipedict_t clipentNewer; // for interpolation
+	static THREADLOCAL int index = 0;
+	static THREADLOCAL c4clipedict_t clipEnts[8];
+	static THREADLOCAL c4clipedict_t *clipent;
+	static THREADLOCAL c4clipedict_t clipentNewer; // for interpolation
 	c4frame_t *cframe = NULL;
 	unsigned int backTime, cframenum, bf, i;
 	edict_t	*ent = game.edicts + entNum;
@@ -275,11 +277,6 @@ static void GClip_Init_AreaGrid( areagrid_t *areagrid, const vec3_t world_mins,
 {
 	int i;
 
-	// the areagrid_marknumber is not allowed to be 0
-	if( areagrid->marknumber < 1 ) {
-		areagrid->marknumber = 1;
-	}
-
 	// choose either the world box size, or a larger box to ensure the grid isn't too fine
 	areagrid->size[0] = max( world_maxs[0] - world_mins[0], AREA_GRID * AREA_GRIDMINSIZE );
 	areagrid->size[1] = max( world_maxs[1] - world_mins[1], AREA_GRID * AREA_GRIDMINSIZE );
@@ -304,8 +301,6 @@ static void GClip_Init_AreaGrid( areagrid_t *areagrid, const vec3_t world_mins,
 		GClip_ClearLink( &areagrid->grid[i] );
 	}
 
-	memset( areagrid->entmarknumber, 0, sizeof( areagrid->entmarknumber ) );
-
 	if( developer->integer ) {
 		Com_Printf( "areagrid settings: divisions %ix%ix1 : box %f %f %f "
 			": %f %f %f size %f %f %f grid %f %f %f (mingrid %f)\n", 
@@ -394,7 +389,7 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 
 	// FIXME: if areagrid_marknumber wraps, all entities need their
 	// ent->priv.server->areagridmarknumber reset
-	areagrid->marknumber++;
+	g_areagrid_marknumber++;
 
 	igridmins[0] = (int) floor( (paddedmins[0] + areagrid->bias[0]) * areagrid->scale[0] );
 	igridmins[1] = (int) floor( (paddedmins[1] + areagrid->bias[1]) * areagrid->scale[1] );
@@ -422,10 +417,10 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 		for( l = grid->next; l != grid; l = l->next ) {
 			clipEnt = GClip_GetClipEdictForDeltaTime( l->entNum, timeDelta );
 
-			if( areagrid->entmarknumber[l->entNum] == areagrid->marknumber ) {
+			if( g_areagrid_entmarknumber[l->entNum] == g_areagrid_marknumber ) {
 				continue;
 			}
-			areagrid->entmarknumber[l->entNum] = areagrid->marknumber;
+			g_areagrid_entmarknumber[l->entNum] = g_areagrid_marknumber;
 
 			if( !clipEnt->r.inuse ) {
 				continue; // deactivated
@@ -459,10 +454,10 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 			for( l = grid->next; l != grid; l = l->next ) {
 				clipEnt = GClip_GetClipEdictForDeltaTime( l->entNum, timeDelta );
 
-				if( areagrid->entmarknumber[l->entNum] == areagrid->marknumber ) {
+				if( g_areagrid_entmarknumber[l->entNum] == g_areagrid_marknumber ) {
 					continue;
 				}
-				areagrid->entmarknumber[l->entNum] = areagrid->marknumber;
+				g_areagrid_entmarknumber[l->entNum] = g_areagrid_marknumber;
 
 				if( !clipEnt->r.inuse ) {
 					continue; // deactivated
@@ -489,6 +484,299 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 }
 
 
+/*
+* Static area tree
+*
+* Triggers and brush models that don't move make up most of the linked
+* entities of a race map, and since the area grid has no vertical
+* subdivision, checkpoints stacked on top of each other all end up in the
+* same cells. Entities with MOVETYPE_NONE are kept in a bounding box tree
+* instead, which is rebuilt in bulk, while players, projectiles and movers
+* stay in the area grid.
+*
+* A static entity that is relinked within its old bounds stays in the tree.
+* Anything else that changes goes to the area grid and the tree is rebuilt
+* at most once every AREA_TREE_REBUILD_DELAY milliseconds, from the start
+* of a frame, so queries from worker threads never see it change.
+*/
+
+#define AREA_TREE_LEAFSIZE			4
+#define AREA_TREE_MAXDEPTH			64
+#define AREA_TREE_REBUILD_DELAY		1000
+
+typedef struct
+{
+	vec3_t mins, maxs;
+	int children;				// the first of two consecutive nodes, 0 for leaves
+	int firstEnt, numEnts;
+} areatreenode_t;
+
+typedef struct
+{
+	areatreenode_t nodes[MAX_EDICTS * 2];
+	int numNodes;
+
+	int ents[MAX_EDICTS];
+	int numEnts;
+
+	bool inTree[MAX_EDICTS];
+	vec3_t entMins[MAX_EDICTS], entMaxs[MAX_EDICTS];	// bounds when the tree was built
+
+	int numPending;				// static entities in the grid and entities that left the tree
+	int numBuilds;
+	unsigned int buildTime;
+} areatree_t;
+
+static areatree_t g_areatree;
+static int g_areatree_sortaxis;
+
+/*
+* GClip_IsStaticEntity
+*/
+static bool GClip_IsStaticEntity( edict_t *ent )
+{
+	if( ent->r.client || ent->movetype != MOVETYPE_NONE )
+		return false;
+	if( ( ent->r.svflags & SVF_PROJECTILE ) || ISEVENTENTITY( &ent->s ) )
+		return false;
+	return true;
+}
+
+/*
+* GClip_BoundsInside
+*/
+static bool GClip_BoundsInside( const vec3_t mins, const vec3_t maxs, const vec3_t outermins, const vec3_t outermaxs )
+{
+	return mins[0] >= outermins[0] && mins[1] >= outermins[1] && mins[2] >= outermins[2]
+		&& maxs[0] <= outermaxs[0] && maxs[1] <= outermaxs[1] && maxs[2] <= outermaxs[2];
+}
+
+/*
+* GClip_LinkEntity_AreaTree
+* 
+* Returns true if the entity can stay in the tree
+*/
+static bool GClip_LinkEntity_AreaTree( areatree_t *areatree, edict_t *ent )
+{
+	int num = NUM_FOR_EDICT( ent );
+	bool isStatic = GClip_IsStaticEntity( ent );
+
+	if( areatree->inTree[num] )
+	{
+		if( isStatic && GClip_BoundsInside( ent->r.absmin, ent->r.absmax, areatree->entMins[num], areatree->entMaxs[num] ) )
+			return true;
+
+		areatree->inTree[num] = false;
+		areatree->numPending++;
+		return false;
+	}
+
+	if( isStatic )
+		areatree->numPending++;
+	return false;
+}
+
+/*
+* GClip_CompareAreaTreeEnts
+*/
+static int GClip_CompareAreaTreeEnts( const void *a, const void *b )
+{
+	int axis = g_areatree_sortaxis;
+	int na = *(const int *)a, nb = *(const int *)b;
+	float ca = g_areatree.entMins[na][axis] + g_areatree.entMaxs[na][axis];
+	float cb = g_areatree.entMins[nb][axis] + g_areatree.entMaxs[nb][axis];
+
+	if( ca != cb )
+		return ca < cb ? -1 : 1;
+	return na - nb;
+}
+
+/*
+* GClip_BuildAreaTreeNode
+* 
+* Splits the entities at the median of the longest axis of their centers
+*/
+static void GClip_BuildAreaTreeNode( areatree_t *areatree, int nodenum, int firstEnt, int numEnts )
+{
+	int i, axis;
+	vec3_t cmins, cmaxs, center;
+	areatreenode_t *node = &areatree->nodes[nodenum];
+
+	ClearBounds( node->mins, node->maxs );
+	ClearBounds( cmins, cmaxs );
+	for( i = firstEnt; i < firstEnt + numEnts; i++ )
+	{
+		AddPointToBounds( areatree->entMins[areatree->ents[i]], node->mins, node->maxs );
+		AddPointToBounds( areatree->entMaxs[areatree->ents[i]], node->mins, node->maxs );
+		VectorAdd( areatree->entMins[areatree->ents[i]], areatree->entMaxs[areatree->ents[i]], center );
+		AddPointToBounds( center, cmins, cmaxs );
+	}
+
+	node->firstEnt = firstEnt;
+	node->numEnts = numEnts;
+	node->children = 0;
+	if( numEnts <= AREA_TREE_LEAFSIZE )
+		return;
+
+	axis = 0;
+	for( i = 1; i < 3; i++ )
+	{
+		if( cmaxs[i] - cmins[i] > cmaxs[axis] - cmins[axis] )
+			axis = i;
+	}
+
+	g_areatree_sortaxis = axis;
+	qsort( areatree->ents + firstEnt, numEnts, sizeof( areatree->ents[0] ), GClip_CompareAreaTreeEnts );
+
+	node->children = areatree->numNodes;
+	areatree->numNodes += 2;
+	GClip_BuildAreaTreeNode( areatree, node->children, firstEnt, numEnts / 2 );
+	GClip_BuildAreaTreeNode( areatree, node->children + 1, firstEnt + numEnts / 2, numEnts - numEnts / 2 );
+}
+
+/*
+* GClip_BuildAreaTree
+* 
+* Moves all linked static entities into a new tree
+*/
+static void GClip_BuildAreaTree( areatree_t *areatree )
+{
+	int i;
+	edict_t *ent;
+
+	areatree->numEnts = 0;
+	memset( areatree->inTree, 0, sizeof( areatree->inTree ) );
+
+	for( i = 1; i < game.numentities; i++ )
+	{
+		ent = EDICT_NUM( i );
+		if( !ent->r.inuse || !ent->linked || !GClip_IsStaticEntity( ent ) )
+			continue;
+
+		GClip_UnlinkEntity_AreaGrid( ent );
+
+		areatree->inTree[i] = true;
+		VectorCopy( ent->r.absmin, areatree->entMins[i] );
+		VectorCopy( ent->r.absmax, areatree->entMaxs[i] );
+		areatree->ents[areatree->numEnts++] = i;
+	}
+
+	areatree->numNodes = 1;
+	GClip_BuildAreaTreeNode( areatree, 0, 0, areatree->numEnts );
+
+	areatree->numPending = 0;
+	areatree->numBuilds++;
+	areatree->buildTime = game.realtime;
+}
+
+/*
+* GClip_ClearAreaTree
+* 
+* Moves all entities of the tree to the area grid
+*/
+static void GClip_ClearAreaTree( areatree_t *areatree )
+{
+	int i;
+	edict_t *ent;
+
+	for( i = 0; i < areatree->numEnts; i++ )
+	{
+		ent = EDICT_NUM( areatree->ents[i] );
+		if( areatree->inTree[areatree->ents[i]] && ent->linked )
+			GClip_LinkEntity_AreaGrid( &g_areagrid, ent );
+		areatree->inTree[areatree->ents[i]] = false;
+	}
+
+	areatree->numNodes = 0;
+	areatree->numEnts = 0;
+}
+
+/*
+* GClip_EntitiesInBox_AreaTree
+* 
+* Entities are returned in entity number order, like they were linked into
+* the area grid cells when the map was spawned
+*/
+static int GClip_EntitiesInBox_AreaTree( areatree_t *areatree, const vec3_t mins, const vec3_t maxs, 
+	int *list, int maxcount, int areatype, int timeDelta )
+{
+	int i, j, entNum, numlist, stackdepth;
+	int stack[AREA_TREE_MAXDEPTH];
+	areatreenode_t *node;
+	c4clipedict_t *clipEnt;
+
+	if( !areatree->numNodes )
+		return 0;
+
+	numlist = 0;
+	stack[0] = 0;
+	stackdepth = 1;
+
+	while( stackdepth )
+	{
+		node = &areatree->nodes[stack[--stackdepth]];
+		if( !BoundsIntersect( mins, maxs, node->mins, node->maxs ) )
+			continue;
+
+		if( node->children )
+		{
+			stack[stackdepth++] = node->children + 1;
+			stack[stackdepth++] = node->children;
+			continue;
+		}
+
+		for( i = node->firstEnt; i < node->firstEnt + node->numEnts; i++ )
+		{
+			entNum = areatree->ents[i];
+			if( !areatree->inTree[entNum] || !EDICT_NUM( entNum )->linked )
+				continue; // left the tree or unlinked since it was built
+
+			clipEnt = GClip_GetClipEdictForDeltaTime( entNum, timeDelta );
+
+			if( !clipEnt->r.inuse ) {
+				continue; // deactivated
+			}
+			if( areatype == AREA_TRIGGERS && clipEnt->r.solid != SOLID_TRIGGER ) {
+				continue;
+			}
+			if( areatype == AREA_SOLID && 
+				( clipEnt->r.solid == SOLID_TRIGGER || clipEnt->r.solid == SOLID_NOT ) ) {
+				continue;
+			}
+
+			if( !BoundsIntersect( mins, maxs, clipEnt->r.absmin, clipEnt->r.absmax ) )
+				continue;
+
+			// insertion sort, the lists are short. When the list is full
+			// the highest numbers are dropped
+			if( numlist < maxcount || ( maxcount > 0 && list[maxcount - 1] > entNum ) )
+			{
+				for( j = min( numlist, maxcount - 1 ); j > 0 && list[j - 1] > entNum; j-- )
+					list[j] = list[j - 1];
+				list[j] = entNum;
+			}
+			numlist++;
+		}
+	}
+
+	return numlist;
+}
+
+/*
+* GClip_UpdateAreaTree
+* 
+* Called at the start of every frame
+*/
+void GClip_UpdateAreaTree( void )
+{
+	if( !g_areatree.numPending )
+		return;
+	if( g_areatree.numBuilds && game.realtime - g_areatree.buildTime < AREA_TREE_REBUILD_DELAY )
+		return;
+
+	GClip_BuildAreaTree( &g_areatree );
+}
+
 /*
 * GClip_ClearWorld
 * called after the world model has been loaded, before linking any entities
@@ -502,6 +790,8 @@ void GClip_ClearWorld( void )
 	trap_CM_InlineModelBounds( world_model, world_mins, world_maxs );
 
 	GClip_Init_AreaGrid( &g_areagrid, world_mins, world_maxs );
+
+	memset( &g_areatree, 0, sizeof( g_areatree ) );
 }
 
 /*
@@ -684,7 +974,8 @@ void GClip_LinkEntity( edict_t *ent )
 	ent->linkcount++;
 	ent->linked = true;
 
-	GClip_LinkEntity_AreaGrid( &g_areagrid, ent );
+	if( !GClip_LinkEntity_AreaTree( &g_areatree, ent ) )
+		GClip_LinkEntity_AreaGrid( &g_areagrid, ent );
 }
 
 /*
@@ -719,8 +1010,12 @@ static int GClip_AreaEdicts( const vec3_t mins, const vec3_t maxs,
 {
 	int count;
 
-	count = GClip_EntitiesInBox_AreaGrid( &g_areagrid, mins, maxs, 
+	count = GClip_EntitiesInBox_AreaTree( &g_areatree, mins, maxs, 
 		list, maxcount, areatype, timeDelta );
+	count = min( count, maxcount );
+
+	count += GClip_EntitiesInBox_AreaGrid( &g_areagrid, mins, maxs, 
+		list + count, maxcount - count, areatype, timeDelta );
 
 	return min( count, maxcount );
 }
@@ -1135,7 +1430,8 @@ void G_PMoveTouchTriggers( pmove_t *pm, vec3_t previous_origin )
 		ent->groundentity_linkcount = ent->groundentity->linkcount;
 	}
 
-	GClip_LinkEntity( ent );
+	if( !G_ParallelThink_DeferLink( ent ) )
+		GClip_LinkEntity( ent );
 
 	for( i = 0; i < 3; i++ )
 	{
@@ -1169,11 +1465,37 @@ void G_PMoveTouchTriggers( pmove_t *pm, vec3_t previous_origin )
 		if( !hit->item && !GClip_EntityContact( mins, maxs, hit ) )
 			continue;
 
-		G_CallTouch( hit, ent, NULL, 0 );
+		if( !G_ParallelThink_DeferTouch( hit, ent ) )
+			G_CallTouch( hit, ent, NULL, 0 );
 	}
 }
 // !racesow
 
+/*
+* GClip_TouchableTriggersInBox
+* Returns true if any trigger that reacts to being touched intersects the box
+*/
+bool GClip_TouchableTriggersInBox( const vec3_t mins, const vec3_t maxs )
+{
+	int i, num;
+	edict_t *hit;
+	int touch[MAX_EDICTS];
+
+	num = GClip_AreaEdicts( mins, maxs, touch, MAX_EDICTS, AREA_TRIGGERS, 0 );
+
+	for( i = 0; i < num; i++ )
+	{
+		hit = &game.edicts[touch[i]];
+		if( !hit->r.inuse )
+			continue;
+
+		if( hit->touch || hit->asTouchFunc )
+			return true;
+	}
+
+	return false;
+}
+
 /*
 * GClip_FindBoxInRadius
 * Returns entities that have their boxes within a spherical area
@@ -1260,3 +1582,100 @@ entity_state_t *G_GetEntityStateForDeltaTime( int entNum, int deltaTime )
 	return &clipEnt->s;
 }
 
+
+/*
+* GClip_AreaBench_Run
+* 
+* Returns the time taken, adds up the entities found and their numbers
+*/
+static unsigned int GClip_AreaBench_Run( vec3_t *boxes, int numBoxes, int repeats, int *hits, unsigned int *checksum )
+{
+	int i, j, r, num;
+	int list[MAX_EDICTS];
+	unsigned int start;
+
+	*hits = 0;
+	*checksum = 0;
+
+	start = trap_Milliseconds();
+	for( r = 0; r < repeats; r++ )
+	{
+		for( i = 0; i < numBoxes; i++ )
+		{
+			num = GClip_AreaEdicts( boxes[i * 2], boxes[i * 2 + 1], list, MAX_EDICTS, ( i & 1 ) ? AREA_SOLID : AREA_TRIGGERS, 0 );
+			if( r )
+				continue;
+
+			*hits += num;
+			for( j = 0; j < num; j++ )
+				*checksum += list[j];
+		}
+	}
+
+	return trap_Milliseconds() - start;
+}
+
+/*
+* GClip_AreaBench_Cmd_f
+* 
+* Queries the area around every linked entity, with the static area tree
+* and with everything in the area grid
+*/
+void GClip_AreaBench_Cmd_f( void )
+{
+	int i, numBoxes, repeats, treeHits, gridHits;
+	unsigned int treeTime, gridTime, treeChecksum, gridChecksum;
+	vec3_t *boxes, center;
+	edict_t *ent;
+
+	if( !level.canSpawnEntities )
+	{
+		G_Printf( "No map loaded\n" );
+		return;
+	}
+
+	repeats = 1000;
+	if( trap_Cmd_Argc() > 1 )
+		repeats = max( atoi( trap_Cmd_Argv( 1 ) ), 1 );
+
+	// a player sized box at the center of each entity, like touching triggers,
+	// and the entity bounds expanded a bit, like traces of things moving past it
+	boxes = ( vec3_t * )G_Malloc( sizeof( vec3_t ) * 4 * game.numentities );
+	numBoxes = 0;
+	for( i = 1; i < game.numentities; i++ )
+	{
+		ent = EDICT_NUM( i );
+		if( !ent->r.inuse || !ent->linked )
+			continue;
+
+		VectorAdd( ent->r.absmin, ent->r.absmax, center );
+		VectorScale( center, 0.5f, center );
+		VectorAdd( center, playerbox_stand_mins, boxes[numBoxes * 2] );
+		VectorAdd( center, playerbox_stand_maxs, boxes[numBoxes * 2 + 1] );
+		numBoxes++;
+
+		VectorSet( boxes[numBoxes * 2], -64, -64, -64 );
+		VectorSet( boxes[numBoxes * 2 + 1], 64, 64, 64 );
+		VectorAdd( ent->r.absmin, boxes[numBoxes * 2], boxes[numBoxes * 2] );
+		VectorAdd( ent->r.absmax, boxes[numBoxes * 2 + 1], boxes[numBoxes * 2 + 1] );
+		numBoxes++;
+	}
+
+	GClip_BuildAreaTree( &g_areatree );
+	treeTime = GClip_AreaBench_Run( boxes, numBoxes, repeats, &treeHits, &treeChecksum );
+
+	G_Printf( "%i static entities in %i tree nodes, %i queries x %i\n", g_areatree.numEnts, g_areatree.numNodes, numBoxes, repeats );
+
+	GClip_ClearAreaTree( &g_areatree );
+	gridTime = GClip_AreaBench_Run( boxes, numBoxes, repeats, &gridHits, &gridChecksum );
+
+	GClip_BuildAreaTree( &g_areatree );
+
+	G_Printf( "tree + grid: %u msec, %.2f usec per query\n", treeTime, numBoxes ? treeTime * 1000.0 / ( (double)numBoxes * repeats ) : 0.0 );
+	G_Printf( "grid only:   %u msec, %.2f usec per query\n", gridTime, numBoxes ? gridTime * 1000.0 / ( (double)numBoxes * repeats ) : 0.0 );
+	G_Printf( "%.2f entities per query\n", numBoxes ? (double)treeHits / numBoxes : 0.0 );
+	if( treeHits != gridHits || treeChecksum != gridChecksum )
+		G_Printf( "%sResults differ: %i entities found with the tree, %i without\n", S_COLOR_RED, treeHits, gridHits );
+
+	G_Free( boxes );
+}
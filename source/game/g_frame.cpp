@@ -658,12 +658,15 @@ static void G_UpdateFrameTime( unsigned int msec )
 * G_RunEntities
 * treat each object in turn
 * even the world and clients get a chance to think
+* entities with nothing to do are skipped, see g_thinkschedule.cpp
 */
 static void G_RunEntities( void )
 {
 	edict_t	*ent;
 
-	for( ent = &game.edicts[0]; ENTNUM( ent ) < game.numentities; ent++ )
+	G_Schedule_BeginFrame();
+
+	for( ent = G_Schedule_NextEntity( NULL ); ent; ent = G_Schedule_NextEntity( ent ) )
 	{
 		if( !ent->r.inuse )
 			continue;
@@ -710,12 +713,15 @@ static void G_RunClients( void )
 		step = 1;
 	}
 
+	G_ParallelThink_Run();
+
 	for( ; i < gs.maxclients && i >= 0; i += step )
 	{
 		ent = game.edicts + 1 + i;
 		if( !ent->r.inuse )
 			continue;
 
+		G_ParallelThink_Flush( ent );
 		G_ClientThink( ent );
 
 		if( ent->takedamage )
@@ -769,6 +775,8 @@ void G_RunFrame( unsigned int msec, unsigned int serverTime )
 	if( !g_snapStarted )
 		G_StartFrameSnap();
 
+	GClip_UpdateAreaTree();
+
 	G_CallVotes_Think();
 
 	// "freeze" match clock
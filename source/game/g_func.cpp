@@ -135,7 +135,7 @@ static void Move_Watch( edict_t *ent )
 	if( Move_AdjustFinalStep( ent ) )
 	{
 		ent->think = Move_Done;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		return;
 	}
 	else
@@ -144,7 +144,7 @@ static void Move_Watch( edict_t *ent )
 	}
 
 	ent->think =  Move_Watch;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 static void Move_Begin( edict_t *ent )
@@ -154,7 +154,7 @@ static void Move_Begin( edict_t *ent )
 	if( Move_AdjustFinalStep( ent ) )
 	{
 		ent->think = Move_Done;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		return;
 	}
 
@@ -162,7 +162,7 @@ static void Move_Begin( edict_t *ent )
 	VectorSubtract( ent->moveinfo.dest, ent->s.origin, dir );
 	VectorNormalize( dir );
 	VectorScale( dir, ent->moveinfo.speed, ent->velocity );
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	ent->think = Move_Watch;
 }
 
@@ -178,7 +178,7 @@ static void Move_Calc( edict_t *ent, vec3_t dest, void ( *func )(edict_t *) )
 	}
 	else
 	{
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		ent->think = Move_Begin;
 	}
 }
@@ -230,7 +230,7 @@ static void AngleMove_Watch( edict_t *ent )
 	if( AngleMove_AdjustFinalStep( ent ) )
 	{
 		ent->think = AngleMove_Done;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		return;
 	}
 	else
@@ -239,7 +239,7 @@ static void AngleMove_Watch( edict_t *ent )
 	}
 
 	ent->think =  AngleMove_Watch;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 static void AngleMove_Begin( edict_t *ent )
@@ -249,14 +249,14 @@ static void AngleMove_Begin( edict_t *ent )
 	if( AngleMove_AdjustFinalStep( ent ) )
 	{
 		ent->think = AngleMove_Done;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		return;
 	}
 
 	// set up velocity vector
 	VectorSubtract( ent->moveinfo.destangles, ent->s.angles, destdelta );
 	VectorScale( destdelta, ent->moveinfo.speed, ent->avelocity );
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	ent->think = AngleMove_Watch;
 }
 
@@ -272,7 +272,7 @@ static void AngleMove_Calc( edict_t *ent, vec3_t destangles, void ( *func )(edic
 	}
 	else
 	{
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		ent->think = AngleMove_Begin;
 	}
 }
@@ -303,7 +303,7 @@ static void plat_hit_top( edict_t *ent )
 	ent->moveinfo.state = STATE_TOP;
 
 	ent->think = plat_go_down;
-	ent->nextThink = level.time + 3000;
+	G_SetNextThink( ent, level.time + 3000 );
 }
 
 static void plat_hit_bottom( edict_t *ent )
@@ -381,7 +381,7 @@ static void Touch_Plat_Center( edict_t *ent, edict_t *other, cplane_t *plane, in
 	if( ent->moveinfo.state == STATE_BOTTOM )
 		plat_go_up( ent );
 	else if( ent->moveinfo.state == STATE_TOP )
-		ent->nextThink = level.time + 1000; // the player is still on the plat, so delay going down
+		G_SetNextThink( ent, level.time + 1000 ); // the player is still on the plat, so delay going down
 }
 
 static void plat_spawn_inside_trigger( edict_t *ent )
@@ -602,7 +602,7 @@ static void door_hit_top( edict_t *self )
 	if( self->moveinfo.wait >= 0 )
 	{
 		self->think = door_go_down;
-		self->nextThink = level.time + ( self->moveinfo.wait * 1000 );
+		G_SetNextThink( self, level.time + ( self->moveinfo.wait * 1000 ) );
 	}
 }
 
@@ -648,7 +648,7 @@ static void door_go_up( edict_t *self, edict_t *activator )
 	if( self->moveinfo.state == STATE_TOP )
 	{ // reset top wait time
 		if( self->moveinfo.wait >= 0 )
-			self->nextThink = level.time + ( self->moveinfo.wait * 1000 );
+			G_SetNextThink( self, level.time + ( self->moveinfo.wait * 1000 ) );
 		return;
 	}
 
@@ -942,7 +942,7 @@ void SP_func_door( edict_t *ent )
 
 	GClip_LinkEntity( ent );
 
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	if( ent->targetname )
 		ent->think = Think_CalcMoveSpeed;
 	else
@@ -1061,7 +1061,7 @@ void SP_func_door_rotating( edict_t *ent )
 
 	GClip_LinkEntity( ent );
 
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	if( ent->health || ent->targetname )
 		ent->think = Think_CalcMoveSpeed;
 	else
@@ -1228,7 +1228,7 @@ static void Think_RotateAccel( edict_t *self )
 	// add acceleration value to current speed to cause accel
 	self->moveinfo.current_speed += self->accel;
 	VectorScale( self->moveinfo.movedir, self->moveinfo.current_speed, self->avelocity );
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 }
 
 static void Think_RotateDecel( edict_t *self )
@@ -1251,7 +1251,7 @@ static void Think_RotateDecel( edict_t *self )
 	// subtract deceleration value from current speed to cause decel
 	self->moveinfo.current_speed -= self->decel;
 	VectorScale( self->moveinfo.movedir, self->moveinfo.current_speed, self->avelocity );
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 }
 
 static void rotating_blocked( edict_t *self, edict_t *other )
@@ -1283,7 +1283,7 @@ static void rotating_use( edict_t *self, edict_t *other, edict_t *activator )
 		{
 			// otherwise decelerate
 			self->think = Think_RotateDecel;
-			self->nextThink = level.time + 1;
+			G_SetNextThink( self, level.time + 1 );
 			self->moveinfo.state = STATE_DECEL;
 		} // decelerate
 	}
@@ -1300,7 +1300,7 @@ static void rotating_use( edict_t *self, edict_t *other, edict_t *activator )
 		{
 			// accelerate baybee
 			self->think = Think_RotateAccel;
-			self->nextThink = level.time + 1;
+			G_SetNextThink( self, level.time + 1 );
 			self->moveinfo.state = STATE_ACCEL;
 		}
 	}
@@ -1424,13 +1424,13 @@ static void button_wait( edict_t *self )
 	// racesow - use -1 to reset immediately
 	if( self->moveinfo.wait == -1 )
 	{
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 		self->think = button_return;
 	}
 	// !racesow
 	if( self->moveinfo.wait >= 0 )
 	{
-		self->nextThink = level.time + ( self->moveinfo.wait * 1000 );
+		G_SetNextThink( self, level.time + ( self->moveinfo.wait * 1000 ) );
 		self->think = button_return;
 	}
 }
@@ -1592,8 +1592,10 @@ static void train_wait( edict_t *self )
 		ent = self->target_ent;
 		savetarget = ent->target;
 		ent->target = ent->pathtarget;
+		G_UpdateEntityIndex( ent );
 		G_UseTargets( ent, self->activator );
 		ent->target = savetarget;
+		G_UpdateEntityIndex( ent );
 
 		// make sure we didn't get killed by a killtarget
 		if( !self->r.inuse )
@@ -1604,7 +1606,7 @@ static void train_wait( edict_t *self )
 	{
 		if( self->moveinfo.wait > 0 )
 		{
-			self->nextThink = level.time + ( self->moveinfo.wait * 1000 );
+			G_SetNextThink( self, level.time + ( self->moveinfo.wait * 1000 ) );
 			self->think = train_next;
 		}
 		else if( self->spawnflags & TRAIN_TOGGLE ) // && wait < 0
@@ -1612,7 +1614,7 @@ static void train_wait( edict_t *self )
 			train_next( self );
 			self->spawnflags &= ~TRAIN_START_ON;
 			VectorClear( self->velocity );
-			self->nextThink = 0;
+			G_SetNextThink( self, 0 );
 		}
 
 		if( !( self->flags & FL_TEAMSLAVE ) )
@@ -1652,6 +1654,7 @@ again:
 	}
 
 	self->target = ent->target;
+	G_UpdateEntityIndex( self );
 
 	// check for a teleport path_corner
 	if( ent->spawnflags & 1 )
@@ -1725,6 +1728,7 @@ static void func_train_find( edict_t *self )
 	}
 
 	self->target = ent->target;
+	G_UpdateEntityIndex( self );
 
 	VectorSubtract( ent->s.origin, self->r.mins, self->s.origin );
 	GClip_LinkEntity( self );
@@ -1735,7 +1739,7 @@ static void func_train_find( edict_t *self )
 
 	if( self->spawnflags & TRAIN_START_ON )
 	{
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 		self->think = train_next;
 		self->activator = self;
 	}
@@ -1751,7 +1755,7 @@ static void train_use( edict_t *self, edict_t *other, edict_t *activator )
 			return;
 		self->spawnflags &= ~TRAIN_START_ON;
 		VectorClear( self->velocity );
-		self->nextThink = 0;
+		G_SetNextThink( self, 0 );
 	}
 	else
 	{
@@ -1790,7 +1794,7 @@ void SP_func_train( edict_t *self )
 	{
 		// start trains on the second frame, to make sure their targets have had
 		// a chance to spawn
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 		self->think = func_train_find;
 	}
 	else
@@ -1861,7 +1865,7 @@ static void trigger_elevator_init( edict_t *self )
 void SP_trigger_elevator( edict_t *self )
 {
 	self->think = trigger_elevator_init;
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 }
 
 //QUAKED func_timer (0.3 0.1 0.6) (-8 -8 -8) (8 8 8) START_ON
@@ -1880,7 +1884,7 @@ void SP_trigger_elevator( edict_t *self )
 void func_timer_think( edict_t *self )
 {
 	G_UseTargets( self, self->activator );
-	self->nextThink = level.time + 1000 * (self->wait + crandom() * self->random);
+	G_SetNextThink( self, level.time + 1000 * (self->wait + crandom() * self->random) );
 }
 
 void func_timer_use( edict_t *self, edict_t *other, edict_t *activator )
@@ -1889,13 +1893,13 @@ void func_timer_use( edict_t *self, edict_t *other, edict_t *activator )
 
 	// if on, turn it off
 	if( self->nextThink ) {
-		self->nextThink = 0;
+		G_SetNextThink( self, 0 );
 		return;
 	}
 
 	// turn it on
 	if( self->delay )
-		self->nextThink = level.time + self->delay * 1000;
+		G_SetNextThink( self, level.time + self->delay * 1000 );
 	else
 		func_timer_think (self);
 }
@@ -1916,8 +1920,8 @@ void SP_func_timer( edict_t *self )
 	}
 
 	if( self->spawnflags & 1 ) {
-		self->nextThink = level.time + 1000 * 
-			(1.0 + st.pausetime + self->delay + self->wait + crandom() * self->random);
+		G_SetNextThink( self, level.time + 1000 * 
+			(1.0 + st.pausetime + self->delay + self->wait + crandom() * self->random) );
 		self->activator = self;
 	}
 }
@@ -2056,7 +2060,7 @@ static void func_bobbing_think( edict_t *ent )
 	VectorMA( ent->moveinfo.start_origin, phase, ent->moveinfo.dir, ent->velocity );
 	VectorSubtract( ent->velocity, ent->s.origin, ent->velocity );
 
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 /*
@@ -2089,7 +2093,7 @@ void SP_func_bobbing( edict_t *ent )
 	VectorCopy( ent->s.origin, ent->moveinfo.start_origin );
 
 	ent->think = func_bobbing_think;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	ent->moveinfo.blocked = func_bobbing_blocked;
 	ent->use = func_bobbing_use;
 
@@ -2141,7 +2145,7 @@ static void func_pendulum_think( edict_t *ent )
 	phase = sin( delta * M_TWOPI );
 	VectorMA( ent->moveinfo.start_angles, phase, ent->moveinfo.dir, ent->avelocity );
 	VectorSubtract( ent->avelocity, ent->s.angles, ent->avelocity );
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 //QUAKED func_pendulum (0 .5 .8) ?
@@ -2192,7 +2196,7 @@ void SP_func_pendulum( edict_t *ent )
 	ent->moveinfo.dir[2] = ent->speed;
 
 	ent->think = func_pendulum_think;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	ent->moveinfo.blocked = func_pendulum_blocked;
 	ent->use = func_pendulum_use;
 
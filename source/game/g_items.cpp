@@ -81,7 +81,7 @@ void SetRespawn( edict_t *ent, int delay )
 	}
 
 	ent->r.solid = SOLID_NOT;
-	ent->nextThink = level.time + delay;
+	G_SetNextThink( ent, level.time + delay );
 	ent->think = DoRespawn;
 	if( GS_MatchState() == MATCH_STATE_WARMUP ) {
 		ent->s.effects |= EF_GHOST;
@@ -96,7 +96,7 @@ void SetRespawn( edict_t *ent, int delay )
 		if( ent->item->type == IT_HEALTH )
 		{
 			ent->think = MegaHealth_think;
-			ent->nextThink = level.time + 1;
+			G_SetNextThink( ent, level.time + 1 );
 		}
 	}
 
@@ -253,7 +253,7 @@ static void Drop_Ammo( edict_t *ent, const gsitem_t *item )
 
 static void MegaHealth_think( edict_t *self )
 {
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 
 	if( self->r.owner )
 	{
@@ -448,7 +448,7 @@ static void drop_make_touchable( edict_t *ent )
 	timeout = G_Gametype_DroppedItemTimeout( ent->item );
 	if( timeout )
 	{
-		ent->nextThink = level.time + 1000 * timeout;
+		G_SetNextThink( ent, level.time + 1000 * timeout );
 		ent->think = G_FreeEdict;
 	}
 }
@@ -464,6 +464,7 @@ edict_t *Drop_Item( edict_t *ent, const gsitem_t *item )
 
 	dropped = G_Spawn();
 	dropped->classname = item->classname;
+	G_UpdateEntityIndex( dropped );
 	dropped->item = item;
 	dropped->spawnflags = DROPPED_ITEM;
 	VectorCopy( item_box_mins, dropped->r.mins );
@@ -586,7 +587,7 @@ edict_t *Drop_Item( edict_t *ent, const gsitem_t *item )
 	dropped->velocity[2] = 300;
 
 	dropped->think = drop_make_touchable;
-	dropped->nextThink = level.time + 1000;
+	G_SetNextThink( dropped, level.time + 1000 );
 
 	ent->r.client->teamstate.last_drop_item = item;
 	VectorCopy( dropped->s.origin, ent->r.client->teamstate.last_drop_location );
@@ -798,7 +799,7 @@ static void item_timer_think( edict_t *ent )
 		else
 			ent->s.frame = (int)((float)ent->s.frame / 1000.0 + 0.5);
 	}
-	ent->nextThink = level.time + 1000;
+	G_SetNextThink( ent, level.time + 1000 );
 }
 
 /*
@@ -822,7 +823,7 @@ static edict_t *Spawn_ItemTimer( edict_t *ent )
 	timer->r.owner = ent;
 	timer->s.modelindex = 0;
 	timer->s.modelindex2 = locationTag;
-	timer->nextThink = level.time + 250;
+	G_SetNextThink( timer, level.time + 250 );
 	timer->think = item_timer_think;
 	VectorCopy( ent->s.origin, timer->s.origin ); // for z-sorting
 
@@ -926,7 +927,7 @@ static void Finish_SpawningItem( edict_t *ent )
 		// team slaves and targeted items aren't present at start
 		if( ent == ent->teammaster && !ent->targetname )
 		{
-			ent->nextThink = level.time + 1;
+			G_SetNextThink( ent, level.time + 1 );
 			ent->think = DoRespawn;
 			GClip_LinkEntity( ent );
 		}
@@ -591,6 +591,8 @@ bool Add_Armor( edict_t *ent, edict_t *other, bool pick_it );
 bool KillBox( edict_t *ent );
 float LookAtKillerYAW( edict_t *self, edict_t *inflictor, edict_t *attacker );
 edict_t *G_Find( edict_t *from, size_t fieldofs, const char *match );
+void G_UpdateEntityIndex( edict_t *ent );
+void G_ResetEntityIndexes( void );
 edict_t *G_FindBoxInRadius( edict_t *from, edict_t *to, vec3_t org, float rad );
 edict_t *G_PickTarget( const char *targetname );
 void G_UseTargets( edict_t *ent, edict_t *activator );
@@ -745,12 +747,15 @@ int GClip_FindBoxInRadius4D( vec3_t org, float rad, int *list, int maxcount, int
 void G_SplashFrac4D( int entNum, vec3_t hitpoint, float maxradius, vec3_t pushdir, float *kickFrac, float *dmgFrac, int timeDelta );
 void RS_SplashFrac4D( int entNum, vec3_t hitpoint, float maxradius, vec3_t pushdir, float *kickFrac, float *dmgFrac, int timeDelta, float splashFrac ); // racesow
 void GClip_ClearWorld( void );
+void GClip_UpdateAreaTree( void );
+void GClip_AreaBench_Cmd_f( void );
 void GClip_SetBrushModel( edict_t *ent, const char *name );
 void GClip_SetAreaPortalState( edict_t *ent, bool open );
 void GClip_LinkEntity( edict_t *ent );
 void GClip_UnlinkEntity( edict_t *ent );
 void GClip_TouchTriggers( edict_t *ent );
 void G_PMoveTouchTriggers( pmove_t *pm, vec3_t previous_origin ); // racesow - previous_origin
+bool GClip_TouchableTriggersInBox( const vec3_t mins, const vec3_t maxs );
 entity_state_t *G_GetEntityStateForDeltaTime( int entNum, int deltaTime );
 int GClip_FindRadius( vec3_t org, float rad, int *list, int maxcount );
 
@@ -1304,7 +1309,7 @@ struct edict_s
 	const char *spawnString;			// keep track of string definition of this entity
 	int spawnflags;
 
-	unsigned int nextThink;
+	unsigned int nextThink;			// only set through G_SetNextThink
 
 	void ( *think )( edict_t *self );
 	void ( *touch )( edict_t *self, edict_t *other, cplane_t *plane, int surfFlags );
@@ -1430,6 +1435,28 @@ raceRun_t *G_NewRaceRun( edict_t *ent, int numSectors );
 void G_SetRaceTime( edict_t *ent, int sector, unsigned int time );
 void G_ListRaces_f( void );
 
+// pmove recording and replay
+void G_PMoveRecord_Frame( edict_t *ent, pmove_t *pm );
+void G_PMoveRecord_Stop( edict_t *ent );
+bool G_PMoveRecord_IsRecording( edict_t *ent );
+void G_PMoveRecord_Cmd_f( void );
+void G_PMoveBench_Cmd_f( void );
+
+// parallel client thinking
+void G_ParallelThink_Run( void );
+void G_ParallelThink_Flush( edict_t *ent );
+qboolean G_ClientThinkParallel( edict_t *ent, usercmd_t *ucmd, int timeDelta );
+bool G_ParallelThink_DeferLink( edict_t *ent );
+bool G_ParallelThink_DeferTouch( edict_t *other, edict_t *ent );
+bool G_ParallelThink_DeferEvent( int entNum, int ev, int parm );
+
+// think scheduling
+void G_SetNextThink( edict_t *ent, unsigned int nextThink );
+void G_Schedule_Wake( edict_t *ent );
+void G_Schedule_BeginFrame( void );
+edict_t *G_Schedule_NextEntity( edict_t *prev );
+void G_Schedule_Reset( void );
+
 // web
 http_response_code_t G_WebRequest( http_query_method_t method, const char *resource, 
 		const char *query_string, char **content, size_t *content_length );
@@ -363,6 +363,8 @@ void G_Init( unsigned int seed, unsigned int framemsec, int protocol )
 	g_maxentities = trap_Cvar_Get( "sv_maxentities", "1024", CVAR_LATCH );
 	game.maxentities = g_maxentities->integer;
 	game.edicts = ( edict_t * )G_Malloc( game.maxentities * sizeof( game.edicts[0] ) );
+	G_ResetEntityIndexes();
+	G_Schedule_Reset();
 
 	// initialize all clients for this game
 	game.clients = ( gclient_t * )G_Malloc( gs.maxclients * sizeof( game.clients[0] ) );
@@ -406,6 +408,8 @@ void G_Shutdown( void )
 
 	SV_WriteIPList ();
 
+	G_PMoveRecord_Stop( NULL );
+
 	trap_Cvar_ForceSet( "nextmap", va( "map \"%s\"", G_SelectNextMapName() ) );
 
 	BOT_RemoveBot( "all" );
@@ -474,6 +478,7 @@ static edict_t *CreateTargetChangeLevel( const char *map )
 
 	ent = G_Spawn();
 	ent->classname = "target_changelevel";
+	G_UpdateEntityIndex( ent );
 	Q_strncpyz( level.nextmap, map, sizeof( level.nextmap ) );
 	ent->map = level.nextmap;
 	return ent;
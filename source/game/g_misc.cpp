@@ -113,10 +113,11 @@ void ThrowDebris( edict_t *self, int modelindex, float speed, vec3_t origin )
 	chunk->avelocity[1] = random()*600;
 	chunk->avelocity[2] = random()*600;
 	chunk->think = G_FreeEdict;
-	chunk->nextThink = level.time + 5000 + random()*5000;
+	G_SetNextThink( chunk, level.time + 5000 + random()*5000 );
 	chunk->s.frame = 0;
 	chunk->flags = 0;
 	chunk->classname = "debris";
+	G_UpdateEntityIndex( chunk );
 	chunk->takedamage = DAMAGE_YES;
 	chunk->die = debris_die;
 	chunk->r.owner = self;
@@ -184,8 +185,10 @@ static void path_corner_touch( edict_t *self, edict_t *other, cplane_t *plane, i
 
 		savetarget = self->target;
 		self->target = self->pathtarget;
+		G_UpdateEntityIndex( self );
 		G_UseTargets( self, other );
 		self->target = savetarget;
+		G_UpdateEntityIndex( self );
 	}
 
 	if( self->target )
@@ -497,7 +500,7 @@ void SP_func_object( edict_t *self )
 		self->r.solid = SOLID_YES;
 		self->movetype = MOVETYPE_PUSH;
 		self->think = func_object_release;
-		self->nextThink = level.time + self->wait * 1000;
+		G_SetNextThink( self, level.time + self->wait * 1000 );
 		self->r.svflags &= ~SVF_NOCLIENT;
 	}
 	else
@@ -644,7 +647,7 @@ static void func_explosive_use( edict_t *self, edict_t *other, edict_t *activato
 	if( self->delay )
 	{
 		self->think = func_explosive_think;
-		self->nextThink = level.time + self->delay * 1000;
+		G_SetNextThink( self, level.time + self->delay * 1000 );
 		return;
 	}
 
@@ -770,7 +773,7 @@ static void misc_portal_surface_think( edict_t *ent )
 	else
 		VectorCopy( ent->r.owner->s.origin, ent->s.origin2 );
 
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 static void locateCamera( edict_t *ent )
@@ -806,7 +809,7 @@ static void locateCamera( edict_t *ent )
 
 	ent->r.owner = owner;
 	ent->think = misc_portal_surface_think;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 
 	// see if the portal_camera has a target
 	if( owner->target )
@@ -842,12 +845,12 @@ void SP_misc_portal_surface( edict_t *ent )
 	if( !ent->target )
 	{
 		ent->think = misc_portal_surface_think;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 	}
 	else
 	{
 		ent->think = locateCamera;
-		ent->nextThink = level.time + 1000;
+		G_SetNextThink( ent, level.time + 1000 );
 	}
 }
 
@@ -1003,7 +1006,7 @@ void SP_misc_particles( edict_t *ent )
 	}
 
 	ent->think = SP_misc_particles_finish;
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 	ent->use = SP_misc_particles_use;
 
 	GClip_LinkEntity( ent );
@@ -1038,5 +1041,5 @@ void SP_misc_video_speaker( edict_t *ent )
 	ent->s.type = ET_VIDEO_SPEAKER;
 
 	ent->think = locateTargetSpeaker;
-	ent->nextThink = level.time + 100;
+	G_SetNextThink( ent, level.time + 100 );
 }
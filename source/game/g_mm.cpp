@@ -386,6 +386,9 @@ void G_SetRaceTime( edict_t *ent, int sector, unsigned int time )
 		rr->times[rr->numSectors] = time;
 		rr->timestamp = trap_Milliseconds();
 
+		// let the server keep a demo of the run
+		trap_RaceRunFinished( ent, rr->numSectors, rr->times );
+
 		// validate the client
 		// no bots for race, at all
 		if( ent->r.svflags & SVF_FAKECLIENT /* && mm_debug_reportbots->value == 0 */ )
@@ -0,0 +1,286 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "g_local.h"
+
+/*
+* Parallel client thinking
+*
+* When the server has sv_parallelthinks enabled, G_RunClients first hands it
+* the players whose moves can't affect each other: players moving through
+* other bodies (PMFEAT_GHOSTMOVE, as race gametypes do) and noclip spectators.
+* The server runs their pending usercmds on worker threads, calling
+* G_ClientThinkParallel for each until it refuses one.
+*
+* A usercmd is refused when it could reach a trigger, fire a weapon or hurt
+* the player, so the move itself only reads the world. Whatever ClientThink
+* still does to shared state (linking the player, touch calls, predicted
+* events) is recorded per client and replayed by G_ParallelThink_Flush in the
+* regular client order, right before the refused and remaining usercmds run
+* serially through G_ClientThink. After a usercmd that deferred a touch or an
+* event with effects beyond the player entity, the client isn't run in
+* parallel again this frame.
+*
+* The parallel moves see the world as it was at the start of the client
+* loop: what other players trigger during the same frame reaches them one
+* frame later. Results don't depend on thread timing.
+*/
+
+#define PTHINK_MAX_DEFERRED		128
+#define PTHINK_MIN_FREE			( MAXTOUCH + 16 )	// worst case a single usercmd can defer
+#define PTHINK_MAX_IMPULSE		1000				// upper bound of the speed gained in one move by jumps, dashes and walljumps
+
+enum
+{
+	PTHINK_LINK,
+	PTHINK_TOUCH,
+	PTHINK_EVENT
+};
+
+typedef struct
+{
+	int type;
+	int entNum;		// touched entity or event owner
+	int ev, parm;
+} g_deferred_t;
+
+typedef struct
+{
+	bool blocked;		// the rest of this frame's usercmds run serially
+	int numDeferred;
+	g_deferred_t deferred[PTHINK_MAX_DEFERRED];
+} g_pthink_client_t;
+
+static g_pthink_client_t g_pthink_clients[MAX_CLIENTS];
+
+// set while a worker thread runs ClientThink
+static THREADLOCAL g_pthink_client_t *g_pthink_current;
+
+/*
+* G_ParallelThink_Eligible
+*
+* Whether anything the client does in ClientThink stays within itself
+*/
+static bool G_ParallelThink_Eligible( edict_t *ent )
+{
+	gclient_t *client = ent->r.client;
+
+	if( !client || ( ent->r.svflags & SVF_FAKECLIENT ) )
+		return false;
+	if( trap_GetClientState( PLAYERNUM( ent ) ) < CS_SPAWNED )
+		return false;
+	if( G_PMoveRecord_IsRecording( ent ) )
+		return false;
+
+	if( GS_Instagib() || GS_FallDamage() )
+		return false;
+	if( GS_MatchState() >= MATCH_STATE_POSTMATCH || GS_MatchPaused() )
+		return false;
+	if( G_IsDead( ent ) || ent->s.type == ET_GIB )
+		return false;
+
+	// must not collide with other players
+	if( ent->movetype == MOVETYPE_NOCLIP )
+		return true;
+	return ent->movetype == MOVETYPE_PLAYER && ( client->ps.pmove.stats[PM_STAT_FEATURES] & PMFEAT_GHOSTMOVE );
+}
+
+/*
+* G_ParallelThink_CanMove
+*/
+static bool G_ParallelThink_CanMove( edict_t *ent, usercmd_t *ucmd )
+{
+	int i;
+	float reach;
+	vec3_t mins, maxs;
+	player_state_t *ps = &ent->r.client->ps;
+
+	if( !G_ParallelThink_Eligible( ent ) )
+		return false;
+
+	// the weapon must stay idle
+	if( ucmd->buttons & BUTTON_ATTACK )
+		return false;
+	if( ps->weaponState != WEAPON_STATE_READY || ps->stats[STAT_PENDING_WEAPON] != ps->stats[STAT_WEAPON] )
+		return false;
+
+	// no trigger within what the move can possibly cover
+	reach = ( VectorLength( ent->velocity ) + PTHINK_MAX_IMPULSE ) * ucmd->msec * 0.001f + 1.0f;
+	for( i = 0; i < 3; i++ )
+	{
+		mins[i] = ent->s.origin[i] + playerbox_stand_mins[i] - reach;
+		maxs[i] = ent->s.origin[i] + playerbox_stand_maxs[i] + reach;
+	}
+
+	return !GClip_TouchableTriggersInBox( mins, maxs );
+}
+
+/*
+* G_ParallelThink_Defer
+*/
+static void G_ParallelThink_Defer( int type, int entNum, int ev, int parm )
+{
+	g_deferred_t *d;
+	g_pthink_client_t *pt = g_pthink_current;
+
+	// consecutive links collapse into one
+	if( type == PTHINK_LINK && pt->numDeferred && pt->deferred[pt->numDeferred - 1].type == PTHINK_LINK )
+		return;
+
+	// can't happen, G_ClientThinkParallel keeps room for a full usercmd
+	if( pt->numDeferred == PTHINK_MAX_DEFERRED )
+		return;
+
+	d = &pt->deferred[pt->numDeferred++];
+	d->type = type;
+	d->entNum = entNum;
+	d->ev = ev;
+	d->parm = parm;
+}
+
+/*
+* G_ParallelThink_DeferLink
+*/
+bool G_ParallelThink_DeferLink( edict_t *ent )
+{
+	if( !g_pthink_current )
+		return false;
+
+	G_ParallelThink_Defer( PTHINK_LINK, ENTNUM( ent ), 0, 0 );
+	return true;
+}
+
+/*
+* G_ParallelThink_DeferTouch
+*/
+bool G_ParallelThink_DeferTouch( edict_t *other, edict_t *ent )
+{
+	if( !g_pthink_current )
+		return false;
+
+	// the touched entity may change the player
+	G_ParallelThink_Defer( PTHINK_TOUCH, ENTNUM( other ), 0, 0 );
+	g_pthink_current->blocked = true;
+	return true;
+}
+
+/*
+* G_ParallelThink_DeferEvent
+*/
+bool G_ParallelThink_DeferEvent( int entNum, int ev, int parm )
+{
+	if( !g_pthink_current )
+		return false;
+
+	G_ParallelThink_Defer( PTHINK_EVENT, entNum, ev, parm );
+
+	// see G_PredictedEvent, anything else only adds an event to the player entity
+	if( ev == EV_FIREWEAPON || ev == EV_SMOOTHREFIREWEAPON || ( ev == EV_FALL && parm ) )
+		g_pthink_current->blocked = true;
+	return true;
+}
+
+/*
+* G_ClientThinkParallel
+*
+* Called by the server from its worker threads
+*/
+qboolean G_ClientThinkParallel( edict_t *ent, usercmd_t *ucmd, int timeDelta )
+{
+	g_pthink_client_t *pt = &g_pthink_clients[PLAYERNUM( ent )];
+
+	if( pt->blocked || pt->numDeferred > PTHINK_MAX_DEFERRED - PTHINK_MIN_FREE )
+		return qfalse;
+
+	if( !G_ParallelThink_CanMove( ent, ucmd ) )
+	{
+		pt->blocked = true;
+		return qfalse;
+	}
+
+	g_pthink_current = pt;
+	ClientThink( ent, ucmd, timeDelta );
+	g_pthink_current = NULL;
+
+	return qtrue;
+}
+
+/*
+* G_ParallelThink_Run
+*
+* Called at the start of the client loop
+*/
+void G_ParallelThink_Run( void )
+{
+	int i, numClients;
+	int clientNums[MAX_CLIENTS];
+	edict_t *ent;
+
+	for( i = 0, numClients = 0; i < gs.maxclients; i++ )
+	{
+		g_pthink_clients[i].blocked = false;
+		g_pthink_clients[i].numDeferred = 0;
+
+		ent = game.edicts + 1 + i;
+		if( !ent->r.inuse || !G_ParallelThink_Eligible( ent ) )
+			continue;
+
+		clientNums[numClients++] = i;
+	}
+
+	if( numClients < 2 )
+		return;
+
+	trap_ExecuteClientThinksParallel( clientNums, numClients );
+}
+
+/*
+* G_ParallelThink_Flush
+*
+* Applies what the client deferred while thinking in parallel
+*/
+void G_ParallelThink_Flush( edict_t *ent )
+{
+	int i;
+	edict_t *other;
+	g_deferred_t *d;
+	g_pthink_client_t *pt = &g_pthink_clients[PLAYERNUM( ent )];
+
+	for( i = 0, d = pt->deferred; i < pt->numDeferred; i++, d++ )
+	{
+		switch( d->type )
+		{
+		case PTHINK_LINK:
+			GClip_LinkEntity( ent );
+			break;
+
+		case PTHINK_TOUCH:
+			// be careful, a previous touch may have removed either of them
+			other = &game.edicts[d->entNum];
+			if( ent->r.inuse && other->r.inuse )
+				G_CallTouch( other, ent, NULL, 0 );
+			break;
+
+		case PTHINK_EVENT:
+			G_PredictedEvent( d->entNum, d->ev, d->parm );
+			break;
+		}
+	}
+
+	pt->numDeferred = 0;
+}
@@ -227,7 +227,7 @@ static void SV_RunThink( edict_t *ent )
 	if( thinktime > level.time )
 		return;
 
-	ent->nextThink = 0;
+	G_SetNextThink( ent, 0 );
 
 	if( ISEVENTENTITY( &ent->s ) )  // events do not think
 		return;
@@ -661,7 +661,7 @@ static void SV_Physics_Pusher( edict_t *ent )
 		for( mover = ent; mover; mover = mover->teamchain )
 		{
 			if( mover->nextThink > 0 )
-				mover->nextThink += game.frametime;
+				G_SetNextThink( mover, mover->nextThink + game.frametime );
 		}
 
 		// if the pusher has a "blocked" function, call it
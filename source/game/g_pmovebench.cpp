@@ -0,0 +1,424 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "g_local.h"
+
+/*
+* Pmove recording and replay
+*
+* "pmoverecord" captures the player state and game state of a client once and
+* then every usercmd it sends, right before it goes into Pmove. "pmovebench"
+* replays such a stream against the world collision model of the loaded map,
+* with no entities, triggers or events involved, and reports the move rate
+* and collision query counts. The state after every move is hashed and can be
+* stored as a baseline, later replays must reproduce it bit for bit.
+*
+* Typical headless use:
+*   wsw_server +map <mapname> +pmovebench <stream> [repeats]
+*/
+
+#define PMOVEREC_IDENT			( ( 'R' << 24 ) + ( 'M' << 16 ) + ( 'P' << 8 ) + 'W' )	// "WPMR"
+#define PMOVEREC_VERSION		1
+#define PMOVEREC_EXTENSION		".pmr"
+#define PMOVEBASELINE_EXTENSION	".pmb"
+#define PMOVEREC_DIR			"pmove"
+
+#define PMOVEBENCH_DEFAULT_REPEATS	100
+
+typedef struct
+{
+	int ident;
+	int version;
+	char mapname[MAX_CONFIGSTRING_CHARS];
+	game_state_t gameState;
+	player_state_t playerState;
+} pmoverec_header_t;
+
+static int pmrec_file;
+static int pmrec_playernum = -1;
+static int pmrec_numcmds;
+static char pmrec_filename[MAX_QPATH];
+
+static int pmbench_traces, pmbench_contents;
+
+/*
+* G_PMoveRecord_Frame
+*
+* Called by ClientThink right before the client is moved
+*/
+void G_PMoveRecord_Frame( edict_t *ent, pmove_t *pm )
+{
+	if( pmrec_playernum < 0 || PLAYERNUM( ent ) != pmrec_playernum )
+		return;
+
+	if( !pmrec_numcmds )
+	{
+		pmoverec_header_t header;
+
+		memset( &header, 0, sizeof( header ) );
+		header.ident = LittleLong( PMOVEREC_IDENT );
+		header.version = LittleLong( PMOVEREC_VERSION );
+		Q_strncpyz( header.mapname, level.mapname, sizeof( header.mapname ) );
+		header.gameState = gs.gameState;
+		header.playerState = *pm->playerState;
+		trap_FS_Write( &header, sizeof( header ), pmrec_file );
+	}
+
+	trap_FS_Write( &pm->cmd, sizeof( pm->cmd ), pmrec_file );
+	pmrec_numcmds++;
+}
+
+/*
+* G_PMoveRecord_Stop
+*
+* Stops recording the given player, or whoever is recorded if ent is NULL
+*/
+void G_PMoveRecord_Stop( edict_t *ent )
+{
+	if( pmrec_playernum < 0 )
+		return;
+	if( ent && PLAYERNUM( ent ) != pmrec_playernum )
+		return;
+
+	trap_FS_FCloseFile( pmrec_file );
+	G_Printf( "Recorded %i moves to %s\n", pmrec_numcmds, pmrec_filename );
+
+	pmrec_file = 0;
+	pmrec_playernum = -1;
+	pmrec_numcmds = 0;
+}
+
+/*
+* G_PMoveRecord_IsRecording
+*/
+bool G_PMoveRecord_IsRecording( edict_t *ent )
+{
+	return pmrec_playernum >= 0 && PLAYERNUM( ent ) == pmrec_playernum;
+}
+
+/*
+* G_PMoveRecord_Cmd_f
+*/
+void G_PMoveRecord_Cmd_f( void )
+{
+	edict_t *ent;
+
+	if( trap_Cmd_Argc() == 2 && !Q_stricmp( trap_Cmd_Argv( 1 ), "stop" ) )
+	{
+		if( pmrec_playernum < 0 )
+			G_Printf( "Not recording\n" );
+		G_PMoveRecord_Stop( NULL );
+		return;
+	}
+
+	if( trap_Cmd_Argc() != 3 )
+	{
+		G_Printf( "Usage: %s <player> <name> | stop\n", trap_Cmd_Argv( 0 ) );
+		return;
+	}
+
+	if( pmrec_playernum >= 0 )
+	{
+		G_Printf( "Already recording to %s\n", pmrec_filename );
+		return;
+	}
+
+	ent = G_PlayerForText( trap_Cmd_Argv( 1 ) );
+	if( !ent || !ent->r.inuse || !ent->r.client )
+	{
+		G_Printf( "No such player: %s\n", trap_Cmd_Argv( 1 ) );
+		return;
+	}
+
+	Q_snprintfz( pmrec_filename, sizeof( pmrec_filename ), "%s/%s", PMOVEREC_DIR, trap_Cmd_Argv( 2 ) );
+	COM_SanitizeFilePath( pmrec_filename );
+	COM_DefaultExtension( pmrec_filename, PMOVEREC_EXTENSION, sizeof( pmrec_filename ) );
+
+	if( trap_FS_FOpenFile( pmrec_filename, &pmrec_file, FS_WRITE ) == -1 )
+	{
+		G_Printf( "Couldn't open %s for writing\n", pmrec_filename );
+		return;
+	}
+
+	pmrec_playernum = PLAYERNUM( ent );
+	pmrec_numcmds = 0;
+	G_Printf( "Recording moves of %s to %s\n", ent->r.client->netname, pmrec_filename );
+}
+
+/*
+* G_PMoveBench_Trace
+*
+* World only, so the replay doesn't depend on entities
+*/
+static void G_PMoveBench_Trace( trace_t *tr, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int ignore, int contentmask, int timeDelta )
+{
+	pmbench_traces++;
+	trap_CM_TransformedBoxTrace( tr, start, end, mins, maxs, NULL, contentmask, NULL, NULL );
+	tr->ent = tr->fraction < 1.0 ? world->s.number : -1;
+}
+
+static int G_PMoveBench_PointContents( vec3_t point, int timeDelta )
+{
+	pmbench_contents++;
+	return trap_CM_TransformedPointContents( point, NULL, NULL, NULL );
+}
+
+static void G_PMoveBench_PredictedEvent( int entNum, int ev, int parm )
+{
+}
+
+static void G_PMoveBench_TouchTriggers( pmove_t *pm, vec3_t previous_origin )
+{
+}
+
+/*
+* G_PMoveBench_Hash
+*
+* FNV-1a over the bits of the movement state
+*/
+static unsigned int G_PMoveBench_Hash( const pmove_state_t *pmove )
+{
+	int i;
+	unsigned int hash = 2166136261u;
+	unsigned int words[6 + 3];
+
+	memcpy( words, pmove->origin, sizeof( float ) * 3 );
+	memcpy( words + 3, pmove->velocity, sizeof( float ) * 3 );
+	words[6] = pmove->pm_type;
+	words[7] = pmove->pm_flags;
+	words[8] = pmove->pm_time;
+
+	for( i = 0; i < 9; i++ )
+	{
+		hash ^= words[i];
+		hash *= 16777619u;
+	}
+	for( i = 0; i < PM_STAT_SIZE; i++ )
+	{
+		hash ^= (unsigned short)pmove->stats[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+* G_PMoveBench_CompareBaseline
+*
+* Returns the index of the first move differing from the baseline, -1 if
+* all match, or -2 if there's no usable baseline
+*/
+static int G_PMoveBench_CompareBaseline( const char *filename, const unsigned int *hashes, int numcmds )
+{
+	int i, length, filenum, count;
+	char *buffer, *ptr;
+	const char *token;
+
+	length = trap_FS_FOpenFile( filename, &filenum, FS_READ );
+	if( length == -1 )
+		return -2;
+
+	buffer = ( char * )G_Malloc( length + 1 );
+	trap_FS_Read( buffer, length, filenum );
+	trap_FS_FCloseFile( filenum );
+	buffer[length] = '\0';
+
+	ptr = buffer;
+	count = atoi( COM_Parse( &ptr ) );
+	if( count != numcmds )
+	{
+		G_Free( buffer );
+		return -2;
+	}
+
+	for( i = 0; i < numcmds; i++ )
+	{
+		token = COM_Parse( &ptr );
+		if( !token[0] || strtoul( token, NULL, 16 ) != hashes[i] )
+			break;
+	}
+
+	G_Free( buffer );
+	return i == numcmds ? -1 : i;
+}
+
+/*
+* G_PMoveBench_WriteBaseline
+*/
+static void G_PMoveBench_WriteBaseline( const char *filename, const unsigned int *hashes, int numcmds )
+{
+	int i, filenum;
+	char line[16];
+
+	if( trap_FS_FOpenFile( filename, &filenum, FS_WRITE ) == -1 )
+	{
+		G_Printf( "Couldn't open %s for writing\n", filename );
+		return;
+	}
+
+	Q_snprintfz( line, sizeof( line ), "%i\n", numcmds );
+	trap_FS_Write( line, strlen( line ), filenum );
+	for( i = 0; i < numcmds; i++ )
+	{
+		Q_snprintfz( line, sizeof( line ), "%08x\n", hashes[i] );
+		trap_FS_Write( line, strlen( line ), filenum );
+	}
+	trap_FS_FCloseFile( filenum );
+
+	G_Printf( "Wrote baseline %s\n", filename );
+}
+
+/*
+* G_PMoveBench_Cmd_f
+*/
+void G_PMoveBench_Cmd_f( void )
+{
+	int i, r, length, filenum, numcmds, repeats, mismatch;
+	unsigned int start, msecs;
+	bool writeBaseline;
+	char filename[MAX_QPATH], baseline[MAX_QPATH];
+	qbyte *buffer;
+	pmoverec_header_t *header;
+	usercmd_t *cmds;
+	unsigned int *hashes;
+	player_state_t ps;
+	game_state_t oldGameState;
+	pmove_t pm;
+	void ( *oldTrace )( trace_t *t, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int ignore, int contentmask, int timeDelta );
+	int ( *oldPointContents )( vec3_t point, int timeDelta );
+	void ( *oldPredictedEvent )( int entNum, int ev, int parm );
+	void ( *oldTouchTriggers )( pmove_t *pm, vec3_t previous_origin );
+
+	if( trap_Cmd_Argc() < 2 )
+	{
+		G_Printf( "Usage: %s <name> [repeats|baseline]\n", trap_Cmd_Argv( 0 ) );
+		return;
+	}
+
+	Q_snprintfz( filename, sizeof( filename ), "%s/%s", PMOVEREC_DIR, trap_Cmd_Argv( 1 ) );
+	COM_SanitizeFilePath( filename );
+	COM_DefaultExtension( filename, PMOVEREC_EXTENSION, sizeof( filename ) );
+	Q_strncpyz( baseline, filename, sizeof( baseline ) );
+	COM_ReplaceExtension( baseline, PMOVEBASELINE_EXTENSION, sizeof( baseline ) );
+
+	writeBaseline = false;
+	repeats = PMOVEBENCH_DEFAULT_REPEATS;
+	if( trap_Cmd_Argc() > 2 )
+	{
+		if( !Q_stricmp( trap_Cmd_Argv( 2 ), "baseline" ) )
+			writeBaseline = true;
+		else
+			repeats = max( atoi( trap_Cmd_Argv( 2 ) ), 1 );
+	}
+
+	length = trap_FS_FOpenFile( filename, &filenum, FS_READ );
+	if( length == -1 )
+	{
+		G_Printf( "Couldn't open %s\n", filename );
+		return;
+	}
+
+	buffer = ( qbyte * )G_Malloc( length );
+	trap_FS_Read( buffer, length, filenum );
+	trap_FS_FCloseFile( filenum );
+
+	header = ( pmoverec_header_t * )buffer;
+	if( length < (int)sizeof( *header ) || LittleLong( header->ident ) != PMOVEREC_IDENT
+		|| LittleLong( header->version ) != PMOVEREC_VERSION )
+	{
+		G_Printf( "%s is not a version %i pmove stream\n", filename, PMOVEREC_VERSION );
+		G_Free( buffer );
+		return;
+	}
+
+	if( Q_stricmp( header->mapname, level.mapname ) )
+	{
+		G_Printf( "%s was recorded on %s, current map is %s\n", filename, header->mapname, level.mapname );
+		G_Free( buffer );
+		return;
+	}
+
+	cmds = ( usercmd_t * )( buffer + sizeof( *header ) );
+	numcmds = ( length - sizeof( *header ) ) / sizeof( usercmd_t );
+	hashes = ( unsigned int * )G_Malloc( sizeof( *hashes ) * ( numcmds + 1 ) );
+
+	// isolate pmove from the running game
+	oldTrace = module_Trace;
+	oldPointContents = module_PointContents;
+	oldPredictedEvent = module_PredictedEvent;
+	oldTouchTriggers = module_PMoveTouchTriggers;
+	oldGameState = gs.gameState;
+
+	module_Trace = G_PMoveBench_Trace;
+	module_PointContents = G_PMoveBench_PointContents;
+	module_PredictedEvent = G_PMoveBench_PredictedEvent;
+	module_PMoveTouchTriggers = G_PMoveBench_TouchTriggers;
+	gs.gameState = header->gameState;
+
+	pmbench_traces = pmbench_contents = 0;
+	start = trap_Milliseconds();
+	for( r = 0; r < repeats; r++ )
+	{
+		ps = header->playerState;
+		for( i = 0; i < numcmds; i++ )
+		{
+			memset( &pm, 0, sizeof( pm ) );
+			pm.playerState = &ps;
+			pm.cmd = cmds[i];
+			pm.snapinitial = i ? qfalse : qtrue;
+			Pmove( &pm );
+
+			if( !r )
+				hashes[i] = G_PMoveBench_Hash( &ps.pmove );
+		}
+	}
+	msecs = trap_Milliseconds() - start;
+
+	module_Trace = oldTrace;
+	module_PointContents = oldPointContents;
+	module_PredictedEvent = oldPredictedEvent;
+	module_PMoveTouchTriggers = oldTouchTriggers;
+	gs.gameState = oldGameState;
+
+	G_Printf( "%i moves x %i: %u msec, %.0f moves/sec\n", numcmds, repeats, msecs,
+		msecs ? (double)numcmds * repeats * 1000.0 / msecs : 0.0 );
+	G_Printf( "%.2f traces, %.2f point contents per move\n",
+		numcmds ? (double)pmbench_traces / ( numcmds * repeats ) : 0.0,
+		numcmds ? (double)pmbench_contents / ( numcmds * repeats ) : 0.0 );
+	G_Printf( "final origin %f %f %f velocity %f %f %f\n",
+		ps.pmove.origin[0], ps.pmove.origin[1], ps.pmove.origin[2],
+		ps.pmove.velocity[0], ps.pmove.velocity[1], ps.pmove.velocity[2] );
+
+	if( writeBaseline )
+	{
+		G_PMoveBench_WriteBaseline( baseline, hashes, numcmds );
+	}
+	else
+	{
+		mismatch = G_PMoveBench_CompareBaseline( baseline, hashes, numcmds );
+		if( mismatch == -1 )
+			G_Printf( "Baseline %s matches\n", baseline );
+		else if( mismatch >= 0 )
+			G_Printf( "%sBaseline %s differs from move %i on\n", S_COLOR_RED, baseline, mismatch );
+		else
+			G_Printf( "No baseline for %i moves in %s\n", numcmds, baseline );
+	}
+
+	G_Free( hashes );
+	G_Free( buffer );
+}
@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // g_public.h -- game dll information visible to server
 
-#define	GAME_API_VERSION    48
+#define	GAME_API_VERSION    52
 
 //===============================================================
 
@@ -167,6 +167,7 @@ typedef struct
 
 	qboolean ( *ML_Update )( void );
 	size_t ( *ML_GetMapByNum )( int num, char *out, size_t size );
+	int ( *ML_FindMap )( const char *pattern, int start );
 	qboolean ( *ML_FilenameExists )( const char *filename );
 	const char *( *ML_GetFullname )( const char *filename );
 
@@ -180,6 +181,7 @@ typedef struct
 	void ( *DropClient )( struct edict_s *ent, int type, const char *message );
 	int ( *GetClientState )( int numClient );
 	void ( *ExecuteClientThinks )( int clientNum );
+	void ( *ExecuteClientThinksParallel )( const int *clientNums, int numClients );
 
 	// The edict array is allocated in the game dll so it
 	// can vary in size from one game to another.
@@ -194,6 +196,9 @@ typedef struct
 	struct stat_query_api_s *( *GetStatQueryAPI )( void );
 	void ( *MM_SendQuery )( struct stat_query_s *query );
 	void ( *MM_GameState )( qboolean state );
+
+	// a race run is finished, times holds the sector times followed by the final time
+	void ( *RaceRunFinished )( struct edict_s *ent, int numSectors, const unsigned int *times );
 } game_import_t;
 
 //
@@ -221,6 +226,10 @@ typedef struct
 	void ( *ClientCommand )( edict_t *ent );
 	void ( *ClientThink )( edict_t *ent, usercmd_t *cmd, int timeDelta );
 
+	// called from several threads at once, returns qfalse without
+	// touching anything if the usercmd has to be run by ClientThink
+	qboolean ( *ClientThinkParallel )( edict_t *ent, usercmd_t *cmd, int timeDelta );
+
 	void ( *RunFrame )( unsigned int msec, unsigned int serverTime );
 	void ( *SnapFrame )( void );
 	void ( *ClearSnap )( void );
@@ -230,6 +230,9 @@ bool G_CallSpawn( edict_t *ent )
 	spawn_t	*s;
 	gsitem_t	*item;
 
+	// the fields were just parsed
+	G_UpdateEntityIndex( ent );
+
 	if( !ent->classname )
 	{
 		if( developer->integer )
@@ -768,6 +771,8 @@ void G_InitLevel( char *mapname, char *entities, int entstrlen, unsigned int lev
 				G_FreeEdict( game.edicts + i );
 		}
 	}
+	G_ResetEntityIndexes();
+	G_Schedule_Reset();
 
 	game.numentities = gs.maxclients + 1;
 
@@ -874,6 +879,7 @@ void G_InitLevel( char *mapname, char *entities, int entstrlen, unsigned int lev
 				{
 					// override entity's classname with whatever item specifies
 					ent->classname = item->classname;
+					G_UpdateEntityIndex( ent );
 					PrecacheItem( item );
 					continue;
 				}
@@ -393,6 +393,10 @@ void G_AddServerCommands( void )
 
 	trap_Cmd_AddCommand( "listratings", G_ListRatings_f );
 	trap_Cmd_AddCommand( "listraces", G_ListRaces_f );
+
+	trap_Cmd_AddCommand( "pmoverecord", G_PMoveRecord_Cmd_f );
+	trap_Cmd_AddCommand( "pmovebench", G_PMoveBench_Cmd_f );
+	trap_Cmd_AddCommand( "areabench", GClip_AreaBench_Cmd_f );
 }
 
 /*
@@ -427,4 +431,8 @@ void G_RemoveCommands( void )
 
 	trap_Cmd_RemoveCommand( "listratings" );
 	trap_Cmd_RemoveCommand( "listraces" );
+
+	trap_Cmd_RemoveCommand( "pmoverecord" );
+	trap_Cmd_RemoveCommand( "pmovebench" );
+	trap_Cmd_RemoveCommand( "areabench" );
 }
@@ -41,6 +41,7 @@ extern "C" QF_DLL_EXPORT game_export_t *GetGameAPI( game_import_t *import )
 	globals.InitLevel = G_InitLevel;
 
 	globals.ClientThink = ClientThink;
+	globals.ClientThinkParallel = G_ClientThinkParallel;
 	globals.ClientConnect = ClientConnect;
 	globals.ClientUserinfoChanged = ClientUserinfoChanged;
 	globals.ClientMultiviewChanged = ClientMultiviewChanged;
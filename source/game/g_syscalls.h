@@ -345,6 +345,11 @@ static inline size_t trap_ML_GetMapByNum( int num, char *out, size_t size )
 	return GAME_IMPORT.ML_GetMapByNum( num, out, size );
 }
 
+static inline int trap_ML_FindMap( const char *pattern, int start )
+{
+	return GAME_IMPORT.ML_FindMap( pattern, start );
+}
+
 static inline void trap_Cmd_ExecuteText( int exec_when, const char *text )
 {
 	GAME_IMPORT.Cmd_ExecuteText( exec_when, text );
@@ -370,6 +375,11 @@ static inline void trap_ExecuteClientThinks( int clientNum )
 	GAME_IMPORT.ExecuteClientThinks( clientNum );
 }
 
+static inline void trap_ExecuteClientThinksParallel( const int *clientNums, int numClients )
+{
+	GAME_IMPORT.ExecuteClientThinksParallel( clientNums, numClients );
+}
+
 static inline void trap_DropClient( edict_t *ent, int type, const char *message )
 {
 	GAME_IMPORT.DropClient( ent, type, message );
@@ -400,3 +410,8 @@ static inline void trap_MM_GameState( bool state )
 {
 	GAME_IMPORT.MM_GameState( state == true ? qtrue : qfalse );
 }
+
+static inline void trap_RaceRunFinished( edict_t *ent, int numSectors, const unsigned int *times )
+{
+	GAME_IMPORT.RaceRunFinished( ent, numSectors, times );
+}
@@ -179,7 +179,7 @@ static void use_target_explosion( edict_t *self, edict_t *other, edict_t *activa
 	}
 
 	self->think = target_explosion_explode;
-	self->nextThink = level.time + self->delay * 1000;
+	G_SetNextThink( self, level.time + self->delay * 1000 );
 }
 
 void SP_target_explosion( edict_t *self )
@@ -257,6 +257,7 @@ static void use_target_spawner( edict_t *self, edict_t *other, edict_t *activato
 
 	ent = G_Spawn();
 	ent->classname = self->target;
+	G_UpdateEntityIndex( ent );
 	VectorCopy( self->s.origin, ent->s.origin );
 	VectorCopy( self->s.angles, ent->s.angles );
 	G_CallSpawn( ent );
@@ -316,7 +317,7 @@ void SP_target_crosslevel_target( edict_t *self )
 	self->r.svflags = SVF_NOCLIENT;
 
 	self->think = target_crosslevel_target_think;
-	self->nextThink = level.time + self->delay * 1000;
+	G_SetNextThink( self, level.time + self->delay * 1000 );
 }
 
 //==========================================================
@@ -424,7 +425,7 @@ static void target_laser_think( edict_t *self )
 
 	GClip_LinkEntity( self );
 
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 }
 
 static void target_laser_on( edict_t *self )
@@ -441,7 +442,7 @@ static void target_laser_off( edict_t *self )
 {
 	self->spawnflags &= ~1;
 	self->r.svflags |= SVF_NOCLIENT;
-	self->nextThink = 0;
+	G_SetNextThink( self, 0 );
 }
 
 static void target_laser_use( edict_t *self, edict_t *other, edict_t *activator )
@@ -512,7 +513,7 @@ void SP_target_laser( edict_t *self )
 {
 	// let everything else get spawned before we start firing
 	self->think = target_laser_start;
-	self->nextThink = level.time + 1000;
+	G_SetNextThink( self, level.time + 1000 );
 	self->count = MOD_TARGET_LASER;
 }
 
@@ -532,7 +533,7 @@ static void target_lightramp_think( edict_t *self )
 
 	if( level.time - self->timeStamp < self->speed * 1000 )
 	{
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 	}
 	else if( self->spawnflags & 1 )
 	{
@@ -835,7 +836,7 @@ static void target_delay_think( edict_t *ent ) {
 }
 
 static void target_delay_use( edict_t *ent, edict_t *other, edict_t *activator ) {
-	ent->nextThink = level.time + 1000 * (ent->wait + ent->random * crandom());
+	G_SetNextThink( ent, level.time + 1000 * (ent->wait + ent->random * crandom()) );
 	ent->think = target_delay_think;
 	ent->activator = activator;
 }
@@ -890,7 +891,7 @@ static void target_give_use( edict_t *self, edict_t *other, edict_t *activator )
 		Touch_Item( give, activator, NULL, 0 );
 
 		if( give->r.inuse ) {
-			give->nextThink = 0;
+			G_SetNextThink( give, 0 );
 			give->think = 0;
 			give->attenuation = attenuation;
 			GClip_UnlinkEntity( give );
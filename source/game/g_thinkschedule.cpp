@@ -0,0 +1,271 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "g_local.h"
+
+/*
+* Think scheduling
+*
+* Most entities of a map are triggers and targets that never move and only
+* think when something uses them, yet G_RunEntities used to visit all of them
+* every frame. Entities are now either awake or asleep. Awake entities are
+* visited every frame, in entity number order as before. An entity falls
+* asleep after a visit when nothing would happen to it until its next think:
+* it's not a client, has MOVETYPE_NONE and isn't standing on anything. Its
+* nextThink then goes into a min-heap, which wakes it up when it's due.
+*
+* Anything that could change that from outside wakes the entity up again:
+* G_SetNextThink, which all writes to nextThink must go through, spawning the
+* entity and G_Schedule_Wake. An entity woken during the entity loop is still
+* run in the same frame when its number is higher than the current one, just
+* like the loop over all entities did.
+*/
+
+#define SCHEDULE_MAX_TIMERS		( MAX_EDICTS * 4 )
+
+typedef struct
+{
+	unsigned int time;
+	int entNum;
+} g_timer_t;
+
+static unsigned int g_schedule_awake[MAX_EDICTS / 32];
+static unsigned int g_schedule_run[MAX_EDICTS / 32];	// awake at the start of the frame or woken since
+
+static g_timer_t g_schedule_timers[SCHEDULE_MAX_TIMERS];
+static int g_schedule_numtimers;
+
+/*
+* G_Schedule_TimerLess
+*/
+static inline bool G_Schedule_TimerLess( const g_timer_t *a, const g_timer_t *b )
+{
+	if( a->time != b->time )
+		return a->time < b->time;
+	return a->entNum < b->entNum;
+}
+
+/*
+* G_Schedule_SiftDown
+*/
+static void G_Schedule_SiftDown( int i )
+{
+	int child;
+	g_timer_t tmp;
+
+	while( ( child = i * 2 + 1 ) < g_schedule_numtimers )
+	{
+		if( child + 1 < g_schedule_numtimers && G_Schedule_TimerLess( &g_schedule_timers[child + 1], &g_schedule_timers[child] ) )
+			child++;
+		if( !G_Schedule_TimerLess( &g_schedule_timers[child], &g_schedule_timers[i] ) )
+			break;
+
+		tmp = g_schedule_timers[i];
+		g_schedule_timers[i] = g_schedule_timers[child];
+		g_schedule_timers[child] = tmp;
+		i = child;
+	}
+}
+
+/*
+* G_Schedule_TimerIsValid
+*
+* Timers aren't removed when the entity is freed or its nextThink changes
+*/
+static bool G_Schedule_TimerIsValid( const g_timer_t *timer )
+{
+	edict_t *ent = &game.edicts[timer->entNum];
+	return ent->r.inuse && ent->nextThink == timer->time;
+}
+
+/*
+* G_Schedule_CompactTimers
+*
+* Throws away outdated and duplicated timers
+*/
+static void G_Schedule_CompactTimers( void )
+{
+	int i, count;
+	qbyte seen[MAX_EDICTS];
+
+	memset( seen, 0, sizeof( seen ) );
+
+	for( i = 0, count = 0; i < g_schedule_numtimers; i++ )
+	{
+		if( !G_Schedule_TimerIsValid( &g_schedule_timers[i] ) || seen[g_schedule_timers[i].entNum] )
+			continue;
+		seen[g_schedule_timers[i].entNum] = 1;
+		g_schedule_timers[count++] = g_schedule_timers[i];
+	}
+
+	g_schedule_numtimers = count;
+	for( i = count / 2 - 1; i >= 0; i-- )
+		G_Schedule_SiftDown( i );
+}
+
+/*
+* G_Schedule_AddTimer
+*/
+static void G_Schedule_AddTimer( edict_t *ent )
+{
+	int i, parent;
+	g_timer_t tmp;
+
+	if( g_schedule_numtimers == SCHEDULE_MAX_TIMERS )
+		G_Schedule_CompactTimers();
+
+	i = g_schedule_numtimers++;
+	g_schedule_timers[i].time = ent->nextThink;
+	g_schedule_timers[i].entNum = ENTNUM( ent );
+
+	while( i > 0 )
+	{
+		parent = ( i - 1 ) / 2;
+		if( !G_Schedule_TimerLess( &g_schedule_timers[i], &g_schedule_timers[parent] ) )
+			break;
+
+		tmp = g_schedule_timers[i];
+		g_schedule_timers[i] = g_schedule_timers[parent];
+		g_schedule_timers[parent] = tmp;
+		i = parent;
+	}
+}
+
+/*
+* G_Schedule_Wake
+*
+* Makes the entity be visited by G_RunEntities again
+*/
+void G_Schedule_Wake( edict_t *ent )
+{
+	int num = ENTNUM( ent );
+
+	g_schedule_awake[num >> 5] |= 1u << ( num & 31 );
+	g_schedule_run[num >> 5] |= 1u << ( num & 31 );
+}
+
+/*
+* G_SetNextThink
+*/
+void G_SetNextThink( edict_t *ent, unsigned int nextThink )
+{
+	ent->nextThink = nextThink;
+	G_Schedule_Wake( ent );
+}
+
+/*
+* G_Schedule_CanSleep
+*/
+static bool G_Schedule_CanSleep( edict_t *ent )
+{
+	if( !ent->r.inuse )
+		return true;
+
+	if( ent->r.client || ent->movetype != MOVETYPE_NONE || ent->groundentity )
+		return false;
+
+	// due but not run yet, a team slave waiting for its captain for example
+	if( ent->nextThink && ent->nextThink <= level.time )
+		return false;
+
+	return level.canSpawnEntities;
+}
+
+/*
+* G_Schedule_BeginFrame
+*
+* Wakes up the entities whose think is due
+*/
+void G_Schedule_BeginFrame( void )
+{
+	edict_t *ent;
+	g_timer_t *timer;
+
+	memcpy( g_schedule_run, g_schedule_awake, sizeof( g_schedule_run ) );
+
+	while( g_schedule_numtimers && g_schedule_timers[0].time <= level.time )
+	{
+		timer = &g_schedule_timers[0];
+		if( G_Schedule_TimerIsValid( timer ) )
+		{
+			ent = &game.edicts[timer->entNum];
+			G_Schedule_Wake( ent );
+
+			// team slaves think through their captain
+			if( ( ent->flags & FL_TEAMSLAVE ) && ent->teammaster )
+				G_Schedule_Wake( ent->teammaster );
+		}
+
+		g_schedule_timers[0] = g_schedule_timers[--g_schedule_numtimers];
+		G_Schedule_SiftDown( 0 );
+	}
+}
+
+/*
+* G_Schedule_NextEntity
+*
+* Returns the next entity to run after prev, or the first one if prev is NULL.
+* Puts prev to sleep when it can
+*/
+edict_t *G_Schedule_NextEntity( edict_t *prev )
+{
+	int num, word;
+	unsigned int bits;
+
+	num = 0;
+	if( prev )
+	{
+		num = ENTNUM( prev );
+		if( G_Schedule_CanSleep( prev ) )
+		{
+			g_schedule_awake[num >> 5] &= ~( 1u << ( num & 31 ) );
+			if( prev->r.inuse && prev->nextThink )
+				G_Schedule_AddTimer( prev );
+		}
+		num++;
+	}
+
+	while( num < game.numentities )
+	{
+		word = num >> 5;
+		bits = g_schedule_run[word] & ( ~0u << ( num & 31 ) );
+		if( bits )
+		{
+			for( num = word << 5; !( bits & 1 ); bits >>= 1 )
+				num++;
+			if( num >= game.numentities )
+				break;
+			return &game.edicts[num];
+		}
+		num = ( word + 1 ) << 5;
+	}
+
+	return NULL;
+}
+
+/*
+* G_Schedule_Reset
+*
+* Wakes all entities and forgets the timers
+*/
+void G_Schedule_Reset( void )
+{
+	memset( g_schedule_awake, 0xFF, sizeof( g_schedule_awake ) );
+	memset( g_schedule_run, 0xFF, sizeof( g_schedule_run ) );
+	g_schedule_numtimers = 0;
+}
@@ -70,7 +70,7 @@ static void multi_trigger( edict_t *ent )
 		// we can't just remove (self) here, because this is a touch function
 		// called while looping through area links...
 		ent->touch = NULL;
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 		ent->think = G_FreeEdict;
 	}
 }
@@ -378,7 +378,7 @@ static void trigger_push_touch( edict_t *self, edict_t *other, cplane_t *plane,
 	if( self->spawnflags & PUSH_ONCE )
 	{
 		self->touch = NULL;
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 		self->think = G_FreeEdict;
 	}
 }
@@ -448,7 +448,7 @@ void SP_trigger_push( edict_t *self )
 
 	self->touch = trigger_push_touch;
 	self->think = trigger_push_setup;
-	self->nextThink = level.time + 1;
+	G_SetNextThink( self, level.time + 1 );
 	self->r.svflags &= ~SVF_NOCLIENT;
 	self->s.type = ET_PUSH_TRIGGER;
 	self->r.svflags |= SVF_TRANSMITORIGIN2;
@@ -506,7 +506,7 @@ void SP_target_push( edict_t *self )
 		// TODO: This was removed from warsow 0.7. I don't know what it
 		// did so I don't know if it's necessary either - K1ll
 		self->think = trigger_push_setup;
-		self->nextThink = level.time + 1;
+		G_SetNextThink( self, level.time + 1 );
 	}
 	self->use = Use_target_push;
 }
@@ -611,7 +611,7 @@ static void hurt_touch( edict_t *self, edict_t *other, cplane_t *plane, int surf
 			edict_t *delayer = G_Spawn();
 			delayer->s.ownerNum = ENTNUM( other );
 			delayer->think = hurt_delayer_think;
-			delayer->nextThink = level.time + diedelay;
+			G_SetNextThink( delayer, level.time + diedelay );
 			if( other->r.client )
 				delayer->deathTimeStamp = other->r.client->resp.timeStamp;
 
@@ -529,6 +529,158 @@ void G_ProjectSource( vec3_t point, vec3_t distance, vec3_t forward, vec3_t righ
 }
 
 
+/*
+* Entity name indexes
+*
+* G_Find is mostly called with classname, targetname and target, so entities
+* are kept in hash chains by the value of those fields. The chains are sorted
+* by entity number, which keeps the order G_Find returns entities in. Code
+* that changes any of these fields must call G_UpdateEntityIndex afterwards,
+* like GClip_LinkEntity after moving an entity. Lookups still compare the
+* strings, so a stale entry can't produce a wrong match.
+*/
+
+#define ENTINDEX_HASH_SIZE	256
+
+typedef struct
+{
+	size_t fieldofs;
+	int hash[ENTINDEX_HASH_SIZE];	// first entity number in the chain, -1 if none
+	int prev[MAX_EDICTS], next[MAX_EDICTS];
+	int key[MAX_EDICTS];
+	const char *value[MAX_EDICTS];	// the string the entity is indexed by
+} g_entindex_t;
+
+static g_entindex_t g_entindexes[] =
+{
+	{ FOFS( classname ) },
+	{ FOFS( targetname ) },
+	{ FOFS( target ) },
+};
+
+#define NUM_ENTINDEXES ( sizeof( g_entindexes ) / sizeof( g_entindexes[0] ) )
+
+/*
+* G_EntityIndexKey
+*/
+static int G_EntityIndexKey( const char *value )
+{
+	unsigned int hash = 0;
+
+	for( ; *value; value++ )
+		hash = hash * 31 + tolower( *value );
+
+	return hash & ( ENTINDEX_HASH_SIZE - 1 );
+}
+
+/*
+* G_EntityIndexForField
+*/
+static g_entindex_t *G_EntityIndexForField( size_t fieldofs )
+{
+	unsigned int i;
+
+	for( i = 0; i < NUM_ENTINDEXES; i++ )
+	{
+		if( g_entindexes[i].fieldofs == fieldofs )
+			return &g_entindexes[i];
+	}
+
+	return NULL;
+}
+
+/*
+* G_EntityIndexLink
+*/
+static void G_EntityIndexLink( g_entindex_t *index, int num, const char *value )
+{
+	int key = G_EntityIndexKey( value );
+	int prev = -1, next;
+
+	for( next = index->hash[key]; next >= 0 && next < num; next = index->next[next] )
+		prev = next;
+
+	index->prev[num] = prev;
+	index->next[num] = next;
+	if( prev >= 0 )
+		index->next[prev] = num;
+	else
+		index->hash[key] = num;
+	if( next >= 0 )
+		index->prev[next] = num;
+
+	index->key[num] = key;
+	index->value[num] = value;
+}
+
+/*
+* G_EntityIndexUnlink
+*/
+static void G_EntityIndexUnlink( g_entindex_t *index, int num )
+{
+	int prev = index->prev[num], next = index->next[num];
+
+	if( !index->value[num] )
+		return;
+
+	if( prev >= 0 )
+		index->next[prev] = next;
+	else
+		index->hash[index->key[num]] = next;
+	if( next >= 0 )
+		index->prev[next] = prev;
+
+	index->value[num] = NULL;
+}
+
+/*
+* G_UpdateEntityIndex
+* 
+* Call after changing the classname, targetname or target of an entity
+*/
+void G_UpdateEntityIndex( edict_t *ent )
+{
+	unsigned int i;
+	int num = ENTNUM( ent );
+	const char *value;
+	g_entindex_t *index;
+
+	for( i = 0; i < NUM_ENTINDEXES; i++ )
+	{
+		index = &g_entindexes[i];
+
+		// the string may also have been freed and another one allocated in its place
+		value = *(const char **)( (qbyte *)ent + index->fieldofs );
+		if( value == index->value[num] && ( !value || G_EntityIndexKey( value ) == index->key[num] ) )
+			continue;
+
+		G_EntityIndexUnlink( index, num );
+		if( value )
+			G_EntityIndexLink( index, num, value );
+	}
+}
+
+/*
+* G_ResetEntityIndexes
+* 
+* Rebuilds the indexes from scratch, for when the edicts were cleared
+*/
+void G_ResetEntityIndexes( void )
+{
+	unsigned int i;
+	int j;
+
+	for( i = 0; i < NUM_ENTINDEXES; i++ )
+	{
+		for( j = 0; j < ENTINDEX_HASH_SIZE; j++ )
+			g_entindexes[i].hash[j] = -1;
+		memset( g_entindexes[i].value, 0, sizeof( g_entindexes[i].value ) );
+	}
+
+	for( j = 0; j < game.maxentities; j++ )
+		G_UpdateEntityIndex( &game.edicts[j] );
+}
+
 /*
 * G_Find
 * 
@@ -542,6 +694,38 @@ void G_ProjectSource( vec3_t point, vec3_t distance, vec3_t forward, vec3_t righ
 edict_t *G_Find( edict_t *from, size_t fieldofs, const char *match )
 {
 	char *s;
+	int num, key;
+	g_entindex_t *index;
+
+	index = match ? G_EntityIndexForField( fieldofs ) : NULL;
+	if( index )
+	{
+		key = G_EntityIndexKey( match );
+
+		// when iterating, from is usually in the same chain already
+		if( from && index->value[ENTNUM( from )] && index->key[ENTNUM( from )] == key )
+		{
+			num = index->next[ENTNUM( from )];
+		}
+		else
+		{
+			num = index->hash[key];
+			while( from && num >= 0 && num <= ENTNUM( from ) )
+				num = index->next[num];
+		}
+
+		for( ; num >= 0 && num < game.numentities; num = index->next[num] )
+		{
+			from = &game.edicts[num];
+			if( !from->r.inuse )
+				continue;
+			s = *(char **) ( (qbyte *)from + fieldofs );
+			if( s && !Q_stricmp( s, match ) )
+				return from;
+		}
+
+		return NULL;
+	}
 
 	if( !from )
 		from = world;
@@ -639,13 +823,14 @@ void G_UseTargets( edict_t *ent, edict_t *activator )
 		// create a temp object to fire at a later time
 		t = G_Spawn();
 		t->classname = "delayed_use";
-		t->nextThink = level.time + 1000 * ent->delay;
+		G_SetNextThink( t, level.time + 1000 * ent->delay );
 		t->think = Think_Delay;
 		t->activator = activator;
 		if( !activator )
 			G_Printf( "Think_Delay with no activator\n" );
 		t->message = ent->message;
 		t->target = ent->target;
+		G_UpdateEntityIndex( t );
 		t->killtarget = ent->killtarget;
 		return;
 	}
@@ -786,6 +971,7 @@ void G_FreeEdict( edict_t *ed )
 	ed->s.number = ENTNUM( ed );
 	ed->r.svflags = SVF_NOCLIENT;
 	ed->scriptSpawned = false;
+	G_UpdateEntityIndex( ed );
 
 	if( !evt && ( level.spawnedTimeStamp != game.realtime ) )
 		ed->freetime = game.realtime; // ET_EVENT or ET_SOUND don't need to wait to be reused
@@ -798,6 +984,8 @@ void G_InitEdict( edict_t *e )
 {
 	e->r.inuse = qtrue;
 	e->classname = NULL;
+	G_UpdateEntityIndex( e );
+	G_Schedule_Wake( e );
 	e->gravity = 1.0;
 	e->s.number = ENTNUM( e );
 	e->timeDelta = 0;
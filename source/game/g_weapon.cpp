@@ -293,7 +293,7 @@ static edict_t *W_Fire_LinearProjectile( edict_t *self, vec3_t start, vec3_t ang
 	projectile->r.owner = self;
 	projectile->s.ownerNum = ENTNUM( self );
 	projectile->touch = W_Touch_Projectile; //generic one. Should be replaced after calling this func
-	projectile->nextThink = level.time + timeout;
+	G_SetNextThink( projectile, level.time + timeout );
 	projectile->think = G_FreeEdict;
 	projectile->classname = NULL; // should be replaced after calling this func.
 	projectile->style = 0;
@@ -354,7 +354,7 @@ static edict_t *W_Fire_TossProjectile( edict_t *self, vec3_t start, vec3_t angle
 	projectile->r.owner = self;
 	projectile->s.ownerNum = ENTNUM( self ); // racesow
 	projectile->touch = W_Touch_Projectile; //generic one. Should be replaced after calling this func
-	projectile->nextThink = level.time + timeout;
+	G_SetNextThink( projectile, level.time + timeout );
 	projectile->think = G_FreeEdict;
 	projectile->classname = NULL; // should be replaced after calling this func.
 	projectile->style = 0;
@@ -488,6 +488,7 @@ edict_t *W_Fire_GunbladeBlast( edict_t *self, vec3_t start, vec3_t angles, float
 	blast->s.effects |= EF_STRONG_WEAPON;
 	blast->touch = W_Touch_GunbladeBlast;
 	blast->classname = "gunblade_blast";
+	G_UpdateEntityIndex( blast );
 	blast->style = mod;
 
 	blast->s.sound = trap_SoundIndex( S_WEAPON_PLASMAGUN_S_FLY );
@@ -784,6 +785,7 @@ edict_t *W_Fire_Grenade( edict_t *self, vec3_t start, vec3_t angles, int speed,
 	grenade->use = NULL;
 	grenade->think = W_Grenade_Explode;
 	grenade->classname = "grenade";
+	G_UpdateEntityIndex( grenade );
 	grenade->gravity = rs_grenade_gravity->value; // racesow
 	grenade->enemy = NULL;
 
@@ -908,6 +910,7 @@ edict_t *W_Fire_Rocket( edict_t *self, vec3_t start, vec3_t angles, int speed, f
 	rocket->touch = W_Touch_Rocket;
 	rocket->think = G_FreeEdict;
 	rocket->classname = "rocket";
+	G_UpdateEntityIndex( rocket );
 	rocket->style = mod;
 
 	return rocket;
@@ -1026,7 +1029,7 @@ static void W_Think_Plasma( edict_t *ent )
 	}
 
 	if( ent->r.inuse )
-		ent->nextThink = level.time + 1;
+		G_SetNextThink( ent, level.time + 1 );
 
 	VectorMA( ent->s.origin, -( game.frametime * 0.001 ), ent->velocity, start );
 
@@ -1062,11 +1065,12 @@ edict_t *W_Fire_Plasma( edict_t *self, vec3_t start, vec3_t angles, float damage
 		rs_plasma_splash->integer, timeout, timeDelta ); // racesow
 	plasma->s.type = ET_PLASMA;
 	plasma->classname = "plasma";
+	G_UpdateEntityIndex( plasma );
 	plasma->style = mod;
 
 	plasma->think = W_Think_Plasma;
 	plasma->touch = W_AutoTouch_Plasma;
-	plasma->nextThink = level.time + 1;
+	G_SetNextThink( plasma, level.time + 1 );
 	plasma->timeout = level.time + timeout;
 
 	if( mod == MOD_PLASMA_S )
@@ -1355,6 +1359,7 @@ edict_t *W_Fire_Electrobolt_Weak( edict_t *self, vec3_t start, vec3_t angles, fl
 	bolt->s.ownerNum = ENTNUM( self );
 	bolt->touch = W_Touch_Bolt;
 	bolt->classname = "bolt";
+	G_UpdateEntityIndex( bolt );
 	bolt->style = mod;
 	bolt->s.effects &= ~EF_STRONG_WEAPON;
 
@@ -1466,7 +1471,7 @@ void G_HideLaser( edict_t *ent )
 
 	// give it 100 msecs before freeing itself, so we can relink it if we start firing again
 	ent->think = G_FreeEdict;
-	ent->nextThink = level.time + 100;
+	G_SetNextThink( ent, level.time + 100 );
 }
 
 /*
@@ -1493,7 +1498,7 @@ static void G_Laser_Think( edict_t *ent )
 		return;
 	}
 
-	ent->nextThink = level.time + 1;
+	G_SetNextThink( ent, level.time + 1 );
 }
 
 static float laser_damage;
@@ -1597,7 +1602,7 @@ edict_t	*W_Fire_Lasergun( edict_t *self, vec3_t start, vec3_t angles, float dama
 	VectorMA( laser->s.origin, range, dir, laser->s.origin2 );
 
 	laser->think = G_Laser_Think;
-	laser->nextThink = level.time + 100;
+	G_SetNextThink( laser, level.time + 100 );
 
 	if( laser_missed && self->r.client )
 		G_AwardPlayerMissedLasergun( self, mod );
@@ -1644,7 +1649,7 @@ edict_t	*W_Fire_Lasergun_Weak( edict_t *self, vec3_t start, vec3_t end, float da
 	VectorCopy( end, laser->s.origin2 );
 
 	laser->think = G_Laser_Think;
-	laser->nextThink = level.time + 100;
+	G_SetNextThink( laser, level.time + 100 );
 
 	if( laser_missed && self->r.client )
 		G_AwardPlayerMissedLasergun( self, mod );
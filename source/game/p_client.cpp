@@ -120,6 +120,7 @@ void G_InitBodyQueue( void )
 	{
 		ent = G_Spawn();
 		ent->classname = "bodyque";
+		G_UpdateEntityIndex( ent );
 	}
 }
 
@@ -134,7 +135,7 @@ static void body_die( edict_t *self, edict_t *inflictor, edict_t *attacker, int
 	ThrowSmallPileOfGibs( self, damage );
 	self->s.origin[2] -= 48;
 	ThrowClientHead( self, damage );
-	self->nextThink = level.time + 3000 + random() * 3000;
+	G_SetNextThink( self, level.time + 3000 + random() * 3000 );
 }
 
 /*
@@ -174,7 +175,7 @@ static void body_ready( edict_t *body )
 	body->takedamage = DAMAGE_YES;
 	body->r.solid = SOLID_YES;
 	body->think = body_think; // body self destruction countdown
-	body->nextThink = level.time + g_deadbody_autogib_delay->integer + ( crandom() * g_deadbody_autogib_delay->value * 0.25f ) ;
+	G_SetNextThink( body, level.time + g_deadbody_autogib_delay->integer + ( crandom() * g_deadbody_autogib_delay->value * 0.25f )  );
 	GClip_LinkEntity( body );
 }
 
@@ -210,6 +211,7 @@ static edict_t *CopyToBodyQue( edict_t *ent, edict_t *attacker, int damage )
 	//init body edict
 	G_InitEdict( body );
 	body->classname = "body";
+	G_UpdateEntityIndex( body );
 	body->health = ent->health;
 	body->mass = ent->mass;
 	body->r.owner = ent->r.owner;
@@ -253,7 +255,7 @@ static edict_t *CopyToBodyQue( edict_t *ent, edict_t *attacker, int damage )
 		ThrowSmallPileOfGibs( body, damage );
 		ThrowClientHead( body, damage ); // sets ET_GIB
 		body->s.frame = 0;
-		body->nextThink = level.time + 3000 + random() * 3000;
+		G_SetNextThink( body, level.time + 3000 + random() * 3000 );
 		body->deadflag = DEAD_DEAD;
 	}
 	else if( ent->s.type == ET_PLAYER )
@@ -291,13 +293,13 @@ static edict_t *CopyToBodyQue( edict_t *ent, edict_t *attacker, int damage )
 		body->think = body_ready;
 		body->takedamage = DAMAGE_NO;
 		body->r.solid = SOLID_NOT;
-		body->nextThink = level.time + 500; // make damageable in 0.5 seconds
+		G_SetNextThink( body, level.time + 500 ); // make damageable in 0.5 seconds
 	}
 	else // wasn't a player, just copy it's model
 	{
 		body->s.modelindex = ent->s.modelindex;
 		body->s.frame = ent->s.frame;
-		body->nextThink = level.time + 5000 + random()*10000;
+		G_SetNextThink( body, level.time + 5000 + random()*10000 );
 	}
 
 	GClip_LinkEntity( body );
@@ -562,6 +564,7 @@ void G_ClientRespawn( edict_t *self, bool ghost )
 		self->classname = "fakeclient";
 	else
 		self->classname = "player";
+	G_UpdateEntityIndex( self );
 
 	VectorCopy( playerbox_stand_mins, self->r.mins );
 	VectorCopy( playerbox_stand_maxs, self->r.maxs );
@@ -1072,7 +1075,7 @@ void ClientUserinfoChanged( edict_t *ent, char *userinfo )
 
 				switcher = G_Spawn();
 				switcher->think = think_MoveTypeSwitcher;
-				switcher->nextThink = level.time + 10000;
+				G_SetNextThink( switcher, level.time + 10000 );
 				switcher->s.ownerNum = ENTNUM( ent );
 				G_PrintMsg( ent, "Movement style will change in 10 seconds.\n" );
 			}
@@ -1281,6 +1284,8 @@ void ClientDisconnect( edict_t *ent, const char *reason )
 	if( !ent->r.client || !ent->r.inuse )
 		return;
 
+	G_PMoveRecord_Stop( ent );
+
 	// always report in RACE mode
 	if( GS_RaceGametype() || ( ent->r.client->team != TEAM_SPECTATOR && GS_MatchState() == MATCH_STATE_PLAYTIME ) )
 		G_AddPlayerReport( ent, false );
@@ -1397,6 +1402,9 @@ void G_PredictedEvent( int entNum, int ev, int parm )
 	edict_t	*ent;
 	vec3_t upDir = { 0, 0, 1 };
 
+	if( G_ParallelThink_DeferEvent( entNum, ev, parm ) )
+		return;
+
 	ent = &game.edicts[entNum];
 	switch( ev )
 	{
@@ -1487,7 +1495,7 @@ void ClientThink( edict_t *ent, usercmd_t *ucmd, int timeDelta )
 {
 	gclient_t *client;
 	int i, j;
-	static pmove_t pm;
+	pmove_t pm;
 	int delta, count;
 
 	client = ent->r.client;
@@ -1579,6 +1587,8 @@ void ClientThink( edict_t *ent, usercmd_t *ucmd, int timeDelta )
 	if( memcmp( &client->old_pmove, &client->ps.pmove, sizeof( pmove_state_t ) ) )
 		pm.snapinitial = qtrue;
 
+	G_PMoveRecord_Frame( ent, &pm );
+
 	// perform a pmove
 	Pmove( &pm );
 
@@ -1607,7 +1617,8 @@ void ClientThink( edict_t *ent, usercmd_t *ucmd, int timeDelta )
 		ent->groundentity_linkcount = ent->groundentity->linkcount;
 	}
 	
-	GClip_LinkEntity( ent );
+	if( !G_ParallelThink_DeferLink( ent ) )
+		GClip_LinkEntity( ent );
 
 	GS_AddLaserbeamPoint( &ent->r.client->resp.trail, &ent->r.client->ps, ucmd->serverTimeStamp );
 
@@ -1639,7 +1650,8 @@ void ClientThink( edict_t *ent, usercmd_t *ucmd, int timeDelta )
 				continue; // duplicated
 
 			// player can't touch projectiles, only projectiles can touch the player
-			G_CallTouch( other, ent, NULL, 0 );
+			if( !G_ParallelThink_DeferTouch( other, ent ) )
+				G_CallTouch( other, ent, NULL, 0 );
 		}
 	}
 
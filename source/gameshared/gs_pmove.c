@@ -83,8 +83,9 @@ typedef struct
 	float dashPlayerSpeed;
 } pml_t;
 
-pmove_t	*pm;
-pml_t pml;
+// per-thread, the game may move several players at once
+static THREADLOCAL pmove_t *pm;
+static THREADLOCAL pml_t pml;
 
 // movement parameters
 
@@ -371,14 +371,17 @@ typedef int socket_handle_t;
 #define ALIGN( x )   __attribute__( ( aligned( x ) ) )
 #define NOINLINE     __attribute__((noinline))
 #define NAKED
+#define THREADLOCAL  __thread
 #elif defined ( _MSC_VER )
 #define ALIGN( x )   __declspec( align( x ) )
 #define NOINLINE
 #define NAKED        __declspec( naked )
+#define THREADLOCAL  __declspec( thread )
 #else
 #define ALIGN( x )
 #define NOINLINE
 #define NAKED
+#define THREADLOCAL
 #endif
 
 #ifdef HAVE___STRTOI64
@@ -411,6 +414,16 @@ typedef int socket_handle_t;
 
 //==============================================
 
+// COM_CPUFeatures flags
+#define QCPU_HAS_RDTSC		0x00000001
+#define QCPU_HAS_MMX		0x00000002
+#define QCPU_HAS_MMXEXT		0x00000004
+#define QCPU_HAS_3DNOW		0x00000010
+#define QCPU_HAS_3DNOWEXT	0x00000020
+#define QCPU_HAS_SSE		0x00000040
+#define QCPU_HAS_SSE2		0x00000080
+#define QCPU_HAS_AVX		0x00000100
+
 typedef unsigned char qbyte;
 typedef enum { qfalse, qtrue }	  qboolean;
 typedef unsigned int qwchar;	// Unicode character
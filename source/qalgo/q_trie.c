@@ -24,87 +24,138 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <assert.h>
 #include <string.h>
 
+/*
+* The trie is a radix tree: every node holds the whole run of letters
+* leading to it instead of a single letter. Nodes, labels and child
+* edges live in three contiguous arenas and refer to each other by index,
+* so lookups walk a few cache friendly arrays instead of chasing one heap
+* node per character. Child edges of a node are kept sorted by their first
+* letter, small nodes are scanned linearly and large ones bisected.
+*/
+
+#define TRIE_NIL				( (unsigned int)-1 )
+#define TRIE_ROOT				0
+#define TRIE_LINEAR_EDGES		8			// scan instead of bisecting up to this many children
+#define TRIE_MIN_GARBAGE		4096		// don't bother compacting arenas below this
+
 /* Trie structure definitions */
 
 struct trie_node_s
 {
-	int depth;
-	char letter;
-	struct trie_node_s *child;
-	struct trie_node_s *sibling;
+	unsigned int label;						// offset of the label in the label arena
+	unsigned int label_len;
+	unsigned int edges;						// offset of the first child edge in the edge arena
+	unsigned short num_edges;
+	unsigned short max_edges;
 	int data_is_set;
 	void *data;
 };
 
 struct trie_s
 {
-	struct trie_node_s *root;
+	struct trie_node_s *nodes;
+	unsigned int num_nodes, max_nodes;
+	unsigned int free_nodes;				// free list, linked through the edges field
+
+	char *labels;
+	unsigned int labels_size, labels_max, labels_garbage;
+
+	char *edge_letters;						// first letter of the child label, for quick scans
+	unsigned int *edge_nodes;
+	unsigned int edges_size, edges_max, edges_garbage;
+
 	unsigned int size;
 	trie_casing_t casing;
 };
 
-typedef enum trie_remove_result_t
-{
-	TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT = 0,
-	TRIE_REMOVE_CHILDREN_OR_DATA_LEFT = 1,
-	TRIE_REMOVE_DATA_LEFT,
-	TRIE_REMOVE_KEY_NOT_FOUND
-} trie_remove_result_t;
-
 /* Forward declarations of internal implementation */
 
-static struct trie_node_s *Trie_CreateNode(
-        int depth,
+static void Trie_InitArenas(
+        struct trie_s *trie
+);
+
+static void Trie_FreeArenas(
+        struct trie_s *trie
+);
+
+static unsigned int Trie_AllocNode(
+        struct trie_s *trie
+);
+
+static void Trie_FreeNode(
+        struct trie_s *trie,
+        unsigned int node
+);
+
+static unsigned int Trie_AllocLabel(
+        struct trie_s *trie,
+        const char *label,
+        unsigned int len
+);
+
+static unsigned int Trie_AllocEdges(
+        struct trie_s *trie,
+        unsigned int count
+);
+
+static unsigned int Trie_FindEdge(
+        const struct trie_s *trie,
+        const struct trie_node_s *node,
         char letter,
-        struct trie_node_s *child,
-        struct trie_node_s *sibling,
-        int data_is_set,
-        void *data
+        int *insert_pos
 );
 
-static void Trie_Destroy_Rec(
-        struct trie_node_s *node
+static void Trie_AddEdge(
+        struct trie_s *trie,
+        unsigned int node,
+        unsigned int child
 );
 
-static struct trie_node_s *TRIE_Find_Rec(
-        struct trie_node_s *node,
-        const char *key,
-        trie_find_mode_t mode,
-        trie_casing_t casing,
-        int ( *predicate )( void *value, void *cookie ),
-        void *cookie
+static void Trie_RemoveEdge(
+        struct trie_s *trie,
+        unsigned int node,
+        unsigned int child
 );
 
-static int Trie_Insert_Rec(
-        struct trie_node_s *node,
-        const char *key,
-        trie_casing_t casing,
-        void *data
+static void Trie_MergeWithChild(
+        struct trie_s *trie,
+        unsigned int node
+);
+
+static void Trie_Compact(
+        struct trie_s *trie
 );
 
-static trie_remove_result_t Trie_Remove_Rec(
-        struct trie_node_s *node,
+static unsigned int Trie_FindNode(
+        const struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
-        void **data
+        trie_find_mode_t mode,
+        unsigned int *label_start
+);
+
+static unsigned int Trie_FirstMatch(
+        const struct trie_s *trie,
+        unsigned int node,
+        int ( *predicate )( void *value, void *cookie ),
+        void *cookie
 );
 
 static unsigned int Trie_NoOfKeys(
-        const struct trie_node_s *node,
-        trie_casing_t casing,
+        const struct trie_s *trie,
+        unsigned int node,
         int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int addSiblings
+        void *cookie
 );
 
 static void Trie_Dump_Rec(
-        const struct trie_node_s *node,
+        const struct trie_s *trie,
+        unsigned int node,
         trie_dump_what_t what,
-        trie_casing_t casing,
         int ( *predicate )( void *value, void *cookie ),
         void *cookie,
-        int dumpSiblings,
-        const char *key_prev,
+        char **key,
+        unsigned int *key_max,
+        unsigned int key_len,
         struct trie_key_value_s **key_value_vector
 );
 
@@ -129,9 +180,8 @@ trie_error_t Trie_Create(
 	if( trie )
 	{
 		*trie = (struct trie_s *) malloc( sizeof( struct trie_s ) );
-		( *trie )->root = Trie_CreateNode( 0, '\0', NULL, NULL, 0, NULL );
-		( *trie )->size = 0;
 		( *trie )->casing = casing;
+		Trie_InitArenas( *trie );
 		return TRIE_OK;
 	}
 	else
@@ -144,7 +194,7 @@ trie_error_t Trie_Destroy(
 {
 	if( trie )
 	{
-		Trie_Destroy_Rec( trie->root );
+		Trie_FreeArenas( trie );
 		free( trie );
 		return TRIE_OK;
 	}
@@ -158,9 +208,8 @@ trie_error_t Trie_Clear(
 {
 	if( trie )
 	{
-		Trie_Destroy_Rec( trie->root );
-		trie->root = Trie_CreateNode( 0, '\0', NULL, NULL, 0, NULL );
-		trie->size = 0;
+		Trie_FreeArenas( trie );
+		Trie_InitArenas( trie );
 		return TRIE_OK;
 	}
 	else
@@ -187,23 +236,72 @@ trie_error_t Trie_Insert(
         void *data
 )
 {
-	if( trie && key )
+	unsigned int node, child, tail, i, len;
+	struct trie_node_s *n;
+
+	if( !trie || !key )
+		return TRIE_INVALID_ARGUMENT;
+
+	node = TRIE_ROOT;
+	for( ;; )
 	{
-		if( !Trie_Insert_Rec( trie->root, key, trie->casing, data ) )
+		n = &trie->nodes[node];
+
+		// match as much of the label as possible
+		for( i = 0; i < n->label_len; i++ )
+		{
+			if( !key[i] || Trie_LetterCompare( trie->labels[n->label + i], key[i], trie->casing ) )
+				break;
+		}
+
+		if( i < n->label_len )
 		{
-			// insertion successful
+			// key diverges inside the label, split the node in two: the tail
+			// takes over the remainder of the label, children and data
+			tail = Trie_AllocNode( trie );
+			n = &trie->nodes[node];
+			trie->nodes[tail] = *n;
+			trie->nodes[tail].label += i;
+			trie->nodes[tail].label_len -= i;
+
+			n->label_len = i;
+			n->edges = 0;
+			n->num_edges = n->max_edges = 0;
+			n->data_is_set = 0;
+			n->data = NULL;
+			Trie_AddEdge( trie, node, tail );
+			n = &trie->nodes[node];
+		}
+
+		key += i;
+		if( !*key )
+		{
+			// end of key reached, set data
+			if( n->data_is_set )
+				return TRIE_DUPLICATE_KEY;
+			n->data = data;
+			n->data_is_set = 1;
 			++trie->size;
 			return TRIE_OK;
 		}
-		else
+
+		child = Trie_FindEdge( trie, n, *key, NULL );
+		if( child == TRIE_NIL )
 		{
-			// key already in trie
-			return TRIE_DUPLICATE_KEY;
+			// no matching child, the rest of the key becomes a new leaf
+			len = strlen( key );
+			child = Trie_AllocNode( trie );
+			n = &trie->nodes[child];
+			n->label = Trie_AllocLabel( trie, key, len );
+			n->label_len = len;
+			n->data = data;
+			n->data_is_set = 1;
+			Trie_AddEdge( trie, node, child );
+			++trie->size;
+			return TRIE_OK;
 		}
-	}
-	else
-	{
-		return TRIE_INVALID_ARGUMENT;
+
+		node = child;
 	}
 }
 
@@ -213,19 +311,65 @@ trie_error_t Trie_Remove(
         void **data
 )
 {
-	if( trie && key && data )
+	unsigned int node, parent, child, i;
+	struct trie_node_s *n;
+
+	if( !trie || !key || !data )
+		return TRIE_INVALID_ARGUMENT;
+
+	node = TRIE_ROOT;
+	parent = TRIE_NIL;
+	for( ;; )
 	{
-		if( Trie_Remove_Rec( trie->root, key, trie->casing, data ) != TRIE_REMOVE_KEY_NOT_FOUND )
+		n = &trie->nodes[node];
+		for( i = 0; i < n->label_len; i++ )
 		{
-			// removal successful
-			--trie->size;
-			return TRIE_OK;
+			if( !key[i] || Trie_LetterCompare( trie->labels[n->label + i], key[i], trie->casing ) )
+				return TRIE_KEY_NOT_FOUND;
 		}
-		else
+
+		key += i;
+		if( !*key )
+			break;
+
+		child = Trie_FindEdge( trie, n, *key, NULL );
+		if( child == TRIE_NIL )
 			return TRIE_KEY_NOT_FOUND;
+
+		parent = node;
+		node = child;
 	}
-	else
-		return TRIE_INVALID_ARGUMENT;
+
+	if( !n->data_is_set )
+		return TRIE_KEY_NOT_FOUND;
+
+	*data = n->data;
+	n->data = NULL;
+	n->data_is_set = 0;
+	--trie->size;
+
+	// keep the tree compressed: drop empty leaves and fold single children
+	if( node != TRIE_ROOT )
+	{
+		if( !n->num_edges )
+		{
+			Trie_RemoveEdge( trie, parent, node );
+			Trie_FreeNode( trie, node );
+			if( parent != TRIE_ROOT && !trie->nodes[parent].data_is_set && trie->nodes[parent].num_edges == 1 )
+				Trie_MergeWithChild( trie, parent );
+		}
+		else if( n->num_edges == 1 )
+		{
+			Trie_MergeWithChild( trie, node );
+		}
+	}
+
+	if( trie->labels_garbage > TRIE_MIN_GARBAGE && trie->labels_garbage > trie->labels_size / 2 )
+		Trie_Compact( trie );
+	else if( trie->edges_garbage > TRIE_MIN_GARBAGE && trie->edges_garbage > trie->edges_size / 2 )
+		Trie_Compact( trie );
+
+	return TRIE_OK;
 }
 
 trie_error_t Trie_Replace(
@@ -237,12 +381,12 @@ trie_error_t Trie_Replace(
 {
 	if( trie && key )
 	{
-		struct trie_node_s *result = TRIE_Find_Rec( trie->root, key, TRIE_EXACT_MATCH, trie->casing, Trie_AlwaysTrue, NULL );
-		if( result )
+		unsigned int node = Trie_FindNode( trie, key, TRIE_EXACT_MATCH, NULL );
+		if( node != TRIE_NIL )
 		{
 			// key found, replace data pointer
-			*data_old = result->data;
-			result->data = data_new;
+			*data_old = trie->nodes[node].data;
+			trie->nodes[node].data = data_new;
 			return TRIE_OK;
 		}
 		else
@@ -271,34 +415,30 @@ trie_error_t Trie_FindIf(
         void **data
 )
 {
-	if( trie && key && data )
+	if( trie && key && data && predicate )
 	{
-		const struct trie_node_s *result = TRIE_Find_Rec( trie->root, key, mode, trie->casing, predicate, cookie );
-		if( result )
+		unsigned int node = Trie_FindNode( trie, key, mode, NULL );
+		if( node != TRIE_NIL )
 		{
-			while( result->child && !result->data_is_set )
+			if( mode == TRIE_PREFIX_MATCH )
 			{
-				const struct trie_node_s *sibling;
-				for( sibling = result; sibling->sibling && !sibling->data_is_set; sibling = sibling->sibling )
-					/* search for sibling with data */;
-				if( sibling->data_is_set )
-				{
-					// sibling found, make it the result
-					result = sibling;
-					break;
-				}
-				// descend
-				result = result->child;
+				// return the first key in order below the prefix
+				node = Trie_FirstMatch( trie, node, predicate, cookie );
+			}
+			else if( !predicate( trie->nodes[node].data, cookie ) )
+			{
+				node = TRIE_NIL;
+			}
+
+			if( node != TRIE_NIL )
+			{
+				*data = trie->nodes[node].data;
+				return TRIE_OK;
 			}
-			assert( result->data_is_set );
-			*data = result->data;
-			return TRIE_OK;
-		}
-		else
-		{
-			*data = NULL;
-			return TRIE_KEY_NOT_FOUND;
 		}
+
+		*data = NULL;
+		return TRIE_KEY_NOT_FOUND;
 	}
 	else
 		return TRIE_INVALID_ARGUMENT;
@@ -323,9 +463,9 @@ trie_error_t Trie_NoOfMatchesIf(
 {
 	if( trie && prefix && matches )
 	{
-		struct trie_node_s *node = TRIE_Find_Rec( trie->root, prefix, TRIE_PREFIX_MATCH, trie->casing, predicate, cookie );
-		*matches = node
-		           ? Trie_NoOfKeys( node, trie->casing, predicate, cookie, 0 )
+		unsigned int node = Trie_FindNode( trie, prefix, TRIE_PREFIX_MATCH, NULL );
+		*matches = node != TRIE_NIL
+		           ? Trie_NoOfKeys( trie, node, predicate, cookie )
 			   : 0;
 		return TRIE_OK;
 	}
@@ -352,18 +492,46 @@ trie_error_t Trie_DumpIf(
         struct trie_dump_s **dump
 )
 {
-	if( prefix && dump && predicate )
+	if( trie && prefix && dump && predicate )
 	{
-		struct trie_node_s *result = TRIE_Find_Rec( trie->root, prefix, TRIE_PREFIX_MATCH, trie->casing, predicate, cookie );
+		unsigned int label_start;
+		unsigned int node = Trie_FindNode( trie, prefix, TRIE_PREFIX_MATCH, &label_start );
 		*dump = (struct trie_dump_s *) malloc( sizeof( struct trie_dump_s ) );
+		( *dump )->what = what;
 		// prefix matches some nodes, begin dump
-		if( result )
+		if( node != TRIE_NIL )
 		{
-			( *dump )->size = Trie_NoOfKeys( result, trie->casing, predicate, cookie, 0 );
-			( *dump )->what = what;
+			char *key = NULL;
+			unsigned int key_max = 0;
+			struct trie_key_value_s *key_value_vector;
+
+			( *dump )->size = Trie_NoOfKeys( trie, node, predicate, cookie );
 			( *dump )->key_value_vector = (struct trie_key_value_s *) malloc( sizeof( struct trie_key_value_s ) *( ( *dump )->size + 1 ) );
-			Trie_Dump_Rec( result, what, trie->casing, predicate, cookie, 0, prefix, &( *dump )->key_value_vector );
-			( *dump )->key_value_vector -= ( *dump )->size;
+
+			if( what & TRIE_DUMP_KEYS )
+			{
+				// rebuild the key leading to the node from the stored labels,
+				// so the dumped keys keep their original casing
+				unsigned int path, len = 0;
+
+				key_max = label_start + 64;
+				key = (char *) malloc( key_max );
+				for( path = TRIE_ROOT; path != node; )
+				{
+					const struct trie_node_s *n = &trie->nodes[path];
+					memcpy( key + len, trie->labels + n->label, n->label_len );
+					len += n->label_len;
+					path = Trie_FindEdge( trie, n, prefix[len], NULL );
+				}
+				assert( len == label_start );
+			}
+
+			key_value_vector = ( *dump )->key_value_vector;
+			Trie_Dump_Rec( trie, node, what, predicate, cookie, &key, &key_max, label_start, &key_value_vector );
+			assert( key_value_vector == ( *dump )->key_value_vector + ( *dump )->size );
+
+			if( key )
+				free( key );
 		}
 		else
 		{
@@ -394,288 +562,496 @@ trie_error_t Trie_FreeDump(
 
 /* Internal implementations */
 
-static struct trie_node_s *Trie_CreateNode(
-        int depth,
-        char letter,
-        struct trie_node_s *child,
-        struct trie_node_s *sibling,
-        int data_is_set,
-        void *data
+static void Trie_InitArenas(
+        struct trie_s *trie
 )
 {
-	struct trie_node_s *result = (struct trie_node_s *) malloc( sizeof( struct trie_node_s ) );
-	assert( result );
-	result->depth = depth;
-	result->letter = letter;
-	result->child = child;
-	result->sibling = sibling;
-	result->data_is_set = data_is_set;
-	result->data = data;
-	return result;
+	trie->max_nodes = 32;
+	trie->nodes = (struct trie_node_s *) malloc( sizeof( struct trie_node_s ) * trie->max_nodes );
+	trie->num_nodes = 0;
+	trie->free_nodes = TRIE_NIL;
+
+	trie->labels_max = 256;
+	trie->labels = (char *) malloc( trie->labels_max );
+	trie->labels_size = trie->labels_garbage = 0;
+
+	trie->edges_max = 64;
+	trie->edge_letters = (char *) malloc( trie->edges_max );
+	trie->edge_nodes = (unsigned int *) malloc( sizeof( unsigned int ) * trie->edges_max );
+	trie->edges_size = trie->edges_garbage = 0;
+
+	trie->size = 0;
+
+	// root node, with an empty label
+	Trie_AllocNode( trie );
 }
 
-static void Trie_Destroy_Rec(
-        struct trie_node_s *node
+static void Trie_FreeArenas(
+        struct trie_s *trie
 )
 {
-	assert( node );
-	if( node->sibling )
-		Trie_Destroy_Rec( node->sibling );
-	if( node->child )
-		Trie_Destroy_Rec( node->child );
-	free( node );
+	free( trie->nodes );
+	free( trie->labels );
+	free( trie->edge_letters );
+	free( trie->edge_nodes );
 }
 
-static struct trie_node_s *TRIE_Find_Rec(
-        struct trie_node_s *node,
-        const char *key,
-        trie_find_mode_t mode,
-        trie_casing_t casing,
-        int ( *predicate )( void *value, void *cookie ),
-        void *cookie
+static unsigned int Trie_AllocNode(
+        struct trie_s *trie
 )
 {
-	assert( key );
-	assert( node );
-	if( !Trie_LetterCompare( *key, node->letter, casing ) )
+	unsigned int node;
+
+	if( trie->free_nodes != TRIE_NIL )
 	{
-		// prefix matches
-		if( !*key || !*( key+1 ) )
-			// end of key reached, see if node contains data
-			if( mode == TRIE_PREFIX_MATCH || node->data_is_set )
-				// node contains data or prefix match only, key is valid
-				return node;
-			else
-				// no data supplied, key only matches prefix of some node in trie
-				return NULL;
-		else if( node->child )
-			// end of key not reached, continue with child
-			return TRIE_Find_Rec( node->child, key + 1, mode, casing, predicate, cookie );
-		else
-			// end of key not reached, but current node is a leaf
-			return NULL;
+		node = trie->free_nodes;
+		trie->free_nodes = trie->nodes[node].edges;
 	}
-	else if( node->sibling && Trie_LetterCompare( node->sibling->letter, *key, casing ) <= 0 )
+	else
 	{
-		// prefix does not match, but we might have a matching sibling
-		return TRIE_Find_Rec( node->sibling, key, mode, casing, predicate, cookie );
+		if( trie->num_nodes == trie->max_nodes )
+		{
+			trie->max_nodes *= 2;
+			trie->nodes = (struct trie_node_s *) realloc( trie->nodes, sizeof( struct trie_node_s ) * trie->max_nodes );
+			assert( trie->nodes );
+		}
+		node = trie->num_nodes++;
 	}
-	else if( !node->depth )
+
+	memset( &trie->nodes[node], 0, sizeof( struct trie_node_s ) );
+	return node;
+}
+
+static void Trie_FreeNode(
+        struct trie_s *trie,
+        unsigned int node
+)
+{
+	struct trie_node_s *n = &trie->nodes[node];
+
+	trie->labels_garbage += n->label_len;
+	trie->edges_garbage += n->max_edges;
+	n->edges = trie->free_nodes;
+	trie->free_nodes = node;
+}
+
+static unsigned int Trie_AllocLabel(
+        struct trie_s *trie,
+        const char *label,
+        unsigned int len
+)
+{
+	unsigned int offset;
+
+	if( trie->labels_size + len > trie->labels_max )
 	{
-		// node is root
-		if( !*key )
-			if( mode == TRIE_PREFIX_MATCH || node->data_is_set )
-				// key is "", return root
-				return node;
-			else
-				// key is "", but root does not contain data
-				return NULL;
-		else if( node->child )
-			return TRIE_Find_Rec( node->child, key, mode, casing, predicate, cookie );
-		else
-			return NULL;
+		while( trie->labels_size + len > trie->labels_max )
+			trie->labels_max *= 2;
+		trie->labels = (char *) realloc( trie->labels, trie->labels_max );
+		assert( trie->labels );
 	}
-	else
+
+	offset = trie->labels_size;
+	if( label )
+		memcpy( trie->labels + offset, label, len );
+	trie->labels_size += len;
+	return offset;
+}
+
+static unsigned int Trie_AllocEdges(
+        struct trie_s *trie,
+        unsigned int count
+)
+{
+	unsigned int offset;
+
+	if( trie->edges_size + count > trie->edges_max )
 	{
-		// prefix does not match, no matching siblings
-		return NULL;
+		while( trie->edges_size + count > trie->edges_max )
+			trie->edges_max *= 2;
+		trie->edge_letters = (char *) realloc( trie->edge_letters, trie->edges_max );
+		trie->edge_nodes = (unsigned int *) realloc( trie->edge_nodes, sizeof( unsigned int ) * trie->edges_max );
+		assert( trie->edge_letters && trie->edge_nodes );
 	}
+
+	offset = trie->edges_size;
+	trie->edges_size += count;
+	return offset;
 }
 
-static int Trie_Insert_Rec(
-        struct trie_node_s *node,
-        const char *key,
-        trie_casing_t casing,
-        void *data
+/*
+* Trie_FindEdge
+*
+* Returns the child starting with letter or TRIE_NIL. If insert_pos is
+* given, it receives the position where such a child would be inserted.
+*/
+static unsigned int Trie_FindEdge(
+        const struct trie_s *trie,
+        const struct trie_node_s *node,
+        char letter,
+        int *insert_pos
 )
 {
-	assert( key );
-	assert( node );
-	if( !node->depth || !Trie_LetterCompare( *key, node->letter, casing ) )
+	const char *letters = trie->edge_letters + node->edges;
+	int lo, hi, mid, cmp;
+
+	if( node->num_edges <= TRIE_LINEAR_EDGES )
 	{
-		// node is root or prefix matches
-		if( ( !node->depth && !*key ) || ( node->depth && !*( key+1 ) ) )
+		for( lo = 0; lo < node->num_edges; lo++ )
 		{
-			// end of key reached, set data
-			if( !node->data_is_set )
-			{
-				node->data = data;
-				node->data_is_set = 1;
-				return TRIE_OK;
-			}
-			else
-				return TRIE_DUPLICATE_KEY;
+			cmp = Trie_LetterCompare( letters[lo], letter, trie->casing );
+			if( !cmp )
+				return trie->edge_nodes[node->edges + lo];
+			if( cmp > 0 )
+				break;
 		}
-		else
+	}
+	else
+	{
+		lo = 0;
+		hi = node->num_edges - 1;
+		while( lo <= hi )
 		{
-			// not end of key, descend to child
-			const char *const nextKey = node->depth
-			                            ? key + 1
-						    : key;
-			if( !node->child || Trie_LetterCompare( node->child->letter, *nextKey, casing ) > 0 )
-				// no matching child, create one
-				node->child = Trie_CreateNode( node->depth + 1, *nextKey, NULL, node->child, 0, NULL );
-			// descend to matching child
-			return Trie_Insert_Rec( node->child, nextKey, casing, data );
+			mid = ( lo + hi ) >> 1;
+			cmp = Trie_LetterCompare( letters[mid], letter, trie->casing );
+			if( !cmp )
+				return trie->edge_nodes[node->edges + mid];
+			if( cmp < 0 )
+				lo = mid + 1;
+			else
+				hi = mid - 1;
 		}
 	}
+
+	if( insert_pos )
+		*insert_pos = lo;
+	return TRIE_NIL;
+}
+
+static void Trie_AddEdge(
+        struct trie_s *trie,
+        unsigned int node,
+        unsigned int child
+)
+{
+	int pos, count;
+	unsigned int edges;
+	char letter = trie->labels[trie->nodes[child].label];
+	struct trie_node_s *n = &trie->nodes[node];
+
+	Trie_FindEdge( trie, n, letter, &pos );
+
+	if( n->num_edges == n->max_edges )
+	{
+		// grow the edge block, the old one becomes garbage
+		count = n->max_edges ? n->max_edges * 2 : 2;
+		if( count > 256 )
+			count = 256;
+		edges = Trie_AllocEdges( trie, count );
+		n = &trie->nodes[node];
+		memcpy( trie->edge_letters + edges, trie->edge_letters + n->edges, n->num_edges );
+		memcpy( trie->edge_nodes + edges, trie->edge_nodes + n->edges, sizeof( unsigned int ) * n->num_edges );
+		trie->edges_garbage += n->max_edges;
+		n->edges = edges;
+		n->max_edges = count;
+	}
+
+	memmove( trie->edge_letters + n->edges + pos + 1, trie->edge_letters + n->edges + pos, n->num_edges - pos );
+	memmove( trie->edge_nodes + n->edges + pos + 1, trie->edge_nodes + n->edges + pos, sizeof( unsigned int ) * ( n->num_edges - pos ) );
+	trie->edge_letters[n->edges + pos] = letter;
+	trie->edge_nodes[n->edges + pos] = child;
+	n->num_edges++;
+}
+
+static void Trie_RemoveEdge(
+        struct trie_s *trie,
+        unsigned int node,
+        unsigned int child
+)
+{
+	int pos;
+	struct trie_node_s *n = &trie->nodes[node];
+
+	for( pos = 0; pos < n->num_edges; pos++ )
+	{
+		if( trie->edge_nodes[n->edges + pos] == child )
+			break;
+	}
+	assert( pos < n->num_edges );
+
+	n->num_edges--;
+	memmove( trie->edge_letters + n->edges + pos, trie->edge_letters + n->edges + pos + 1, n->num_edges - pos );
+	memmove( trie->edge_nodes + n->edges + pos, trie->edge_nodes + n->edges + pos + 1, sizeof( unsigned int ) * ( n->num_edges - pos ) );
+}
+
+/*
+* Trie_MergeWithChild
+*
+* Folds the only child of a data-less node into the node itself
+*/
+static void Trie_MergeWithChild(
+        struct trie_s *trie,
+        unsigned int node
+)
+{
+	unsigned int child, label, len;
+	struct trie_node_s *n = &trie->nodes[node], *c;
+
+	assert( node != TRIE_ROOT && n->num_edges == 1 && !n->data_is_set );
+
+	child = trie->edge_nodes[n->edges];
+	c = &trie->nodes[child];
+	len = n->label_len + c->label_len;
+
+	if( n->label + n->label_len == c->label )
+	{
+		// labels are still adjacent since the split
+		label = n->label;
+	}
 	else
 	{
-		assert( node->depth );
-		if( !node->sibling || Trie_LetterCompare( node->sibling->letter, *key, casing ) > 0 )
-			node->sibling = Trie_CreateNode( node->depth, *key, NULL, node->sibling, 0, NULL );
-		return Trie_Insert_Rec( node->sibling, key, casing, data );
+		// reserve first, the arena may move
+		label = Trie_AllocLabel( trie, NULL, len );
+		n = &trie->nodes[node];
+		c = &trie->nodes[child];
+		memcpy( trie->labels + label, trie->labels + n->label, n->label_len );
+		memcpy( trie->labels + label + n->label_len, trie->labels + c->label, c->label_len );
+		trie->labels_garbage += len;
+	}
+
+	n = &trie->nodes[node];
+	c = &trie->nodes[child];
+	trie->edges_garbage += n->max_edges;
+
+	*n = *c;
+	n->label = label;
+	n->label_len = len;
+
+	// the child's label and edges now belong to the node
+	c->label_len = 0;
+	c->max_edges = 0;
+	Trie_FreeNode( trie, child );
+}
+
+/*
+* Trie_Compact
+*
+* Rewrites the label and edge arenas without the garbage left by removals
+*/
+static void Trie_Compact(
+        struct trie_s *trie
+)
+{
+	unsigned int j, node, stack_size, stack_max;
+	unsigned int *stack;
+	char *labels, *edge_letters;
+	unsigned int *edge_nodes;
+	unsigned int labels_size = 0, edges_size = 0;
+	struct trie_node_s *n;
+
+	labels = (char *) malloc( trie->labels_size - trie->labels_garbage + 1 );
+	edge_letters = (char *) malloc( trie->edges_size - trie->edges_garbage + 1 );
+	edge_nodes = (unsigned int *) malloc( sizeof( unsigned int ) * ( trie->edges_size - trie->edges_garbage + 1 ) );
+
+	stack_max = trie->num_nodes;
+	stack = (unsigned int *) malloc( sizeof( unsigned int ) * stack_max );
+	stack_size = 0;
+	stack[stack_size++] = TRIE_ROOT;
+
+	while( stack_size )
+	{
+		node = stack[--stack_size];
+		n = &trie->nodes[node];
+
+		memcpy( labels + labels_size, trie->labels + n->label, n->label_len );
+		n->label = labels_size;
+		labels_size += n->label_len;
+
+		memcpy( edge_letters + edges_size, trie->edge_letters + n->edges, n->max_edges );
+		memcpy( edge_nodes + edges_size, trie->edge_nodes + n->edges, sizeof( unsigned int ) * n->max_edges );
+		n->edges = edges_size;
+		edges_size += n->max_edges;
+
+		for( j = 0; j < n->num_edges; j++ )
+			stack[stack_size++] = edge_nodes[n->edges + j];
 	}
+
+	assert( labels_size == trie->labels_size - trie->labels_garbage );
+	assert( edges_size == trie->edges_size - trie->edges_garbage );
+
+	free( stack );
+	free( trie->labels );
+	free( trie->edge_letters );
+	free( trie->edge_nodes );
+
+	trie->labels = labels;
+	trie->labels_max = trie->labels_size - trie->labels_garbage + 1;
+	trie->labels_size = labels_size;
+	trie->labels_garbage = 0;
+
+	trie->edge_letters = edge_letters;
+	trie->edge_nodes = edge_nodes;
+	trie->edges_max = trie->edges_size - trie->edges_garbage + 1;
+	trie->edges_size = edges_size;
+	trie->edges_garbage = 0;
 }
 
-static trie_remove_result_t Trie_Remove_Rec(
-        struct trie_node_s *node,
+/*
+* Trie_FindNode
+*
+* Returns the node matching the key. For prefix matches, the key may end
+* inside the node label. label_start receives the number of key characters
+* matched before the node label.
+*/
+static unsigned int Trie_FindNode(
+        const struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
-        void **data
+        trie_find_mode_t mode,
+        unsigned int *label_start
 )
 {
-	trie_remove_result_t status;
-	assert( node );
+	unsigned int node, i;
+	const char *start = key;
+	const struct trie_node_s *n;
+
 	assert( key );
-	if( node->depth && Trie_LetterCompare( node->letter, *key, casing ) < 0 )
-	{
-		// node is not root and prefix does not match
-		if( node->sibling )
-		{
-			// call recursively for sibling
-			status = Trie_Remove_Rec( node->sibling, key, casing, data );
-			if( status == TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT )
-			{
-				// sibling node has no children or data, free it and preserve siblings
-				struct trie_node_s *sibling = node->sibling->sibling;
-				free( node->sibling );
-				node->sibling = sibling;
-				// ch : is this right?
-				// return ( node->child != NULL ) || ( node->data_is_set );
-				return ( node->child != NULL ) || ( node->data_is_set ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
-			}
-			else
-				return status;
-		}
-		else
-			// key not found
-			return TRIE_REMOVE_KEY_NOT_FOUND;
-	}
-	else if( !node->depth || !Trie_LetterCompare( node->letter, *key, casing ) )
+
+	node = TRIE_ROOT;
+	for( ;; )
 	{
-		// prefix matches or node is root, check for end of key
-		if( !( !node->depth && !*key ) && !( node->depth && !*( key+1 ) ) )
+		n = &trie->nodes[node];
+		for( i = 0; i < n->label_len; i++ )
 		{
-			// not end of key, descend
-			if( node->child )
+			if( !key[i] )
 			{
-				status = Trie_Remove_Rec( node->child, node->depth ? key + 1 : key, casing, data );
-				if( !status )
-				{
-					// child node has no children, free it and preserve siblings
-					struct trie_node_s *sibling = node->child->sibling;
-					free( node->child );
-					node->child = sibling;
-					// ch : is this right?
-					// return ( node->child != NULL ) || ( node->data_is_set );
-					return ( node->child != NULL ) || ( node->data_is_set ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
-				}
-				else
-					return status;
+				// key ends inside the label, only a prefix of some key
+				if( mode != TRIE_PREFIX_MATCH )
+					return TRIE_NIL;
+				if( label_start )
+					*label_start = key - start;
+				return node;
 			}
-			else
-				// key not found
-				return TRIE_REMOVE_KEY_NOT_FOUND;
+			if( Trie_LetterCompare( trie->labels[n->label + i], key[i], trie->casing ) )
+				return TRIE_NIL;
 		}
-		else
+
+		if( !key[i] )
 		{
-			// end of key
-			*data = node->data;
-			node->data = NULL;
-			node->data_is_set = 0;
-			// ch : is this right?
-			// return ( node->child != 0 );
-			return ( node->child != 0 ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
+			if( mode != TRIE_PREFIX_MATCH && !n->data_is_set )
+				return TRIE_NIL;
+			if( label_start )
+				*label_start = key - start;
+			return node;
 		}
+		key += i;
+
+		node = Trie_FindEdge( trie, n, *key, NULL );
+		if( node == TRIE_NIL )
+			return TRIE_NIL;
 	}
-	else
-		// key not found
-		return TRIE_REMOVE_KEY_NOT_FOUND;
+}
+
+static unsigned int Trie_FirstMatch(
+        const struct trie_s *trie,
+        unsigned int node,
+        int ( *predicate )( void *value, void *cookie ),
+        void *cookie
+)
+{
+	unsigned int i, result;
+	const struct trie_node_s *n = &trie->nodes[node];
+
+	if( n->data_is_set && predicate( n->data, cookie ) )
+		return node;
+
+	for( i = 0; i < n->num_edges; i++ )
+	{
+		result = Trie_FirstMatch( trie, trie->edge_nodes[n->edges + i], predicate, cookie );
+		if( result != TRIE_NIL )
+			return result;
+	}
+
+	return TRIE_NIL;
 }
 
 static unsigned int Trie_NoOfKeys(
-        const struct trie_node_s *node,
-        trie_casing_t casing,
+        const struct trie_s *trie,
+        unsigned int node,
         int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int addSiblings
+        void *cookie
 )
 {
-	unsigned int noOfKeys;
-	assert( node );
+	unsigned int i, noOfKeys;
+	const struct trie_node_s *n = &trie->nodes[node];
+
 	assert( predicate );
 	// if data is set, we have a data node, otherwise just a prefix node
-	if( node->data_is_set && predicate( node->data, cookie ) )
+	if( n->data_is_set && predicate( n->data, cookie ) )
 		noOfKeys = 1;
 	else
 		noOfKeys = 0;
-	// recursively add siblings and children
-	if( addSiblings && node->sibling )
-		noOfKeys += Trie_NoOfKeys( node->sibling, casing, predicate, cookie, 1 );
-	if( node->child )
-		noOfKeys += Trie_NoOfKeys( node->child, casing, predicate, cookie, 1 );
+	// recursively add children
+	for( i = 0; i < n->num_edges; i++ )
+		noOfKeys += Trie_NoOfKeys( trie, trie->edge_nodes[n->edges + i], predicate, cookie );
 	return noOfKeys;
 }
 
+/*
+* Trie_Dump_Rec
+*
+* key holds the key_len characters leading to the node label
+*/
 static void Trie_Dump_Rec(
-        const struct trie_node_s *node,
+        const struct trie_s *trie,
+        unsigned int node,
         trie_dump_what_t what,
-        trie_casing_t casing,
         int ( *predicate )( void *value, void *cookie ),
         void *cookie,
-        int dumpSiblings,
-        const char *key_prev,
+        char **key,
+        unsigned int *key_max,
+        unsigned int key_len,
         struct trie_key_value_s **key_value_vector
 )
 {
-	char *key = NULL;
-	int keyDumped = 0;
+	unsigned int i;
+	const struct trie_node_s *n = &trie->nodes[node];
+
 	if( what & TRIE_DUMP_KEYS )
 	{
-		key = (char *) malloc( sizeof( char ) * ( node->depth + 1 ) );
-		strncpy( key, key_prev, node->depth ); // copy previous key
-		if( node->depth )
-			key[node->depth - 1] = node->letter; // append/replace letter
-		key[node->depth] = '\0';        // terminate key string
+		// append the label
+		if( key_len + n->label_len + 1 > *key_max )
+		{
+			while( key_len + n->label_len + 1 > *key_max )
+				*key_max *= 2;
+			*key = (char *) realloc( *key, *key_max );
+			assert( *key );
+		}
+		memcpy( *key + key_len, trie->labels + n->label, n->label_len );
+		key_len += n->label_len;
 	}
-	if( node->data_is_set && predicate( node->data, cookie ) )
+
+	if( n->data_is_set && predicate( n->data, cookie ) )
 	{
 		// dump key and values if requested
 		if( what & TRIE_DUMP_KEYS )
 		{
-			keyDumped = 1;
-			( *key_value_vector )->key = key;
+			char *copy = (char *) malloc( key_len + 1 );
+			memcpy( copy, *key, key_len );
+			copy[key_len] = '\0';
+			( *key_value_vector )->key = copy;
 		}
 		else
 			( *key_value_vector )->key = NULL;
 		( *key_value_vector )->value = ( what & TRIE_DUMP_VALUES )
-		                               ? node->data
+		                               ? n->data
 					       : NULL;
 		// increment key_vector
 		++ ( *key_value_vector );
 	}
-	// dump children
-	if( node->child )
-		Trie_Dump_Rec( node->child, what, casing, predicate, cookie, 1, key, key_value_vector );
-	// dump siblings
-	if( dumpSiblings && node->sibling )
-		Trie_Dump_Rec( node->sibling, what, casing, predicate, cookie, 1, key, key_value_vector );
-	if( ( what & TRIE_DUMP_KEYS ) && !keyDumped )
-	{
-		assert( key );
-		free( key );
-	}
+
+	// dump children, in letter order
+	for( i = 0; i < n->num_edges; i++ )
+		Trie_Dump_Rec( trie, trie->edge_nodes[n->edges + i], what, predicate, cookie, key, key_max, key_len, key_value_vector );
 }
 
 static int Trie_AlwaysTrue(
@@ -692,8 +1068,15 @@ static inline int Trie_LetterCompare(
         trie_casing_t casing
 )
 {
-	if( casing == TRIE_CASE_SENSITIVE )
-		return ( (int) left ) - ( (int) right );
-	else
-		return ( (int) tolower( left ) ) - ( (int) tolower( right ) );
+	int l = (unsigned char)left, r = (unsigned char)right;
+
+	if( casing != TRIE_CASE_SENSITIVE )
+	{
+		// plain ASCII folding, tolower() is a call per letter on some libcs
+		if( l >= 'A' && l <= 'Z' )
+			l += 'a' - 'A';
+		if( r >= 'A' && r <= 'Z' )
+			r += 'a' - 'A';
+	}
+	return l - r;
 }
@@ -249,9 +249,6 @@ cmodel_t *CM_LoadMap( cmodel_state_t *cms, const char *name, qboolean clientload
 
 	descr->loader( cms, NULL, buf, bspFormat );
 
-	CM_InitBoxHull( cms );
-	CM_InitOctagonHull( cms );
-
 	if( cms->numareas )
 	{
 		cms->map_areas = Mem_Alloc( cms->mempool, cms->numareas * sizeof( *cms->map_areas ) );
@@ -22,39 +22,62 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "qcommon.h"
 #include "cm_local.h"
 
+/*
+* Box and octagon hulls are rewritten for every CM_ModelForBBox call, so each
+* thread that traces against entities gets its own copy.
+*/
+typedef struct
+{
+	qboolean initialized;
+
+	cplane_t box_planes[6];
+	cbrushside_t box_brushsides[6];
+	cbrush_t box_brush[1];
+	cbrush_t *box_markbrushes[1];
+	cmodel_t box_cmodel[1];
+
+	cplane_t oct_planes[10];
+	cbrushside_t oct_brushsides[10];
+	cbrush_t oct_brush[1];
+	cbrush_t *oct_markbrushes[1];
+	cmodel_t oct_cmodel[1];
+} cm_hulls_t;
+
+static THREADLOCAL cm_hulls_t cm_hulls;
+
 /*
 * CM_InitBoxHull
 *
 * Set up the planes so that the six floats of a bounding box
 * can just be stored out and get a proper clipping hull structure.
 */
-void CM_InitBoxHull( cmodel_state_t *cms )
+static void CM_InitBoxHull( cm_hulls_t *hulls )
 {
 	int i;
 	cplane_t *p;
 	cbrushside_t *s;
 
-	cms->box_brush->numsides = 6;
-	cms->box_brush->brushsides = cms->box_brushsides;
-	cms->box_brush->contents = CONTENTS_BODY;
+	hulls->box_brush->numsides = 6;
+	hulls->box_brush->brushsides = hulls->box_brushsides;
+	hulls->box_brush->contents = CONTENTS_BODY;
 
-	cms->box_markbrushes[0] = cms->box_brush;
+	hulls->box_markbrushes[0] = hulls->box_brush;
 
-	cms->box_cmodel->builtin = qtrue;
-	cms->box_cmodel->nummarkfaces = 0;
-	cms->box_cmodel->markfaces = NULL;
-	cms->box_cmodel->markbrushes = cms->box_markbrushes;
-	cms->box_cmodel->nummarkbrushes = 1;
+	hulls->box_cmodel->builtin = qtrue;
+	hulls->box_cmodel->nummarkfaces = 0;
+	hulls->box_cmodel->markfaces = NULL;
+	hulls->box_cmodel->markbrushes = hulls->box_markbrushes;
+	hulls->box_cmodel->nummarkbrushes = 1;
 
 	for( i = 0; i < 6; i++ )
 	{
 		// brush sides
-		s = cms->box_brushsides + i;
-		s->plane = cms->box_planes + i;
+		s = hulls->box_brushsides + i;
+		s->plane = hulls->box_planes + i;
 		s->surfFlags = 0;
 
 		// planes
-		p = &cms->box_planes[i];
+		p = &hulls->box_planes[i];
 		VectorClear( p->normal );
 
 		if( ( i & 1 ) )
@@ -78,7 +101,7 @@ void CM_InitBoxHull( cmodel_state_t *cms )
 * Set up the planes so that the six floats of a bounding box
 * can just be stored out and get a proper clipping hull structure.
 */
-void CM_InitOctagonHull( cmodel_state_t *cms )
+static void CM_InitOctagonHull( cm_hulls_t *hulls )
 {
 	int i;
 	cplane_t *p;
@@ -90,28 +113,28 @@ void CM_InitOctagonHull( cmodel_state_t *cms )
 		{  1, -1, 0 }
 	};
 
-	cms->oct_brush->numsides = 10;
-	cms->oct_brush->brushsides = cms->oct_brushsides;
-	cms->oct_brush->contents = CONTENTS_BODY;
+	hulls->oct_brush->numsides = 10;
+	hulls->oct_brush->brushsides = hulls->oct_brushsides;
+	hulls->oct_brush->contents = CONTENTS_BODY;
 
-	cms->oct_markbrushes[0] = cms->oct_brush;
+	hulls->oct_markbrushes[0] = hulls->oct_brush;
 
-	cms->oct_cmodel->builtin = qtrue;
-	cms->oct_cmodel->nummarkfaces = 0;
-	cms->oct_cmodel->markfaces = NULL;
-	cms->oct_cmodel->markbrushes = cms->oct_markbrushes;
-	cms->oct_cmodel->nummarkbrushes = 1;
+	hulls->oct_cmodel->builtin = qtrue;
+	hulls->oct_cmodel->nummarkfaces = 0;
+	hulls->oct_cmodel->markfaces = NULL;
+	hulls->oct_cmodel->markbrushes = hulls->oct_markbrushes;
+	hulls->oct_cmodel->nummarkbrushes = 1;
 
 	// axial planes
 	for( i = 0; i < 6; i++ )
 	{
 		// brush sides
-		s = cms->oct_brushsides + i;
-		s->plane = cms->oct_planes + i;
+		s = hulls->oct_brushsides + i;
+		s->plane = hulls->oct_planes + i;
 		s->surfFlags = 0;
 
 		// planes
-		p = &cms->oct_planes[i];
+		p = &hulls->oct_planes[i];
 		VectorClear( p->normal );
 
 		if( ( i & 1 ) )
@@ -131,12 +154,12 @@ void CM_InitOctagonHull( cmodel_state_t *cms )
 	// non-axial planes
 	for( i = 6; i < 10; i++ ) {
 		// brush sides
-		s = cms->oct_brushsides + i;
-		s->plane = cms->oct_planes + i;
+		s = hulls->oct_brushsides + i;
+		s->plane = hulls->oct_planes + i;
 		s->surfFlags = 0;
 
 		// planes
-		p = &cms->oct_planes[i];
+		p = &hulls->oct_planes[i];
 		VectorCopy( oct_dirs[i-6], p->normal );
 
 		p->type = PLANE_NONAXIAL;
@@ -144,6 +167,22 @@ void CM_InitOctagonHull( cmodel_state_t *cms )
 	}
 }
 
+/*
+* CM_GetHulls
+*/
+static inline cm_hulls_t *CM_GetHulls( void )
+{
+	cm_hulls_t *hulls = &cm_hulls;
+
+	if( !hulls->initialized )
+	{
+		CM_InitBoxHull( hulls );
+		CM_InitOctagonHull( hulls );
+		hulls->initialized = qtrue;
+	}
+	return hulls;
+}
+
 /*
 * CM_ModelForBBox
 * 
@@ -151,17 +190,19 @@ void CM_InitOctagonHull( cmodel_state_t *cms )
 */
 cmodel_t *CM_ModelForBBox( cmodel_state_t *cms, vec3_t mins, vec3_t maxs )
 {
-	cms->box_planes[0].dist = maxs[0];
-	cms->box_planes[1].dist = -mins[0];
-	cms->box_planes[2].dist = maxs[1];
-	cms->box_planes[3].dist = -mins[1];
-	cms->box_planes[4].dist = maxs[2];
-	cms->box_planes[5].dist = -mins[2];
+	cm_hulls_t *hulls = CM_GetHulls();
 
-	VectorCopy( mins, cms->box_cmodel->mins );
-	VectorCopy( maxs, cms->box_cmodel->maxs );
+	hulls->box_planes[0].dist = maxs[0];
+	hulls->box_planes[1].dist = -mins[0];
+	hulls->box_planes[2].dist = maxs[1];
+	hulls->box_planes[3].dist = -mins[1];
+	hulls->box_planes[4].dist = maxs[2];
+	hulls->box_planes[5].dist = -mins[2];
 
-	return cms->box_cmodel;
+	VectorCopy( mins, hulls->box_cmodel->mins );
+	VectorCopy( maxs, hulls->box_cmodel->maxs );
+
+	return hulls->box_cmodel;
 }
 
 /*
@@ -176,6 +217,7 @@ cmodel_t *CM_OctagonModelForBBox( cmodel_state_t *cms, vec3_t mins, vec3_t maxs
 	float a, b, d, t;
 	float sina, cosa;
 	vec3_t offset, size[2];
+	cm_hulls_t *hulls = CM_GetHulls();
 
 	for( i = 0; i < 3; i++ ) {
 		offset[i] = ( mins[i] + maxs[i] ) * 0.5;
@@ -183,16 +225,16 @@ cmodel_t *CM_OctagonModelForBBox( cmodel_state_t *cms, vec3_t mins, vec3_t maxs
 		size[1][i] = maxs[i] - offset[i];
 	}
 
-	VectorCopy( offset, cms->oct_cmodel->cyl_offset );
-	VectorCopy( size[0], cms->oct_cmodel->mins );
-	VectorCopy( size[1], cms->oct_cmodel->maxs );
+	VectorCopy( offset, hulls->oct_cmodel->cyl_offset );
+	VectorCopy( size[0], hulls->oct_cmodel->mins );
+	VectorCopy( size[1], hulls->oct_cmodel->maxs );
 
-	cms->oct_planes[0].dist = size[1][0];
-	cms->oct_planes[1].dist = -size[0][0];
-	cms->oct_planes[2].dist = size[1][1];
-	cms->oct_planes[3].dist = -size[0][1];
-	cms->oct_planes[4].dist = size[1][2];
-	cms->oct_planes[5].dist = -size[0][2];
+	hulls->oct_planes[0].dist = size[1][0];
+	hulls->oct_planes[1].dist = -size[0][0];
+	hulls->oct_planes[2].dist = size[1][1];
+	hulls->oct_planes[3].dist = -size[0][1];
+	hulls->oct_planes[4].dist = size[1][2];
+	hulls->oct_planes[5].dist = -size[0][2];
 
 	a = size[1][0]; // halfx
 	b = size[1][1]; // halfy
@@ -212,19 +254,19 @@ cmodel_t *CM_OctagonModelForBBox( cmodel_state_t *cms, vec3_t mins, vec3_t maxs
 
 	// the following should match normals and signbits set in CM_InitOctagonHull
 
-	VectorSet( cms->oct_planes[6].normal, cosa, sina, 0 );
-	cms->oct_planes[6].dist = d;
+	VectorSet( hulls->oct_planes[6].normal, cosa, sina, 0 );
+	hulls->oct_planes[6].dist = d;
 
-	VectorSet( cms->oct_planes[7].normal, -cosa, sina, 0 );
-	cms->oct_planes[7].dist = d;
+	VectorSet( hulls->oct_planes[7].normal, -cosa, sina, 0 );
+	hulls->oct_planes[7].dist = d;
 
-	VectorSet( cms->oct_planes[8].normal, -cosa, -sina, 0 );
-	cms->oct_planes[8].dist = d;
+	VectorSet( hulls->oct_planes[8].normal, -cosa, -sina, 0 );
+	hulls->oct_planes[8].dist = d;
 
-	VectorSet( cms->oct_planes[9].normal, cosa, -sina, 0 );
-	cms->oct_planes[9].dist = d;
+	VectorSet( hulls->oct_planes[9].normal, cosa, -sina, 0 );
+	hulls->oct_planes[9].dist = d;
 
-	return cms->oct_cmodel;
+	return hulls->oct_cmodel;
 }
 
 /*
@@ -248,12 +290,20 @@ int CM_PointLeafnum( cmodel_state_t *cms, const vec3_t p )
 	return -1 - num;
 }
 
+typedef struct
+{
+	int count, maxcount;
+	int *list;
+	float *mins, *maxs;
+	int topnode;
+} cm_leafquery_t;
+
 /*
 * CM_BoxLeafnums
 *
 * Fills in a list of all the leafs touched
 */
-static void CM_BoxLeafnums_r( cmodel_state_t *cms, int nodenum )
+static void CM_BoxLeafnums_r( cmodel_state_t *cms, cm_leafquery_t *q, int nodenum )
 {
 	int s;
 	cnode_t	*node;
@@ -261,7 +311,7 @@ static void CM_BoxLeafnums_r( cmodel_state_t *cms, int nodenum )
 	while( nodenum >= 0 )
 	{
 		node = &cms->map_nodes[nodenum];
-		s = BOX_ON_PLANE_SIDE( cms->leaf_mins, cms->leaf_maxs, node->plane ) - 1;
+		s = BOX_ON_PLANE_SIDE( q->mins, q->maxs, node->plane ) - 1;
 
 		if( s < 2 )
 		{
@@ -270,14 +320,14 @@ static void CM_BoxLeafnums_r( cmodel_state_t *cms, int nodenum )
 		}
 
 		// go down both sides
-		if( cms->leaf_topnode == -1 )
-			cms->leaf_topnode = nodenum;
-		CM_BoxLeafnums_r( cms, node->children[0] );
+		if( q->topnode == -1 )
+			q->topnode = nodenum;
+		CM_BoxLeafnums_r( cms, q, node->children[0] );
 		nodenum = node->children[1];
 	}
 
-	if( cms->leaf_count < cms->leaf_maxcount )
-		cms->leaf_list[cms->leaf_count++] = -1 - nodenum;
+	if( q->count < q->maxcount )
+		q->list[q->count++] = -1 - nodenum;
 }
 
 /*
@@ -285,20 +335,22 @@ static void CM_BoxLeafnums_r( cmodel_state_t *cms, int nodenum )
 */
 int CM_BoxLeafnums( cmodel_state_t *cms, vec3_t mins, vec3_t maxs, int *list, int listsize, int *topnode )
 {
-	cms->leaf_list = list;
-	cms->leaf_count = 0;
-	cms->leaf_maxcount = listsize;
-	cms->leaf_mins = mins;
-	cms->leaf_maxs = maxs;
+	cm_leafquery_t q;
 
-	cms->leaf_topnode = -1;
+	q.list = list;
+	q.count = 0;
+	q.maxcount = listsize;
+	q.mins = mins;
+	q.maxs = maxs;
 
-	CM_BoxLeafnums_r( cms, 0 );
+	q.topnode = -1;
+
+	CM_BoxLeafnums_r( cms, &q, 0 );
 
 	if( topnode )
-		*topnode = cms->leaf_topnode;
+		*topnode = q.topnode;
 
-	return cms->leaf_count;
+	return q.count;
 }
 
 /*
@@ -360,7 +412,7 @@ static int CM_PointContents( cmodel_state_t *cms, vec3_t p, cmodel_t *cmodel )
 	if( !cms->numnodes )    // map not loaded
 		return 0;
 
-	c_pointcontents++; // optimize counter
+	QAtomic_Add( &c_pointcontents, 1 ); // optimize counter
 
 	if( cmodel == cms->map_cmodels )
 	{
@@ -488,19 +540,25 @@ BOX TRACING
 #endif
 #define RADIUS_EPSILON		1.0f
 
-static vec3_t trace_start, trace_end;
-static vec3_t trace_mins, trace_maxs;
-static vec3_t trace_startmins, trace_endmins;
-static vec3_t trace_startmaxs, trace_endmaxs;
-static vec3_t trace_absmins, trace_absmaxs;
-static vec3_t trace_extents;
+// per-thread so that the game can run traces from several threads at once
+static THREADLOCAL vec3_t trace_start, trace_end;
+static THREADLOCAL vec3_t trace_mins, trace_maxs;
+static THREADLOCAL vec3_t trace_startmins, trace_endmins;
+static THREADLOCAL vec3_t trace_startmaxs, trace_endmaxs;
+static THREADLOCAL vec3_t trace_absmins, trace_absmaxs;
+static THREADLOCAL vec3_t trace_extents;
 
-static trace_t	*trace_trace;
+static THREADLOCAL trace_t *trace_trace;
 #ifdef TRACEVICFIX
-static float trace_realfraction;
+static THREADLOCAL float trace_realfraction;
 #endif
-static int trace_contents;
-static qboolean trace_ispoint;      // optimized case
+static THREADLOCAL int trace_contents;
+static THREADLOCAL qboolean trace_ispoint;      // optimized case
+
+// unique for every trace, brushes and patches are stamped with it to avoid
+// testing them twice. Concurrent traces may overwrite each other's stamps,
+// which only causes a brush to be tested again, never skipped
+static THREADLOCAL int trace_checkcount;
 
 /*
 * CM_ClipBoxToBrush
@@ -524,7 +582,7 @@ static void CM_ClipBoxToBrush( cmodel_state_t *cms, cbrush_t *brush )
 	leavefrac = 1;
 	clipplane = NULL;
 
-	c_brush_traces++;
+	QAtomic_Add( &c_brush_traces, 1 );
 
 	getout = qfalse;
 	startout = qfalse;
@@ -769,9 +827,9 @@ static void CM_CollideBox( cmodel_state_t *cms, cbrush_t **markbrushes, int numm
 	for( i = 0; i < nummarkbrushes; i++ )
 	{
 		b = markbrushes[i];
-		if( b->checkcount == cms->checkcount )
+		if( b->checkcount == trace_checkcount )
 			continue; // already checked this brush
-		b->checkcount = cms->checkcount;
+		b->checkcount = trace_checkcount;
 		if( !( b->contents & trace_contents ) )
 			continue;
 		func( cms, b );
@@ -786,9 +844,9 @@ static void CM_CollideBox( cmodel_state_t *cms, cbrush_t **markbrushes, int numm
 	for( i = 0; i < nummarkfaces; i++ )
 	{
 		patch = markfaces[i];
-		if( patch->checkcount == cms->checkcount )
+		if( patch->checkcount == trace_checkcount )
 			continue; // already checked this patch
-		patch->checkcount = cms->checkcount;
+		patch->checkcount = trace_checkcount;
 		if( !( patch->contents & trace_contents ) )
 			continue;
 		if( !BoundsIntersect( patch->mins, patch->maxs, trace_absmins, trace_absmaxs ) )
@@ -949,8 +1007,8 @@ static void CM_BoxTrace( cmodel_state_t *cms, trace_t *tr, vec3_t start, vec3_t
 
 	notworld = ( cmodel != cms->map_cmodels ? qtrue : qfalse );
 
-	cms->checkcount++;  // for multi-check avoidance
-	c_traces++;     // for statistics, may be zeroed
+	trace_checkcount = QAtomic_Add( &cms->checkcount, 1 );  // for multi-check avoidance
+	QAtomic_Add( &c_traces, 1 );     // for statistics, may be zeroed
 
 	// fill in a default trace
 	memset( tr, 0, sizeof( *tr ) );
@@ -1109,7 +1167,7 @@ void CM_TransformedBoxTrace( cmodel_state_t *cms, trace_t *tr, vec3_t start, vec
 	}
 
 	// cylinder offset
-	if( cmodel == cms->oct_cmodel )
+	if( cmodel == cm_hulls.oct_cmodel )
 	{
 		VectorSubtract( start, cmodel->cyl_offset, start_l );
 		VectorSubtract( end, cmodel->cyl_offset, end_l );
@@ -52,11 +52,13 @@ static cvar_t *logconsole = NULL;
 static cvar_t *logconsole_append;
 static cvar_t *logconsole_flush;
 static cvar_t *logconsole_timestamp;
+static cvar_t *logconsole_rotate_size;
+static cvar_t *logconsole_rotate_time;
+static cvar_t *logconsole_rotate_keep;
 static cvar_t *com_showtrace;
 static cvar_t *com_introPlayed3;
 
 int log_stats_file = 0;
-static int log_file = 0;
 
 static int server_state = CA_UNINITIALIZED;
 static int client_state = CA_UNINITIALIZED;
@@ -172,13 +174,7 @@ void Com_Printf( const char *format, ... )
 {
 	va_list	argptr;
 	char msg[MAX_PRINTMSG];
-
-	time_t timestamp;
-	char timestamp_str[MAX_PRINTMSG];
-	struct tm *timestampptr;
-	timestamp = time( NULL );
-	timestampptr = gmtime( &timestamp );
-	strftime( timestamp_str, MAX_PRINTMSG, "%Y-%m-%dT%H:%M:%SZ ", timestampptr );
+	time_t timestamp = time( NULL );
 
 	va_start( argptr, format );
 	Q_vsnprintfz( msg, sizeof( msg ), format, argptr );
@@ -205,12 +201,6 @@ void Com_Printf( const char *format, ... )
 	{
 		logconsole->modified = qfalse;
 
-		if( log_file )
-		{
-			FS_FCloseFile( log_file );
-			log_file = 0;
-		}
-
 		if( logconsole->string && logconsole->string[0] )
 		{
 			size_t name_size;
@@ -221,24 +211,29 @@ void Com_Printf( const char *format, ... )
 			Q_strncpyz( name, logconsole->string, name_size );
 			COM_DefaultExtension( name, ".log", name_size );
 
-			if( FS_FOpenFile( name, &log_file, ( logconsole_append && logconsole_append->integer ? FS_APPEND : FS_WRITE ) ) == -1 )
-			{
-				log_file = 0;
+			if( !Log_Open( name, logconsole_append && logconsole_append->integer ? qtrue : qfalse ) )
 				Com_Printf( "Couldn't open: %s\n", name );
-			}
 
 			Mem_TempFree( name );
 		}
+		else
+		{
+			Log_Open( NULL, qfalse );
+		}
 	}
 
-	if( log_file )
+	if( logconsole && logconsole_rotate_keep && ( logconsole_timestamp->modified || logconsole_flush->modified || logconsole_rotate_size->modified
+		|| logconsole_rotate_time->modified || logconsole_rotate_keep->modified ) )
 	{
-		if( logconsole_timestamp && logconsole_timestamp->integer )
-			FS_Printf( log_file, "%s", timestamp_str );
-		FS_Printf( log_file, "%s", msg );
-		if( logconsole_flush && logconsole_flush->integer )
-			FS_Flush( log_file ); // force it to save every time
+		logconsole_timestamp->modified = logconsole_flush->modified = qfalse;
+		logconsole_rotate_size->modified = logconsole_rotate_time->modified = logconsole_rotate_keep->modified = qfalse;
+
+		Log_SetOptions( logconsole_timestamp->integer ? qtrue : qfalse, logconsole_flush->integer ? qtrue : qfalse,
+			logconsole_rotate_size->integer * 1024, logconsole_rotate_time->integer * 60, logconsole_rotate_keep->integer );
 	}
+
+	// written by a background thread
+	Log_Write( timestamp, msg );
 }
 
 
@@ -303,11 +298,7 @@ void Com_Error( com_error_code_t code, const char *format, ... )
 		MM_Shutdown();
 	}
 
-	if( log_file )
-	{
-		FS_FCloseFile( log_file );
-		log_file = 0;
-	}
+	Log_Shutdown();
 
 	Sys_Error( "%s", msg );
 }
@@ -336,11 +327,7 @@ void Com_Quit( void )
 	CL_Shutdown();
 	MM_Shutdown();
 
-	if( log_file )
-	{
-		FS_FCloseFile( log_file );
-		log_file = 0;
-	}
+	Log_Shutdown();
 
 	Sys_Quit();
 }
@@ -630,6 +617,12 @@ void Com_FreePureList( purelist_t **purelist )
 
 //============================================================================
 
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+#include <cpuid.h>
+#elif defined(_MSC_VER) && ( defined(_M_IX86) || defined(_M_X64) )
+#include <intrin.h>
+#endif
+
 static unsigned int com_CPUFeatures = 0xFFFFFFFF;
 
 static inline int CPU_haveCPUID()
@@ -668,6 +661,8 @@ static inline int CPU_haveCPUID()
 			mov     has_CPUID,1         ; We have CPUID support
 done:
 	}
+#elif ( defined(__GNUC__) && defined(__x86_64__) ) || ( defined(_MSC_VER) && defined(_M_X64) )
+	has_CPUID = 1;	// always there in 64-bit mode
 #endif
 	return has_CPUID;
 }
@@ -704,6 +699,14 @@ static inline int CPU_getCPUIDFeatures()
 			mov     features, edx
 done:
 	}
+#elif defined(__GNUC__) && defined(__x86_64__)
+	unsigned int eax, ebx, ecx, edx;
+	if( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+		features = edx;
+#elif defined(_MSC_VER) && defined(_M_X64)
+	int regs[4];
+	__cpuid( regs, 1 );
+	features = regs[3];
 #endif
 	return features;
 }
@@ -738,10 +741,50 @@ static inline int CPU_getCPUIDFeaturesExt()
 			mov     features,edx
 done:
 	}
+#elif defined(__GNUC__) && defined(__x86_64__)
+	unsigned int eax, ebx, ecx, edx;
+	if( __get_cpuid( 0x80000001, &eax, &ebx, &ecx, &edx ) )
+		features = edx;
+#elif defined(_MSC_VER) && defined(_M_X64)
+	int regs[4];
+	__cpuid( regs, 0x80000000 );
+	if( (unsigned int)regs[0] >= 0x80000001 )
+	{
+		__cpuid( regs, 0x80000001 );
+		features = regs[3];
+	}
 #endif
 	return features;
 }
 
+/*
+* CPU_haveAVX
+*
+* The OS must also save the upper halves of the ymm registers
+*/
+static inline int CPU_haveAVX()
+{
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+	unsigned int eax, ebx, ecx, edx, xcr0;
+
+	if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+		return 0;
+	if( !( ecx & 0x08000000 ) || !( ecx & 0x10000000 ) )	// OSXSAVE and AVX
+		return 0;
+	__asm__ __volatile__ ( "xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0) );
+	return ( xcr0 & 6 ) == 6;
+#elif defined(_MSC_VER) && ( _MSC_FULL_VER >= 160040219 ) && ( defined(_M_IX86) || defined(_M_X64) )
+	int regs[4];
+
+	__cpuid( regs, 1 );
+	if( !( regs[2] & 0x08000000 ) || !( regs[2] & 0x10000000 ) )
+		return 0;
+	return ( _xgetbv( 0 ) & 6 ) == 6;
+#else
+	return 0;
+#endif
+}
+
 /*
 * COM_CPUFeatures
 *
@@ -772,6 +815,8 @@ unsigned int COM_CPUFeatures( void )
 				com_CPUFeatures |= QCPU_HAS_SSE;
 			if( CPUIDFeatures & 0x04000000 )
 				com_CPUFeatures |= QCPU_HAS_SSE2;
+			if( CPU_haveAVX() )
+				com_CPUFeatures |= QCPU_HAS_AVX;
 		}
 	}
 
@@ -1019,6 +1064,9 @@ void Qcommon_Init( int argc, char **argv )
 	logconsole_append = Cvar_Get( "logconsole_append", "1", CVAR_ARCHIVE );
 	logconsole_flush =  Cvar_Get( "logconsole_flush", "0", CVAR_ARCHIVE );
 	logconsole_timestamp =	Cvar_Get( "logconsole_timestamp", "0", CVAR_ARCHIVE );
+	logconsole_rotate_size = Cvar_Get( "logconsole_rotate_size", "0", CVAR_ARCHIVE );
+	logconsole_rotate_time = Cvar_Get( "logconsole_rotate_time", "0", CVAR_ARCHIVE );
+	logconsole_rotate_keep = Cvar_Get( "logconsole_rotate_keep", "5", CVAR_ARCHIVE );
 
 	com_showtrace =	    Cvar_Get( "com_showtrace", "0", 0 );
 	com_introPlayed3 =   Cvar_Get( "com_introPlayed3", "0", CVAR_ARCHIVE );
@@ -1150,11 +1198,12 @@ void Qcommon_Frame( unsigned int realmsec )
 
 	if( com_showtrace->integer )
 	{
-		Com_Printf( "%4i traces %4i brush traces %4i points\n",
-			c_traces, c_brush_traces, c_pointcontents );
-		c_traces = 0;
-		c_brush_traces = 0;
-		c_pointcontents = 0;
+		int traces = c_traces, brushtraces = c_brush_traces, points = c_pointcontents;
+
+		Com_Printf( "%4i traces %4i brush traces %4i points\n", traces, brushtraces, points );
+		QAtomic_Add( &c_traces, -traces );
+		QAtomic_Add( &c_brush_traces, -brushtraces );
+		QAtomic_Add( &c_pointcontents, -points );
 	}
 
 	wswcurl_perform();
@@ -1246,11 +1295,7 @@ void Qcommon_Shutdown( void )
 		FS_FCloseFile( log_stats_file );
 		log_stats_file = 0;
 	}
-	if( log_file )
-	{
-		FS_FCloseFile( log_file );
-		log_file = 0;
-	}
+	Log_Shutdown();
 	logconsole = NULL;
 	FS_Shutdown();
 
@@ -161,12 +161,16 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 				var->string = ZoneCopyString( (char *) var_value );
 				var->value = atof( var->string );
 				var->integer = Q_rint( var->value );
+				if( Cvar_FlagIsSet( flags, CVAR_SERVERINFO ) )
+					serverinfo_modcount++;
 			}
 			var->flags = flags;
 		}
 
 		if( Cvar_FlagIsSet( flags, CVAR_USERINFO ) && !Cvar_FlagIsSet( var->flags, CVAR_USERINFO ) )
 			userinfo_modified = qtrue; // transmit at next oportunity
+		if( Cvar_FlagIsSet( flags, CVAR_SERVERINFO ) && !Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+			serverinfo_modcount++;
 
 		Cvar_FlagSet( &var->flags, flags );
 		return var;
@@ -196,6 +200,9 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 
 	Trie_Insert( cvar_trie, var_name, var );
 
+	if( Cvar_FlagIsSet( flags, CVAR_SERVERINFO ) )
+		serverinfo_modcount++;
+
 	return var;
 }
 
@@ -287,6 +294,8 @@ static cvar_t *Cvar_Set2( const char *var_name, const char *value, qboolean forc
 					var->value = atof( var->string );
 					var->integer = Q_rint( var->value );
 					Cvar_SetModified( var );
+					if( Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+						serverinfo_modcount++;
 				}
 			}
 			return var;
@@ -308,6 +317,8 @@ static cvar_t *Cvar_Set2( const char *var_name, const char *value, qboolean forc
 
 	if( Cvar_FlagIsSet( var->flags, CVAR_USERINFO ) )
 		userinfo_modified = qtrue; // transmit at next oportunity
+	if( Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+		serverinfo_modcount++;
 
 	Mem_ZoneFree( var->string ); // free the old value string
 
@@ -347,6 +358,9 @@ cvar_t *Cvar_FullSet( const char *var_name, const char *value, cvar_flag_t flags
 	if( !var )
 		return Cvar_Get( var_name, value, flags );
 
+	if( Cvar_FlagIsSet( flags, CVAR_SERVERINFO ) != Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+		serverinfo_modcount++;
+
 	if( overwrite_flags )
 	{
 		var->flags = flags;
@@ -408,6 +422,8 @@ void Cvar_GetLatchedVars( cvar_flag_t flags )
 		var->latched_string = NULL;
 		var->value = atof( var->string );
 		var->integer = Q_rint( var->value );
+		if( Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+			serverinfo_modcount++;
 	}
 	Trie_FreeDump( dump );
 }
@@ -435,6 +451,8 @@ void Cvar_FixCheatVars( void )
 		var->string = ZoneCopyString( var->dvalue );
 		var->value = atof( var->string );
 		var->integer = Q_rint( var->value );
+		if( Cvar_FlagIsSet( var->flags, CVAR_SERVERINFO ) )
+			serverinfo_modcount++;
 	}
 	Trie_FreeDump( dump );
 }
@@ -694,6 +712,7 @@ static void Cvar_ArchiveList_f( void )
 #endif
 
 qboolean userinfo_modified;
+int serverinfo_modcount;
 
 static char *Cvar_BitInfo( int bit )
 {
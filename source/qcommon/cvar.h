@@ -41,6 +41,10 @@ static inline void	    Cvar_UnsetModified( cvar_t *var );
 // that the client knows to send it to the server
 extern qboolean	userinfo_modified;
 
+// this is incremented each time a CVAR_SERVERINFO variable is changed so
+// that the server knows when to rebuild its status replies
+extern int serverinfo_modcount;
+
 /*
 
    cvar_t variables are used to hold scalar or string variables that can be changed or displayed at the console or prog code as well as accessed directly
@@ -0,0 +1,741 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// DEMO INDEX FUNCTIONS
+
+#include "qcommon.h"
+#include "../qalgo/q_trie.h"
+
+/*
+* Listing demos with their meta data used to open and inflate every single
+* demo each time. The index remembers the meta data of each demo together
+* with the size and modification time of the file it came from, and keeps
+* it in a cache file between runs.
+*
+* A directory is scanned when it's listed: files are checked against their
+* entries and only new or changed demos are read, entries of removed files
+* are dropped. The sorted and filtered list of the last query is kept, so
+* paging through it doesn't scan the directory again for a while.
+*/
+
+#define DI_CACHE			"democache.txt"
+#define DI_CACHE_VERSION	1
+
+#define DI_TRIE_CASING		TRIE_CASE_INSENSITIVE
+
+#define DI_RESCAN_MSEC		2000
+
+#define DI_MAX_FILTER_TERMS	8
+#define DI_MAX_PATH			256
+
+typedef struct demoindex_s
+{
+	char *path;					// relative to the game directory, extension included
+	char *name;					// the file name part of path
+	size_t dirlen;
+	int size;
+	unsigned int mtime;
+	char *meta_data;			// key\0value\0 pairs
+	size_t meta_data_size;
+	int scan;					// scan that last saw the file
+	struct demoindex_s *prev, *next;
+} demoindex_t;
+
+typedef struct
+{
+	char dir[DI_MAX_PATH];
+	char filter[MAX_STRING_CHARS];
+	char sort[MAX_QPATH];
+	int generation;
+	unsigned int time;
+
+	demoindex_t **entries;
+	int numentries, maxentries;
+} diquery_t;
+
+static demoindex_t *di_entries;
+static trie_t *di_trie;
+static int di_generation;		// bumped on any change to the entries
+static int di_scan;
+static qboolean di_dirty;
+static diquery_t di_query;
+
+static qboolean di_initialized = qfalse;
+
+/*
+* DI_FindEntry
+*/
+static demoindex_t *DI_FindEntry( const char *path )
+{
+	demoindex_t *entry;
+
+	if( Trie_Find( di_trie, path, TRIE_EXACT_MATCH, ( void ** )&entry ) != TRIE_OK )
+		return NULL;
+	return entry;
+}
+
+/*
+* DI_RemoveEntry
+*/
+static void DI_RemoveEntry( demoindex_t *entry )
+{
+	void *data;
+
+	Trie_Remove( di_trie, entry->path, &data );
+
+	if( entry->prev )
+		entry->prev->next = entry->next;
+	else
+		di_entries = entry->next;
+	if( entry->next )
+		entry->next->prev = entry->prev;
+
+	Mem_ZoneFree( entry );
+
+	di_generation++;
+	di_dirty = qtrue;
+}
+
+/*
+* DI_AddEntry
+* Adds the demo to the index, replacing the old entry of the file
+*/
+static demoindex_t *DI_AddEntry( const char *path, int size, unsigned int mtime, const char *meta_data, size_t meta_data_size )
+{
+	demoindex_t *entry;
+	char *buffer, *slash;
+	size_t pathlen;
+
+	entry = DI_FindEntry( path );
+	if( entry )
+		DI_RemoveEntry( entry );
+
+	pathlen = strlen( path ) + 1;
+	buffer = ( char * )Mem_ZoneMalloc( sizeof( demoindex_t ) + pathlen + meta_data_size + 1 );
+
+	entry = ( demoindex_t * )buffer;
+	buffer += sizeof( demoindex_t );
+
+	entry->path = buffer;
+	memcpy( entry->path, path, pathlen );
+	buffer += pathlen;
+
+	slash = strrchr( entry->path, '/' );
+	entry->name = slash ? slash + 1 : entry->path;
+	entry->dirlen = slash ? slash - entry->path : 0;
+
+	entry->meta_data = buffer;
+	entry->meta_data_size = meta_data_size;
+	if( meta_data_size )
+		memcpy( entry->meta_data, meta_data, meta_data_size );
+	entry->meta_data[meta_data_size] = '\0';
+
+	entry->size = size;
+	entry->mtime = mtime;
+	entry->scan = di_scan;
+
+	Trie_Insert( di_trie, entry->path, entry );
+
+	entry->prev = NULL;
+	entry->next = di_entries;
+	if( di_entries )
+		di_entries->prev = entry;
+	di_entries = entry;
+
+	di_generation++;
+	di_dirty = qtrue;
+
+	return entry;
+}
+
+/*
+* DI_StatFile
+* Returns qfalse if the file doesn't exist
+*/
+static qboolean DI_StatFile( const char *path, int *size, unsigned int *mtime )
+{
+	int filenum;
+
+	*size = FS_FOpenFile( path, &filenum, FS_READ );
+	if( !filenum || *size < 0 )
+		return qfalse;
+	FS_FCloseFile( filenum );
+
+	*mtime = ( unsigned int )FS_FileMTime( path );
+	return qtrue;
+}
+
+/*
+* DI_ReadEntry
+* Reads the meta data of a new or changed demo
+*/
+static demoindex_t *DI_ReadEntry( const char *path, int size, unsigned int mtime )
+{
+	int filenum, length;
+	size_t meta_data_size = 0;
+	char *meta_data;
+	demoindex_t *entry;
+
+	meta_data = ( char * )Mem_TempMalloc( SNAP_MAX_DEMO_META_DATA_SIZE );
+
+	length = FS_FOpenFile( path, &filenum, FS_READ|SNAP_DEMO_GZ );
+	if( filenum )
+	{
+		if( length > 0 )
+			meta_data_size = SNAP_ReadDemoMetaData( filenum, meta_data, SNAP_MAX_DEMO_META_DATA_SIZE );
+		FS_FCloseFile( filenum );
+	}
+	meta_data_size = min( meta_data_size, SNAP_MAX_DEMO_META_DATA_SIZE - 1 );
+
+	entry = DI_AddEntry( path, size, mtime, meta_data, meta_data_size );
+
+	Mem_TempFree( meta_data );
+
+	return entry;
+}
+
+/*
+* DI_ScanDirectory
+* Brings the entries of demos in the directory up to date
+*/
+static void DI_ScanDirectory( const char *dir )
+{
+	int i, total, size;
+	unsigned int mtime;
+	size_t bufsize = 0, dirlen;
+	char *files, *name, path[DI_MAX_PATH];
+	demoindex_t *entry, *next;
+
+	di_scan++;
+	dirlen = strlen( dir );
+
+	total = FS_GetFileListExt( dir, APP_DEMO_EXTENSION_STR, NULL, &bufsize, 0, 0 );
+	if( total && bufsize )
+	{
+		files = ( char * )Mem_TempMalloc( bufsize );
+		FS_GetFileList( dir, APP_DEMO_EXTENSION_STR, files, bufsize, 0, 0 );
+
+		for( i = 0, name = files; i < total; i++, name += strlen( name ) + 1 )
+		{
+			if( dirlen + 1 + strlen( name ) >= sizeof( path ) )
+				continue;
+			Q_snprintfz( path, sizeof( path ), "%s/%s", dir, name );
+
+			if( !DI_StatFile( path, &size, &mtime ) )
+				continue;
+
+			entry = DI_FindEntry( path );
+			if( entry && entry->size == size && entry->mtime == mtime )
+				entry->scan = di_scan;
+			else
+				DI_ReadEntry( path, size, mtime );
+		}
+
+		Mem_TempFree( files );
+	}
+
+	// drop the demos that are gone
+	for( entry = di_entries; entry; entry = next )
+	{
+		next = entry->next;
+		if( entry->scan != di_scan && entry->dirlen == dirlen && !Q_strnicmp( entry->path, dir, dirlen ) )
+			DI_RemoveEntry( entry );
+	}
+}
+
+/*
+* DI_WriteEscaped
+*/
+static void DI_WriteEscaped( int filenum, const char *s )
+{
+	char buf[256];
+	size_t len = 0;
+
+	for( ; *s; s++ )
+	{
+		if( len + 2 >= sizeof( buf ) )
+		{
+			FS_Write( buf, len, filenum );
+			len = 0;
+		}
+
+		switch( *s )
+		{
+		case '\\': buf[len++] = '\\'; buf[len++] = '\\'; break;
+		case '\t': buf[len++] = '\\'; buf[len++] = 't'; break;
+		case '\n': buf[len++] = '\\'; buf[len++] = 'n'; break;
+		case '\r': buf[len++] = '\\'; buf[len++] = 'r'; break;
+		default: buf[len++] = *s; break;
+		}
+	}
+
+	FS_Write( buf, len, filenum );
+}
+
+/*
+* DI_WriteCache
+* Writes the entries to the cache file, one demo a line: path, size, mtime
+* and the meta data pairs, all tab separated
+*/
+static void DI_WriteCache( void )
+{
+	int filenum;
+	const char *s, *end;
+	demoindex_t *entry;
+
+	if( !di_dirty )
+		return;
+
+	if( FS_FOpenFile( DI_CACHE, &filenum, FS_WRITE ) == -1 )
+		return;
+
+	FS_Printf( filenum, "%i\r\n", DI_CACHE_VERSION );
+
+	for( entry = di_entries; entry; entry = entry->next )
+	{
+		DI_WriteEscaped( filenum, entry->path );
+		FS_Printf( filenum, "\t%i\t%u", entry->size, entry->mtime );
+
+		end = entry->meta_data + entry->meta_data_size;
+		for( s = entry->meta_data; s < end; s += strlen( s ) + 1 )
+		{
+			FS_Write( "\t", 1, filenum );
+			DI_WriteEscaped( filenum, s );
+		}
+
+		FS_Write( "\r\n", 2, filenum );
+	}
+
+	FS_FCloseFile( filenum );
+
+	di_dirty = qfalse;
+}
+
+/*
+* DI_UnescapeField
+* Unescapes the field in place and terminates it, returns the next one
+*/
+static char *DI_UnescapeField( char *s, size_t *len )
+{
+	char *out = s, *start = s;
+
+	while( *s && *s != '\t' )
+	{
+		if( *s == '\\' && s[1] )
+		{
+			s++;
+			switch( *s )
+			{
+			case 't': *out++ = '\t'; break;
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			default: *out++ = *s; break;
+			}
+			s++;
+			continue;
+		}
+		*out++ = *s++;
+	}
+
+	*len = out - start;
+	if( *s )
+		s++;
+	*out = '\0';
+	return s;
+}
+
+/*
+* DI_LoadCache
+*/
+static void DI_LoadCache( void )
+{
+	char *buffer, *line, *next, *field, *meta_data;
+	char *path, *size, *mtime;
+	size_t len, meta_data_size;
+
+	FS_LoadFile( DI_CACHE, ( void ** )&buffer, NULL, 0 );
+	if( !buffer )
+		return;
+
+	meta_data = ( char * )Mem_TempMalloc( SNAP_MAX_DEMO_META_DATA_SIZE );
+
+	line = buffer;
+	next = strchr( line, '\n' );
+	if( next && atoi( line ) == DI_CACHE_VERSION )
+	{
+		for( line = next + 1; *line; line = next )
+		{
+			next = strchr( line, '\n' );
+			if( next )
+				*next++ = '\0';
+			else
+				next = line + strlen( line );
+
+			len = strlen( line );
+			if( len && line[len-1] == '\r' )
+				line[len-1] = '\0';
+
+			path = line;
+			size = DI_UnescapeField( path, &len );
+			mtime = DI_UnescapeField( size, &len );
+			field = DI_UnescapeField( mtime, &len );
+			if( !*path || !*size || !*mtime )
+				continue;
+
+			meta_data_size = 0;
+			while( *field )
+			{
+				char *value = field;
+
+				field = DI_UnescapeField( value, &len );
+				if( meta_data_size + len + 1 >= SNAP_MAX_DEMO_META_DATA_SIZE )
+					break;
+				memcpy( meta_data + meta_data_size, value, len + 1 );
+				meta_data_size += len + 1;
+			}
+
+			DI_AddEntry( path, atoi( size ), strtoul( mtime, NULL, 10 ), meta_data, meta_data_size );
+		}
+	}
+
+	Mem_TempFree( meta_data );
+	FS_FreeFile( buffer );
+
+	// the entries are just what the file had
+	di_dirty = qfalse;
+}
+
+/*
+* DI_GetMetaValue
+*/
+static const char *DI_GetMetaValue( const demoindex_t *entry, const char *key )
+{
+	const char *s, *value, *end;
+
+	end = entry->meta_data + entry->meta_data_size;
+	for( s = entry->meta_data; s < end; s = value + strlen( value ) + 1 )
+	{
+		value = s + strlen( s ) + 1;
+		if( value >= end )
+			break;
+		if( !Q_stricmp( s, key ) )
+			return value;
+	}
+
+	return NULL;
+}
+
+/*
+* DI_MatchString
+* Case insensitive substring match, color tokens ignored
+*/
+static qboolean DI_MatchString( const char *s, const char *lpattern )
+{
+	char buf[MAX_STRING_CHARS];
+
+	Q_strncpyz( buf, s, sizeof( buf ) );
+	COM_RemoveColorTokens( buf );
+	Q_strlwr( buf );
+
+	return strstr( buf, lpattern ) != NULL;
+}
+
+/*
+* DI_MatchFilter
+* The filter is a space separated list of terms which all have to match.
+* A term matches the file name or any meta value, "key:text" only looks
+* at the given meta key and "name:text" at the file name
+*/
+static qboolean DI_MatchFilter( const demoindex_t *entry, char **terms, int numterms )
+{
+	int i;
+	char *colon;
+	const char *s, *value, *end;
+	qboolean match;
+
+	for( i = 0; i < numterms; i++ )
+	{
+		colon = strchr( terms[i], ':' );
+		if( colon )
+		{
+			*colon = '\0';
+			if( !strcmp( terms[i], "name" ) )
+				value = entry->name;
+			else
+				value = DI_GetMetaValue( entry, terms[i] );
+			*colon = ':';
+
+			if( !value || !DI_MatchString( value, colon + 1 ) )
+				return qfalse;
+			continue;
+		}
+
+		match = DI_MatchString( entry->name, terms[i] );
+
+		end = entry->meta_data + entry->meta_data_size;
+		for( s = entry->meta_data; s < end && !match; s = value + strlen( value ) + 1 )
+		{
+			value = s + strlen( s ) + 1;
+			if( value >= end )
+				break;
+			match = DI_MatchString( value, terms[i] );
+		}
+
+		if( !match )
+			return qfalse;
+	}
+
+	return qtrue;
+}
+
+static const char *di_sortkey;
+static qboolean di_sortdescending;
+
+/*
+* DI_CompareValues
+* Numbers compare as numbers, anything else as strings, missing values last
+*/
+static int DI_CompareValues( const char *a, const char *b )
+{
+	char *enda, *endb;
+	double na, nb;
+
+	if( !a || !b )
+		return ( a ? -1 : 0 ) + ( b ? 1 : 0 );
+
+	na = strtod( a, &enda );
+	nb = strtod( b, &endb );
+	if( enda != a && !*enda && endb != b && !*endb )
+		return na < nb ? -1 : ( na > nb ? 1 : 0 );
+
+	return Q_stricmp( a, b );
+}
+
+/*
+* DI_CompareEntries
+*/
+static int DI_CompareEntries( const void *pa, const void *pb )
+{
+	const demoindex_t *a = *( const demoindex_t ** )pa;
+	const demoindex_t *b = *( const demoindex_t ** )pb;
+	int cmp = 0;
+
+	if( !strcmp( di_sortkey, "size" ) )
+		cmp = a->size < b->size ? -1 : ( a->size > b->size ? 1 : 0 );
+	else if( !strcmp( di_sortkey, "date" ) )
+		cmp = a->mtime < b->mtime ? -1 : ( a->mtime > b->mtime ? 1 : 0 );
+	else if( strcmp( di_sortkey, "name" ) )
+		cmp = DI_CompareValues( DI_GetMetaValue( a, di_sortkey ), DI_GetMetaValue( b, di_sortkey ) );
+
+	if( !cmp )
+		cmp = Q_stricmp( a->name, b->name );
+
+	return di_sortdescending ? -cmp : cmp;
+}
+
+/*
+* DI_RunQuery
+* Fills the query list with the demos of the directory that match the
+* filter, sorted by the sort key
+*/
+static void DI_RunQuery( void )
+{
+	int numterms;
+	size_t dirlen;
+	char filter[MAX_STRING_CHARS], *terms[DI_MAX_FILTER_TERMS], *s;
+	demoindex_t *entry;
+
+	DI_ScanDirectory( di_query.dir );
+
+	Q_strncpyz( filter, di_query.filter, sizeof( filter ) );
+	COM_RemoveColorTokens( filter );
+	Q_strlwr( filter );
+
+	numterms = 0;
+	for( s = strtok( filter, " " ); s && numterms < DI_MAX_FILTER_TERMS; s = strtok( NULL, " " ) )
+		terms[numterms++] = s;
+
+	dirlen = strlen( di_query.dir );
+	di_query.numentries = 0;
+
+	for( entry = di_entries; entry; entry = entry->next )
+	{
+		if( entry->dirlen != dirlen || Q_strnicmp( entry->path, di_query.dir, dirlen ) )
+			continue;
+		if( !DI_MatchFilter( entry, terms, numterms ) )
+			continue;
+
+		if( di_query.numentries == di_query.maxentries )
+		{
+			di_query.maxentries = di_query.maxentries ? di_query.maxentries * 2 : 256;
+			if( di_query.entries )
+				di_query.entries = ( demoindex_t ** )Mem_Realloc( di_query.entries, sizeof( *di_query.entries ) * di_query.maxentries );
+			else
+				di_query.entries = ( demoindex_t ** )Mem_ZoneMalloc( sizeof( *di_query.entries ) * di_query.maxentries );
+		}
+		di_query.entries[di_query.numentries++] = entry;
+	}
+
+	di_sortkey = di_query.sort;
+	di_sortdescending = qfalse;
+	if( *di_sortkey == '-' )
+	{
+		di_sortkey++;
+		di_sortdescending = qtrue;
+	}
+	if( !*di_sortkey )
+		di_sortkey = "name";
+
+	qsort( di_query.entries, di_query.numentries, sizeof( *di_query.entries ), DI_CompareEntries );
+
+	DI_WriteCache();
+
+	di_query.generation = di_generation;
+	di_query.time = Sys_Milliseconds();
+}
+
+/*
+* DI_GetFileList
+* Lists the demos in the directory like FS_GetFileList, but only those
+* matching the filter and sorted by the sort key, "name", "size", "date" or
+* any meta data key, prefixed with '-' for descending order
+*/
+int DI_GetFileList( const char *dir, const char *filter, const char *sort, char *buf, size_t bufsize, int start, int end )
+{
+	int i, found;
+	size_t len, alllen;
+	char cleandir[DI_MAX_PATH];
+
+	if( !di_initialized || !dir )
+		return 0;
+
+	Q_strncpyz( cleandir, dir, sizeof( cleandir ) );
+	COM_SanitizeFilePath( cleandir );
+	len = strlen( cleandir );
+	while( len && cleandir[len-1] == '/' )
+		cleandir[--len] = '\0';
+
+	if( !filter )
+		filter = "";
+	if( !sort )
+		sort = "";
+
+	if( di_query.generation != di_generation || Sys_Milliseconds() - di_query.time > DI_RESCAN_MSEC
+		|| strcmp( di_query.dir, cleandir ) || strcmp( di_query.filter, filter ) || strcmp( di_query.sort, sort ) )
+	{
+		Q_strncpyz( di_query.dir, cleandir, sizeof( di_query.dir ) );
+		Q_strncpyz( di_query.filter, filter, sizeof( di_query.filter ) );
+		Q_strncpyz( di_query.sort, sort, sizeof( di_query.sort ) );
+		DI_RunQuery();
+	}
+
+	if( !buf )
+		return di_query.numentries;
+
+	if( end <= 0 || end > di_query.numentries )
+		end = di_query.numentries;
+
+	found = 0;
+	alllen = 0;
+	for( i = max( start, 0 ); i < end; i++ )
+	{
+		len = strlen( di_query.entries[i]->name ) + 1;
+		if( alllen + len > bufsize )
+			break;
+		memcpy( buf + alllen, di_query.entries[i]->name, len );
+		alllen += len;
+		found++;
+	}
+
+	return found;
+}
+
+/*
+* DI_GetMetaData
+* Returns the meta data of the demo from the index, reading it first if the
+* demo is new or has changed. Returns 0 if the file doesn't exist
+*/
+size_t DI_GetMetaData( const char *path, char *meta_data, size_t meta_data_size )
+{
+	int size;
+	unsigned int mtime;
+	demoindex_t *entry;
+
+	if( !di_initialized || !meta_data || !meta_data_size )
+		return 0;
+
+	if( !DI_StatFile( path, &size, &mtime ) )
+		return 0;
+
+	entry = DI_FindEntry( path );
+	if( !entry || entry->size != size || entry->mtime != mtime )
+		entry = DI_ReadEntry( path, size, mtime );
+
+	memcpy( meta_data, entry->meta_data, min( meta_data_size, entry->meta_data_size ) );
+	meta_data[min( meta_data_size - 1, entry->meta_data_size )] = '\0';
+
+	return entry->meta_data_size;
+}
+
+/*
+* DI_Init
+*/
+void DI_Init( void )
+{
+	if( di_initialized )
+		return;
+
+	Trie_Create( DI_TRIE_CASING, &di_trie );
+
+	memset( &di_query, 0, sizeof( di_query ) );
+	di_query.generation = -1;
+
+	DI_LoadCache();
+
+	di_initialized = qtrue;
+}
+
+/*
+* DI_Shutdown
+*/
+void DI_Shutdown( void )
+{
+	demoindex_t *entry;
+
+	if( !di_initialized )
+		return;
+
+	DI_WriteCache();
+
+	di_initialized = qfalse;
+
+	Trie_Destroy( di_trie );
+	di_trie = NULL;
+
+	while( di_entries )
+	{
+		entry = di_entries;
+		di_entries = entry->next;
+		Mem_ZoneFree( entry );
+	}
+
+	if( di_query.entries )
+		Mem_Free( di_query.entries );
+	memset( &di_query, 0, sizeof( di_query ) );
+	di_generation++;
+}
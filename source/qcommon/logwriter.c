@@ -0,0 +1,435 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// logwriter.c -- console log file written from a background thread
+
+#include "qcommon.h"
+
+/*
+* Com_Printf only copies each line into a ring of fixed size slots, a line
+* spanning as many consecutive slots as it needs. Producers reserve slots
+* by advancing the enqueue position with a compare-and-swap, so printing
+* never blocks, and lines that don't fit are counted and dropped. The
+* writer thread moves whole batches of lines to the file and rotates it.
+*
+* Each slot carries a sequence number: a slot is free for the record
+* starting at position p when its sequence is p, holds a published record
+* when it is p + 1, and is released for the next lap by setting it to
+* p + LOG_RING_SLOTS. The first slot of a record is published last.
+*/
+
+#define LOG_RING_SLOTS		4096				// must be a power of two
+#define LOG_RING_MASK		( LOG_RING_SLOTS - 1 )
+#define LOG_SLOT_SIZE		128
+#define LOG_SLOT_DATA		( LOG_SLOT_SIZE - 16 )
+#define LOG_MAX_RECORD_SLOTS	( ( MAX_PRINTMSG + LOG_SLOT_DATA - 1 ) / LOG_SLOT_DATA )
+
+#define LOG_BATCH_SIZE		0x10000
+#define LOG_WRITER_MSEC		20
+#define LOG_FLUSH_MSEC		1000
+
+typedef struct
+{
+	volatile int seq;
+	unsigned short numSlots;	// first slot only
+	unsigned short len;			// bytes in this slot
+	long long stamp;			// first slot only
+	char data[LOG_SLOT_DATA];
+} log_slot_t;
+
+typedef struct
+{
+	volatile int enqueuePos;
+	int dequeuePos;				// writer only
+	volatile int dropped;
+	log_slot_t slots[LOG_RING_SLOTS];
+} log_ring_t;
+
+static log_ring_t *log_ring;
+
+// everything below is protected by log_mutex
+static qmutex_t *log_mutex;
+static qthread_t *log_thread;
+static volatile int log_shutdown;
+static volatile qboolean log_active;
+
+static FILE *log_fp;
+static char log_filename[MAX_QPATH*4];
+static size_t log_filesize;
+static time_t log_opentime;
+static unsigned int log_lastflush;
+
+static qboolean log_timestamps;
+static qboolean log_flush;
+static size_t log_rotatesize;
+static int log_rotatetime;
+static int log_rotatekeep;
+
+static char log_batch[LOG_BATCH_SIZE];
+static size_t log_batchlen;
+
+/*
+* Log_FlushBatch
+*/
+static void Log_FlushBatch( void )
+{
+	if( log_batchlen && log_fp )
+		fwrite( log_batch, 1, log_batchlen, log_fp );
+	log_batchlen = 0;
+}
+
+/*
+* Log_Rotate
+*
+* Shifts name.1 ... name.keep-1 one up, moves the log to name.1 and starts a new one
+*/
+static void Log_Rotate( time_t now )
+{
+	int i;
+	char from[sizeof( log_filename ) + 8], to[sizeof( log_filename ) + 8];
+
+	Log_FlushBatch();
+	fclose( log_fp );
+
+	if( log_rotatekeep > 0 )
+	{
+		Q_snprintfz( to, sizeof( to ), "%s.%i", log_filename, log_rotatekeep );
+		remove( to );
+		for( i = log_rotatekeep - 1; i > 0; i-- )
+		{
+			Q_snprintfz( from, sizeof( from ), "%s.%i", log_filename, i );
+			Q_snprintfz( to, sizeof( to ), "%s.%i", log_filename, i + 1 );
+			rename( from, to );
+		}
+		Q_snprintfz( to, sizeof( to ), "%s.1", log_filename );
+		rename( log_filename, to );
+	}
+
+	log_fp = fopen( log_filename, "wb" );
+	log_filesize = 0;
+	log_opentime = now;
+}
+
+/*
+* Log_Output
+*/
+static void Log_Output( time_t stamp, const char *text, size_t len )
+{
+	size_t stamplen = 0;
+	char stampstr[32];
+
+	if( !log_fp )
+		return;
+
+	if( log_filesize )
+	{
+		if( ( log_rotatesize && log_filesize + len > log_rotatesize ) ||
+			( log_rotatetime && stamp - log_opentime >= log_rotatetime ) )
+		{
+			Log_Rotate( stamp );
+			if( !log_fp )
+				return;
+		}
+	}
+
+	if( log_timestamps )
+		stamplen = strftime( stampstr, sizeof( stampstr ), "%Y-%m-%dT%H:%M:%SZ ", gmtime( &stamp ) );
+
+	if( log_batchlen + stamplen + len > sizeof( log_batch ) )
+		Log_FlushBatch();
+
+	memcpy( log_batch + log_batchlen, stampstr, stamplen );
+	memcpy( log_batch + log_batchlen + stamplen, text, len );
+	log_batchlen += stamplen + len;
+	log_filesize += stamplen + len;
+}
+
+/*
+* Log_Drain
+*
+* Writes out all published lines, must be called with log_mutex held
+*/
+static void Log_Drain( void )
+{
+	int i, dropped;
+	unsigned int pos;
+	size_t len;
+	time_t stamp;
+	log_slot_t *slot;
+	qboolean written = qfalse;
+	char text[LOG_MAX_RECORD_SLOTS * LOG_SLOT_DATA];
+
+	pos = (unsigned int)log_ring->dequeuePos;
+	for( ;; )
+	{
+		slot = &log_ring->slots[pos & LOG_RING_MASK];
+		if( QAtomic_Add( &slot->seq, 0 ) != (int)( pos + 1 ) )
+			break;
+
+		len = 0;
+		stamp = (time_t)slot->stamp;
+		for( i = 0; i < slot->numSlots; i++ )
+		{
+			const log_slot_t *part = &log_ring->slots[( pos + i ) & LOG_RING_MASK];
+			memcpy( text + len, part->data, part->len );
+			len += part->len;
+		}
+
+		// release in order, the last slot of the record goes last
+		for( i = 0; i < slot->numSlots; i++ )
+			QAtomic_Add( &log_ring->slots[( pos + i ) & LOG_RING_MASK].seq, LOG_RING_SLOTS - 1 );
+		pos += i;
+
+		Log_Output( stamp, text, len );
+		written = qtrue;
+	}
+	log_ring->dequeuePos = (int)pos;
+
+	dropped = QAtomic_Add( &log_ring->dropped, 0 );
+	if( dropped )
+	{
+		QAtomic_Add( &log_ring->dropped, -dropped );
+		len = Q_snprintfz( text, sizeof( text ), "%i console lines dropped\n", dropped );
+		Log_Output( time( NULL ), text, len );
+		written = qtrue;
+	}
+
+	if( !written || !log_fp )
+		return;
+
+	Log_FlushBatch();
+	if( log_flush || Sys_Milliseconds() - log_lastflush >= LOG_FLUSH_MSEC )
+	{
+		fflush( log_fp );
+		log_lastflush = Sys_Milliseconds();
+	}
+}
+
+/*
+* Log_WriterThread
+*/
+static void *Log_WriterThread( void *param )
+{
+	while( !QAtomic_Add( &log_shutdown, 0 ) )
+	{
+		QMutex_Lock( log_mutex );
+		Log_Drain();
+		QMutex_Unlock( log_mutex );
+
+		Sys_Sleep( LOG_WRITER_MSEC );
+	}
+
+	return NULL;
+}
+
+/*
+* Log_Init
+*/
+static void Log_Init( void )
+{
+	int i;
+
+	if( log_ring )
+		return;
+
+	log_ring = ( log_ring_t * )Mem_ZoneMalloc( sizeof( *log_ring ) );
+	for( i = 0; i < LOG_RING_SLOTS; i++ )
+		log_ring->slots[i].seq = i;
+
+	log_mutex = QMutex_Create();
+
+	log_shutdown = 0;
+	log_thread = QThread_Create( Log_WriterThread, NULL );
+	if( !log_thread )
+		Com_DPrintf( "Log_Init: couldn't create the writer thread, writing the log inline\n" );
+}
+
+/*
+* Log_CloseFile
+*/
+static void Log_CloseFile( void )
+{
+	log_active = qfalse;
+
+	Log_Drain();
+	Log_FlushBatch();
+
+	if( log_fp )
+	{
+		fclose( log_fp );
+		log_fp = NULL;
+	}
+}
+
+/*
+* Log_Open
+*
+* Closes the current log and starts writing to filename inside the game
+* directory, or nowhere if filename is empty
+*/
+qboolean Log_Open( const char *filename, qboolean append )
+{
+	const char *path;
+
+	if( !filename || !filename[0] )
+	{
+		if( log_ring )
+		{
+			QMutex_Lock( log_mutex );
+			Log_CloseFile();
+			QMutex_Unlock( log_mutex );
+		}
+		return qtrue;
+	}
+
+	Log_Init();
+
+	QMutex_Lock( log_mutex );
+	Log_CloseFile();
+	QMutex_Unlock( log_mutex );
+
+	if( !COM_ValidateRelativeFilename( filename ) )
+		return qfalse;
+
+	path = va( "%s/%s/%s", FS_WriteDirectory(), FS_GameDirectory(), filename );
+	FS_CreateAbsolutePath( path );
+
+	QMutex_Lock( log_mutex );
+	Q_strncpyz( log_filename, path, sizeof( log_filename ) );
+	log_fp = fopen( log_filename, append ? "ab" : "wb" );
+	if( log_fp )
+	{
+		fseek( log_fp, 0, SEEK_END );
+		log_filesize = (size_t)ftell( log_fp );
+		log_opentime = time( NULL );
+		log_lastflush = Sys_Milliseconds();
+		log_active = qtrue;
+	}
+	QMutex_Unlock( log_mutex );
+
+	return log_fp ? qtrue : qfalse;
+}
+
+/*
+* Log_SetOptions
+*
+* rotateSize is in bytes and rotateTime in seconds, 0 disables either
+*/
+void Log_SetOptions( qboolean timestamps, qboolean flush, int rotateSize, int rotateTime, int rotateKeep )
+{
+	if( log_mutex )
+		QMutex_Lock( log_mutex );
+	log_timestamps = timestamps;
+	log_flush = flush;
+	log_rotatesize = (size_t)max( rotateSize, 0 );
+	log_rotatetime = max( rotateTime, 0 );
+	log_rotatekeep = max( rotateKeep, 0 );
+	if( log_mutex )
+		QMutex_Unlock( log_mutex );
+}
+
+/*
+* Log_Write
+*
+* Queues a line for the writer thread, safe to call from any thread
+*/
+void Log_Write( time_t stamp, const char *msg )
+{
+	int i, diff;
+	unsigned int pos;
+	size_t len, chunk;
+	int numSlots;
+	log_slot_t *slot;
+
+	if( !log_active )
+		return;
+
+	len = strlen( msg );
+	if( !len )
+		return;
+	if( len > MAX_PRINTMSG )
+		len = MAX_PRINTMSG;
+	numSlots = (int)( ( len + LOG_SLOT_DATA - 1 ) / LOG_SLOT_DATA );
+
+	// reserve numSlots consecutive slots, the consumer frees them in order
+	// so the last one being free means all of them are
+	pos = (unsigned int)log_ring->enqueuePos;
+	for( ;; )
+	{
+		slot = &log_ring->slots[( pos + numSlots - 1 ) & LOG_RING_MASK];
+		diff = QAtomic_Add( &slot->seq, 0 ) - (int)( pos + numSlots - 1 );
+		if( diff == 0 )
+		{
+			if( QAtomic_CAS( &log_ring->enqueuePos, (int)pos, (int)( pos + numSlots ) ) )
+				break;
+		}
+		else if( diff < 0 )
+		{
+			QAtomic_Add( &log_ring->dropped, 1 );
+			return;
+		}
+		pos = (unsigned int)log_ring->enqueuePos;
+	}
+
+	// fill and publish the continuation slots, then the first one
+	for( i = numSlots - 1; i >= 0; i-- )
+	{
+		slot = &log_ring->slots[( pos + i ) & LOG_RING_MASK];
+		chunk = len - i * LOG_SLOT_DATA;
+		if( chunk > LOG_SLOT_DATA )
+			chunk = LOG_SLOT_DATA;
+		memcpy( slot->data, msg + i * LOG_SLOT_DATA, chunk );
+		slot->len = (unsigned short)chunk;
+		if( !i )
+		{
+			slot->numSlots = (unsigned short)numSlots;
+			slot->stamp = (long long)stamp;
+		}
+		QAtomic_Add( &slot->seq, 1 );
+	}
+
+	if( !log_thread )
+	{
+		QMutex_Lock( log_mutex );
+		Log_Drain();
+		QMutex_Unlock( log_mutex );
+	}
+}
+
+/*
+* Log_Shutdown
+*
+* Stops the writer thread after everything queued so far is written
+*/
+void Log_Shutdown( void )
+{
+	if( !log_ring )
+		return;
+
+	if( log_thread )
+	{
+		QAtomic_Add( &log_shutdown, 1 );
+		QThread_Join( log_thread );
+		log_thread = NULL;
+	}
+
+	Log_CloseFile();
+
+	QMutex_Destroy( &log_mutex );
+	Mem_ZoneFree( log_ring );
+	log_ring = NULL;
+}
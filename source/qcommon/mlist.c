@@ -35,13 +35,30 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 typedef struct mapinfo_s
 {
 	char *filename, *fullname;
+	char *lfilename;			// lowercase filename, for sorting and searching
 	struct mapinfo_s *next;
 } mapinfo_t;
 
 static mapinfo_t *maplist;
 static trie_t *mlist_filenames_trie = NULL, *mlist_fullnames_trie = NULL;
 
-static qboolean ml_flush = qtrue;
+// all maps sorted by lowercase filename, map numbers index this array
+static mapinfo_t **ml_catalog;
+static int ml_catalog_num, ml_catalog_size;
+static int ml_catalog_generation;
+
+// the last search pattern and the catalog range it can match
+typedef struct
+{
+	char pattern[MAX_CONFIGSTRING_CHARS];
+	char lpattern[MAX_CONFIGSTRING_CHARS];
+	qboolean glob;
+	int first, last;
+	int generation;
+} mlsearch_t;
+
+static mlsearch_t ml_search;
+
 static qboolean ml_initialized = qfalse;
 
 static void ML_BuildCache( void );
@@ -49,6 +66,56 @@ static void ML_InitFromCache( void );
 static void ML_InitFromMaps( void );
 static void ML_GetFullnameFromMap( const char *filename, char *fullname, size_t len );
 static qboolean ML_FilenameExistsExt( const char *filename, qboolean quick );
+static int ML_CatalogLowerBound( const char *lname, size_t len, qboolean upper );
+
+/*
+* ML_CatalogAdd
+* Inserts the map at its sorted position, the cache and directory listings
+* are mostly sorted already so this usually appends
+*/
+static void ML_CatalogAdd( mapinfo_t *map )
+{
+	int pos;
+
+	pos = ML_CatalogLowerBound( map->lfilename, strlen( map->lfilename ) + 1, qfalse );
+	if( pos < ml_catalog_num && !strcmp( ml_catalog[pos]->lfilename, map->lfilename ) )
+		return;
+
+	if( ml_catalog_num == ml_catalog_size )
+	{
+		ml_catalog_size = ml_catalog_size ? ml_catalog_size * 2 : 256;
+		if( ml_catalog )
+			ml_catalog = ( mapinfo_t ** )Mem_Realloc( ml_catalog, sizeof( *ml_catalog ) * ml_catalog_size );
+		else
+			ml_catalog = ( mapinfo_t ** )Mem_ZoneMalloc( sizeof( *ml_catalog ) * ml_catalog_size );
+	}
+
+	memmove( ml_catalog + pos + 1, ml_catalog + pos, sizeof( *ml_catalog ) * ( ml_catalog_num - pos ) );
+	ml_catalog[pos] = map;
+	ml_catalog_num++;
+	ml_catalog_generation++;
+}
+
+/*
+* ML_CatalogLowerBound
+* Returns the first catalog position whose first len characters don't sort
+* before lname, or sort after it if upper is set
+*/
+static int ML_CatalogLowerBound( const char *lname, size_t len, qboolean upper )
+{
+	int lo = 0, hi = ml_catalog_num, mid, cmp;
+
+	while( lo < hi )
+	{
+		mid = ( lo + hi ) >> 1;
+		cmp = strncmp( ml_catalog[mid]->lfilename, lname, len );
+		if( cmp < 0 || ( upper && !cmp ) )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
 
 /*
 * ML_AddMap
@@ -76,8 +143,7 @@ static void ML_AddMap( const char *filename, const char *fullname )
 	if( !ML_ValidateFullname( fullname ) && *fullname )	// allow empty fullnames
 		return;
 
-	ml_flush = qtrue;	// tell everyone that maplist has changed
-	buffer = ( char* )Mem_ZoneMalloc( sizeof( mapinfo_t ) + strlen( filename ) + 1 + strlen( fullname ) + 1 );
+	buffer = ( char* )Mem_ZoneMalloc( sizeof( mapinfo_t ) + ( strlen( filename ) + 1 ) * 2 + strlen( fullname ) + 1 );
 
 	map = ( mapinfo_t * )buffer;
 	buffer += sizeof( mapinfo_t );
@@ -87,6 +153,11 @@ static void ML_AddMap( const char *filename, const char *fullname )
 	COM_StripExtension( map->filename );
 	buffer += strlen( filename ) + 1;
 
+	map->lfilename = buffer;
+	strcpy( map->lfilename, map->filename );
+	Q_strlwr( map->lfilename );
+	buffer += strlen( filename ) + 1;
+
 	map->fullname = buffer;
 	strcpy( map->fullname, fullname );
 	COM_RemoveColorTokens( map->fullname );
@@ -94,6 +165,7 @@ static void ML_AddMap( const char *filename, const char *fullname )
 
 	Trie_Insert( mlist_filenames_trie, map->filename, map );
 	Trie_Insert( mlist_fullnames_trie, map->fullname, map );
+	ML_CatalogAdd( map );
 
 	map->next = maplist;
 	maplist = map;
@@ -107,22 +179,19 @@ static void ML_BuildCache( void )
 {
 	int filenum;
 	mapinfo_t *map;
-	struct trie_dump_s *dump;
 
 	if( !ml_initialized )
 		return;
 
 	if( FS_FOpenFile( MLIST_CACHE, &filenum, FS_WRITE ) != -1 )
 	{
-		unsigned int i;
+		int i;
 
-		Trie_Dump( mlist_filenames_trie, "", TRIE_DUMP_VALUES, &dump );
-		for( i = 0; i < dump->size; ++i )
+		for( i = 0; i < ml_catalog_num; ++i )
 		{
-			map = ( mapinfo_t * )( dump->key_value_vector[i].value );
+			map = ml_catalog[i];
 			FS_Printf( filenum, "%s\r\n%s\r\n", map->filename, map->fullname );
 		}
-		Trie_FreeDump( dump );
 
 		FS_FCloseFile( filenum );
 	}
@@ -298,10 +367,74 @@ static void ML_InitFromMaps( void )
 	}
 }
 
-static int ML_PatternMatchesMap( void *map, void *pattern )
+/*
+* ML_PrepareSearch
+* Lowercases the pattern once and narrows globs with a literal prefix
+* down to the catalog range sharing that prefix
+*/
+static void ML_PrepareSearch( const char *pattern )
 {
-	assert( map );
-	return !pattern || Com_GlobMatch( (const char *) pattern, ( (mapinfo_t *) map )->filename, qfalse );
+	size_t prefixlen;
+
+	if( ml_search.generation == ml_catalog_generation && !strcmp( ml_search.pattern, pattern ) )
+		return;
+
+	Q_strncpyz( ml_search.pattern, pattern, sizeof( ml_search.pattern ) );
+	Q_strncpyz( ml_search.lpattern, pattern, sizeof( ml_search.lpattern ) );
+	COM_RemoveColorTokens( ml_search.lpattern );
+	Q_strlwr( ml_search.lpattern );
+	ml_search.generation = ml_catalog_generation;
+
+	prefixlen = strcspn( ml_search.lpattern, "*?[" );
+	ml_search.glob = ml_search.lpattern[prefixlen] != '\0' ? qtrue : qfalse;
+	ml_search.first = 0;
+	ml_search.last = ml_catalog_num;
+
+	// globs only apply to the filenames, which are sorted
+	if( ml_search.glob && prefixlen )
+	{
+		ml_search.first = ML_CatalogLowerBound( ml_search.lpattern, prefixlen, qfalse );
+		ml_search.last = ML_CatalogLowerBound( ml_search.lpattern, prefixlen, qtrue );
+	}
+}
+
+/*
+* ML_FindMap
+* Returns the number of the first map from start on matching the pattern, or -1.
+* Patterns with wildcards are globbed against the filename, anything else
+* is searched for in both the filename and the fullname.
+*/
+int ML_FindMap( const char *pattern, int start )
+{
+	int i;
+	mapinfo_t *map;
+
+	if( !ml_initialized || !pattern )
+		return -1;
+
+	if( start < 0 )
+		start = 0;
+
+	if( !*pattern )
+		return start < ml_catalog_num ? start : -1;
+
+	ML_PrepareSearch( pattern );
+
+	for( i = max( start, ml_search.first ); i < ml_search.last; i++ )
+	{
+		map = ml_catalog[i];
+		if( ml_search.glob )
+		{
+			if( Com_GlobMatch( ml_search.lpattern, map->lfilename, qtrue ) )
+				return i;
+		}
+		else if( strstr( map->lfilename, ml_search.lpattern ) || strstr( map->fullname, ml_search.lpattern ) )
+		{
+			return i;
+		}
+	}
+
+	return -1;
 }
 
 /*
@@ -313,12 +446,11 @@ static void ML_MapListCmd( void )
 	char *pattern;
 	mapinfo_t *map;
 	int argc = Cmd_Argc();
-	unsigned int i;
-	struct trie_dump_s *dump;
+	int i, count;
 
 	if( argc > 2 )
 	{
-		Com_Printf( "Usage: %s [rebuild]\n", Cmd_Argv(0) );
+		Com_Printf( "Usage: %s [rebuild|update|pattern]\n", Cmd_Argv(0) );
 		return;
 	}
 
@@ -343,15 +475,15 @@ static void ML_MapListCmd( void )
 		}
 	}
 
-	Trie_DumpIf( mlist_filenames_trie, "", TRIE_DUMP_VALUES, ML_PatternMatchesMap, pattern, &dump );
-	for( i = 0; i < dump->size; i++ )
+	count = 0;
+	for( i = ML_FindMap( pattern ? pattern : "", 0 ); i >= 0; i = ML_FindMap( pattern ? pattern : "", i + 1 ) )
 	{
-		map = ( mapinfo_t * )( dump->key_value_vector[i].value );
+		map = ml_catalog[i];
 		Com_Printf( "%s: %s\n", map->filename, map->fullname );
+		count++;
 	}
-	Trie_FreeDump( dump );
 
-	Com_Printf( "%d map(s) %s\n", i, pattern ? "matching" : "total" );
+	Com_Printf( "%d map(s) %s\n", count, pattern ? "matching" : "total" );
 }
 
 /*
@@ -397,7 +529,6 @@ void ML_Init( void )
 		ML_InitFromMaps();
 
 	ml_initialized = qtrue;
-	ml_flush = qtrue;
 }
 
 /*
@@ -427,7 +558,13 @@ void ML_Shutdown( void )
 		Mem_ZoneFree( map );
 	}
 
-	ml_flush = qtrue;
+	if( ml_catalog )
+	{
+		Mem_Free( ml_catalog );
+		ml_catalog = NULL;
+	}
+	ml_catalog_num = ml_catalog_size = 0;
+	ml_catalog_generation++;
 }
 
 /*
@@ -671,36 +808,16 @@ qboolean ML_ValidateFullname( const char *fullname )
 */
 size_t ML_GetMapByNum( int num, char *out, size_t size )
 {
-	static int i = 0;
-	static struct trie_dump_s *dump = NULL;
 	size_t fsize;
 	mapinfo_t *map;
 
 	if( !ml_initialized )
 		return 0;
 
-	if( ml_flush || i > num )
-	{
-		if( dump )
-		{
-			Trie_FreeDump( dump );
-			dump = NULL;
-		}
-		ml_flush = qfalse;
-	}
-
-	if( !dump )
-	{
-		i = 0;
-		Trie_Dump( mlist_filenames_trie, "", TRIE_DUMP_VALUES, &dump );
-	}
-
-	for( ; i < num && i < (int)dump->size; i++ )
-		;
-	if( i == (int)dump->size )
+	if( num < 0 || num >= ml_catalog_num )
 		return 0;
 
-	map = ( mapinfo_t * )( dump->key_value_vector[i].value );
+	map = ml_catalog[num];
 	fsize = strlen( map->filename ) + 1 + strlen( map->fullname ) + 1;
 	if( out && (fsize <= size) )
 	{
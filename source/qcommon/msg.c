@@ -276,6 +276,138 @@ char *MSG_ReadStringLine( msg_t *msg )
 	return MSG_ReadString2( msg, qtrue );
 }
 
+//==================================================
+// BIT IO
+//
+// Bits are packed lowest first, a bitstream always
+// starts and ends on a byte boundary of the message
+//==================================================
+
+#define ZIGZAG( x )		( ( (unsigned int)( x ) << 1 ) ^ (unsigned int)( ( x ) >> 31 ) )
+#define UNZIGZAG( x )	( (int)( ( x ) >> 1 ) ^ -(int)( ( x ) & 1 ) )
+
+void MSG_BeginWritingBits( msg_bits_t *bits, msg_t *msg )
+{
+	bits->msg = msg;
+	bits->bits = 0;
+	bits->numbits = 0;
+}
+
+void MSG_WriteBits( msg_bits_t *bits, unsigned int value, int numbits )
+{
+	assert( numbits >= 0 && numbits <= 32 );
+
+	if( numbits < 32 )
+		value &= ( 1u << numbits ) - 1;
+
+	bits->bits |= (quint64)value << bits->numbits;
+	bits->numbits += numbits;
+
+	while( bits->numbits >= 8 )
+	{
+		MSG_WriteByte( bits->msg, (int)( bits->bits & 255 ) );
+		bits->bits >>= 8;
+		bits->numbits -= 8;
+	}
+}
+
+/*
+* MSG_UGolombLength
+*
+* Number of bits of the exp-golomb code of the given order for the value
+*/
+static int MSG_UGolombLength( unsigned int value, int order )
+{
+	int n;
+	quint64 q = (quint64)value + ( 1u << order );
+
+	for( n = 0; q >> ( n + 1 ); n++ );
+	return 2 * n - order + 1;
+}
+
+void MSG_WriteUGolomb( msg_bits_t *bits, unsigned int value, int order )
+{
+	int n;
+	quint64 q = (quint64)value + ( 1u << order );
+
+	for( n = 0; q >> ( n + 1 ); n++ );
+
+	// zeros for the length, the leading one, then the low bits
+	MSG_WriteBits( bits, 0, n - order );
+	MSG_WriteBits( bits, 1, 1 );
+	MSG_WriteBits( bits, (unsigned int)( q & ( ( (quint64)1 << n ) - 1 ) ), n );
+}
+
+void MSG_WriteSGolomb( msg_bits_t *bits, int value, int order )
+{
+	MSG_WriteUGolomb( bits, ZIGZAG( value ), order );
+}
+
+void MSG_EndWritingBits( msg_bits_t *bits )
+{
+	if( bits->numbits > 0 )
+		MSG_WriteByte( bits->msg, (int)( bits->bits & 255 ) );
+	bits->bits = 0;
+	bits->numbits = 0;
+}
+
+void MSG_BeginReadingBits( msg_bits_t *bits, msg_t *msg )
+{
+	bits->msg = msg;
+	bits->bits = 0;
+	bits->numbits = 0;
+}
+
+unsigned int MSG_ReadBits( msg_bits_t *bits, int numbits )
+{
+	unsigned int value;
+	msg_t *msg = bits->msg;
+
+	assert( numbits >= 0 && numbits <= 32 );
+
+	while( bits->numbits < numbits )
+	{
+		// past the end reads zeros, but still moves on so the caller notices
+		if( msg->readcount < msg->cursize )
+			bits->bits |= (quint64)msg->data[msg->readcount] << bits->numbits;
+		msg->readcount++;
+		bits->numbits += 8;
+	}
+
+	value = (unsigned int)( bits->bits & ( ( (quint64)1 << numbits ) - 1 ) );
+	bits->bits >>= numbits;
+	bits->numbits -= numbits;
+	return value;
+}
+
+unsigned int MSG_ReadUGolomb( msg_bits_t *bits, int order )
+{
+	int n;
+	quint64 q;
+
+	for( n = order; !MSG_ReadBits( bits, 1 ); n++ )
+	{
+		if( n >= 32 )
+			return 0; // broken code, or reading past the end
+	}
+
+	q = ( (quint64)1 << n ) | MSG_ReadBits( bits, n );
+	return (unsigned int)( q - ( 1u << order ) );
+}
+
+int MSG_ReadSGolomb( msg_bits_t *bits, int order )
+{
+	unsigned int value = MSG_ReadUGolomb( bits, order );
+	return UNZIGZAG( value );
+}
+
+void MSG_EndReadingBits( msg_bits_t *bits )
+{
+	// the rest of the last byte is padding
+	bits->bits = 0;
+	bits->numbits = 0;
+}
+
 //==================================================
 // SPECIAL CASES
 //==================================================
@@ -755,6 +887,491 @@ void MSG_ReadDeltaEntity( msg_t *msg, entity_state_t *from, entity_state_t *to,
 		to->team = (qbyte)MSG_ReadByte( msg );
 }
 
+//==================================================
+// PACKED ENTITIES
+//
+// Bitstream entity deltas, for the clients which negotiated
+// them. Values are quantized exactly like in the byte aligned
+// deltas above, only the coding differs: origins are sent as
+// residuals to the old origin, or to the one extrapolated from
+// the two frames before, and the rarely changing fields are
+// selected by a mask only as long as the last changed one.
+//
+// entity: 1 (more), number delta, remove bit,
+//         3 origin bits, 3 angle bits, 1 (fields) [fields mask],
+//         fields, origin, angles
+//==================================================
+
+#define PACKED_NUMBER_ORDER		2
+#define PACKED_GOLOMB_ORDER		4
+#define PACKED_COORD_ORDER		4
+#define PACKED_COORD_BITS		24	// absolute coordinates, as in MSG_WriteCoord
+#define PACKED_COORD_LIMIT		( 1<<26 )
+#define PACKED_FIELDCOUNT_BITS	4
+
+enum
+{
+	PF_BITS,			// raw bits
+	PF_SBITS,			// raw bits, sign extended when read
+	PF_SIZED,			// byte count in 2 bits, then the bytes, bits set: 16 bit values are signed
+	PF_GOLOMB,			// exp-golomb code
+
+	PF_TYPE,			// type and linearProjectile
+	PF_WEAPON,			// weapon and teleported
+	PF_EVENT,			// events are not delta compressed, just 0 compressed
+	PF_ATTENUATION,
+	PF_ORIGIN2
+};
+
+typedef struct
+{
+	size_t offset;
+	int coding;
+	int bits;			// bit count, golomb order, event index or signed flag
+} packedfield_t;
+
+#define PFOFS( x ) (size_t)&( ( (entity_state_t *)0 )->x )
+
+// ordered by how often they change
+static const packedfield_t msg_packedFields[] =
+{
+	{ PFOFS( events[0] ), PF_EVENT, 0 },
+	{ PFOFS( events[1] ), PF_EVENT, 1 },
+	{ PFOFS( frame ), PF_SIZED, 1 },
+	{ PFOFS( weapon ), PF_WEAPON, 8 },
+	{ PFOFS( effects ), PF_SIZED, 1 },
+	{ PFOFS( sound ), PF_BITS, 8 },
+	{ PFOFS( solid ), PF_SBITS, 16 },
+	{ PFOFS( modelindex ), PF_GOLOMB, PACKED_GOLOMB_ORDER },
+	{ PFOFS( modelindex2 ), PF_GOLOMB, PACKED_GOLOMB_ORDER },
+	{ PFOFS( skinnum ), PF_SIZED, 1 },
+	{ PFOFS( svflags ), PF_SBITS, 16 },
+	{ PFOFS( type ), PF_TYPE, 8 },
+	{ PFOFS( light ), PF_SIZED, 0 },
+	{ PFOFS( team ), PF_BITS, 8 },
+	{ PFOFS( attenuation ), PF_ATTENUATION, 8 },
+	{ PFOFS( origin2 ), PF_ORIGIN2, PACKED_COORD_BITS },
+};
+
+#define PACKED_NUMFIELDS ( sizeof( msg_packedFields ) / sizeof( msg_packedFields[0] ) )
+
+#define PACKED_FIELD( ent, f ) ( *(int *)( (qbyte *)( ent ) + ( f )->offset ) )
+#define PACKED_QUANTIZE( x ) ( Q_rint( ( ( x )*PM_VECTOR_SNAP ) ) )
+
+/*
+* MSG_ExtrapolateEntityOrigin
+*
+* Quantized origin of the entity continuing the move from prev to from.
+* frames is the distance from the from frame to the new one, prevFrames
+* from the prev frame to the from frame
+*/
+qboolean MSG_ExtrapolateEntityOrigin( const entity_state_t *from, const entity_state_t *prev, int frames, int prevFrames, int *predicted )
+{
+	int i, cur, old;
+	qint64 p;
+
+	if( from->linearProjectile || prev->linearProjectile || frames <= 0 || prevFrames <= 0 )
+		return qfalse;
+
+	for( i = 0; i < 3; i++ )
+	{
+		cur = PACKED_QUANTIZE( from->origin[i] );
+		old = PACKED_QUANTIZE( prev->origin[i] );
+		p = cur + (qint64)( cur - old ) * frames / prevFrames;
+		predicted[i] = (int)bound( -PACKED_COORD_LIMIT, p, PACKED_COORD_LIMIT );
+	}
+
+	return qtrue;
+}
+
+/*
+* MSG_PackedOriginBase
+*
+* The values origin residuals are relative to. The client only has the
+* same old origin when the entity didn't switch between moving on its own
+* and being a linear projectile, the origin is always sent in full then
+*/
+static void MSG_PackedOriginBase( const entity_state_t *from, const entity_state_t *to, const int *predicted, int *base )
+{
+	int i;
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( to->linearProjectile != from->linearProjectile )
+			base[i] = 0;
+		else if( to->linearProjectile )
+			base[i] = PACKED_QUANTIZE( from->linearProjectileVelocity[i] );
+		else if( predicted )
+			base[i] = bound( -PACKED_COORD_LIMIT, predicted[i], PACKED_COORD_LIMIT );
+		else
+			base[i] = PACKED_QUANTIZE( from->origin[i] );
+	}
+}
+
+/*
+* MSG_WritePackedCoord
+*/
+static void MSG_WritePackedCoord( msg_bits_t *bits, int value, int base )
+{
+	unsigned int code = ZIGZAG( value - base );
+
+	// far from the prediction, send it like the byte aligned deltas do
+	if( value >= -( 1<<( PACKED_COORD_BITS-1 ) ) && value < ( 1<<( PACKED_COORD_BITS-1 ) )
+		&& MSG_UGolombLength( code, PACKED_COORD_ORDER ) > PACKED_COORD_BITS )
+	{
+		MSG_WriteBits( bits, 1, 1 );
+		MSG_WriteBits( bits, value, PACKED_COORD_BITS );
+		return;
+	}
+
+	MSG_WriteBits( bits, 0, 1 );
+	MSG_WriteUGolomb( bits, code, PACKED_COORD_ORDER );
+}
+
+/*
+* MSG_ReadPackedCoord
+*/
+static int MSG_ReadPackedCoord( msg_bits_t *bits, int base )
+{
+	unsigned int code;
+
+	if( MSG_ReadBits( bits, 1 ) )
+	{
+		code = MSG_ReadBits( bits, PACKED_COORD_BITS );
+		if( code & ( 1<<( PACKED_COORD_BITS-1 ) ) )
+			code |= ~( ( 1u<<PACKED_COORD_BITS ) - 1 );
+		return (int)code;
+	}
+
+	code = MSG_ReadUGolomb( bits, PACKED_COORD_ORDER );
+	return base + UNZIGZAG( code );
+}
+
+/*
+* MSG_PackedFieldChanged
+*/
+static qboolean MSG_PackedFieldChanged( const packedfield_t *f, const entity_state_t *from, const entity_state_t *to, qboolean updateOtherOrigin )
+{
+	switch( f->coding )
+	{
+	case PF_TYPE:
+		return to->type != from->type || to->linearProjectile != from->linearProjectile;
+	case PF_WEAPON:
+		return to->weapon != from->weapon || to->teleported != from->teleported;
+	case PF_EVENT:
+		return to->events[f->bits] != 0;
+	case PF_ATTENUATION:
+		return to->attenuation != from->attenuation;
+	case PF_ORIGIN2:
+		return updateOtherOrigin && !VectorCompare( to->origin2, from->origin2 );
+	default:
+		return PACKED_FIELD( to, f ) != PACKED_FIELD( from, f );
+	}
+}
+
+/*
+* MSG_WritePackedField
+*/
+static void MSG_WritePackedField( msg_bits_t *bits, const packedfield_t *f, const entity_state_t *to )
+{
+	int i;
+	unsigned int value;
+
+	switch( f->coding )
+	{
+	case PF_BITS:
+	case PF_SBITS:
+		MSG_WriteBits( bits, PACKED_FIELD( to, f ), f->bits );
+		break;
+	case PF_SIZED:
+		// like the byte aligned deltas, a value using the upper half is sent in full
+		value = PACKED_FIELD( to, f );
+		if( f->bits )
+			i = ( value & 0xFFFF0000 ) ? 3 : ( value & 0xFF00 ) ? 1 : 0;
+		else
+			i = ( value & 0xFF000000 ) ? 3 : ( value & 0xFF0000 ) ? 2 : ( value & 0xFF00 ) ? 1 : 0;
+		MSG_WriteBits( bits, i, 2 );
+		MSG_WriteBits( bits, value, ( i + 1 ) * 8 );
+		break;
+	case PF_GOLOMB:
+		MSG_WriteUGolomb( bits, PACKED_FIELD( to, f ), f->bits );
+		break;
+	case PF_TYPE:
+		MSG_WriteBits( bits, ( to->type & ~ET_INVERSE ) | ( to->linearProjectile ? ET_INVERSE : 0 ), f->bits );
+		break;
+	case PF_WEAPON:
+		MSG_WriteBits( bits, ( to->weapon & ~ET_INVERSE ) | ( to->teleported ? ET_INVERSE : 0 ), f->bits );
+		break;
+	case PF_EVENT:
+		i = f->bits;
+		MSG_WriteBits( bits, to->events[i] & ~EV_INVERSE, 7 );
+		MSG_WriteBits( bits, to->eventParms[i] ? 1 : 0, 1 );
+		if( to->eventParms[i] )
+			MSG_WriteBits( bits, (qbyte)to->eventParms[i], 8 );
+		break;
+	case PF_ATTENUATION:
+		MSG_WriteBits( bits, (qbyte)( to->attenuation * 16 ), f->bits );
+		break;
+	case PF_ORIGIN2:
+		for( i = 0; i < 3; i++ )
+			MSG_WriteBits( bits, PACKED_QUANTIZE( to->origin2[i] ), f->bits );
+		break;
+	default:
+		assert( 0 );
+		break;
+	}
+}
+
+/*
+* MSG_ReadPackedField
+*/
+static void MSG_ReadPackedField( msg_bits_t *bits, const packedfield_t *f, entity_state_t *to )
+{
+	int i;
+	unsigned int value;
+
+	switch( f->coding )
+	{
+	case PF_BITS:
+		PACKED_FIELD( to, f ) = MSG_ReadBits( bits, f->bits );
+		break;
+	case PF_SBITS:
+		value = MSG_ReadBits( bits, f->bits );
+		if( value & ( 1u<<( f->bits-1 ) ) )
+			value |= ~( ( 1u<<f->bits ) - 1 );
+		PACKED_FIELD( to, f ) = (int)value;
+		break;
+	case PF_SIZED:
+		i = MSG_ReadBits( bits, 2 );
+		value = MSG_ReadBits( bits, ( i + 1 ) * 8 );
+		if( f->bits && i == 1 )
+			value = (short)value;
+		PACKED_FIELD( to, f ) = (int)value;
+		break;
+	case PF_GOLOMB:
+		PACKED_FIELD( to, f ) = MSG_ReadUGolomb( bits, f->bits );
+		break;
+	case PF_TYPE:
+		value = MSG_ReadBits( bits, f->bits );
+		to->type = value & ~ET_INVERSE;
+		to->linearProjectile = ( value & ET_INVERSE ) ? qtrue : qfalse;
+		break;
+	case PF_WEAPON:
+		value = MSG_ReadBits( bits, f->bits );
+		to->weapon = value & ~ET_INVERSE;
+		to->teleported = ( value & ET_INVERSE ) ? qtrue : qfalse;
+		break;
+	case PF_EVENT:
+		i = f->bits;
+		to->events[i] = MSG_ReadBits( bits, 7 );
+		to->eventParms[i] = MSG_ReadBits( bits, 1 ) ? MSG_ReadBits( bits, 8 ) : 0;
+		break;
+	case PF_ATTENUATION:
+		to->attenuation = (float)MSG_ReadBits( bits, f->bits ) / 16.0;
+		break;
+	case PF_ORIGIN2:
+		for( i = 0; i < 3; i++ )
+		{
+			value = MSG_ReadBits( bits, f->bits );
+			if( value & ( 1u<<( f->bits-1 ) ) )
+				value |= ~( ( 1u<<f->bits ) - 1 );
+			to->origin2[i] = (float)(int)value*( 1.0/PM_VECTOR_SNAP );
+		}
+		break;
+	default:
+		assert( 0 );
+		break;
+	}
+}
+
+/*
+* MSG_WritePackedDeltaEntity
+*
+* Writes an entity of a packed packetentities bitstream, lastnum is the
+* number of the entity written before it, or 0. predicted is the
+* extrapolated origin, if any. Returns false if there was nothing to send
+*/
+qboolean MSG_WritePackedDeltaEntity( msg_bits_t *bits, int lastnum, const entity_state_t *from, const entity_state_t *to,
+								   const int *predicted, qboolean force, qboolean updateOtherOrigin )
+{
+	unsigned int i;
+	int originbits, anglebits, numfields, fieldbits;
+	int base[3];
+	const float *origin, *oldorigin;
+
+	if( !to->number )
+		Com_Error( ERR_FATAL, "MSG_WritePackedDeltaEntity: Unset entity number" );
+	else if( to->number >= MAX_EDICTS )
+		Com_Error( ERR_FATAL, "MSG_WritePackedDeltaEntity: Entity number >= MAX_EDICTS" );
+	else if( to->number <= lastnum )
+		Com_Error( ERR_FATAL, "MSG_WritePackedDeltaEntity: Entities out of order" );
+
+	if( to->linearProjectile )
+	{
+		origin = to->linearProjectileVelocity;
+		oldorigin = from->linearProjectileVelocity;
+	}
+	else
+	{
+		origin = to->origin;
+		oldorigin = from->origin;
+	}
+
+	originbits = anglebits = 0;
+	for( i = 0; i < 3; i++ )
+	{
+		if( origin[i] != oldorigin[i] || to->linearProjectile != from->linearProjectile )
+			originbits |= 1<<i;
+		if( to->angles[i] != from->angles[i] )
+			anglebits |= 1<<i;
+	}
+
+	fieldbits = numfields = 0;
+	for( i = 0; i < PACKED_NUMFIELDS; i++ )
+	{
+		if( MSG_PackedFieldChanged( &msg_packedFields[i], from, to, updateOtherOrigin ) )
+		{
+			fieldbits |= 1<<i;
+			numfields = i + 1;
+		}
+	}
+
+	if( !originbits && !anglebits && !fieldbits && !force )
+		return qfalse; // nothing to send!
+
+	MSG_WriteBits( bits, 1, 1 );
+	MSG_WriteUGolomb( bits, to->number - lastnum - 1, PACKED_NUMBER_ORDER );
+	MSG_WriteBits( bits, 0, 1 );
+
+	MSG_WriteBits( bits, originbits, 3 );
+	MSG_WriteBits( bits, anglebits, 3 );
+	MSG_WriteBits( bits, numfields ? 1 : 0, 1 );
+	if( numfields )
+	{
+		// the last field is implied by the count
+		MSG_WriteBits( bits, numfields - 1, PACKED_FIELDCOUNT_BITS );
+		MSG_WriteBits( bits, fieldbits, numfields - 1 );
+
+		for( i = 0; i < (unsigned)numfields; i++ )
+		{
+			if( fieldbits & ( 1<<i ) )
+				MSG_WritePackedField( bits, &msg_packedFields[i], to );
+		}
+	}
+
+	MSG_PackedOriginBase( from, to, predicted, base );
+	for( i = 0; i < 3; i++ )
+	{
+		if( originbits & ( 1<<i ) )
+			MSG_WritePackedCoord( bits, PACKED_QUANTIZE( origin[i] ), base[i] );
+	}
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( !( anglebits & ( 1<<i ) ) )
+			continue;
+		if( to->solid == SOLID_BMODEL )
+			MSG_WriteBits( bits, ANGLE2SHORT( to->angles[i] ), 16 );
+		else
+			MSG_WriteBits( bits, ANGLE2BYTE( to->angles[i] ), 8 );
+	}
+
+	return qtrue;
+}
+
+/*
+* MSG_WritePackedEntityRemove
+*/
+void MSG_WritePackedEntityRemove( msg_bits_t *bits, int lastnum, int number )
+{
+	if( number <= lastnum || number >= MAX_EDICTS )
+		Com_Error( ERR_FATAL, "MSG_WritePackedEntityRemove: Invalid entity number" );
+
+	MSG_WriteBits( bits, 1, 1 );
+	MSG_WriteUGolomb( bits, number - lastnum - 1, PACKED_NUMBER_ORDER );
+	MSG_WriteBits( bits, 1, 1 );
+}
+
+/*
+* MSG_ReadPackedEntityNumber
+*
+* Returns 0 at the end of the entities
+*/
+int MSG_ReadPackedEntityNumber( msg_bits_t *bits, int lastnum, qboolean *remove )
+{
+	unsigned int delta;
+
+	*remove = qfalse;
+	if( !MSG_ReadBits( bits, 1 ) )
+		return 0;
+
+	delta = MSG_ReadUGolomb( bits, PACKED_NUMBER_ORDER );
+	if( delta >= MAX_EDICTS )
+		return MAX_EDICTS;
+
+	*remove = MSG_ReadBits( bits, 1 ) ? qtrue : qfalse;
+	return lastnum + 1 + (int)delta;
+}
+
+/*
+* MSG_ReadPackedDeltaEntity
+*
+* Reads the rest of an entity after MSG_ReadPackedEntityNumber
+*/
+void MSG_ReadPackedDeltaEntity( msg_bits_t *bits, const entity_state_t *from, entity_state_t *to, int number, const int *predicted )
+{
+	unsigned int i;
+	int originbits, anglebits, numfields, fieldbits;
+	int base[3];
+	float *origin;
+
+	// set everything to the state we are delta'ing from
+	*to = *from;
+
+	to->number = number;
+
+	originbits = MSG_ReadBits( bits, 3 );
+	anglebits = MSG_ReadBits( bits, 3 );
+
+	fieldbits = 0;
+	if( MSG_ReadBits( bits, 1 ) )
+	{
+		numfields = MSG_ReadBits( bits, PACKED_FIELDCOUNT_BITS ) + 1;
+		fieldbits = MSG_ReadBits( bits, numfields - 1 ) | ( 1<<( numfields - 1 ) );
+	}
+
+	for( i = 0; i < PACKED_NUMFIELDS; i++ )
+	{
+		if( fieldbits & ( 1<<i ) )
+		{
+			MSG_ReadPackedField( bits, &msg_packedFields[i], to );
+		}
+		else if( msg_packedFields[i].coding == PF_EVENT )
+		{
+			to->events[msg_packedFields[i].bits] = 0;
+			to->eventParms[msg_packedFields[i].bits] = 0;
+		}
+	}
+
+	origin = to->linearProjectile ? to->linearProjectileVelocity : to->origin;
+	MSG_PackedOriginBase( from, to, predicted, base );
+	for( i = 0; i < 3; i++ )
+	{
+		if( originbits & ( 1<<i ) )
+			origin[i] = (float)MSG_ReadPackedCoord( bits, base[i] )*( 1.0/PM_VECTOR_SNAP );
+	}
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( !( anglebits & ( 1<<i ) ) )
+			continue;
+		if( to->solid == SOLID_BMODEL )
+			to->angles[i] = SHORT2ANGLE( (short)MSG_ReadBits( bits, 16 ) );
+		else
+			to->angles[i] = BYTE2ANGLE( MSG_ReadBits( bits, 8 ) );
+	}
+}
+
 
 void MSG_WriteDeltaUsercmd( msg_t *buf, usercmd_t *from, usercmd_t *cmd )
 {
@@ -384,6 +384,33 @@ int Netchan_DecompressMessage( msg_t *msg )
 	return length;
 }
 
+/*
+* Netchan_CompressChunk
+* 
+* Compresses a block that is sent inside a message, returns the compressed length
+* or 0 if it didn't fit in outlen
+*/
+int Netchan_CompressChunk( qbyte *in, int inlen, qbyte *out, int outlen )
+{
+	int length;
+
+	length = Netchan_ZLibCompressChunk( in, inlen, out, outlen, Z_BEST_COMPRESSION, -MAX_WBITS );
+	return length < 0 ? 0 : length;
+}
+
+/*
+* Netchan_DecompressChunk
+* 
+* Returns the decompressed length or -1 on error
+*/
+int Netchan_DecompressChunk( qbyte *in, int inlen, qbyte *out, int outlen )
+{
+	int length;
+
+	length = Netchan_ZLibDecompressChunk( in, inlen, out, outlen, -MAX_WBITS );
+	return length < 0 ? -1 : length;
+}
+
 /*
 * Netchan_DropAllFragments
 * 
@@ -61,6 +61,13 @@ typedef struct
 	qboolean compressed;
 } msg_t;
 
+typedef struct
+{
+	msg_t *msg;
+	quint64 bits;			// not yet written, or already read bits
+	int numbits;
+} msg_bits_t;
+
 // msg.c
 void MSG_Init( msg_t *buf, qbyte *data, size_t length );
 void MSG_Clear( msg_t *buf );
@@ -113,6 +120,24 @@ void MSG_ReadDir( msg_t *sb, vec3_t vector );
 void MSG_ReadData( msg_t *sb, void *buffer, size_t length );
 int MSG_SkipData( msg_t *sb, size_t length );
 
+void MSG_BeginWritingBits( msg_bits_t *bits, msg_t *msg );
+void MSG_WriteBits( msg_bits_t *bits, unsigned int value, int numbits );
+void MSG_WriteUGolomb( msg_bits_t *bits, unsigned int value, int order );
+void MSG_WriteSGolomb( msg_bits_t *bits, int value, int order );
+void MSG_EndWritingBits( msg_bits_t *bits );
+void MSG_BeginReadingBits( msg_bits_t *bits, msg_t *msg );
+unsigned int MSG_ReadBits( msg_bits_t *bits, int numbits );
+unsigned int MSG_ReadUGolomb( msg_bits_t *bits, int order );
+int MSG_ReadSGolomb( msg_bits_t *bits, int order );
+void MSG_EndReadingBits( msg_bits_t *bits );
+
+qboolean MSG_ExtrapolateEntityOrigin( const entity_state_t *from, const entity_state_t *prev, int frames, int prevFrames, int *predicted );
+qboolean MSG_WritePackedDeltaEntity( msg_bits_t *bits, int lastnum, const entity_state_t *from, const entity_state_t *to,
+								   const int *predicted, qboolean force, qboolean updateOtherOrigin );
+void MSG_WritePackedEntityRemove( msg_bits_t *bits, int lastnum, int number );
+int MSG_ReadPackedEntityNumber( msg_bits_t *bits, int lastnum, qboolean *remove );
+void MSG_ReadPackedDeltaEntity( msg_bits_t *bits, const entity_state_t *from, entity_state_t *to, int number, const int *predicted );
+
 //============================================================================
 
 typedef struct purelist_s
@@ -139,7 +164,8 @@ void Com_FreePureList( purelist_t **purelist );
 
 void SNAP_ParseBaseline( msg_t *msg, entity_state_t *baselines );
 void SNAP_SkipFrame( msg_t *msg, struct snapshot_s *header );
-struct snapshot_s *SNAP_ParseFrame( msg_t *msg, struct snapshot_s *lastFrame, int *suppressCount, struct snapshot_s *backup, entity_state_t *baselines, int showNet );
+struct snapshot_s *SNAP_ParseFrame( msg_t *msg, struct snapshot_s *lastFrame, int *suppressCount, struct snapshot_s *backup, entity_state_t *baselines, qboolean packedEntities, int showNet );
+void SNAP_ReadPacketEntities( msg_t *msg, struct snapshot_s *oldframe, struct snapshot_s *prevframe, struct snapshot_s *newframe, entity_state_t *baselines, qboolean packedEntities, int showNet );
 
 void SNAP_WriteFrameSnapToClient( struct ginfo_s *gi, struct client_s *client, msg_t *msg, unsigned int frameNum, unsigned int gameTime,
 								 entity_state_t *baselines, struct client_entities_s *client_entities,
@@ -157,6 +183,10 @@ int SNAP_ReadDemoMessage( int demofile, msg_t *msg );
 void SNAP_BeginDemoRecording( int demofile, unsigned int spawncount, unsigned int snapFrameTime, 
 								const char *sv_name, unsigned int sv_bitflags, purelist_t *purelist, 
 								char *configstrings, entity_state_t *baselines );
+qbyte *SNAP_BuildDemoStart( size_t *size, size_t *meta_size, const char *meta_data, size_t meta_data_realsize, 
+								unsigned int spawncount, unsigned int snapFrameTime, const char *sv_name, 
+								unsigned int sv_bitflags, purelist_t *purelist, char *configstrings, 
+								entity_state_t *baselines );
 void SNAP_StopDemoRecording( int demofile );
 void SNAP_WriteDemoMetaData( const char *filename, const char *meta_data, size_t meta_data_realsize );
 size_t SNAP_ClearDemoMeta( char *meta_data, size_t meta_data_max_size );
@@ -251,6 +281,12 @@ enum svc_ops_e
 	svc_extension			// for future expansion
 };
 
+// svc_extension ids
+#define SVC_EXT_GAMESTATE		1			// [long] size [...] compressed configstrings and baselines
+
+// largest uncompressed gamestate: every configstring and a baseline for every entity
+#define MAX_GAMESTATE_SIZE		( MAX_CONFIGSTRINGS * ( 2 + MAX_CONFIGSTRING_CHARS ) + 2 + MAX_EDICTS * ( sizeof( entity_state_t ) + 16 ) )
+
 //==============================================
 
 //
@@ -274,6 +310,12 @@ enum clc_ops_e
 #define SV_BITFLAGS_TVSERVER		( 1<<2 )
 #define SV_BITFLAGS_HTTP			( 1<<3 )
 #define SV_BITFLAGS_HTTP_BASEURL	( 1<<4 )
+#define SV_BITFLAGS_PACKEDENTITIES	( 1<<5 )	// packetentities are sent as a bitstream
+#define SV_BITFLAGS_GAMESTATE		( 1<<6 )	// the gamestate can be requested as a single message
+
+// connect flags
+#define CONNECT_FLAG_TVCLIENT		( 1<<0 )
+#define CONNECT_FLAG_PACKEDENTITIES	( 1<<1 )	// the client can read packed packetentities
 
 // framesnap flags
 #define FRAMESNAP_FLAG_DELTA		( 1<<0 )
@@ -699,6 +741,8 @@ qboolean Netchan_PushAllFragments( netchan_t *chan );
 qboolean Netchan_TransmitNextFragment( netchan_t *chan );
 int Netchan_CompressMessage( msg_t *msg );
 int Netchan_DecompressMessage( msg_t *msg );
+int Netchan_CompressChunk( qbyte *in, int inlen, qbyte *out, int outlen );
+int Netchan_DecompressChunk( qbyte *in, int inlen, qbyte *out, int outlen );
 void Netchan_OutOfBand( const socket_t *socket, const netadr_t *address, size_t length, const qbyte *data );
 void Netchan_OutOfBandPrint( const socket_t *socket, const netadr_t *address, const char *format, ... );
 int Netchan_GamePort( void );
@@ -944,6 +988,11 @@ void	Sys_AppActivate( void );
 unsigned int	Sys_Milliseconds( void );
 quint64		Sys_Microseconds( void );
 void		Sys_Sleep( unsigned int millis );
+int		Sys_NumberOfProcessors( void );
+
+int		Sys_ForkInstance( void );
+int		Sys_ReapInstance( void );
+void	Sys_KillInstance( int pid );
 
 char	*Sys_ConsoleInput( void );
 void	Sys_ConsoleOutput( char *string );
@@ -970,14 +1019,7 @@ CPU FEATURES
 ==============================================================
 */
 
-#define QCPU_HAS_RDTSC		0x00000001
-#define QCPU_HAS_MMX		0x00000002
-#define QCPU_HAS_MMXEXT		0x00000004
-#define QCPU_HAS_3DNOW		0x00000010
-#define QCPU_HAS_3DNOWEXT	0x00000020
-#define QCPU_HAS_SSE		0x00000040
-#define QCPU_HAS_SSE2		0x00000080
-
+// the QCPU_HAS_ flags are in q_arch.h
 unsigned int COM_CPUFeatures( void );
 
 /*
@@ -1056,6 +1098,7 @@ const char *ML_GetFilenameExt( const char *fullname, qboolean recursive );
 const char *ML_GetFilename( const char *fullname );
 const char *ML_GetFullname( const char *filename );
 size_t ML_GetMapByNum( int num, char *out, size_t size );
+int ML_FindMap( const char *pattern, int start );
 
 qboolean ML_FilenameExists( const char *filename );
 
@@ -1067,6 +1110,32 @@ char **ML_CompleteBuildList( const char *partial );
 /*
 ==============================================================
 
+DEMO INDEX
+
+==============================================================
+*/
+void DI_Init( void );
+void DI_Shutdown( void );
+
+int DI_GetFileList( const char *dir, const char *filter, const char *sort, char *buf, size_t bufsize, int start, int end );
+size_t DI_GetMetaData( const char *path, char *meta_data, size_t meta_data_size );
+
+/*
+==============================================================
+
+CONSOLE LOG
+
+==============================================================
+*/
+
+qboolean Log_Open( const char *filename, qboolean append );
+void Log_SetOptions( qboolean timestamps, qboolean flush, int rotateSize, int rotateTime, int rotateKeep );
+void Log_Write( time_t stamp, const char *msg );
+void Log_Shutdown( void );
+
+/*
+==============================================================
+
 MULTITHREADING
 
 ==============================================================
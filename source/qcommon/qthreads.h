@@ -24,6 +24,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 struct qmutex_s;
 typedef struct qmutex_s qmutex_t;
 
+struct qcondvar_s;
+typedef struct qcondvar_s qcondvar_t;
+
 struct qthread_s;
 typedef struct qthread_s qthread_t;
 
@@ -32,6 +35,15 @@ void QMutex_Destroy( qmutex_t **pmutex );
 void QMutex_Lock( qmutex_t *mutex );
 void QMutex_Unlock( qmutex_t *mutex );
 
+qcondvar_t *QCondVar_Create( void );
+void QCondVar_Destroy( qcondvar_t **pcond );
+void QCondVar_Wait( qcondvar_t *cond, qmutex_t *mutex );
+void QCondVar_Wake( qcondvar_t *cond );
+void QCondVar_WakeAll( qcondvar_t *cond );
+
+int QAtomic_Add( volatile int *value, int add );
+qboolean QAtomic_CAS( volatile int *value, int oldval, int newval );
+
 qthread_t *QThread_Create( void *(*routine) (void*), void *param );
 void QThread_Join( qthread_t *thread );
 
@@ -20,13 +20,21 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 
-#define DEMO_SAFEWRITE(demofile,msg,force) \
+#define DEMO_SAFEWRITE(out,msg,force) \
 	if( force || (msg)->cursize > (msg)->maxsize / 2 ) \
 	{ \
-		SNAP_RecordDemoMessage( demofile, msg, 0 ); \
+		SNAP_WriteDemoOutput( out, msg ); \
 		MSG_Clear( msg ); \
 	}
 
+// demo messages go either to a file or to a growing memory buffer
+typedef struct
+{
+	int demofile;
+	qbyte *data;
+	size_t size, maxsize;
+} snap_demooutput_t;
+
 static char dummy_meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 
 /*
@@ -50,6 +58,34 @@ void SNAP_RecordDemoMessage( int demofile, msg_t *msg, int offset )
 	FS_Write( msg->data + offset, len, demofile );
 }
 
+/*
+* SNAP_WriteDemoOutput
+*/
+static void SNAP_WriteDemoOutput( snap_demooutput_t *out, msg_t *msg )
+{
+	int len;
+
+	if( out->demofile )
+	{
+		SNAP_RecordDemoMessage( out->demofile, msg, 0 );
+		return;
+	}
+
+	if( !msg->cursize )
+		return;
+
+	if( out->size + 4 + msg->cursize > out->maxsize )
+	{
+		out->maxsize = max( out->maxsize * 2, out->size + 4 + msg->cursize );
+		out->data = out->data ? Mem_Realloc( out->data, out->maxsize ) : Mem_ZoneMalloc( out->maxsize );
+	}
+
+	len = LittleLong( msg->cursize );
+	memcpy( out->data + out->size, &len, 4 );
+	memcpy( out->data + out->size + 4, msg->data, msg->cursize );
+	out->size += 4 + msg->cursize;
+}
+
 /*
 * SNAP_ReadDemoMessage
 */
@@ -131,7 +167,8 @@ static void SNAP_RecordDemoMetaDataMessage( int demofile, msg_t *msg )
 	complevel = FS_GetCompressionLevel( demofile );
 	FS_SetCompressionLevel( demofile, 0 );
 
-	DEMO_SAFEWRITE( demofile, msg, qtrue );
+	SNAP_RecordDemoMessage( demofile, msg, 0 );
+	MSG_Clear( msg );
 
 	FS_SetCompressionLevel( demofile, complevel );
 
@@ -139,51 +176,45 @@ static void SNAP_RecordDemoMetaDataMessage( int demofile, msg_t *msg )
 }
 
 /*
-* SNAP_BeginDemoRecording
+* SNAP_WriteDemoStartMessages
+*
+* Serverdata, configstrings and baselines
 */
-void SNAP_BeginDemoRecording( int demofile, unsigned int spawncount, unsigned int snapFrameTime, 
-	const char *sv_name, unsigned int sv_bitflags, purelist_t *purelist, char *configstrings, 
-	entity_state_t *baselines )
+static void SNAP_WriteDemoStartMessages( snap_demooutput_t *out, msg_t *msg, unsigned int spawncount, 
+	unsigned int snapFrameTime, const char *sv_name, unsigned int sv_bitflags, purelist_t *purelist, 
+	char *configstrings, entity_state_t *baselines )
 {
 	unsigned int i;
-	msg_t msg;
-	qbyte msg_buffer[MAX_MSGLEN];
 	purelist_t *purefile;
 	entity_state_t nullstate;
 	entity_state_t *base;
 
-	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
-
-	SNAP_DemoMetaDataMessage( &msg, "", 0 );
-
-	SNAP_RecordDemoMetaDataMessage( demofile, &msg );
-
 	// serverdata message
-	MSG_WriteByte( &msg, svc_serverdata );
-	MSG_WriteLong( &msg, APP_PROTOCOL_VERSION );
-	MSG_WriteLong( &msg, spawncount );
-	MSG_WriteShort( &msg, (unsigned short)snapFrameTime );
-	MSG_WriteString( &msg, FS_BaseGameDirectory() );
-	MSG_WriteString( &msg, FS_GameDirectory() );
-	MSG_WriteShort( &msg, -1 ); // playernum
-	MSG_WriteString( &msg, sv_name ); // level name
-	MSG_WriteByte( &msg, sv_bitflags & ~SV_BITFLAGS_HTTP ); // sv_bitflags
+	MSG_WriteByte( msg, svc_serverdata );
+	MSG_WriteLong( msg, APP_PROTOCOL_VERSION );
+	MSG_WriteLong( msg, spawncount );
+	MSG_WriteShort( msg, (unsigned short)snapFrameTime );
+	MSG_WriteString( msg, FS_BaseGameDirectory() );
+	MSG_WriteString( msg, FS_GameDirectory() );
+	MSG_WriteShort( msg, -1 ); // playernum
+	MSG_WriteString( msg, sv_name ); // level name
+	MSG_WriteByte( msg, sv_bitflags & ~SV_BITFLAGS_HTTP ); // sv_bitflags
 
 	// pure files
 	i = Com_CountPureListFiles( purelist );
 	if( i > (short)0x7fff )
 		Com_Error( ERR_DROP, "Error: Too many pure files." );
 
-	MSG_WriteShort( &msg, i );
+	MSG_WriteShort( msg, i );
 
 	purefile = purelist;
 	while( purefile )
 	{
-		MSG_WriteString( &msg, purefile->filename );
-		MSG_WriteLong( &msg, purefile->checksum );
+		MSG_WriteString( msg, purefile->filename );
+		MSG_WriteLong( msg, purefile->checksum );
 		purefile = purefile->next;
 
-		DEMO_SAFEWRITE( demofile, &msg, qfalse );
+		DEMO_SAFEWRITE( out, msg, qfalse );
 	}
 
 	// config strings
@@ -192,10 +223,10 @@ void SNAP_BeginDemoRecording( int demofile, unsigned int spawncount, unsigned in
 		const char *configstring = configstrings + i * MAX_CONFIGSTRING_CHARS;
 		if( configstring[0] )
 		{
-			MSG_WriteByte( &msg, svc_servercs );
-			MSG_WriteString( &msg, va( "cs %i \"%s\"", i, configstring ) );
+			MSG_WriteByte( msg, svc_servercs );
+			MSG_WriteString( msg, va( "cs %i \"%s\"", i, configstring ) );
 
-			DEMO_SAFEWRITE( demofile, &msg, qfalse );
+			DEMO_SAFEWRITE( out, msg, qfalse );
 		}
 	}
 
@@ -207,20 +238,74 @@ void SNAP_BeginDemoRecording( int demofile, unsigned int spawncount, unsigned in
 		base = &baselines[i];
 		if( base->modelindex || base->sound || base->effects )
 		{
-			MSG_WriteByte( &msg, svc_spawnbaseline );
-			MSG_WriteDeltaEntity( &nullstate, base, &msg, qtrue, qtrue );
+			MSG_WriteByte( msg, svc_spawnbaseline );
+			MSG_WriteDeltaEntity( &nullstate, base, msg, qtrue, qtrue );
 
-			DEMO_SAFEWRITE( demofile, &msg, qfalse );
+			DEMO_SAFEWRITE( out, msg, qfalse );
 		}
 	}
 
 	// client expects the server data to be in a separate packet
-	DEMO_SAFEWRITE( demofile, &msg, qtrue );
+	DEMO_SAFEWRITE( out, msg, qtrue );
+
+	MSG_WriteByte( msg, svc_servercs );
+	MSG_WriteString( msg, "precache" );
+
+	DEMO_SAFEWRITE( out, msg, qtrue );
+}
+
+/*
+* SNAP_BeginDemoRecording
+*/
+void SNAP_BeginDemoRecording( int demofile, unsigned int spawncount, unsigned int snapFrameTime, 
+	const char *sv_name, unsigned int sv_bitflags, purelist_t *purelist, char *configstrings, 
+	entity_state_t *baselines )
+{
+	msg_t msg;
+	qbyte msg_buffer[MAX_MSGLEN];
+	snap_demooutput_t out;
+
+	memset( &out, 0, sizeof( out ) );
+	out.demofile = demofile;
+
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+
+	SNAP_DemoMetaDataMessage( &msg, "", 0 );
+
+	SNAP_RecordDemoMetaDataMessage( demofile, &msg );
+
+	SNAP_WriteDemoStartMessages( &out, &msg, spawncount, snapFrameTime, sv_name, sv_bitflags, 
+		purelist, configstrings, baselines );
+}
+
+/*
+* SNAP_BuildDemoStart
+*
+* Puts the messages SNAP_BeginDemoRecording would write, with the given meta
+* data, into a buffer from the zone, each one prefixed by its length. The
+* meta data message comes first and takes meta_size bytes of it.
+*/
+qbyte *SNAP_BuildDemoStart( size_t *size, size_t *meta_size, const char *meta_data, size_t meta_data_realsize, 
+	unsigned int spawncount, unsigned int snapFrameTime, const char *sv_name, unsigned int sv_bitflags, 
+	purelist_t *purelist, char *configstrings, entity_state_t *baselines )
+{
+	msg_t msg;
+	qbyte msg_buffer[MAX_MSGLEN];
+	snap_demooutput_t out;
+
+	memset( &out, 0, sizeof( out ) );
+
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+
+	SNAP_DemoMetaDataMessage( &msg, meta_data, meta_data_realsize );
+	DEMO_SAFEWRITE( &out, &msg, qtrue );
+	*meta_size = out.size;
 
-	MSG_WriteByte( &msg, svc_servercs );
-	MSG_WriteString( &msg, "precache" );
+	SNAP_WriteDemoStartMessages( &out, &msg, spawncount, snapFrameTime, sv_name, sv_bitflags, 
+		purelist, configstrings, baselines );
 
-	DEMO_SAFEWRITE( demofile, &msg, qtrue );
+	*size = out.size;
+	return out.data;
 }
 
 /*
@@ -455,6 +455,191 @@ static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot
 	}
 }
 
+/*
+* SNAP_PackedPrevEntity
+*
+* The state of the entity in the frame before the delta frame, if it was there
+*/
+static entity_state_t *SNAP_PackedPrevEntity( snapshot_t *prevframe, int *previndex, int number )
+{
+	entity_state_t *state;
+
+	if( !prevframe )
+		return NULL;
+
+	for( ; *previndex < prevframe->numEntities; ( *previndex )++ )
+	{
+		state = &prevframe->parsedEntities[*previndex & ( MAX_PARSE_ENTITIES-1 )];
+		if( state->number == number )
+			return state;
+		if( state->number > number )
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+* SNAP_ParsePackedEntities
+*
+* The bitstream version of SNAP_ParsePacketEntities. Entities present in
+* prevframe too get their origin relative to the extrapolated one
+*/
+static void SNAP_ParsePackedEntities( msg_t *msg, snapshot_t *oldframe, snapshot_t *prevframe, snapshot_t *newframe, entity_state_t *baselines, int shownet )
+{
+	int newnum, lastnum;
+	int oldindex, oldnum, previndex;
+	int frames, prevFrames;
+	int predicted[3];
+	qboolean remove;
+	entity_state_t *oldstate = NULL, *prevstate, *state;
+	msg_bits_t bits;
+
+	newframe->numEntities = 0;
+
+	frames = prevFrames = 0;
+	if( oldframe && prevframe )
+	{
+		frames = newframe->serverFrame - oldframe->serverFrame;
+		prevFrames = oldframe->serverFrame - prevframe->serverFrame;
+	}
+
+	// delta from the entities present in oldframe
+	oldindex = 0;
+	previndex = 0;
+	if( !oldframe || oldindex >= oldframe->numEntities )
+	{
+		oldnum = 99999;
+	}
+	else
+	{
+		oldstate = &oldframe->parsedEntities[oldindex & ( MAX_PARSE_ENTITIES-1 )];
+		oldnum = oldstate->number;
+	}
+
+	MSG_BeginReadingBits( &bits, msg );
+
+	lastnum = 0;
+	while( qtrue )
+	{
+		newnum = MSG_ReadPackedEntityNumber( &bits, lastnum, &remove );
+		if( newnum >= MAX_EDICTS )
+			Com_Error( ERR_DROP, "SNAP_ParsePackedEntities: bad number:%i", newnum );
+		if( msg->readcount > msg->cursize )
+			Com_Error( ERR_DROP, "SNAP_ParsePackedEntities: end of message" );
+
+		if( !newnum )
+			break;
+		lastnum = newnum;
+
+		while( oldnum < newnum )
+		{
+			// one or more entities from the old packet are unchanged
+			if( shownet == 3 )
+				Com_Printf( "   unchanged: %i\n", oldnum );
+
+			SNAP_DeltaEntity( msg, newframe, oldnum, oldstate, 0 );
+
+			oldindex++;
+			if( oldindex >= oldframe->numEntities )
+			{
+				oldnum = 99999;
+			}
+			else
+			{
+				oldstate = &oldframe->parsedEntities[oldindex & ( MAX_PARSE_ENTITIES-1 )];
+				oldnum = oldstate->number;
+			}
+		}
+
+		if( remove )
+		{
+			if( oldnum != newnum )
+			{
+				Com_Printf( "U_REMOVE: oldnum != newnum\n" );
+				continue;
+			}
+
+			// the entity present in oldframe is not in the current frame
+			if( shownet == 3 )
+				Com_Printf( "   remove: %i\n", newnum );
+		}
+		else
+		{
+			state = &newframe->parsedEntities[newframe->numEntities & ( MAX_PARSE_ENTITIES-1 )];
+			newframe->numEntities++;
+
+			if( oldnum > newnum )
+			{
+				// delta from baseline
+				if( shownet == 3 )
+					Com_Printf( "   baseline: %i\n", newnum );
+
+				MSG_ReadPackedDeltaEntity( &bits, &baselines[newnum], state, newnum, NULL );
+				continue;
+			}
+
+			// delta from previous state
+			if( shownet == 3 )
+				Com_Printf( "   delta: %i\n", newnum );
+
+			prevstate = SNAP_PackedPrevEntity( prevframe, &previndex, newnum );
+			if( prevstate && MSG_ExtrapolateEntityOrigin( oldstate, prevstate, frames, prevFrames, predicted ) )
+				MSG_ReadPackedDeltaEntity( &bits, oldstate, state, newnum, predicted );
+			else
+				MSG_ReadPackedDeltaEntity( &bits, oldstate, state, newnum, NULL );
+		}
+
+		oldindex++;
+		if( oldindex >= oldframe->numEntities )
+		{
+			oldnum = 99999;
+		}
+		else
+		{
+			oldstate = &oldframe->parsedEntities[oldindex & ( MAX_PARSE_ENTITIES-1 )];
+			oldnum = oldstate->number;
+		}
+	}
+
+	MSG_EndReadingBits( &bits );
+
+	// any remaining entities in the old frame are copied over
+	while( oldnum != 99999 )
+	{
+		// one or more entities from the old packet are unchanged
+		if( shownet == 3 )
+			Com_Printf( "   unchanged: %i\n", oldnum );
+
+		SNAP_DeltaEntity( msg, newframe, oldnum, oldstate, 0 );
+
+		oldindex++;
+		if( oldindex >= oldframe->numEntities )
+		{
+			oldnum = 99999;
+		}
+		else
+		{
+			oldstate = &oldframe->parsedEntities[oldindex & ( MAX_PARSE_ENTITIES-1 )];
+			oldnum = oldstate->number;
+		}
+	}
+}
+
+/*
+* SNAP_ReadPacketEntities
+*
+* Reads the entities following svc_packetentities, in the format
+* negotiated with the server
+*/
+void SNAP_ReadPacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot_t *prevframe, snapshot_t *newframe, entity_state_t *baselines, qboolean packedEntities, int showNet )
+{
+	if( packedEntities )
+		SNAP_ParsePackedEntities( msg, oldframe, prevframe, newframe, baselines, showNet );
+	else
+		SNAP_ParsePacketEntities( msg, oldframe, newframe, baselines, showNet );
+}
+
 /*
 * SNAP_ParseFrameHeader
 */
@@ -562,11 +747,11 @@ void SNAP_SkipFrame( msg_t *msg, snapshot_t *header )
 /*
 * SNAP_ParseFrame
 */
-snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCount, snapshot_t *backup, entity_state_t *baselines, int showNet )
+snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCount, snapshot_t *backup, entity_state_t *baselines, qboolean packedEntities, int showNet )
 {
 	int cmd;
 	size_t len;
-	snapshot_t	*deltaframe;
+	snapshot_t	*deltaframe, *prevframe;
 	int numplayers;
 	char *text;
 	int framediff, numtargets;
@@ -669,7 +854,25 @@ snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCou
 	_SHOWNET( msg, svc_strings[cmd], showNet );
 	if( cmd != svc_packetentities )
 		Com_Error( ERR_DROP, "SNAP_ParseFrame: not packetentities" );
-	SNAP_ParsePacketEntities( msg, deltaframe, newframe, baselines, showNet );
+
+	// packed entities extrapolate from the frame the delta frame was delta'd from,
+	// the server only does it while both are recent enough
+	prevframe = NULL;
+	if( packedEntities && deltaframe && deltaframe->delta && deltaframe->deltaFrameNum > 0
+		&& newframe->serverFrame < deltaframe->deltaFrameNum + UPDATE_MASK )
+	{
+		prevframe = &backup[deltaframe->deltaFrameNum & UPDATE_MASK];
+		if( !prevframe->valid || prevframe->serverFrame != deltaframe->deltaFrameNum )
+		{
+			// should never happen
+			if( newframe->valid )
+				Com_Printf( "Extrapolation frame too old.\n" );
+			newframe->valid = qfalse;
+			prevframe = NULL;
+		}
+	}
+
+	SNAP_ReadPacketEntities( msg, deltaframe, prevframe, newframe, baselines, packedEntities, showNet );
 
 	return newframe;
 }
@@ -121,6 +121,128 @@ static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, clien
 	MSG_WriteShort( msg, 0 ); // end of packetentities
 }
 
+/*
+* SNAP_PackedPrevEntity
+*
+* The state of the entity in the frame before the delta frame, if it was there
+*/
+static entity_state_t *SNAP_PackedPrevEntity( client_snapshot_t *prev, int *previndex, int number, entity_state_t *client_entities, int num_client_entities )
+{
+	entity_state_t *ent;
+
+	if( !prev )
+		return NULL;
+
+	for( ; *previndex < prev->num_entities; ( *previndex )++ )
+	{
+		ent = &client_entities[( prev->first_entity + *previndex )%num_client_entities];
+		if( ent->number == number )
+			return ent;
+		if( ent->number > number )
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+* SNAP_EmitPackedEntities
+*
+* The bitstream version of SNAP_EmitPacketEntities, for clients which
+* negotiated packed entities. Entities which were in the prev frame too
+* get their origin coded against the one extrapolated from prev and from
+*/
+static void SNAP_EmitPackedEntities( ginfo_t *gi, client_snapshot_t *from, client_snapshot_t *prev, int frames, int prevFrames,
+									client_snapshot_t *to, msg_t *msg, entity_state_t *baselines, entity_state_t *client_entities, int num_client_entities )
+{
+	entity_state_t *oldent, *newent, *prevent;
+	int oldindex, newindex, previndex;
+	int oldnum, newnum, lastnum;
+	int from_num_entities;
+	int predicted[3];
+	qboolean otherOrigin;
+	msg_bits_t bits;
+
+	MSG_WriteByte( msg, svc_packetentities );
+	MSG_BeginWritingBits( &bits, msg );
+
+	if( !from )
+		from_num_entities = 0;
+	else
+		from_num_entities = from->num_entities;
+
+	newindex = 0;
+	oldindex = 0;
+	previndex = 0;
+	lastnum = 0;
+	while( newindex < to->num_entities || oldindex < from_num_entities )
+	{
+		if( newindex >= to->num_entities )
+		{
+			newent = NULL;
+			newnum = 9999;
+		}
+		else
+		{
+			newent = &client_entities[( to->first_entity+newindex )%num_client_entities];
+			newnum = newent->number;
+		}
+
+		if( oldindex >= from_num_entities )
+		{
+			oldent = NULL;
+			oldnum = 9999;
+		}
+		else
+		{
+			oldent = &client_entities[( from->first_entity+oldindex )%num_client_entities];
+			oldnum = oldent->number;
+		}
+
+		if( newnum == oldnum )
+		{
+			// delta update from old position, nothing is written if it didn't change
+			otherOrigin = ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? qtrue : qfalse;
+			prevent = SNAP_PackedPrevEntity( prev, &previndex, newnum, client_entities, num_client_entities );
+			if( prevent && MSG_ExtrapolateEntityOrigin( oldent, prevent, frames, prevFrames, predicted ) )
+			{
+				if( MSG_WritePackedDeltaEntity( &bits, lastnum, oldent, newent, predicted, qfalse, otherOrigin ) )
+					lastnum = newnum;
+			}
+			else
+			{
+				if( MSG_WritePackedDeltaEntity( &bits, lastnum, oldent, newent, NULL, qfalse, otherOrigin ) )
+					lastnum = newnum;
+			}
+			oldindex++;
+			newindex++;
+			continue;
+		}
+
+		if( newnum < oldnum )
+		{
+			// this is a new entity, send it from the baseline
+			otherOrigin = ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? qtrue : qfalse;
+			MSG_WritePackedDeltaEntity( &bits, lastnum, &baselines[newnum], newent, NULL, qtrue, otherOrigin );
+			lastnum = newnum;
+			newindex++;
+			continue;
+		}
+
+		if( newnum > oldnum )
+		{
+			// the old entity isn't present in the new message
+			MSG_WritePackedEntityRemove( &bits, lastnum, oldnum );
+			lastnum = oldnum;
+			oldindex++;
+			continue;
+		}
+	}
+
+	MSG_WriteBits( &bits, 0, 1 ); // end of packetentities
+	MSG_EndWritingBits( &bits );
+}
+
 /*
 * SNAP_WriteDeltaGameStateToClient
 */
@@ -625,7 +747,7 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, uns
 								 entity_state_t *baselines, client_entities_t *client_entities,
 								 int numcmds, gcommand_t *commands, const char *commandsData )
 {
-	client_snapshot_t *frame, *oldframe;
+	client_snapshot_t *frame, *oldframe, *prevframe;
 	int flags, i, index, pos, length, supcnt;
 
 	// this is the frame we are creating
@@ -662,6 +784,15 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, uns
 	if( client->nodelta && client->reliable )
 		client->nodelta = qfalse;
 
+	// packed entities are extrapolated from the frame oldframe was delta'd from,
+	// the client checks the same conditions
+	prevframe = NULL;
+	if( client->packedentities && oldframe && oldframe->deltaFrameNum > 0
+		&& frameNum < (unsigned)oldframe->deltaFrameNum + UPDATE_MASK )
+		prevframe = &client->snapShots[oldframe->deltaFrameNum & UPDATE_MASK];
+
+	frame->deltaFrameNum = oldframe ? client->lastframe : -1;
+
 	MSG_WriteByte( msg, svc_frame );
 
 	pos = msg->cursize;
@@ -738,7 +869,11 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, uns
 	MSG_WriteByte( msg, 0 );
 
 	// delta encode the entities
-	SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0 );
+	if( client->packedentities )
+		SNAP_EmitPackedEntities( gi, oldframe, prevframe, frameNum - client->lastframe, prevframe ? client->lastframe - oldframe->deltaFrameNum : 0, 
+			frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0 );
+	else
+		SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0 );
 
 	// write length into reserved space
 	length = msg->cursize - pos - 2;
@@ -68,6 +68,84 @@ void QMutex_Unlock( qmutex_t *mutex )
 	Sys_Mutex_Unlock( mutex );
 }
 
+/*
+* QCondVar_Create
+*/
+qcondvar_t *QCondVar_Create( void )
+{
+	int ret;
+	qcondvar_t *cond;
+
+	ret = Sys_CondVar_Create( &cond );
+	if( ret != 0 ) {
+		return NULL;
+	}
+	return cond;
+}
+
+/*
+* QCondVar_Destroy
+*/
+void QCondVar_Destroy( qcondvar_t **pcond )
+{
+	assert( pcond != NULL );
+	if( pcond && *pcond ) {
+		Sys_CondVar_Destroy( *pcond );
+		*pcond = NULL;
+	}
+}
+
+/*
+* QCondVar_Wait
+*
+* The mutex must be locked by the caller, it is released while waiting
+* and locked again before returning. Spurious wakeups are possible.
+*/
+void QCondVar_Wait( qcondvar_t *cond, qmutex_t *mutex )
+{
+	assert( cond != NULL );
+	assert( mutex != NULL );
+	Sys_CondVar_Wait( cond, mutex );
+}
+
+/*
+* QCondVar_Wake
+*/
+void QCondVar_Wake( qcondvar_t *cond )
+{
+	assert( cond != NULL );
+	Sys_CondVar_Wake( cond );
+}
+
+/*
+* QCondVar_WakeAll
+*/
+void QCondVar_WakeAll( qcondvar_t *cond )
+{
+	assert( cond != NULL );
+	Sys_CondVar_WakeAll( cond );
+}
+
+/*
+* QAtomic_Add
+*
+* Returns the new value
+*/
+int QAtomic_Add( volatile int *value, int add )
+{
+	return Sys_Atomic_Add( value, add );
+}
+
+/*
+* QAtomic_CAS
+*
+* Sets value to newval if it equals oldval, returns whether it did
+*/
+qboolean QAtomic_CAS( volatile int *value, int oldval, int newval )
+{
+	return Sys_Atomic_CAS( value, oldval, newval );
+}
+
 /*
 * QThread_Create
 */
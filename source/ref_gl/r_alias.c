@@ -683,6 +683,30 @@ float R_AliasModelBBox( const entity_t *e, vec3_t mins, vec3_t maxs )
 	return R_AliasModelLerpBBox( e, mod, mins, maxs );
 }
 
+/*
+* R_PrecullAliasModelEntity
+*
+* R_CullModelEntity as done by R_AddAliasModelToDrawList, but without
+* printing anything, for the job threads. Returns -1 for entities that
+* have to be culled on the main thread
+*/
+int R_PrecullAliasModelEntity( const entity_t *e )
+{
+	const model_t *mod;
+	const maliasmodel_t *aliasmodel;
+	vec3_t mins, maxs;
+	float radius;
+
+	mod = R_AliasModelLOD( e );
+	if( !( aliasmodel = ( ( const maliasmodel_t * )mod->extradata ) ) || !aliasmodel->nummeshes )
+		return -1;
+	if( e->frame < 0 || e->frame >= aliasmodel->numframes || e->oldframe < 0 || e->oldframe >= aliasmodel->numframes )
+		return -1;
+
+	radius = R_AliasModelLerpBBox( e, mod, mins, maxs );
+	return R_CullModelEntity( e, mins, maxs, radius, qtrue );
+}
+
 /*
 * R_AliasModelFrameBounds
 */
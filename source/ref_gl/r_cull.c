@@ -277,11 +277,85 @@ qboolean R_VisCullSphere( const vec3_t origin, float radius )
 	return qtrue;
 }
 
+/*
+* Model entities are culled on the job threads before R_DrawEntities adds
+* them to the draw list, R_CullModelEntity then returns the stored results.
+* Entities that can't be culled from the job threads get -1 and are culled
+* on the main thread as usual.
+*/
+#define MIN_PRECULL_ENTITIES	32
+
+static int r_entityPrecull[MAX_ENTITIES];
+static qboolean r_entityPrecullValid;
+
+/*
+* R_PrecullEntitiesJob
+*/
+static void R_PrecullEntitiesJob( void *arg, int first, int last )
+{
+	int i;
+	const entity_t *e;
+
+	for( i = first; i < last; i++ )
+	{
+		e = R_NUM2ENT( i );
+		r_entityPrecull[i] = -1;
+
+		// the world entity isn't drawn by R_DrawEntities
+		if( !i || e->rtype != RT_MODEL || !e->model )
+			continue;
+
+		switch( e->model->type )
+		{
+		case mod_alias:
+			r_entityPrecull[i] = R_PrecullAliasModelEntity( e );
+			break;
+		case mod_skeletal:
+			r_entityPrecull[i] = R_PrecullSkeletalModelEntity( e );
+			break;
+		case mod_brush:
+			r_entityPrecull[i] = R_PrecullBrushModelEntity( e );
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/*
+* R_PrecullEntities
+*/
+void R_PrecullEntities( void )
+{
+	r_entityPrecullValid = qfalse;
+
+	if( !R_NumJobThreads() || rsc.numEntities < MIN_PRECULL_ENTITIES )
+		return;
+
+	R_ParallelFor( rsc.numEntities, MIN_PRECULL_ENTITIES / 2, R_PrecullEntitiesJob, NULL );
+	r_entityPrecullValid = qtrue;
+}
+
+/*
+* R_ClearEntityPrecull
+*/
+void R_ClearEntityPrecull( void )
+{
+	r_entityPrecullValid = qfalse;
+}
+
 /*
 * R_CullModelEntity
 */
 int R_CullModelEntity( const entity_t *e, vec3_t mins, vec3_t maxs, float radius, qboolean sphereCull )
 {
+	if( r_entityPrecullValid )
+	{
+		int num = R_ENT2NUM( e );
+		if( num >= 0 && num < (int)rsc.numEntities && r_entityPrecull[num] >= 0 )
+			return r_entityPrecull[num];
+	}
+
 	if( e->flags & RF_NOSHADOW )
 	{
 		if( rn.renderFlags & RF_SHADOWMAPVIEW )
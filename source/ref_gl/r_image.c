@@ -360,8 +360,10 @@ static void R_FlipTexture( const qbyte *in, qbyte *out, int width, int height,
 
 /*
 * R_ResampleTexture
+*
+* lines must hold outwidth * 2 offsets
 */
-static void R_ResampleTexture( const qbyte *in, int inwidth, int inheight, qbyte *out, int outwidth, int outheight, int samples )
+static void R_ResampleTexture( const qbyte *in, int inwidth, int inheight, qbyte *out, int outwidth, int outheight, int samples, unsigned *lines )
 {
 	int i, j, k;
 	int inwidthS, outwidthS;
@@ -376,7 +378,7 @@ static void R_ResampleTexture( const qbyte *in, int inwidth, int inheight, qbyte
 		return;
 	}
 
-	p1 = ( unsigned * )R_PrepareImageBuffer( TEXTURE_LINE_BUF, outwidth * sizeof( *p1 ) * 2 );
+	p1 = lines;
 	p2 = p1 + outwidth;
 
 	fracstep = inwidth * 0x10000 / outwidth;
@@ -415,8 +417,20 @@ static void R_ResampleTexture( const qbyte *in, int inwidth, int inheight, qbyte
 	}
 }
 
+/*
+* R_HeightmapBumpScale
+*/
+static float R_HeightmapBumpScale( float bumpScale )
+{
+	if( !bumpScale )
+		bumpScale = 1.0f;
+	return bumpScale * max( 0, r_lighting_bumpscale->value );
+}
+
 /*
 * R_HeightmapToNormalmap
+*
+* bumpScale comes from R_HeightmapBumpScale
 */
 static int R_HeightmapToNormalmap( const qbyte *in, qbyte *out, int width, int height, float bumpScale, int samples )
 {
@@ -425,9 +439,6 @@ static int R_HeightmapToNormalmap( const qbyte *in, qbyte *out, int width, int h
 	float ibumpScale;
 	const qbyte *p0, *p1, *p2;
 
-	if( !bumpScale )
-		bumpScale = 1.0f;
-	bumpScale *= max( 0, r_lighting_bumpscale->value );
 	ibumpScale = ( 255.0 * 3.0 ) / bumpScale;
 
 	memset( out, 255, width * height * 4 );
@@ -457,22 +468,19 @@ static int R_HeightmapToNormalmap( const qbyte *in, qbyte *out, int width, int h
 /*
 * R_MipMap
 * 
-* Operates in place, quartering the size of the texture
+* Quarters the size of the texture, out may be the same as in
 * note: if given odd width/height this discards the last row/column of
 * pixels, rather than doing a proper box-filter scale down (LordHavoc)
 */
-static void R_MipMap( qbyte *in, int width, int height, int samples )
+static void R_MipMap( const qbyte *in, qbyte *out, int width, int height, int samples )
 {
 	int i, j, k, samples2;
-	qbyte *out;
 
 	// width <<= 2;
 	width *= samples;
 	height >>= 1;
 	samples2 = samples << 1;
 
-
-	out = in;
 	for( i = 0; i < height; i++, in += width )
 	{
 		for( j = 0; j < width; j += samples2, out += samples, in += samples2 )
@@ -516,105 +524,87 @@ static int R_TextureFormat( int samples, qboolean noCompress )
 #endif
 
 /*
-* R_Upload32
+* R_ScaledTextureSize
+*
+* The size the texture is uploaded at: power of two unless keepSize is set,
+* sampled down by picmip and clamped to maxSize
 */
-static void R_Upload32( qbyte **data, int width, int height, int flags, 
-	int *upload_width, int *upload_height, int samples,
-	qboolean subImage, qboolean noScale )
+static void R_ScaledTextureSize( int width, int height, int flags, qboolean keepSize, int maxSize, 
+	int *scaledWidth, int *scaledHeight )
 {
-	int i, comp, format, type;
-	int target, target2;
-	int numTextures;
-	qbyte *scaled = NULL;
-	int scaledWidth, scaledHeight;
-
-	assert( samples );
+	int w, h;
 
-	// we can't properly mipmap a NPT-texture in software
-	if( ( glConfig.ext.texture_non_power_of_two && ( flags & IT_NOMIPMAP ) )
-		|| ( subImage && noScale ) )
+	if( keepSize )
 	{
-		scaledWidth = width;
-		scaledHeight = height;
+		w = width;
+		h = height;
 	}
 	else
 	{
-		for( scaledWidth = 1; scaledWidth < width; scaledWidth <<= 1 );
-		for( scaledHeight = 1; scaledHeight < height; scaledHeight <<= 1 );
+		for( w = 1; w < width; w <<= 1 );
+		for( h = 1; h < height; h <<= 1 );
 	}
 
 	if( !( flags & IT_NOPICMIP ) ) {
 		if( flags & IT_SKY ) {
 			// let people sample down the sky textures for speed
-			scaledWidth >>= r_skymip->integer;
-			scaledHeight >>= r_skymip->integer;
+			w >>= r_skymip->integer;
+			h >>= r_skymip->integer;
 		}
 		else {
 			// let people sample down the world textures for speed
-			scaledWidth >>= r_picmip->integer;
-			scaledHeight >>= r_picmip->integer;
+			w >>= r_picmip->integer;
+			h >>= r_picmip->integer;
 		}
 	}
 
 	// don't ever bother with > maxSize textures
-	if( flags & IT_CUBEMAP )
-	{
-		numTextures = 6;
-		target = GL_TEXTURE_CUBE_MAP_ARB;
-		target2 = GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB;
-		clamp( scaledWidth, 1, glConfig.maxTextureCubemapSize );
-		clamp( scaledHeight, 1, glConfig.maxTextureCubemapSize );
-	}
-	else
-	{
-		if( flags & ( IT_FLIPX|IT_FLIPY|IT_FLIPDIAGONAL ) )
-		{
-			qbyte *temp = R_PrepareImageBuffer( TEXTURE_FLIPPING_BUF0, width * height * samples );
-			R_FlipTexture( data[0], temp, width, height, samples, 
-				(flags & IT_FLIPX) ? qtrue : qfalse, 
-				(flags & IT_FLIPY) ? qtrue : qfalse, 
-				(flags & IT_FLIPDIAGONAL) ? qtrue : qfalse );
-			data = &r_imageBuffers[TEXTURE_FLIPPING_BUF0];
-		}
-
-		numTextures = 1;
-		target = GL_TEXTURE_2D;
-		target2 = GL_TEXTURE_2D;
-		clamp( scaledWidth, 1, glConfig.maxTextureSize );
-		clamp( scaledHeight, 1, glConfig.maxTextureSize );
-	}
+	clamp( w, 1, maxSize );
+	clamp( h, 1, maxSize );
 
-	if( upload_width )
-		*upload_width = scaledWidth;
-	if( upload_height )
-		*upload_height = scaledHeight;
+	*scaledWidth = w;
+	*scaledHeight = h;
+}
 
+/*
+* R_TextureUploadFormat
+*/
+static void R_TextureUploadFormat( int flags, int samples, int *comp, int *format, int *type )
+{
 	if( flags & IT_DEPTH )
 	{
-		comp = GL_DEPTH_COMPONENT;
-		format = GL_DEPTH_COMPONENT;
-		type = glConfig.ext.depth24 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+		*comp = GL_DEPTH_COMPONENT;
+		*format = GL_DEPTH_COMPONENT;
+		*type = glConfig.ext.depth24 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 	}
 	else if( flags & IT_LUMINANCE )
 	{
-		comp = GL_LUMINANCE;
-		format = GL_LUMINANCE;
-		type = GL_UNSIGNED_BYTE;
+		*comp = GL_LUMINANCE;
+		*format = GL_LUMINANCE;
+		*type = GL_UNSIGNED_BYTE;
 	}
 	else
 	{
 		if( samples == 4 )
-			format = ( flags & IT_BGRA ? GL_BGRA_EXT : GL_RGBA );
+			*format = ( flags & IT_BGRA ? GL_BGRA_EXT : GL_RGBA );
 		else
-			format = ( flags & IT_BGRA ? GL_BGR_EXT : GL_RGB );
+			*format = ( flags & IT_BGRA ? GL_BGR_EXT : GL_RGB );
 #ifdef GL_ES_VERSION_2_0
-		comp = format;
+		*comp = *format;
 #else
-		comp = R_TextureFormat( samples, flags & IT_NOCOMPRESS ? qtrue : qfalse );
+		*comp = R_TextureFormat( samples, flags & IT_NOCOMPRESS ? qtrue : qfalse );
 #endif
-		type = GL_UNSIGNED_BYTE;
+		*type = GL_UNSIGNED_BYTE;
 	}
+}
 
+/*
+* R_SetTextureParameters
+*
+* Filtering and wrapping of the texture bound to target
+*/
+static void R_SetTextureParameters( int target, int flags )
+{
 	if( flags & IT_NOFILTERING )
 	{
 		qglTexParameteri( target, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
@@ -663,6 +653,60 @@ static void R_Upload32( qbyte **data, int width, int height, int flags,
 		qglTexParameteri( target, GL_TEXTURE_WRAP_T, GL_CLAMP );
 	}
 #endif
+}
+
+/*
+* R_Upload32
+*/
+static void R_Upload32( qbyte **data, int width, int height, int flags, 
+	int *upload_width, int *upload_height, int samples,
+	qboolean subImage, qboolean noScale )
+{
+	int i, comp, format, type;
+	int target, target2;
+	int numTextures;
+	qbyte *scaled = NULL;
+	int scaledWidth, scaledHeight;
+	qboolean keepSize;
+
+	assert( samples );
+
+	// we can't properly mipmap a NPT-texture in software
+	keepSize = ( glConfig.ext.texture_non_power_of_two && ( flags & IT_NOMIPMAP ) ) || ( subImage && noScale );
+
+	if( flags & IT_CUBEMAP )
+	{
+		numTextures = 6;
+		target = GL_TEXTURE_CUBE_MAP_ARB;
+		target2 = GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB;
+		R_ScaledTextureSize( width, height, flags, keepSize, glConfig.maxTextureCubemapSize, &scaledWidth, &scaledHeight );
+	}
+	else
+	{
+		if( flags & ( IT_FLIPX|IT_FLIPY|IT_FLIPDIAGONAL ) )
+		{
+			qbyte *temp = R_PrepareImageBuffer( TEXTURE_FLIPPING_BUF0, width * height * samples );
+			R_FlipTexture( data[0], temp, width, height, samples, 
+				(flags & IT_FLIPX) ? qtrue : qfalse, 
+				(flags & IT_FLIPY) ? qtrue : qfalse, 
+				(flags & IT_FLIPDIAGONAL) ? qtrue : qfalse );
+			data = &r_imageBuffers[TEXTURE_FLIPPING_BUF0];
+		}
+
+		numTextures = 1;
+		target = GL_TEXTURE_2D;
+		target2 = GL_TEXTURE_2D;
+		R_ScaledTextureSize( width, height, flags, keepSize, glConfig.maxTextureSize, &scaledWidth, &scaledHeight );
+	}
+
+	if( upload_width )
+		*upload_width = scaledWidth;
+	if( upload_height )
+		*upload_height = scaledHeight;
+
+	R_TextureUploadFormat( flags, samples, &comp, &format, &type );
+
+	R_SetTextureParameters( target, flags );
 
 	if( ( scaledWidth == width ) && ( scaledHeight == height ) && ( flags & IT_NOMIPMAP ) )
 	{
@@ -689,7 +733,8 @@ static void R_Upload32( qbyte **data, int width, int height, int flags,
 			// resample the texture
 			mip = scaled;
 			if( data[i] )
-				R_ResampleTexture( data[i], width, height, (qbyte*)mip, scaledWidth, scaledHeight, samples );
+				R_ResampleTexture( data[i], width, height, (qbyte*)mip, scaledWidth, scaledHeight, samples, 
+					( unsigned * )R_PrepareImageBuffer( TEXTURE_LINE_BUF, scaledWidth * sizeof( unsigned ) * 2 ) );
 			else
 				mip = NULL;
 
@@ -708,7 +753,7 @@ static void R_Upload32( qbyte **data, int width, int height, int flags,
 				h = scaledHeight;
 				while( w > 1 || h > 1 )
 				{
-					R_MipMap( mip, w, h, samples );
+					R_MipMap( mip, mip, w, h, samples );
 
 					w >>= 1;
 					h >>= 1;
@@ -796,6 +841,8 @@ void R_ReplaceImage( image_t *image, qbyte **pic, int width, int height, int fla
 	assert( image );
 	assert( image->texnum );
 
+	R_FinishImage( image );
+
 	RB_BindTexture( 0, image );
 
 	if( image->width != width || image->height != height )
@@ -824,6 +871,8 @@ void R_ReplaceSubImage( image_t *image, qbyte **pic, int width, int height )
 	assert( image );
 	assert( image->texnum );
 
+	R_FinishImage( image );
+
 	RB_BindTexture( 0, image );
 
 	R_Upload32( pic, width, height, image->flags,
@@ -832,6 +881,446 @@ void R_ReplaceSubImage( image_t *image, qbyte **pic, int width, int height )
 	image->registrationSequence = rsh.registrationSequence;
 }
 
+/*
+* R_ReplaceImageRegion
+*
+* Updates a rectangle of an image that was uploaded without scaling and mipmaps
+*/
+void R_ReplaceImageRegion( image_t *image, int x, int y, qbyte **pic, int width, int height )
+{
+	int format;
+
+	assert( image );
+	assert( image->texnum );
+
+	R_FinishImage( image );
+
+	if( !( image->flags & IT_NOMIPMAP ) || image->upload_width != image->width || image->upload_height != image->height )
+		return;
+	if( x < 0 || y < 0 || x + width > image->width || y + height > image->height )
+		return;
+
+	if( image->samples == 4 )
+		format = ( image->flags & IT_BGRA ? GL_BGRA_EXT : GL_RGBA );
+	else
+		format = ( image->flags & IT_BGRA ? GL_BGR_EXT : GL_RGB );
+
+	RB_BindTexture( 0, image );
+
+	qglTexSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, pic[0] );
+
+	image->registrationSequence = rsh.registrationSequence;
+}
+
+/*
+==============================================================================
+
+IMAGE LOAD BATCHES
+
+==============================================================================
+*/
+
+/*
+* Between R_BeginImageLoadBatch and R_EndImageLoadBatch, R_FindImage only
+* reads the file and its dimensions on the main thread. Decoding, normalmap
+* conversion, flipping, resampling and mipmapping are done by a job and the
+* main thread uploads the results as they arrive, in submission order. The
+* image is usable right away, apart from its pixels and samples, which are
+* filled in by the upload. Cubemaps are still loaded right away.
+*/
+
+#define MAX_PENDING_IMAGE_JOBS	64
+
+typedef struct r_imagejob_s
+{
+	rjob_t			job;
+	image_t			*image;
+
+	// input, set on the main thread
+	r_imginfo_t		( *decode )( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
+	qbyte			*file;
+	size_t			fileSize;
+	int				flags;
+	float			bumpScale;
+	qboolean		swapBGR;
+	int				width, height;
+	int				scaledWidth, scaledHeight;
+
+	// output, set by the job
+	qbyte			*levels;			// all mip levels, one after the other
+	int				numLevels;
+	int				samples;
+	int				outFlags;
+	unsigned int	decodeUsec;
+} r_imagejob_t;
+
+static struct
+{
+	qboolean		active;
+	r_imagejob_t	jobs[MAX_PENDING_IMAGE_JOBS];
+	int				head, numPending;
+
+	int				numImages;
+	quint64			startTime;
+	quint64			readUsec, uploadUsec, decodeUsec;
+} r_imageBatch;
+
+static void R_InitNoTexture( int *w, int *h, int *flags, int *samples );
+
+/*
+* R_AllocImageJobBufferCb
+*/
+static qbyte *R_AllocImageJobBufferCb( void *ptr, size_t size, const char *filename, int linenum )
+{
+	return malloc( size );
+}
+
+/*
+* R_DecodeImageJob
+*
+* Runs on a worker thread, so only libc memory and nothing global
+*/
+static void R_DecodeImageJob( void *arg )
+{
+	r_imagejob_t *job = arg;
+	int i, w, h, samples, flags;
+	size_t size;
+	qbyte *pic, *temp, *mip;
+	unsigned *lines;
+	r_imginfo_t imginfo;
+	quint64 start = ri.Sys_Microseconds();
+
+	job->levels = NULL;
+	job->numLevels = 0;
+	flags = job->flags;
+
+	imginfo = job->decode( job->file, job->fileSize, R_AllocImageJobBufferCb, NULL );
+	pic = imginfo.pixels;
+	samples = imginfo.samples;
+	if( !pic || !samples || imginfo.width != job->width || imginfo.height != job->height )
+	{
+		if( pic )
+			free( pic );
+		goto done;
+	}
+
+	w = job->width;
+	h = job->height;
+
+	if( ( imginfo.comp & ~1 ) == IMGCOMP_BGR )
+	{
+		if( job->swapBGR )
+			R_SwapBlueRed( pic, w, h, samples );
+		else
+			flags |= IT_BGRA;
+	}
+
+	if( flags & IT_HEIGHTMAP )
+	{
+		temp = malloc( w * h * 4 );
+		samples = R_HeightmapToNormalmap( pic, temp, w, h, job->bumpScale, samples );
+		free( pic );
+		pic = temp;
+	}
+
+	if( flags & ( IT_FLIPX|IT_FLIPY|IT_FLIPDIAGONAL ) )
+	{
+		temp = malloc( w * h * samples );
+		R_FlipTexture( pic, temp, w, h, samples, 
+			(flags & IT_FLIPX) ? qtrue : qfalse, 
+			(flags & IT_FLIPY) ? qtrue : qfalse, 
+			(flags & IT_FLIPDIAGONAL) ? qtrue : qfalse );
+		free( pic );
+		pic = temp;
+	}
+
+	if( job->scaledWidth == w && job->scaledHeight == h && ( flags & IT_NOMIPMAP ) )
+	{
+		job->levels = pic;
+		job->numLevels = 1;
+		goto done;
+	}
+
+	// count the mip levels
+	w = job->scaledWidth;
+	h = job->scaledHeight;
+	size = w * h * samples;
+	job->numLevels = 1;
+	if( !( flags & IT_NOMIPMAP ) )
+	{
+		while( w > 1 || h > 1 )
+		{
+			w = max( w >> 1, 1 );
+			h = max( h >> 1, 1 );
+			size += w * h * samples;
+			job->numLevels++;
+		}
+	}
+
+	job->levels = malloc( size );
+	lines = malloc( job->scaledWidth * sizeof( *lines ) * 2 );
+	R_ResampleTexture( pic, job->width, job->height, job->levels, job->scaledWidth, job->scaledHeight, samples, lines );
+	free( lines );
+	free( pic );
+
+	w = job->scaledWidth;
+	h = job->scaledHeight;
+	for( i = 1, mip = job->levels; i < job->numLevels; i++ )
+	{
+		R_MipMap( mip, mip + w * h * samples, w, h, samples );
+		mip += w * h * samples;
+		w = max( w >> 1, 1 );
+		h = max( h >> 1, 1 );
+	}
+
+done:
+	job->samples = samples;
+	job->outFlags = flags;
+	job->decodeUsec = ri.Sys_Microseconds() - start;
+}
+
+/*
+* R_UploadImageJob
+*/
+static void R_UploadImageJob( r_imagejob_t *job )
+{
+	int i, w, h, comp, format, type;
+	qbyte *mip;
+	image_t *image = job->image;
+	quint64 start = ri.Sys_Microseconds();
+
+	R_FreeFile( job->file );
+	job->file = NULL;
+
+	RB_BindTexture( 0, image );
+
+	if( !job->levels )
+	{
+		int flags, samples;
+
+		// same as a missing file, except that the image exists already
+		ri.Com_DPrintf( S_COLOR_YELLOW "Bad image file %s%s\n", image->name, image->extension );
+
+		R_InitNoTexture( &w, &h, &flags, &samples );
+		R_Upload32( &r_imageBuffers[TEXTURE_LOADING_BUF0], w, h, image->flags & ~( IT_FLIPX|IT_FLIPY|IT_FLIPDIAGONAL ), 
+			&image->upload_width, &image->upload_height, samples, qfalse, qfalse );
+		image->samples = samples;
+	}
+	else
+	{
+		image->flags = job->outFlags;
+		image->samples = job->samples;
+
+		R_SetTextureParameters( GL_TEXTURE_2D, image->flags );
+		R_TextureUploadFormat( image->flags, image->samples, &comp, &format, &type );
+
+		w = image->upload_width;
+		h = image->upload_height;
+		for( i = 0, mip = job->levels; i < job->numLevels; i++ )
+		{
+			qglTexImage2D( GL_TEXTURE_2D, i, comp, w, h, 0, format, type, mip );
+			mip += w * h * image->samples;
+			w = max( w >> 1, 1 );
+			h = max( h >> 1, 1 );
+		}
+
+		free( job->levels );
+		job->levels = NULL;
+	}
+
+	image->job = NULL;
+	job->image = NULL;
+
+	r_imageBatch.decodeUsec += job->decodeUsec;
+	r_imageBatch.uploadUsec += ri.Sys_Microseconds() - start;
+}
+
+/*
+* R_FinishOldestImageJob
+*/
+static void R_FinishOldestImageJob( void )
+{
+	r_imagejob_t *job;
+
+	assert( r_imageBatch.numPending );
+
+	job = &r_imageBatch.jobs[r_imageBatch.head];
+	R_WaitJob( &job->job );
+	R_UploadImageJob( job );
+
+	r_imageBatch.head = ( r_imageBatch.head + 1 ) % MAX_PENDING_IMAGE_JOBS;
+	r_imageBatch.numPending--;
+}
+
+/*
+* R_UploadFinishedImageJobs
+*/
+static void R_UploadFinishedImageJobs( void )
+{
+	while( r_imageBatch.numPending && R_JobDone( &r_imageBatch.jobs[r_imageBatch.head].job ) )
+		R_FinishOldestImageJob();
+}
+
+/*
+* R_FinishImage
+*
+* Makes sure the pixels of the image are uploaded
+*/
+void R_FinishImage( image_t *image )
+{
+	while( image && image->job )
+		R_FinishOldestImageJob();
+}
+
+/*
+* R_QueueImageLoad
+*
+* Returns qfalse if the image has to be loaded right away
+*/
+static qboolean R_QueueImageLoad( char *pathname, size_t pathsize, unsigned int len, 
+	int flags, float bumpScale, image_t **result )
+{
+	const char *extension;
+	r_imagejob_t *job;
+	image_t *image;
+	qbyte *file;
+	int fileSize, width, height, maxSize;
+	qboolean ( *probe )( qbyte *buffer, size_t length, int *width, int *height );
+	qboolean keepSize;
+	quint64 start = ri.Sys_Microseconds();
+
+	*result = NULL;
+
+	extension = ri.FS_FirstExtension( pathname, IMAGE_EXTENSIONS, NUM_IMAGE_EXTENSIONS );
+	if( !extension )
+		return qtrue;
+
+	COM_ReplaceExtension( pathname, extension, pathsize );
+
+	if( r_imageBatch.numPending == MAX_PENDING_IMAGE_JOBS )
+		R_FinishOldestImageJob();
+	job = &r_imageBatch.jobs[( r_imageBatch.head + r_imageBatch.numPending ) % MAX_PENDING_IMAGE_JOBS];
+
+	if( !Q_stricmp( extension, ".jpg" ) ) {
+		job->decode = DecodeJPG;
+		probe = ProbeJPG;
+	}
+	else if( !Q_stricmp( extension, ".tga" ) ) {
+		job->decode = DecodeTGA;
+		probe = ProbeTGA;
+	}
+	else if( !Q_stricmp( extension, ".png" ) ) {
+		job->decode = DecodePNG;
+		probe = ProbePNG;
+	}
+	else {
+		return qfalse;
+	}
+
+	fileSize = R_LoadFile( pathname, (void **)&file );
+	if( !file )
+		return qtrue;
+
+	if( !probe( file, fileSize, &width, &height ) )
+	{
+		R_FreeFile( file );
+		return qfalse;
+	}
+
+	r_imageBatch.readUsec += ri.Sys_Microseconds() - start;
+
+	job->file = file;
+	job->fileSize = fileSize;
+	job->flags = flags;
+	job->bumpScale = ( flags & IT_HEIGHTMAP ) ? R_HeightmapBumpScale( bumpScale ) : 0;
+	job->swapBGR = glConfig.ext.bgra ? qfalse : qtrue;
+	job->width = width;
+	job->height = height;
+
+	keepSize = glConfig.ext.texture_non_power_of_two && ( flags & IT_NOMIPMAP );
+	maxSize = glConfig.maxTextureSize;
+	R_ScaledTextureSize( width, height, flags, keepSize, maxSize, &job->scaledWidth, &job->scaledHeight );
+
+	// same as R_LoadImage, without the upload
+	if( image_cur_hash >= IMAGES_HASH_SIZE )
+		image_cur_hash = COM_SuperFastHash( ( const qbyte *)pathname, len, len ) % IMAGES_HASH_SIZE;
+
+	image = R_AllocPic();
+	if( !image ) {
+		R_FreeFile( file );
+		ri.Com_Error( ERR_DROP, "R_LoadImage: r_numImages == MAX_GLIMAGES" );
+	}
+	image_cur_hash = IMAGES_HASH_SIZE+1;
+
+	image->name = R_MallocExt( r_imagesPool, len + 1, 0, 1 );
+	memcpy( image->name, pathname, len );
+	image->name[len] = 0;
+	image->extension[0] = '.';
+	Q_strncpyz( &image->extension[1], &pathname[len+1], sizeof( image->extension )-1 );
+	image->width = width;
+	image->height = height;
+	image->upload_width = job->scaledWidth;
+	image->upload_height = job->scaledHeight;
+	image->flags = flags;
+	image->samples = 0;
+	image->fbo = 0;
+	image->texnum = 0;
+	image->registrationSequence = rsh.registrationSequence;
+	image->job = job;
+
+	RB_AllocTextureNum( image );
+
+	job->image = image;
+	r_imageBatch.numPending++;
+	r_imageBatch.numImages++;
+	R_SubmitJob( &job->job, R_DecodeImageJob, job );
+
+	R_UploadFinishedImageJobs();
+
+	*result = image;
+	return qtrue;
+}
+
+/*
+* R_BeginImageLoadBatch
+*/
+void R_BeginImageLoadBatch( void )
+{
+	// left open by an error
+	R_EndImageLoadBatch();
+
+	r_imageBatch.active = qtrue;
+	r_imageBatch.head = r_imageBatch.numPending = 0;
+	r_imageBatch.numImages = 0;
+	r_imageBatch.readUsec = r_imageBatch.uploadUsec = r_imageBatch.decodeUsec = 0;
+	r_imageBatch.startTime = ri.Sys_Microseconds();
+}
+
+/*
+* R_EndImageLoadBatch
+*
+* Uploads the remaining images and reports the timings
+*/
+void R_EndImageLoadBatch( void )
+{
+	if( !r_imageBatch.active )
+		return;
+
+	while( r_imageBatch.numPending )
+		R_FinishOldestImageJob();
+
+	r_imageBatch.active = qfalse;
+
+	if( r_imageBatch.numImages )
+	{
+		Com_Printf( "Loaded %i images in %.1f ms: read %.1f ms, decode %.1f ms on %i thread%s, upload %.1f ms\n",
+			r_imageBatch.numImages, ( ri.Sys_Microseconds() - r_imageBatch.startTime ) * 0.001f,
+			r_imageBatch.readUsec * 0.001f, r_imageBatch.decodeUsec * 0.001f, 
+			max( R_NumJobThreads(), 1 ), R_NumJobThreads() > 1 ? "s" : "",
+			r_imageBatch.uploadUsec * 0.001f );
+	}
+}
+
 /*
 * R_FindImage
 * 
@@ -997,6 +1486,10 @@ image_t	*R_FindImage( const char *name, const char *suffix, int flags, float bum
 		qbyte *pic;
 
 		Q_strncatz( pathname, extension, pathsize );
+
+		if( r_imageBatch.active && R_QueueImageLoad( pathname, pathsize, len, flags, bumpScale, &image ) )
+			return image;
+
 		samples = R_LoadImageFromDisk( pathname, pathsize, &pic, &width, &height, &flags, 0 );
 
 		if( pic )
@@ -1006,7 +1499,7 @@ image_t	*R_FindImage( const char *name, const char *suffix, int flags, float bum
 			if( flags & IT_HEIGHTMAP )
 			{
 				temp = R_PrepareImageBuffer( TEXTURE_FLIPPING_BUF0, width * height * 4 );
-				samples = R_HeightmapToNormalmap( pic, temp, width, height, bumpScale, samples );
+				samples = R_HeightmapToNormalmap( pic, temp, width, height, R_HeightmapBumpScale( bumpScale ), samples );
 				pic = temp;
 			}
 
@@ -1691,6 +2184,8 @@ void R_TouchImage( image_t *image )
 */
 static void R_FreeImage( image_t *image )
 {
+	R_FinishImage( image );
+
 	RB_FreeTextureNum( image );
 
 	R_Free( image->name );
@@ -1754,6 +2249,8 @@ void R_ShutdownImages( void )
 	if( !r_imagesPool )
 		return;
 
+	R_EndImageLoadBatch();
+
 	R_ReleaseBuiltinTextures();
 
 	for( i = 0, image = images; i < MAX_GLIMAGES; i++, image++ ) {
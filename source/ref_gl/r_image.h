@@ -61,6 +61,7 @@ typedef struct image_s
 	int				fbo;						// frame buffer object texture is attached to
 	unsigned int	framenum;					// rf.frameCount texture was updated (rendered to)
 	float			bumpScale;
+	struct r_imagejob_s *job;					// pending decode in a load batch, see R_FinishImage
 	struct image_s	*next, *prev;
 } image_t;
 
@@ -84,8 +85,12 @@ void R_AnisotropicFilter( int value );
 
 image_t *R_LoadImage( const char *name, qbyte **pic, int width, int height, int flags, int samples );
 image_t	*R_FindImage( const char *name, const char *suffix, int flags, float bumpScale );
+void R_FinishImage( image_t *image );
+void R_BeginImageLoadBatch( void );
+void R_EndImageLoadBatch( void );
 void R_ReplaceImage( image_t *image, qbyte **pic, int width, int height, int flags, int samples );
 void R_ReplaceSubImage( image_t *image, qbyte **pic, int width, int height );
+void R_ReplaceImageRegion( image_t *image, int x, int y, qbyte **pic, int width, int height );
 
 void R_BeginAviDemo( void );
 void R_WriteAviFrame( int frame, qboolean scissor );
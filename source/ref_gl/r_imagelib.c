@@ -291,23 +291,19 @@ static void tga_grey( qbyte *pout, qbyte *pin, int size )
 }
 
 /*
-* LoadTGA
+* DecodeTGA
 */
-r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+r_imginfo_t DecodeTGA( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
 {
 	int i, j, columns, rows, samples;
-	qbyte *buf_p, *buffer, *pixbuf, *targa_rgba;
+	qbyte *buf_p, *pixbuf, *targa_rgba;
 	qbyte palette[256][4];
 	TargaHeader targa_header;
 	r_imginfo_t imginfo;
 
 	memset( &imginfo, 0, sizeof( imginfo ) );
 
-	//
-	// load the file
-	//
-	R_LoadFile( name, (void **)&buffer );
-	if( !buffer )
+	if( length < 18 )
 		return imginfo;
 
 	buf_p = buffer;
@@ -339,20 +335,14 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 		// uncompressed colormapped image
 		if( targa_header.pixel_size != 8 )
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: Only 8 bit images supported for type 1 and 9" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 		if( targa_header.colormap_length != 256 )
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: Only 8 bit colormaps are supported for type 1 and 9" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 		if( targa_header.colormap_index )
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: colormap_index is not supported for type 1 and 9" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 		if( targa_header.colormap_size == 24 )
@@ -379,8 +369,6 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 		}
 		else
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: only 24 and 32 bit colormaps are supported for type 1 and 9" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 	}
@@ -389,8 +377,6 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 		// uncompressed or RLE compressed RGB
 		if( targa_header.pixel_size != 32 && targa_header.pixel_size != 24 )
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: Only 32 or 24 bit images supported for type 2 and 10" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 
@@ -401,8 +387,6 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 		// uncompressed grayscale
 		if( targa_header.pixel_size != 8 )
 		{
-			ri.Com_DPrintf( S_COLOR_YELLOW "LoadTGA: Only 8 bit images supported for type 3 and 11" );
-			R_FreeFile( buffer );
 			return imginfo;
 		}
 	}
@@ -477,8 +461,6 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 		free( tmpLine );
 	}
 
-	R_FreeFile( buffer );
-
 	imginfo.comp = (samples == 4 ? IMGCOMP_BGRA : IMGCOMP_BGR);
 	imginfo.width = columns;
 	imginfo.height = rows;
@@ -487,6 +469,44 @@ r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 	return imginfo;
 }
 
+/*
+* ProbeTGA
+*
+* Reads the dimensions from the header, without decoding
+*/
+qboolean ProbeTGA( qbyte *buffer, size_t length, int *width, int *height )
+{
+	if( length < 18 )
+		return qfalse;
+
+	*width = buffer[12] | ( buffer[13] << 8 );
+	*height = buffer[14] | ( buffer[15] << 8 );
+	return *width > 0 && *height > 0;
+}
+
+/*
+* LoadTGA
+*/
+r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+{
+	qbyte *buffer;
+	size_t length;
+	r_imginfo_t imginfo;
+
+	memset( &imginfo, 0, sizeof( imginfo ) );
+
+	length = R_LoadFile( name, (void **)&buffer );
+	if( !buffer )
+		return imginfo;
+
+	imginfo = DecodeTGA( buffer, length, allocbuf, uptr );
+	if( !imginfo.pixels )
+		ri.Com_DPrintf( S_COLOR_YELLOW "Bad or unsupported tga file %s\n", name );
+
+	R_FreeFile( buffer );
+	return imginfo;
+}
+
 #undef WRITEPIXEL24
 #undef WRITEPIXEL32
 #undef WRITEPIXEL
@@ -558,14 +578,10 @@ struct q_jpeg_error_mgr {
 
 static void q_jpg_error_exit(j_common_ptr cinfo)
 {
-	char buffer[JMSG_LENGTH_MAX];
-
 	// cinfo->err really points to a my_error_mgr struct, so coerce pointer
 	struct q_jpeg_error_mgr *qerr = (struct q_jpeg_error_mgr *) cinfo->err;
 
-    // create the message
-	qerr->pub.format_message( cinfo, buffer );
-	ri.Com_DPrintf( "q_jpg_error_exit: %s\n", buffer );
+	// no printing here, the decoder may run on a worker thread
 
 	// Return control to the setjmp point
 	longjmp(qerr->setjmp_buffer, 1);
@@ -577,7 +593,7 @@ static void q_jpg_noop( j_decompress_ptr cinfo )
 
 static boolean q_jpg_fill_input_buffer( j_decompress_ptr cinfo )
 {
-	ri.Com_DPrintf( "Premature end of jpeg file\n" );
+	// premature end of file
 	return 1;
 }
 
@@ -603,23 +619,18 @@ void q_jpeg_mem_src( j_decompress_ptr cinfo, unsigned char *mem, unsigned long l
 }
 
 /*
-* LoadJPG
+* DecodeJPG
 */
-r_imginfo_t LoadJPG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+r_imginfo_t DecodeJPG( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
 {
-	unsigned int i, length, samples, widthXsamples;
-	qbyte *img, *scan, *buffer, *line, *jpg_rgb;
+	unsigned int i, samples, widthXsamples;
+	qbyte *img, *scan, *line, *jpg_rgb;
 	struct q_jpeg_error_mgr jerr;
 	struct jpeg_decompress_struct cinfo;
 	r_imginfo_t imginfo;
 
 	memset( &imginfo, 0, sizeof( imginfo ) );
 
-	// load the file
-	length = R_LoadFile( name, (void **)&buffer );
-	if( !buffer )
-		return imginfo;
-
 	cinfo.err = jpeg_std_error( &jerr.pub );
 	jerr.pub.error_exit = q_jpg_error_exit;
 
@@ -638,9 +649,7 @@ r_imginfo_t LoadJPG( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 	if( samples != 3 && samples != 1 )
 	{
 error:
-		ri.Com_DPrintf( S_COLOR_YELLOW "Bad jpeg file %s\n", name );
 		jpeg_destroy_decompress( &cinfo );
-		R_FreeFile( buffer );
 		return imginfo;
 	}
 
@@ -653,10 +662,8 @@ error:
 		scan = line;
 		if( !jpeg_read_scanlines( &cinfo, &scan, 1 ) )
 		{
-			Com_Printf( S_COLOR_YELLOW "Bad jpeg file %s\n", name );
-			jpeg_destroy_decompress( &cinfo );
-			R_FreeFile( buffer );
-			return imginfo;
+			free( line );
+			goto error;
 		}
 
 		if( samples == 1 )
@@ -674,7 +681,6 @@ error:
 	jpeg_finish_decompress( &cinfo );
 	jpeg_destroy_decompress( &cinfo );
 
-	R_FreeFile( buffer );
 	free( line );
 
 	imginfo.comp = IMGCOMP_RGB;
@@ -685,6 +691,56 @@ error:
 	return imginfo;
 }
 
+/*
+* ProbeJPG
+*/
+qboolean ProbeJPG( qbyte *buffer, size_t length, int *width, int *height )
+{
+	struct q_jpeg_error_mgr jerr;
+	struct jpeg_decompress_struct cinfo;
+
+	cinfo.err = jpeg_std_error( &jerr.pub );
+	jerr.pub.error_exit = q_jpg_error_exit;
+
+	if( setjmp( jerr.setjmp_buffer ) ) {
+		jpeg_destroy_decompress( &cinfo );
+		return qfalse;
+	}
+
+	jpeg_create_decompress( &cinfo );
+	q_jpeg_mem_src( &cinfo, buffer, length );
+	jpeg_read_header( &cinfo, TRUE );
+
+	*width = cinfo.image_width;
+	*height = cinfo.image_height;
+	jpeg_destroy_decompress( &cinfo );
+
+	return *width > 0 && *height > 0;
+}
+
+/*
+* LoadJPG
+*/
+r_imginfo_t LoadJPG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+{
+	qbyte *buffer;
+	size_t length;
+	r_imginfo_t imginfo;
+
+	memset( &imginfo, 0, sizeof( imginfo ) );
+
+	length = R_LoadFile( name, (void **)&buffer );
+	if( !buffer )
+		return imginfo;
+
+	imginfo = DecodeJPG( buffer, length, allocbuf, uptr );
+	if( !imginfo.pixels )
+		ri.Com_DPrintf( S_COLOR_YELLOW "Bad jpeg file %s\n", name );
+
+	R_FreeFile( buffer );
+	return imginfo;
+}
+
 #define JPEG_OUTPUT_BUFFER_SIZE		4096
 
 static void q_jpg_init_destination(j_compress_ptr cinfo)
@@ -802,14 +858,13 @@ typedef struct {
 	size_t curptr;
 } q_png_iobuf_t;
 
+// no printing in the callbacks, the decoder may run on a worker thread
 static void q_png_error_fn( png_structp png_ptr, const char *message )
 {
-    ri.Com_DPrintf( "q_png_error_fn: error: %s\n", message );
 }
 
 static void q_png_warning_fn( png_structp png_ptr, const char *message )
 {
-    ri.Com_DPrintf( "q_png_warning_fn: warning: %s\n", message );
 }
 
 //LordHavoc: removed __cdecl prefix, added overrun protection, and rewrote this to be more efficient
@@ -819,8 +874,6 @@ static void q_png_user_read_fn( png_structp png_ptr, unsigned char *data, size_t
 	size_t rem = io->size - io->curptr;
 
 	if( length > rem ) {
-        ri.Com_DPrintf( "q_png_user_read_fn: overrun by %i bytes\n", (int)(length - rem) );
-
         // a read going past the end of the file, fill in the remaining bytes
         // with 0 just to be consistent
         memset( data + rem, 0, length - rem );
@@ -832,13 +885,11 @@ static void q_png_user_read_fn( png_structp png_ptr, unsigned char *data, size_t
 }
 
 /*
-* LoadPNG
+* DecodePNG
 */
-r_imginfo_t LoadPNG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+r_imginfo_t DecodePNG( qbyte *png_data, size_t png_datasize, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
 {
 	qbyte *img;
-	qbyte *png_data;
-	size_t png_datasize;
 	q_png_iobuf_t io;
 	png_structp png_ptr = NULL;
 	png_infop info_ptr = NULL;
@@ -851,19 +902,11 @@ r_imginfo_t LoadPNG( const char *name, qbyte *(*allocbuf)( void *, size_t, const
 
 	memset( &imginfo, 0, sizeof( imginfo ) );
 
-	// load the file
-	png_datasize = R_LoadFile( name, (void **)&png_data );
-	if( !png_data )
-		return imginfo;
-
 	if( png_sig_cmp( png_data, 0, png_datasize ) ) {
 error:
-		ri.Com_DPrintf( S_COLOR_YELLOW "Bad png file %s\n", name );
-
 		if( png_ptr != NULL ) {
 			png_destroy_write_struct( &png_ptr, NULL );
 		}
-		R_FreeFile( png_data );
         return imginfo;
 	}
 	
@@ -964,8 +1007,6 @@ error:
 
 	free( row_pointers );
 
-	R_FreeFile( png_data );
-
 	imginfo.comp = (samples == 4 ? IMGCOMP_RGBA : IMGCOMP_RGB);
 	imginfo.width = p_width;
 	imginfo.height = p_height;
@@ -973,3 +1014,41 @@ error:
 	imginfo.pixels = img;
 	return imginfo;
 }
+
+/*
+* ProbePNG
+*
+* Reads the dimensions from the IHDR chunk, which always comes first
+*/
+qboolean ProbePNG( qbyte *buffer, size_t length, int *width, int *height )
+{
+	if( length < 24 || png_sig_cmp( buffer, 0, 8 ) || memcmp( buffer + 12, "IHDR", 4 ) )
+		return qfalse;
+
+	*width = ( buffer[16] << 24 ) | ( buffer[17] << 16 ) | ( buffer[18] << 8 ) | buffer[19];
+	*height = ( buffer[20] << 24 ) | ( buffer[21] << 16 ) | ( buffer[22] << 8 ) | buffer[23];
+	return *width > 0 && *height > 0;
+}
+
+/*
+* LoadPNG
+*/
+r_imginfo_t LoadPNG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr )
+{
+	qbyte *buffer;
+	size_t length;
+	r_imginfo_t imginfo;
+
+	memset( &imginfo, 0, sizeof( imginfo ) );
+
+	length = R_LoadFile( name, (void **)&buffer );
+	if( !buffer )
+		return imginfo;
+
+	imginfo = DecodePNG( buffer, length, allocbuf, uptr );
+	if( !imginfo.pixels )
+		ri.Com_DPrintf( S_COLOR_YELLOW "Bad png file %s\n", name );
+
+	R_FreeFile( buffer );
+	return imginfo;
+}
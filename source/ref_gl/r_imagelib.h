@@ -39,12 +39,18 @@ typedef struct
 	qbyte *pixels;
 } r_imginfo_t;
 
+r_imginfo_t DecodeTGA( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
+qboolean ProbeTGA( qbyte *buffer, size_t length, int *width, int *height );
 r_imginfo_t LoadTGA( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
 qboolean WriteTGA( const char *name, r_imginfo_t *info, int quality );
 
+r_imginfo_t DecodeJPG( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
+qboolean ProbeJPG( qbyte *buffer, size_t length, int *width, int *height );
 r_imginfo_t LoadJPG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
 qboolean WriteJPG( const char *name, r_imginfo_t *info, int quality );
 
+r_imginfo_t DecodePNG( qbyte *buffer, size_t length, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
+qboolean ProbePNG( qbyte *buffer, size_t length, int *width, int *height );
 r_imginfo_t LoadPNG( const char *name, qbyte *(*allocbuf)( void *, size_t, const char *, int ), void *uptr );
 
 #endif // R_IMAGELIB_H
@@ -0,0 +1,317 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// r_jobs.c -- worker threads for CPU side work of the renderer
+
+#include "r_local.h"
+
+/*
+* Jobs are run by a small pool of worker threads in the order they were
+* submitted. The caller owns the job structure and has to keep it around
+* until the job is done. Waiting for a job which no worker has picked up
+* yet runs it on the calling thread, so waiting on jobs in any order never
+* stalls.
+*
+* Job functions must not call anything that isn't thread-safe: no printing,
+* no managed memory, no cvars, no GL and no filesystem.
+*
+* Without worker threads (r_jobthreads 0 or a single CPU) jobs run right
+* when they are submitted.
+*/
+
+#define MAX_JOB_THREADS		16
+#define MAX_PARALLEL_BATCHES	64
+
+static struct qthread_s *r_jobThreads[MAX_JOB_THREADS];
+static int r_numJobThreads;
+
+static struct qmutex_s *r_jobMutex;
+static struct qcondvar_s *r_jobQueued;		// signalled when jobs are submitted
+static struct qcondvar_s *r_jobFinished;	// signalled when a job is done
+static rjob_t *r_jobHead, *r_jobTail;
+static volatile int r_jobQuit;
+
+/*
+* R_RunJob
+*/
+static void R_RunJob( rjob_t *job )
+{
+	job->func( job->arg );
+
+	ri.Mutex_Lock( r_jobMutex );
+	job->state = RJOB_DONE;
+	ri.CondVar_WakeAll( r_jobFinished );
+	ri.Mutex_Unlock( r_jobMutex );
+}
+
+/*
+* R_JobThreadProc
+*/
+static void *R_JobThreadProc( void *param )
+{
+	rjob_t *job;
+
+	while( 1 )
+	{
+		ri.Mutex_Lock( r_jobMutex );
+		while( !r_jobHead && !r_jobQuit )
+			ri.CondVar_Wait( r_jobQueued, r_jobMutex );
+
+		if( !r_jobHead )
+		{
+			ri.Mutex_Unlock( r_jobMutex );
+			break;
+		}
+
+		job = r_jobHead;
+		r_jobHead = job->next;
+		if( !r_jobHead )
+			r_jobTail = NULL;
+		job->state = RJOB_RUNNING;
+		ri.Mutex_Unlock( r_jobMutex );
+
+		R_RunJob( job );
+	}
+
+	return NULL;
+}
+
+/*
+* R_InitJobs
+*/
+void R_InitJobs( void )
+{
+	int i, count;
+
+	r_numJobThreads = 0;
+	r_jobHead = r_jobTail = NULL;
+	r_jobQuit = 0;
+
+	// leave a CPU for the main thread
+	count = r_jobthreads->integer;
+	if( count < 0 )
+		count = ri.Sys_NumberOfProcessors() - 1;
+	count = bound( 0, count, MAX_JOB_THREADS );
+	if( !count )
+		return;
+
+	r_jobMutex = ri.Mutex_Create();
+	r_jobQueued = ri.CondVar_Create();
+	r_jobFinished = ri.CondVar_Create();
+	if( !r_jobMutex || !r_jobQueued || !r_jobFinished )
+	{
+		R_ShutdownJobs();
+		return;
+	}
+
+	for( i = 0; i < count; i++ )
+	{
+		r_jobThreads[i] = ri.Thread_Create( R_JobThreadProc, NULL );
+		if( !r_jobThreads[i] )
+			break;
+		r_numJobThreads++;
+	}
+
+	if( !r_numJobThreads )
+		R_ShutdownJobs();
+}
+
+/*
+* R_ShutdownJobs
+*
+* Runs the remaining jobs and stops the threads
+*/
+void R_ShutdownJobs( void )
+{
+	int i;
+
+	if( r_numJobThreads )
+	{
+		ri.Mutex_Lock( r_jobMutex );
+		r_jobQuit = 1;
+		ri.CondVar_WakeAll( r_jobQueued );
+		ri.Mutex_Unlock( r_jobMutex );
+
+		for( i = 0; i < r_numJobThreads; i++ )
+		{
+			ri.Thread_Join( r_jobThreads[i] );
+			r_jobThreads[i] = NULL;
+		}
+		r_numJobThreads = 0;
+	}
+
+	if( r_jobFinished )
+		ri.CondVar_Destroy( &r_jobFinished );
+	if( r_jobQueued )
+		ri.CondVar_Destroy( &r_jobQueued );
+	if( r_jobMutex )
+		ri.Mutex_Destroy( &r_jobMutex );
+	r_jobHead = r_jobTail = NULL;
+}
+
+/*
+* R_NumJobThreads
+*/
+int R_NumJobThreads( void )
+{
+	return r_numJobThreads;
+}
+
+/*
+* R_SubmitJob
+*/
+void R_SubmitJob( rjob_t *job, void ( *func )( void * ), void *arg )
+{
+	job->func = func;
+	job->arg = arg;
+	job->next = NULL;
+
+	if( !r_numJobThreads )
+	{
+		job->state = RJOB_RUNNING;
+		func( arg );
+		job->state = RJOB_DONE;
+		return;
+	}
+
+	ri.Mutex_Lock( r_jobMutex );
+	job->state = RJOB_QUEUED;
+	if( r_jobTail )
+		r_jobTail->next = job;
+	else
+		r_jobHead = job;
+	r_jobTail = job;
+	ri.CondVar_Wake( r_jobQueued );
+	ri.Mutex_Unlock( r_jobMutex );
+}
+
+/*
+* R_JobDone
+*/
+qboolean R_JobDone( rjob_t *job )
+{
+	int state;
+
+	if( !r_numJobThreads )
+		return job->state == RJOB_DONE;
+
+	ri.Mutex_Lock( r_jobMutex );
+	state = job->state;
+	ri.Mutex_Unlock( r_jobMutex );
+
+	return state == RJOB_DONE;
+}
+
+/*
+* R_WaitJob
+*
+* Takes the job off the queue and runs it here if no worker has started it
+*/
+void R_WaitJob( rjob_t *job )
+{
+	rjob_t *prev, *cur;
+
+	if( !r_numJobThreads )
+		return;
+
+	ri.Mutex_Lock( r_jobMutex );
+
+	if( job->state == RJOB_QUEUED )
+	{
+		for( prev = NULL, cur = r_jobHead; cur && cur != job; prev = cur, cur = cur->next );
+		assert( cur == job );
+
+		if( prev )
+			prev->next = job->next;
+		else
+			r_jobHead = job->next;
+		if( r_jobTail == job )
+			r_jobTail = prev;
+
+		job->state = RJOB_RUNNING;
+		ri.Mutex_Unlock( r_jobMutex );
+
+		R_RunJob( job );
+		return;
+	}
+
+	while( job->state != RJOB_DONE )
+		ri.CondVar_Wait( r_jobFinished, r_jobMutex );
+
+	ri.Mutex_Unlock( r_jobMutex );
+}
+
+typedef struct
+{
+	void		( *func )( void *arg, int first, int last );
+	void		*arg;
+	int			first, last;
+} rparallelbatch_t;
+
+/*
+* R_RunParallelBatch
+*/
+static void R_RunParallelBatch( void *arg )
+{
+	rparallelbatch_t *batch = arg;
+	batch->func( batch->arg, batch->first, batch->last );
+}
+
+/*
+* R_ParallelFor
+*
+* Calls func for consecutive ranges of [0, count), at least minBatch long,
+* on the job threads and the calling thread. Returns when all are done
+*/
+void R_ParallelFor( int count, int minBatch, void ( *func )( void *arg, int first, int last ), void *arg )
+{
+	int i, numBatches, size;
+	rjob_t jobs[MAX_PARALLEL_BATCHES];
+	rparallelbatch_t batches[MAX_PARALLEL_BATCHES];
+
+	if( count <= 0 )
+		return;
+
+	// a few batches per thread, to even out the uneven ones
+	numBatches = ( count + minBatch - 1 ) / max( minBatch, 1 );
+	numBatches = min( numBatches, ( r_numJobThreads + 1 ) * 4 );
+	numBatches = min( numBatches, MAX_PARALLEL_BATCHES );
+	if( !r_numJobThreads || numBatches <= 1 )
+	{
+		func( arg, 0, count );
+		return;
+	}
+
+	size = ( count + numBatches - 1 ) / numBatches;
+	numBatches = ( count + size - 1 ) / size;
+
+	for( i = 0; i < numBatches; i++ )
+	{
+		batches[i].func = func;
+		batches[i].arg = arg;
+		batches[i].first = i * size;
+		batches[i].last = min( count, ( i + 1 ) * size );
+	}
+
+	for( i = 1; i < numBatches; i++ )
+		R_SubmitJob( &jobs[i], R_RunParallelBatch, &batches[i] );
+
+	R_RunParallelBatch( &batches[0] );
+
+	for( i = 1; i < numBatches; i++ )
+		R_WaitJob( &jobs[i] );
+}
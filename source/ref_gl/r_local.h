@@ -382,6 +382,7 @@ extern cvar_t *r_wallcolor;
 extern cvar_t *r_floorcolor;
 
 extern cvar_t *r_maxglslbones;
+extern cvar_t *r_jobthreads;
 
 extern cvar_t *gl_finish;
 extern cvar_t *gl_cull;
@@ -401,6 +402,7 @@ void R_LatLongToNorm4( const qbyte latlong[2], vec4_t out );
 // r_alias.c
 //
 qboolean	R_AddAliasModelToDrawList( const entity_t *e );
+int			R_PrecullAliasModelEntity( const entity_t *e );
 qboolean	R_DrawAliasSurf( const entity_t *e, const shader_t *shader, const mfog_t *fog, drawSurfaceAlias_t *drawSurf );
 qboolean	R_AliasModelLerpTag( orientation_t *orient, const maliasmodel_t *aliasmodel, int framenum, int oldframenum,
 				float lerpfrac, const char *name );
@@ -440,6 +442,8 @@ qboolean	R_CullSphere( const vec3_t centre, const float radius, const unsigned i
 qboolean	R_VisCullBox( const vec3_t mins, const vec3_t maxs );
 qboolean	R_VisCullSphere( const vec3_t origin, float radius );
 int			R_CullModelEntity( const entity_t *e, vec3_t mins, vec3_t maxs, float radius, qboolean sphereCull );
+void		R_PrecullEntities( void );
+void		R_ClearEntityPrecull( void );
 qboolean	R_CullSpriteEntity( const entity_t *e );
 
 //
@@ -468,6 +472,32 @@ void		RFB_GetObjectSize( int object, int *width, int *height );
 void		RFB_FreeUnusedObjects( void );
 void		RFB_Shutdown( void );
 
+//
+// r_jobs.c
+//
+typedef enum
+{
+	RJOB_QUEUED,
+	RJOB_RUNNING,
+	RJOB_DONE
+} rjobstate_t;
+
+typedef struct rjob_s
+{
+	void		( *func )( void *arg );
+	void		*arg;
+	int			state;
+	struct rjob_s *next;
+} rjob_t;
+
+void		R_InitJobs( void );
+void		R_ShutdownJobs( void );
+int			R_NumJobThreads( void );
+void		R_SubmitJob( rjob_t *job, void ( *func )( void * ), void *arg );
+qboolean	R_JobDone( rjob_t *job );
+void		R_WaitJob( rjob_t *job );
+void		R_ParallelFor( int count, int minBatch, void ( *func )( void *arg, int first, int last ), void *arg );
+
 //
 // r_light.c
 //
@@ -647,6 +677,7 @@ void R_ClearScene( void );
 void R_AddEntityToScene( const entity_t *ent );
 void R_AddLightToScene( const vec3_t org, float intensity, float r, float g, float b );
 void R_AddPolyToScene( const poly_t *poly );
+void R_AddQuadsToScene( const poly_t *poly );
 void R_AddLightStyleToScene( int style, float r, float g, float b );
 void R_RenderScene( const refdef_t *fd );
 
@@ -657,11 +688,13 @@ void R_RenderScene( const refdef_t *fd );
 
 void		R_MarkLeaves( void );
 void		R_DrawWorld( void );
+void		R_InitWorldTasks( void );
 qboolean	R_SurfPotentiallyVisible( const msurface_t *surf );
 qboolean	R_SurfPotentiallyShadowed( const msurface_t *surf );
 qboolean	R_SurfPotentiallyLit( const msurface_t *surf );
 qboolean	R_AddBrushModelToDrawList( const entity_t *e );
 float		R_BrushModelBBox( const entity_t *e, vec3_t mins, vec3_t maxs, qboolean *rotated );
+int			R_PrecullBrushModelEntity( const entity_t *e );
 qboolean	R_DrawBSPSurf( const entity_t *e, const shader_t *shader, const mfog_t *fog, drawSurfaceBSP_t *drawSurf );
 
 //
@@ -678,6 +711,7 @@ shader_t	*R_FindShaderForSkinFile( const struct skinfile_s *skinfile, const char
 // r_skm.c
 //
 qboolean	R_AddSkeletalModelToDrawList( const entity_t *e );
+int			R_PrecullSkeletalModelEntity( const entity_t *e );
 qboolean	R_DrawSkeletalSurf( const entity_t *e, const shader_t *shader, const mfog_t *fog, drawSurfaceSkeletal_t *drawSurf );
 float		R_SkeletalModelBBox( const entity_t *e, vec3_t mins, vec3_t maxs );
 void		R_SkeletalModelFrameBounds( const model_t *mod, int frame, vec3_t mins, vec3_t maxs );
@@ -685,9 +719,11 @@ int			R_SkeletalGetBoneInfo( const model_t *mod, int bonenum, char *name, size_t
 void		R_SkeletalGetBonePose( const model_t *mod, int bonenum, int frame, bonepose_t *bonepose );
 int			R_SkeletalGetNumBones( const model_t *mod, int *numFrames );
 
+void		R_InitSkeletalKernels( void );
 void		R_InitSkeletalCache( void );
 void		R_ClearSkeletalCache( void );
 void		R_ShutdownSkeletalCache( void );
+void		R_SkeletalBench_f( void );
 
 //
 // r_vbo.c
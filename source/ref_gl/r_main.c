@@ -1245,6 +1245,8 @@ static void R_DrawEntities( void )
 		return;
 	}
 
+	R_PrecullEntities();
+
 	for( i = 1; i < rsc.numEntities; i++ )
 	{
 		e = R_NUM2ENT(i);
@@ -1292,6 +1294,8 @@ static void R_DrawEntities( void )
 			}
 		}
 	}
+
+	R_ClearEntityPrecull();
 }
 
 //=======================================================================
@@ -1547,6 +1551,9 @@ static void R_UpdateHWGamma( void )
 */
 void R_BeginFrame( float cameraSeparation, qboolean forceClear, qboolean forceVsync )
 {
+	// in case registration was cut short by an error
+	R_EndImageLoadBatch();
+
 	GLimp_BeginFrame();
 
 	RB_BeginFrame();
@@ -79,8 +79,12 @@ static void R_ReserveDrawSurfaces( drawList_t *list, int minMeshes )
 		memcpy( newDs, ds, oldSize * sizeof( sortedDrawSurf_t ) );
 		R_Free( ds );
 	}
+	if( list->sortTemp ) {
+		R_Free( list->sortTemp );
+	}
 	
 	list->drawSurfs = newDs;
+	list->sortTemp = R_Malloc( newSize * sizeof( sortedDrawSurf_t ) );
 	list->maxDrawSurfs = newSize;
 }
 
@@ -165,42 +169,88 @@ qboolean R_AddDSurfToDrawList( const entity_t *e, const mfog_t *fog, const shade
 	return qtrue;
 }
 
-/*
-* R_DrawSurfCompare
-*
-* Comparison callback function for R_SortDrawList
-*/
-static int R_DrawSurfCompare( const sortedDrawSurf_t *sbs1, const sortedDrawSurf_t *sbs2 )
-{
-	if( sbs1->distKey > sbs2->distKey )
-		return 1;
-	if( sbs2->distKey > sbs1->distKey )
-		return -1;
-
-	if( sbs1->sortKey > sbs2->sortKey )
-		return 1;
-	if( sbs2->sortKey > sbs1->sortKey )
-		return -1;
-
-	return 0;
-}
-
 /*
 * R_SortDrawList
 *
-* Regular quicksort. Note that for all kinds of transparent meshes
-* you probably want to set distance or draw order to prevent flickering
-* due to quicksort's unstable nature.
+* LSD radix sort on the distance key followed by the sort key, a byte per
+* pass. Passes in which all surfaces fall into the same bucket are skipped,
+* which is most of the high bytes of the distance key. Being stable, it
+* also keeps surfaces with equal keys in the order they were added.
 */
 void R_SortDrawList( void )
 {
+	unsigned int i, pass, numPasses, count, sum, n;
+	unsigned int counts[8][256];
+	int passes[8];
+	unsigned int key;
 	drawList_t *list = rn.meshlist;
+	sortedDrawSurf_t *src, *dst, *tmp;
+	const sortedDrawSurf_t *sds;
 
 	if( r_draworder->integer ) {
 		return;
 	}
-	qsort( list->drawSurfs, list->numDrawSurfs, sizeof( sortedDrawSurf_t ), 
-		(int (*)(const void *, const void *))R_DrawSurfCompare );
+
+	count = list->numDrawSurfs;
+	if( count < 2 ) {
+		return;
+	}
+
+	// all histograms in a single pass, bytes 0-3 are the sort key
+	memset( counts, 0, sizeof( counts ) );
+	for( i = 0, sds = list->drawSurfs; i < count; i++, sds++ ) {
+		counts[0][sds->sortKey & 0xFF]++;
+		counts[1][(sds->sortKey >> 8) & 0xFF]++;
+		counts[2][(sds->sortKey >> 16) & 0xFF]++;
+		counts[3][sds->sortKey >> 24]++;
+		counts[4][sds->distKey & 0xFF]++;
+		counts[5][(sds->distKey >> 8) & 0xFF]++;
+		counts[6][(sds->distKey >> 16) & 0xFF]++;
+		counts[7][sds->distKey >> 24]++;
+	}
+
+	// turn the counts into offsets and drop the trivial passes
+	for( pass = 0, numPasses = 0; pass < 8; pass++ ) {
+		key = pass < 4 ? list->drawSurfs->sortKey : list->drawSurfs->distKey;
+		if( counts[pass][( key >> ( ( pass & 3 ) * 8 ) ) & 0xFF] == count ) {
+			continue;
+		}
+		for( i = 0, sum = 0; i < 256; i++ ) {
+			n = counts[pass][i];
+			counts[pass][i] = sum;
+			sum += n;
+		}
+		passes[numPasses++] = pass;
+	}
+
+	src = list->drawSurfs;
+	dst = list->sortTemp;
+	for( pass = 0; pass < numPasses; pass++ ) {
+		unsigned int *offsets = counts[passes[pass]];
+		unsigned int shift = ( passes[pass] & 3 ) * 8;
+
+		if( passes[pass] < 4 ) {
+			for( i = 0; i < count; i++ ) {
+				key = ( src[i].sortKey >> shift ) & 0xFF;
+				dst[offsets[key]++] = src[i];
+			}
+		} else {
+			for( i = 0; i < count; i++ ) {
+				key = ( src[i].distKey >> shift ) & 0xFF;
+				dst[offsets[key]++] = src[i];
+			}
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// the sorted surfaces may have ended up in the scratch buffer
+	if( src != list->drawSurfs ) {
+		list->sortTemp = list->drawSurfs;
+		list->drawSurfs = src;
+	}
 }
 
 /*
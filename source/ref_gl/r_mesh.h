@@ -59,6 +59,7 @@ typedef struct
 {
 	unsigned int		numDrawSurfs, maxDrawSurfs;
 	sortedDrawSurf_t	*drawSurfs;
+	sortedDrawSurf_t	*sortTemp;			// same size, R_SortDrawList scratch
 
 	unsigned int		maxVboSlices;
 	vboSlice_t			*vboSlices;
@@ -1116,10 +1116,15 @@ void R_RegisterWorldModel( const char *model, const dvis_t *pvsData )
 	rsh.worldBrushModel = NULL;
 	rsh.worldModelSequence++;
 
+	// decode the world textures on the job threads
+	R_BeginImageLoadBatch();
+
 	mod_isworldmodel = qtrue;
 	rsh.worldModel = Mod_ForName( model, qtrue );
 	mod_isworldmodel = qfalse;
 
+	R_EndImageLoadBatch();
+
 	if( !rsh.worldModel ) {
 		return;
 	}
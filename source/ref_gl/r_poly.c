@@ -38,9 +38,9 @@ void R_BatchPolySurf( const entity_t *e, const shader_t *shader, const mfog_t *f
 {
 	mesh_t mesh;
 
-	// backend knows how to count elements for quads
-	mesh.elems = NULL;
-	mesh.numElems = 0;
+	// backend knows how to build trifan elements for non-indexed polys
+	mesh.elems = poly->elems;
+	mesh.numElems = poly->numElems;
 	mesh.numVerts = poly->numVerts;
 	mesh.xyzArray = poly->xyzArray;
 	mesh.normalsArray = poly->normalsArray;
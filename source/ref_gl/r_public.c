@@ -60,6 +60,7 @@ QF_DLL_EXPORT ref_export_t *GetRefAPI( ref_import_t *import )
 	globals.RegisterModel = R_RegisterModel;
 	globals.RegisterPic = R_RegisterPic;
 	globals.RegisterRawPic = R_RegisterRawPic;
+	globals.ReplaceRawSubPic = R_ReplaceRawSubPic;
 	globals.RegisterLevelshot = R_RegisterLevelshot;
 	globals.RegisterSkin = R_RegisterSkin;
 	globals.RegisterSkinFile = R_RegisterSkinFile;
@@ -72,6 +73,7 @@ QF_DLL_EXPORT ref_export_t *GetRefAPI( ref_import_t *import )
 	globals.AddEntityToScene = R_AddEntityToScene;
 	globals.AddLightToScene = R_AddLightToScene;
 	globals.AddPolyToScene = R_AddPolyToScene;
+	globals.AddQuadsToScene = R_AddQuadsToScene;
 	globals.AddLightStyleToScene = R_AddLightStyleToScene;
 	globals.RenderScene = R_RenderScene;
 
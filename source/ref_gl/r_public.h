@@ -22,10 +22,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "../cgame/ref.h"
 
-#define REF_API_VERSION 2
+#define REF_API_VERSION 7
 
 struct mempool_s;
 struct cinematics_s;
+struct qthread_s;
+struct qmutex_s;
+struct qcondvar_s;
 
 //
 // these are the functions exported by the refresh module
@@ -58,6 +61,8 @@ typedef struct
 
 	unsigned int ( *Sys_Milliseconds )( void );
 	quint64 ( *Sys_Microseconds )( void );
+	int ( *Sys_NumberOfProcessors )( void );
+	unsigned int ( *Com_CPUFeatures )( void );
 
 	int ( *FS_FOpenFile )( const char *filename, int *filenum, int mode );
 	int ( *FS_FOpenAbsoluteFile )( const char *filename, int *filenum, int mode );
@@ -96,6 +101,20 @@ typedef struct
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 	void *( *Mem_Realloc )( void *data, size_t size, const char *filename, int fileline );
 	size_t ( *Mem_PoolTotalSize )( struct mempool_s *pool );
+
+	// threads
+	struct qthread_s *( *Thread_Create )( void *( *routine )( void * ), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
+	struct qmutex_s *( *Mutex_Create )( void );
+	void ( *Mutex_Destroy )( struct qmutex_s **pmutex );
+	void ( *Mutex_Lock )( struct qmutex_s *mutex );
+	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+	struct qcondvar_s *( *CondVar_Create )( void );
+	void ( *CondVar_Destroy )( struct qcondvar_s **pcond );
+	void ( *CondVar_Wait )( struct qcondvar_s *cond, struct qmutex_s *mutex );
+	void ( *CondVar_Wake )( struct qcondvar_s *cond );
+	void ( *CondVar_WakeAll )( struct qcondvar_s *cond );
+	int ( *Atomic_Add )( volatile int *value, int add );
 } ref_import_t;
 
 typedef struct
@@ -129,6 +148,7 @@ typedef struct
 	struct model_s *( *RegisterModel )( const char *name );
 	struct shader_s *( *RegisterPic )( const char *name );
 	struct shader_s *( *RegisterRawPic )( const char *name, int width, int height, qbyte *data );
+	void		( *ReplaceRawSubPic )( struct shader_s *shader, int x, int y, int width, int height, qbyte *data );
 	struct shader_s *( *RegisterLevelshot )( const char *name, struct shader_s *defaultShader, qboolean *matchesDefault );
 	struct shader_s *( *RegisterSkin )( const char *name );
 	struct skinfile_s *( *RegisterSkinFile )( const char *name );
@@ -141,6 +161,7 @@ typedef struct
 	void		( *AddEntityToScene )( const entity_t *ent );
 	void		( *AddLightToScene )( const vec3_t org, float intensity, float r, float g, float b );
 	void		( *AddPolyToScene )( const poly_t *poly );
+	void		( *AddQuadsToScene )( const poly_t *poly );
 	void		( *AddLightStyleToScene )( int style, float r, float g, float b );
 	void		( *RenderScene )( const refdef_t *fd );
 
@@ -114,6 +114,7 @@ cvar_t *r_wallcolor;
 cvar_t *r_floorcolor;
 
 cvar_t *r_maxglslbones;
+cvar_t *r_jobthreads;
 
 cvar_t *gl_drawbuffer;
 cvar_t *gl_driver;
@@ -868,6 +869,9 @@ static void R_Register( const char *screenshotsPrefix )
 
 	r_maxglslbones = ri.Cvar_Get( "r_maxglslbones", STR_TOSTR( MAX_GLSL_UNIFORM_BONES ), CVAR_LATCH_VIDEO );
 
+	// -1 picks one thread per CPU but the first
+	r_jobthreads = ri.Cvar_Get( "r_jobthreads", "-1", CVAR_ARCHIVE|CVAR_LATCH_VIDEO );
+
 	gl_finish = ri.Cvar_Get( "gl_finish", "0", CVAR_ARCHIVE );
 	gl_cull = ri.Cvar_Get( "gl_cull", "1", 0 );
 	gl_drawbuffer = ri.Cvar_Get( "gl_drawbuffer", "GL_BACK", 0 );
@@ -884,6 +888,7 @@ static void R_Register( const char *screenshotsPrefix )
 	ri.Cmd_AddCommand( "screenshot", R_ScreenShot_f );
 	ri.Cmd_AddCommand( "envshot", R_EnvShot_f );
 	ri.Cmd_AddCommand( "modellist", Mod_Modellist_f );
+	ri.Cmd_AddCommand( "skmbench", R_SkeletalBench_f );
 	ri.Cmd_AddCommand( "gfxinfo", R_GfxInfo_f );
 	ri.Cmd_AddCommand( "glslprogramlist", RP_ProgramList_f );
 }
@@ -1028,6 +1033,7 @@ init_qgl:
 	rsh.screenshotPrefix = R_CopyString( screenshotPrefix );
 
 	R_InitDrawLists();
+	R_InitWorldTasks();
 
 	if( !R_RegisterGLExtensions() ) {
 		QGL_Shutdown();
@@ -1051,6 +1057,8 @@ init_qgl:
 
 	RFB_Init();
 
+	R_InitJobs();
+
 	R_InitImages();
 
 	RB_Init();
@@ -1098,6 +1106,7 @@ static void R_InitVolatileAssets( void )
 {
 	// init volatile data
 	R_InitSkeletalCache();
+	R_InitSkeletalKernels();
 	R_InitCoronas();
 	R_InitCustomColors();
 
@@ -1174,6 +1183,7 @@ void R_EndRegistration( void )
 void R_Shutdown( qboolean verbose )
 {
 	ri.Cmd_RemoveCommand( "modellist" );
+	ri.Cmd_RemoveCommand( "skmbench" );
 	ri.Cmd_RemoveCommand( "screenshot" );
 	ri.Cmd_RemoveCommand( "envshot" );
 	ri.Cmd_RemoveCommand( "imagelist" );
@@ -1206,6 +1216,8 @@ void R_Shutdown( qboolean verbose )
 
 	R_ShutdownImages();
 
+	R_ShutdownJobs();
+
 	RFB_Shutdown();
 
 	// restore original gamma
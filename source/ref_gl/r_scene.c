@@ -117,46 +117,140 @@ void R_AddLightToScene( const vec3_t org, float intensity, float r, float g, flo
 	}
 }
 
+/*
+* R_AddScenePoly
+*/
+static void R_AddScenePoly( const poly_t *poly, int numVerts, elem_t *elems, int numElems )
+{
+	drawSurfacePoly_t *dp;
+
+	if( rsc.numPolys >= MAX_POLYS ) {
+		return;
+	}
+
+	assert( poly->shader != NULL );
+	if( !poly->shader ) {
+		return;
+	}
+
+	dp = &rsc.polys[rsc.numPolys];
+	dp->type = ST_POLY;
+	dp->shader = poly->shader;
+	dp->numVerts = numVerts;
+	dp->xyzArray = poly->verts;
+	dp->normalsArray = poly->normals;
+	dp->stArray = poly->stcoords;
+	dp->colorsArray = poly->colors;
+	dp->elems = elems;
+	dp->numElems = numElems;
+	dp->fogNum = poly->fognum;
+
+	// if fogNum is unset, we need to find the volume for polygon bounds
+	if( !dp->fogNum ) {
+		int i;
+		mfog_t *fog;
+		vec3_t dpmins, dpmaxs;
+
+		ClearBounds( dpmins, dpmaxs );
+
+		for( i = 0; i < dp->numVerts; i++ ) {
+			AddPointToBounds( dp->xyzArray[i], dpmins, dpmaxs );
+		}
+
+		fog = R_FogForBounds( dpmins, dpmaxs );
+		dp->fogNum = (fog ? fog - rsh.worldBrushModel->fogs + 1 : -1);
+	}
+
+	rsc.numPolys++;
+}
+
 /*
 * R_AddPolyToScene
 */
 void R_AddPolyToScene( const poly_t *poly )
 {
-	if( ( rsc.numPolys < MAX_POLYS ) && poly && poly->numverts )
-	{
-		drawSurfacePoly_t *dp = &rsc.polys[rsc.numPolys];
+	if( !poly || !poly->numverts ) {
+		return;
+	}
 
-		assert( poly->shader != NULL );
-		if( !poly->shader ) {
+	if( poly->elems && poly->numelems ) {
+		// indexed polys can't be safely truncated
+		if( poly->numverts > MAX_POLY_VERTS ) {
 			return;
 		}
+		R_AddScenePoly( poly, poly->numverts, poly->elems, poly->numelems );
+		return;
+	}
 
-		dp->type = ST_POLY;
-		dp->shader = poly->shader;
-		dp->numVerts = min( poly->numverts, MAX_POLY_VERTS );
-		dp->xyzArray = poly->verts;
-		dp->normalsArray = poly->normals;
-		dp->stArray = poly->stcoords;
-		dp->colorsArray = poly->colors;
-		dp->fogNum = poly->fognum;
-
-		// if fogNum is unset, we need to find the volume for polygon bounds
-		if( !dp->fogNum ) {
-			int i;
-			mfog_t *fog;
-			vec3_t dpmins, dpmaxs;
-
-			ClearBounds( dpmins, dpmaxs );
-
-			for( i = 0; i < dp->numVerts; i++ ) {
-				AddPointToBounds( dp->xyzArray[i], dpmins, dpmaxs );
-			}
+	R_AddScenePoly( poly, min( poly->numverts, MAX_POLY_VERTS ), NULL, 0 );
+}
+
+/*
+* R_FogForQuad
+*/
+static int R_FogForQuad( const poly_t *poly, int quad )
+{
+	int i;
+	mfog_t *fog;
+	vec3_t mins, maxs;
+
+	ClearBounds( mins, maxs );
+	for( i = quad * 4; i < quad * 4 + 4; i++ ) {
+		AddPointToBounds( poly->verts[i], mins, maxs );
+	}
+
+	fog = R_FogForBounds( mins, maxs );
+	return fog ? fog - rsh.worldBrushModel->fogs + 1 : -1;
+}
+
+/*
+* R_AddQuadsToScene
+*
+* Adds a batch of independent quads sharing the same shader, every
+* 4 vertices of the poly form a separate quad. Without a fognum the
+* fog is looked up per quad and the batch is split where it changes.
+*/
+void R_AddQuadsToScene( const poly_t *poly )
+{
+	int numQuads, first, last, fogNum, nextFogNum;
+	poly_t run;
+	static elem_t quadElems[MAX_POLY_QUADS*6];
 
-			fog = R_FogForBounds( dpmins, dpmaxs );
-			dp->fogNum = (fog ? fog - rsh.worldBrushModel->fogs + 1 : -1);
+	if( !poly ) {
+		return;
+	}
+
+	numQuads = min( poly->numverts / 4, MAX_POLY_QUADS );
+	if( !numQuads ) {
+		return;
+	}
+
+	if( !quadElems[1] ) {
+		R_BuildQuadElements( 0, MAX_POLY_QUADS*4, quadElems );
+	}
+
+	if( poly->fognum ) {
+		R_AddScenePoly( poly, numQuads * 4, quadElems, numQuads * 6 );
+		return;
+	}
+
+	run = *poly;
+	fogNum = R_FogForQuad( poly, 0 );
+	for( first = 0; first < numQuads; first = last, fogNum = nextFogNum ) {
+		nextFogNum = fogNum;
+		for( last = first + 1; last < numQuads; last++ ) {
+			nextFogNum = R_FogForQuad( poly, last );
+			if( nextFogNum != fogNum ) {
+				break;
+			}
 		}
 
-		rsc.numPolys++;
+		run.verts = poly->verts + first * 4;
+		run.normals = poly->normals ? poly->normals + first * 4 : NULL;
+		run.stcoords = poly->stcoords ? poly->stcoords + first * 4 : NULL;
+		run.colors = poly->colors ? poly->colors + first * 4 : NULL;
+		run.fognum = fogNum;
+		R_AddScenePoly( &run, ( last - first ) * 4, quadElems, ( last - first ) * 6 );
 	}
 }
 
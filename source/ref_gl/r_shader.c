@@ -2889,6 +2889,27 @@ shader_t *R_RegisterRawPic( const char *name, int width, int height, qbyte *data
 	return s;
 }
 
+/*
+* R_ReplaceRawSubPic
+*
+* Replaces a rectangle of the image of a shader registered by R_RegisterRawPic.
+*/
+void R_ReplaceRawSubPic( shader_t *shader, int x, int y, int width, int height, qbyte *data )
+{
+	image_t *image;
+
+	if( !shader || shader->type != SHADER_TYPE_2D_RAW ) {
+		return;
+	}
+
+	image = shader->passes[0].images[0];
+	if( !image || image == rsh.noTexture ) {
+		return;
+	}
+
+	R_ReplaceImageRegion( image, x, y, &data, width, height );
+}
+
 /*
 * R_RegisterLevelshot
 */
@@ -289,6 +289,7 @@ shader_t	*R_LoadShader( const char *name, shaderType_e type, qboolean forceDefau
 shader_t	*R_RegisterShader( const char *name, shaderType_e type );
 shader_t	*R_RegisterPic( const char *name );
 shader_t	*R_RegisterRawPic( const char *name, int width, int height, qbyte *data );
+void		R_ReplaceRawSubPic( shader_t *shader, int x, int y, int width, int height, qbyte *data );
 shader_t	*R_RegisterLevelshot( const char *name, shader_t *defaultShader, qboolean *matchesDefault );
 shader_t	*R_RegisterSkin( const char *name );
 shader_t	*R_RegisterVideo( const char *name );
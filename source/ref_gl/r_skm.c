@@ -23,6 +23,21 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "r_local.h"
 #include "iqm.h"
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+# define SKM_SSE2
+# include <emmintrin.h>
+#endif
+
+#if defined( SKM_SSE2 ) && ( defined( __clang__ ) || ( defined( __GNUC__ ) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+# define SKM_AVX
+# define SKM_AVX_FUNC __attribute__( ( target( "avx" ) ) )
+# include <immintrin.h>
+#elif defined( SKM_SSE2 ) && defined( _MSC_VER ) && ( _MSC_VER >= 1600 )
+# define SKM_AVX
+# define SKM_AVX_FUNC
+# include <immintrin.h>
+#endif
+
 // typedefs
 typedef struct iqmheader iqmheader_t;
 typedef struct iqmvertexarray iqmvertexarray_t;
@@ -149,6 +164,91 @@ static int Mod_SkeletalModel_AddBlend( mskmodel_t *model, const mskblend_t *newb
 	return model->numbones + i;
 }
 
+typedef struct
+{
+	unsigned int blend;
+	unsigned int index;
+} mskvertkey_t;
+
+/*
+* Mod_SkeletalCompareVertKeys
+*/
+static int Mod_SkeletalCompareVertKeys( const void *a, const void *b )
+{
+	const mskvertkey_t *ka = ( const mskvertkey_t * )a, *kb = ( const mskvertkey_t * )b;
+
+	if( ka->blend != kb->blend ) {
+		return ka->blend < kb->blend ? -1 : 1;
+	}
+	return ka->index < kb->index ? -1 : ( ka->index > kb->index ? 1 : 0 );
+}
+
+/*
+* Mod_SkeletalPermuteVertArray
+*/
+static void Mod_SkeletalPermuteVertArray( void *data, size_t stride, unsigned int numverts, const mskvertkey_t *keys, qbyte *temp )
+{
+	unsigned int i;
+
+	for( i = 0; i < numverts; i++ ) {
+		memcpy( temp + i * stride, ( qbyte * )data + keys[i].index * stride, stride );
+	}
+	memcpy( data, temp, numverts * stride );
+}
+
+/*
+* Mod_SkeletalSortMeshVerts
+* 
+* Reorders the vertices of the mesh so that the vertices sharing the same blend
+* are next to each other, which lets the CPU transforms load each pose only once
+*/
+static void Mod_SkeletalSortMeshVerts( mskmesh_t *mesh )
+{
+	unsigned int i;
+	unsigned int *remap;
+	mskvertkey_t *keys;
+	qbyte *temp;
+
+	if( mesh->numverts < 2 ) {
+		return;
+	}
+
+	keys = R_Malloc( sizeof( *keys ) * mesh->numverts );
+	for( i = 0; i < mesh->numverts; i++ ) {
+		keys[i].blend = mesh->vertexBlends[i];
+		keys[i].index = i;
+	}
+	qsort( keys, mesh->numverts, sizeof( *keys ), Mod_SkeletalCompareVertKeys );
+
+	for( i = 0; i < mesh->numverts && keys[i].index == i; i++ );
+	if( i == mesh->numverts ) {
+		// already sorted
+		R_Free( keys );
+		return;
+	}
+
+	temp = R_Malloc( sizeof( vec4_t ) * mesh->numverts );
+
+	Mod_SkeletalPermuteVertArray( mesh->xyzArray, sizeof( vec4_t ), mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->normalsArray, sizeof( vec4_t ), mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->stArray, sizeof( vec2_t ), mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->sVectorsArray, sizeof( vec4_t ), mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->blendIndices, sizeof( qbyte ) * SKM_MAX_WEIGHTS, mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->blendWeights, sizeof( qbyte ) * SKM_MAX_WEIGHTS, mesh->numverts, keys, temp );
+	Mod_SkeletalPermuteVertArray( mesh->vertexBlends, sizeof( unsigned int ), mesh->numverts, keys, temp );
+
+	remap = ( unsigned int * )temp;
+	for( i = 0; i < mesh->numverts; i++ ) {
+		remap[keys[i].index] = i;
+	}
+	for( i = 0; i < mesh->numtris * 3; i++ ) {
+		mesh->elems[i] = remap[mesh->elems[i]];
+	}
+
+	R_Free( temp );
+	R_Free( keys );
+}
+
 /*
 * Mod_LoadSkeletalModel
 */
@@ -641,6 +741,9 @@ void Mod_LoadSkeletalModel( model_t *mod, const model_t *parent, void *buffer, b
 			outelems += 3;
 		}
 
+		// group the vertices by blend for the CPU transforms
+		Mod_SkeletalSortMeshVerts( &poutmodel->meshes[i] );
+
 		poutmodel->meshes[i].maxWeights = 1;
 
 		vblendweights_byte = poutmodel->meshes[i].blendWeights;
@@ -1095,6 +1198,318 @@ static void R_SkeletalTransformNormalsAndSVecs( int numverts, const unsigned int
 	}
 }
 
+#ifdef SKM_SSE2
+
+/*
+* R_SkeletalTransformVector_SSE2
+*/
+static inline __m128 R_SkeletalTransformVector_SSE2( __m128 v, __m128 c0, __m128 c1, __m128 c2 )
+{
+	__m128 x = _mm_shuffle_ps( v, v, 0x00 );
+	__m128 y = _mm_shuffle_ps( v, v, 0x55 );
+	__m128 z = _mm_shuffle_ps( v, v, 0xAA );
+
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, c0 ), _mm_mul_ps( y, c1 ) ), _mm_mul_ps( z, c2 ) );
+}
+
+/*
+* R_SkeletalBlendPoses_SSE2
+*/
+static void R_SkeletalBlendPoses_SSE2( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose )
+{
+	unsigned int i, j, k;
+	float *pose;
+	mskblend_t *blend;
+
+	for( i = 0, j = numbones, blend = blends; i < numblends; i++, j++, blend++ ) {
+		const float *b;
+		__m128 f, p0, p1, p2, p3;
+
+		pose = relbonepose[j];
+
+		b = relbonepose[blend->indices[0]];
+		f = _mm_set1_ps( blend->weights[0] * (1.0 / 255.0) );
+
+		p0 = _mm_mul_ps( f, _mm_loadu_ps( b + 0 ) );
+		p1 = _mm_mul_ps( f, _mm_loadu_ps( b + 4 ) );
+		p2 = _mm_mul_ps( f, _mm_loadu_ps( b + 8 ) );
+		p3 = _mm_mul_ps( f, _mm_loadu_ps( b + 12 ) );
+
+		for( k = 1; k < SKM_MAX_WEIGHTS && blend->weights[k]; k++ ) {
+			b = relbonepose[blend->indices[k]];
+			f = _mm_set1_ps( blend->weights[k] * (1.0 / 255.0) );
+
+			p0 = _mm_add_ps( p0, _mm_mul_ps( f, _mm_loadu_ps( b + 0 ) ) );
+			p1 = _mm_add_ps( p1, _mm_mul_ps( f, _mm_loadu_ps( b + 4 ) ) );
+			p2 = _mm_add_ps( p2, _mm_mul_ps( f, _mm_loadu_ps( b + 8 ) ) );
+			p3 = _mm_add_ps( p3, _mm_mul_ps( f, _mm_loadu_ps( b + 12 ) ) );
+		}
+
+		_mm_storeu_ps( pose + 0, p0 );
+		_mm_storeu_ps( pose + 4, p1 );
+		_mm_storeu_ps( pose + 8, p2 );
+		_mm_storeu_ps( pose + 12, p3 );
+	}
+}
+
+/*
+* R_SkeletalTransformVerts_SSE2
+* 
+* The vertices are sorted by blend, so the pose is only loaded when the blend changes.
+* The 4th row of the blended poses is never written to, hence the mask.
+*/
+static void R_SkeletalTransformVerts_SSE2( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov )
+{
+	const float *pose = NULL;
+	const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+	const __m128 one = _mm_set_ps( 1, 0, 0, 0 );
+	__m128 c0, c1, c2, c3, r;
+
+	c0 = c1 = c2 = c3 = _mm_setzero_ps();
+
+	for( ; numverts; numverts--, v += 4, ov += 4, blends++ ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm_and_ps( _mm_loadu_ps( pose + 0 ), mask );
+			c1 = _mm_and_ps( _mm_loadu_ps( pose + 4 ), mask );
+			c2 = _mm_and_ps( _mm_loadu_ps( pose + 8 ), mask );
+			c3 = _mm_and_ps( _mm_loadu_ps( pose + 12 ), mask );
+		}
+
+		r = _mm_add_ps( R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ), c0, c1, c2 ), c3 );
+		_mm_storeu_ps( ov, _mm_or_ps( _mm_and_ps( r, mask ), one ) );
+	}
+}
+
+/*
+* R_SkeletalTransformNormals_SSE2
+*/
+static void R_SkeletalTransformNormals_SSE2( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov )
+{
+	const float *pose = NULL;
+	const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+	__m128 c0, c1, c2, r;
+
+	c0 = c1 = c2 = _mm_setzero_ps();
+
+	for( ; numverts; numverts--, v += 4, ov += 4, blends++ ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm_and_ps( _mm_loadu_ps( pose + 0 ), mask );
+			c1 = _mm_and_ps( _mm_loadu_ps( pose + 4 ), mask );
+			c2 = _mm_and_ps( _mm_loadu_ps( pose + 8 ), mask );
+		}
+
+		r = R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ), c0, c1, c2 );
+		_mm_storeu_ps( ov, _mm_and_ps( r, mask ) );
+	}
+}
+
+/*
+* R_SkeletalTransformNormalsAndSVecs_SSE2
+*/
+static void R_SkeletalTransformNormalsAndSVecs_SSE2( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv )
+{
+	const float *pose = NULL;
+	const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+	__m128 c0, c1, c2, r, s;
+
+	c0 = c1 = c2 = _mm_setzero_ps();
+
+	for( ; numverts; numverts--, v += 4, ov += 4, sv += 4, osv += 4, blends++ ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm_and_ps( _mm_loadu_ps( pose + 0 ), mask );
+			c1 = _mm_and_ps( _mm_loadu_ps( pose + 4 ), mask );
+			c2 = _mm_and_ps( _mm_loadu_ps( pose + 8 ), mask );
+		}
+
+		r = R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ), c0, c1, c2 );
+		_mm_storeu_ps( ov, _mm_and_ps( r, mask ) );
+
+		// the 4th component of the S-vector is the handedness and is kept as is
+		s = _mm_loadu_ps( sv );
+		r = R_SkeletalTransformVector_SSE2( s, c0, c1, c2 );
+		_mm_storeu_ps( osv, _mm_or_ps( _mm_and_ps( r, mask ), _mm_andnot_ps( mask, s ) ) );
+	}
+}
+
+#endif // SKM_SSE2
+
+#ifdef SKM_AVX
+
+/*
+* R_SkeletalTransformVectors_AVX
+*
+* Transforms two vectors at once, one per 128-bit lane
+*/
+static inline SKM_AVX_FUNC __m256 R_SkeletalTransformVectors_AVX( __m256 v, __m256 c0, __m256 c1, __m256 c2 )
+{
+	__m256 x = _mm256_permute_ps( v, 0x00 );
+	__m256 y = _mm256_permute_ps( v, 0x55 );
+	__m256 z = _mm256_permute_ps( v, 0xAA );
+
+	return _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x, c0 ), _mm256_mul_ps( y, c1 ) ), _mm256_mul_ps( z, c2 ) );
+}
+
+/*
+* R_SkeletalBlendPoses_AVX
+*/
+static SKM_AVX_FUNC void R_SkeletalBlendPoses_AVX( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose )
+{
+	unsigned int i, j, k;
+	float *pose;
+	mskblend_t *blend;
+
+	for( i = 0, j = numbones, blend = blends; i < numblends; i++, j++, blend++ ) {
+		const float *b;
+		__m256 f, p01, p23;
+
+		pose = relbonepose[j];
+
+		b = relbonepose[blend->indices[0]];
+		f = _mm256_set1_ps( blend->weights[0] * (1.0 / 255.0) );
+
+		p01 = _mm256_mul_ps( f, _mm256_loadu_ps( b + 0 ) );
+		p23 = _mm256_mul_ps( f, _mm256_loadu_ps( b + 8 ) );
+
+		for( k = 1; k < SKM_MAX_WEIGHTS && blend->weights[k]; k++ ) {
+			b = relbonepose[blend->indices[k]];
+			f = _mm256_set1_ps( blend->weights[k] * (1.0 / 255.0) );
+
+			p01 = _mm256_add_ps( p01, _mm256_mul_ps( f, _mm256_loadu_ps( b + 0 ) ) );
+			p23 = _mm256_add_ps( p23, _mm256_mul_ps( f, _mm256_loadu_ps( b + 8 ) ) );
+		}
+
+		_mm256_storeu_ps( pose + 0, p01 );
+		_mm256_storeu_ps( pose + 8, p23 );
+	}
+
+	_mm256_zeroupper();
+}
+
+/*
+* R_SkeletalTransformVerts_AVX
+*
+* Pairs of vertices sharing the same blend are transformed together,
+* the odd vertex at the end of a blend group goes through the SSE path
+*/
+static SKM_AVX_FUNC void R_SkeletalTransformVerts_AVX( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov )
+{
+	const float *pose = NULL;
+	const __m256 mask = _mm256_castsi256_ps( _mm256_set_epi32( 0, -1, -1, -1, 0, -1, -1, -1 ) );
+	const __m256 one = _mm256_set_ps( 1, 0, 0, 0, 1, 0, 0, 0 );
+	__m256 c0, c1, c2, c3, r;
+
+	c0 = c1 = c2 = c3 = _mm256_setzero_ps();
+
+	while( numverts ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 0 ) ), mask );
+			c1 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 4 ) ), mask );
+			c2 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 8 ) ), mask );
+			c3 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 12 ) ), mask );
+		}
+
+		if( numverts > 1 && blends[1] == blends[0] ) {
+			r = _mm256_add_ps( R_SkeletalTransformVectors_AVX( _mm256_loadu_ps( v ), c0, c1, c2 ), c3 );
+			_mm256_storeu_ps( ov, _mm256_or_ps( _mm256_and_ps( r, mask ), one ) );
+			numverts -= 2, v += 8, ov += 8, blends += 2;
+		} else {
+			__m128 r1 = _mm_add_ps( R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ),
+				_mm256_castps256_ps128( c0 ), _mm256_castps256_ps128( c1 ), _mm256_castps256_ps128( c2 ) ),
+				_mm256_castps256_ps128( c3 ) );
+			_mm_storeu_ps( ov, _mm_or_ps( _mm_and_ps( r1, _mm256_castps256_ps128( mask ) ), _mm256_castps256_ps128( one ) ) );
+			numverts--, v += 4, ov += 4, blends++;
+		}
+	}
+
+	_mm256_zeroupper();
+}
+
+/*
+* R_SkeletalTransformNormals_AVX
+*/
+static SKM_AVX_FUNC void R_SkeletalTransformNormals_AVX( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov )
+{
+	const float *pose = NULL;
+	const __m256 mask = _mm256_castsi256_ps( _mm256_set_epi32( 0, -1, -1, -1, 0, -1, -1, -1 ) );
+	__m256 c0, c1, c2, r;
+
+	c0 = c1 = c2 = _mm256_setzero_ps();
+
+	while( numverts ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 0 ) ), mask );
+			c1 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 4 ) ), mask );
+			c2 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 8 ) ), mask );
+		}
+
+		if( numverts > 1 && blends[1] == blends[0] ) {
+			r = R_SkeletalTransformVectors_AVX( _mm256_loadu_ps( v ), c0, c1, c2 );
+			_mm256_storeu_ps( ov, _mm256_and_ps( r, mask ) );
+			numverts -= 2, v += 8, ov += 8, blends += 2;
+		} else {
+			__m128 r1 = R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ),
+				_mm256_castps256_ps128( c0 ), _mm256_castps256_ps128( c1 ), _mm256_castps256_ps128( c2 ) );
+			_mm_storeu_ps( ov, _mm_and_ps( r1, _mm256_castps256_ps128( mask ) ) );
+			numverts--, v += 4, ov += 4, blends++;
+		}
+	}
+
+	_mm256_zeroupper();
+}
+
+/*
+* R_SkeletalTransformNormalsAndSVecs_AVX
+*/
+static SKM_AVX_FUNC void R_SkeletalTransformNormalsAndSVecs_AVX( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv )
+{
+	const float *pose = NULL;
+	const __m256 mask = _mm256_castsi256_ps( _mm256_set_epi32( 0, -1, -1, -1, 0, -1, -1, -1 ) );
+	__m256 c0, c1, c2, r, s;
+
+	c0 = c1 = c2 = _mm256_setzero_ps();
+
+	while( numverts ) {
+		if( relbonepose[*blends] != pose ) {
+			pose = relbonepose[*blends];
+			c0 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 0 ) ), mask );
+			c1 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 4 ) ), mask );
+			c2 = _mm256_and_ps( _mm256_broadcast_ps( ( const __m128 * )( pose + 8 ) ), mask );
+		}
+
+		if( numverts > 1 && blends[1] == blends[0] ) {
+			r = R_SkeletalTransformVectors_AVX( _mm256_loadu_ps( v ), c0, c1, c2 );
+			_mm256_storeu_ps( ov, _mm256_and_ps( r, mask ) );
+
+			s = _mm256_loadu_ps( sv );
+			r = R_SkeletalTransformVectors_AVX( s, c0, c1, c2 );
+			_mm256_storeu_ps( osv, _mm256_or_ps( _mm256_and_ps( r, mask ), _mm256_andnot_ps( mask, s ) ) );
+
+			numverts -= 2, v += 8, ov += 8, sv += 8, osv += 8, blends += 2;
+		} else {
+			__m128 m1 = _mm256_castps256_ps128( mask ), s1, r1;
+			__m128 c01 = _mm256_castps256_ps128( c0 ), c11 = _mm256_castps256_ps128( c1 ), c21 = _mm256_castps256_ps128( c2 );
+
+			r1 = R_SkeletalTransformVector_SSE2( _mm_loadu_ps( v ), c01, c11, c21 );
+			_mm_storeu_ps( ov, _mm_and_ps( r1, m1 ) );
+
+			s1 = _mm_loadu_ps( sv );
+			r1 = R_SkeletalTransformVector_SSE2( s1, c01, c11, c21 );
+			_mm_storeu_ps( osv, _mm_or_ps( _mm_and_ps( r1, m1 ), _mm_andnot_ps( m1, s1 ) ) );
+
+			numverts--, v += 4, ov += 4, sv += 4, osv += 4, blends++;
+		}
+	}
+
+	_mm256_zeroupper();
+}
+
+#endif // SKM_AVX
+
 // set the FP precision back to whatever value it was
 #if defined ( _WIN32 ) && ( _MSC_VER >= 1400 ) && defined( NDEBUG )
 # pragma float_control(pop)
@@ -1102,6 +1517,194 @@ static void R_SkeletalTransformNormalsAndSVecs( int numverts, const unsigned int
 # pragma fp_contract(off)	// this line is needed on Itanium processors
 #endif
 
+typedef struct
+{
+	const char *name;
+	unsigned int cpuFeatures;
+	void ( *blendPoses )( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose );
+	void ( *transformVerts )( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov );
+	void ( *transformNormals )( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov );
+	void ( *transformNormalsAndSVecs )( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv );
+} skmkernels_t;
+
+// ordered from the slowest to the fastest
+static const skmkernels_t r_skmkernels[] =
+{
+	{
+		"generic", 0,
+		R_SkeletalBlendPoses, R_SkeletalTransformVerts, R_SkeletalTransformNormals, R_SkeletalTransformNormalsAndSVecs
+	},
+#ifdef SKM_SSE2
+	{
+		"sse2", QCPU_HAS_SSE2,
+		R_SkeletalBlendPoses_SSE2, R_SkeletalTransformVerts_SSE2, R_SkeletalTransformNormals_SSE2, R_SkeletalTransformNormalsAndSVecs_SSE2
+	},
+#endif
+#ifdef SKM_AVX
+	{
+		"avx", QCPU_HAS_SSE2|QCPU_HAS_AVX,
+		R_SkeletalBlendPoses_AVX, R_SkeletalTransformVerts_AVX, R_SkeletalTransformNormals_AVX, R_SkeletalTransformNormalsAndSVecs_AVX
+	},
+#endif
+};
+
+#define NUM_SKM_KERNELS ( sizeof( r_skmkernels ) / sizeof( r_skmkernels[0] ) )
+
+static const skmkernels_t *r_skmkernel = &r_skmkernels[0];
+
+/*
+* R_InitSkeletalKernels
+* 
+* Picks the fastest CPU transforms the processor supports
+*/
+void R_InitSkeletalKernels( void )
+{
+	unsigned int i;
+	unsigned int features = ri.Com_CPUFeatures();
+
+	r_skmkernel = &r_skmkernels[0];
+	for( i = 1; i < NUM_SKM_KERNELS; i++ ) {
+		if( ( features & r_skmkernels[i].cpuFeatures ) == r_skmkernels[i].cpuFeatures ) {
+			r_skmkernel = &r_skmkernels[i];
+		}
+	}
+
+	ri.Com_DPrintf( "Using %s skeletal transforms\n", r_skmkernel->name );
+}
+
+/*
+* R_SkeletalBenchPoses
+* 
+* Computes the bone matrices for the frame, the same way R_DrawSkeletalSurf does
+*/
+static void R_SkeletalBenchPoses( const mskmodel_t *skmodel, unsigned int frame, mat4_t *relbonepose )
+{
+	unsigned int i;
+	dualquat_t dq;
+	bonepose_t tempbonepose[256];
+	const bonepose_t *bp = skmodel->frames[frame].boneposes;
+
+	for( i = 0; i < skmodel->numbones; i++ ) {
+		if( skmodel->bones[i].parent >= 0 ) {
+			DualQuat_Multiply( tempbonepose[skmodel->bones[i].parent].dualquat, bp[i].dualquat, tempbonepose[i].dualquat );
+		}
+		else {
+			DualQuat_Copy( bp[i].dualquat, tempbonepose[i].dualquat );
+		}
+	}
+
+	for( i = 0; i < skmodel->numbones; i++ ) {
+		DualQuat_Multiply( tempbonepose[i].dualquat, skmodel->invbaseposes[i].dualquat, dq );
+		DualQuat_Normalize( dq );
+		Matrix4_FromDualQuaternion( dq, relbonepose[i] );
+	}
+}
+
+/*
+* R_SkeletalBenchRun
+*/
+static void R_SkeletalBenchRun( const skmkernels_t *kernel, const mskmodel_t *skmodel, mat4_t *relbonepose, vec4_t *out )
+{
+	unsigned int i;
+	const mskmesh_t *mesh;
+
+	kernel->blendPoses( skmodel->numblends, skmodel->blends, skmodel->numbones, relbonepose );
+
+	for( i = 0, mesh = skmodel->meshes; i < skmodel->nummeshes; out += mesh->numverts * 3, i++, mesh++ ) {
+		kernel->transformVerts( mesh->numverts, mesh->vertexBlends, relbonepose,
+			( vec_t * )mesh->xyzArray[0], ( vec_t * )out[0] );
+		kernel->transformNormalsAndSVecs( mesh->numverts, mesh->vertexBlends, relbonepose,
+			( vec_t * )mesh->normalsArray[0], ( vec_t * )out[mesh->numverts],
+			( vec_t * )mesh->sVectorsArray[0], ( vec_t * )out[mesh->numverts * 2] );
+	}
+}
+
+/*
+* R_SkeletalBench_f
+* 
+* Times the CPU transforms over all frames of a skeletal model and compares
+* their results to the generic ones
+*/
+void R_SkeletalBench_f( void )
+{
+	unsigned int i, j, f, repeats, numposes;
+	float error, maxerror;
+	quint64 time;
+	model_t *mod;
+	const mskmodel_t *skmodel;
+	mat4_t *poses;
+	vec4_t *out, *ref;
+
+	if( ri.Cmd_Argc() < 2 ) {
+		Com_Printf( "usage: skmbench <model> [repeats]\n" );
+		return;
+	}
+
+	mod = Mod_ForName( ri.Cmd_Argv( 1 ), qfalse );
+	if( !mod || mod->type != mod_skeletal ) {
+		Com_Printf( "%s is not a skeletal model\n", ri.Cmd_Argv( 1 ) );
+		return;
+	}
+
+	skmodel = ( const mskmodel_t * )mod->extradata;
+	if( !skmodel->numframes || !skmodel->numverts ) {
+		return;
+	}
+
+	repeats = ri.Cmd_Argc() > 2 ? max( atoi( ri.Cmd_Argv( 2 ) ), 1 ) : 100;
+
+	numposes = skmodel->numbones + skmodel->numblends;
+	poses = R_Malloc( sizeof( mat4_t ) * numposes * skmodel->numframes );
+	out = R_Malloc( sizeof( vec4_t ) * skmodel->numverts * 3 );
+	ref = R_Malloc( sizeof( vec4_t ) * skmodel->numverts * 3 );
+
+	for( f = 0; f < skmodel->numframes; f++ ) {
+		R_SkeletalBenchPoses( skmodel, f, poses + f * numposes );
+	}
+
+	Com_Printf( "%s: %i vertices, %i bones, %i blends, %i frames\n", mod->name,
+		skmodel->numverts, skmodel->numbones, skmodel->numblends, skmodel->numframes );
+
+	for( i = 0; i < NUM_SKM_KERNELS; i++ ) {
+		const skmkernels_t *kernel = &r_skmkernels[i];
+
+		if( ( ri.Com_CPUFeatures() & kernel->cpuFeatures ) != kernel->cpuFeatures ) {
+			Com_Printf( "%-8s not supported\n", kernel->name );
+			continue;
+		}
+
+		time = ri.Sys_Microseconds();
+		for( j = 0; j < repeats; j++ ) {
+			for( f = 0; f < skmodel->numframes; f++ ) {
+				R_SkeletalBenchRun( kernel, skmodel, poses + f * numposes, out );
+			}
+		}
+		time = ri.Sys_Microseconds() - time;
+
+		maxerror = 0;
+		for( f = 0; f < skmodel->numframes; f++ ) {
+			R_SkeletalBenchRun( &r_skmkernels[0], skmodel, poses + f * numposes, ref );
+			R_SkeletalBenchRun( kernel, skmodel, poses + f * numposes, out );
+
+			for( j = 0; j < skmodel->numverts * 3 * 4; j++ ) {
+				error = fabs( ref[0][j] - out[0][j] );
+				if( error > maxerror ) {
+					maxerror = error;
+				}
+			}
+		}
+
+		Com_Printf( "%-8s %8.2f usec/frame %8.2f Mverts/sec, max error %g%s\n", kernel->name,
+			(double)time / ( repeats * skmodel->numframes ),
+			time ? (double)skmodel->numverts * repeats * skmodel->numframes / time : 0.0,
+			maxerror, kernel == r_skmkernel ? " (in use)" : "" );
+	}
+
+	R_Free( ref );
+	R_Free( out );
+	R_Free( poses );
+}
+
 //=======================================================================
 
 /*
@@ -1267,7 +1870,7 @@ qboolean R_DrawSkeletalSurf( const entity_t *e, const shader_t *shader, const mf
 			}
 
 			// generate matrices for all blend combinations
-			R_SkeletalBlendPoses( skmodel->numblends, skmodel->blends, skmodel->numbones, bonePoseRelativeMat );
+			r_skmkernel->blendPoses( skmodel->numblends, skmodel->blends, skmodel->numbones, bonePoseRelativeMat );
 		}
 	}
 
@@ -1290,15 +1893,15 @@ qboolean R_DrawSkeletalSurf( const entity_t *e, const shader_t *shader, const mf
 			return qfalse;
 		}
 
-		R_SkeletalTransformVerts( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
+		r_skmkernel->transformVerts( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
 			( vec_t * )skmesh->xyzArray[0], ( vec_t * )rb_mesh->xyzArray );
 
 		if( vattribs & VATTRIB_SVECTOR_BIT ) {
-			R_SkeletalTransformNormalsAndSVecs( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
+			r_skmkernel->transformNormalsAndSVecs( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
 			( vec_t * )skmesh->normalsArray[0], ( vec_t * )rb_mesh->normalsArray,
 			( vec_t * )skmesh->sVectorsArray[0], ( vec_t * )rb_mesh->sVectorsArray );
 		} else if( vattribs & VATTRIB_NORMAL_BIT ) {
-			R_SkeletalTransformNormals( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
+			r_skmkernel->transformNormals( skmesh->numverts, skmesh->vertexBlends, bonePoseRelativeMat,
 			( vec_t * )skmesh->normalsArray[0], ( vec_t * )rb_mesh->normalsArray );
 		}
 
@@ -1356,6 +1959,30 @@ void R_SkeletalModelFrameBounds( const model_t *mod, int frame, vec3_t mins, vec
 	VectorCopy( pframe->maxs, maxs );
 }
 
+/*
+* R_PrecullSkeletalModelEntity
+*
+* R_CullModelEntity as done by R_AddSkeletalModelToDrawList, but without
+* printing anything, for the job threads. Returns -1 for entities that
+* have to be culled on the main thread
+*/
+int R_PrecullSkeletalModelEntity( const entity_t *e )
+{
+	const model_t *mod;
+	const mskmodel_t *skmodel;
+	vec3_t mins, maxs;
+	float radius;
+
+	mod = R_SkeletalModelLOD( e );
+	if( !( skmodel = ( ( mskmodel_t * )mod->extradata ) ) || !skmodel->nummeshes )
+		return -1;
+	if( e->frame < 0 || e->frame >= (int)skmodel->numframes || e->oldframe < 0 || e->oldframe >= (int)skmodel->numframes )
+		return -1;
+
+	radius = R_SkeletalModelLerpBBox( e, mod, mins, maxs );
+	return R_CullModelEntity( e, mins, maxs, radius, qtrue );
+}
+
 /*
 * R_AddSkeletalModelToDrawList
 */
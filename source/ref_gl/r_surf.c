@@ -327,6 +327,32 @@ float R_BrushModelBBox( const entity_t *e, vec3_t mins, vec3_t maxs, qboolean *r
 		Matrix3_TransformVector( (e)->axis, temp, out ); \
 	}
 
+/*
+* R_PrecullBrushModelEntity
+*
+* R_CullModelEntity as done by R_AddBrushModelToDrawList, for the job
+* threads. Returns -1 for entities that have to be culled on the main thread
+*/
+int R_PrecullBrushModelEntity( const entity_t *e )
+{
+	vec3_t bmins, bmaxs;
+	qboolean rotated;
+	float radius;
+	const mbrushmodel_t *bmodel = ( const mbrushmodel_t * )e->model->extradata;
+
+	if( bmodel->nummodelsurfaces == 0 ) {
+		return -1;
+	}
+
+	// R_DrawEntities sets the outline right before adding the entity
+	if( e->outlineHeight != rsc.worldent->outlineHeight ) {
+		return -1;
+	}
+
+	radius = R_BrushModelBBox( e, bmins, bmaxs, &rotated );
+	return R_CullModelEntity( e, bmins, bmaxs, radius, rotated );
+}
+
 /*
 * R_AddBrushModelToDrawList
 */
@@ -465,98 +491,108 @@ static void R_MarkLeafSurfaces( msurface_t **mark, unsigned int clipFlags,
 }
 
 /*
-* R_RecursiveWorldNode
+* R_ClipWorldNode
+*
+* Returns qfalse if the node is outside of the PVS or the frustum, otherwise
+* drops the planes the node is entirely in front of from clipFlags
 */
-static void R_RecursiveWorldNode( mnode_t *node, unsigned int clipFlags, 
-	unsigned int dlightBits, unsigned int shadowBits )
+static qboolean R_ClipWorldNode( const mnode_t *node, unsigned int *clipFlags )
 {
 	unsigned int i;
-	unsigned int dlightBits1;
-	unsigned int shadowBits1;
 	unsigned int bit;
 	const cplane_t *clipplane;
-	mleaf_t	*pleaf;
 
-	while( 1 )
-	{
-		if( node->pvsframe != rf.pvsframecount )
-			return;
+	if( node->pvsframe != rf.pvsframecount )
+		return qfalse;
 
-		if( clipFlags )
+	if( *clipFlags )
+	{
+		for( i = sizeof( rn.frustum )/sizeof( rn.frustum[0] ), bit = 1, clipplane = rn.frustum; i > 0; i--, bit<<=1, clipplane++ )
 		{
-			for( i = sizeof( rn.frustum )/sizeof( rn.frustum[0] ), bit = 1, clipplane = rn.frustum; i > 0; i--, bit<<=1, clipplane++ )
+			if( *clipFlags & bit )
 			{
-				if( clipFlags & bit )
-				{
-					int clipped = BoxOnPlaneSide( node->mins, node->maxs, clipplane );
-					if( clipped == 2 )
-						return;
-					else if( clipped == 1 )
-						clipFlags &= ~bit; // node is entirely on screen
-				}
+				int clipped = BoxOnPlaneSide( node->mins, node->maxs, clipplane );
+				if( clipped == 2 )
+					return qfalse;
+				else if( clipped == 1 )
+					*clipFlags &= ~bit; // node is entirely on screen
 			}
 		}
+	}
 
-		if( !node->plane )
-			break;
+	return qtrue;
+}
 
-		dlightBits1 = 0;
-		if( dlightBits )
-		{
-			float dist;
-			unsigned int checkBits = dlightBits;
+/*
+* R_SplitWorldNodeLights
+*
+* Leaves the dlight and shadow bits for the front child of the node
+* in dlightBits and shadowBits, the ones for the back child go to
+* dlightBits1 and shadowBits1
+*/
+static void R_SplitWorldNodeLights( const mnode_t *node, unsigned int *dlightBits, unsigned int *shadowBits, 
+	unsigned int *dlightBits1, unsigned int *shadowBits1 )
+{
+	unsigned int i;
+	unsigned int bit;
 
-			for( i = 0, bit = 1; i < rsc.numDlights; i++, bit <<= 1 )
+	*dlightBits1 = 0;
+	if( *dlightBits )
+	{
+		float dist;
+		unsigned int checkBits = *dlightBits;
+
+		for( i = 0, bit = 1; i < rsc.numDlights; i++, bit <<= 1 )
+		{
+			dlight_t *dl = rsc.dlights + i;
+			if( *dlightBits & bit )
 			{
-				dlight_t *dl = rsc.dlights + i;
-				if( dlightBits & bit )
-				{
-					dist = PlaneDiff( dl->origin, node->plane );
-					if( dist < -dl->intensity )
-						dlightBits &= ~bit;
-					if( dist < dl->intensity )
-						dlightBits1 |= bit;
-
-					checkBits &= ~bit;
-					if( !checkBits )
-						break;
-				}
+				dist = PlaneDiff( dl->origin, node->plane );
+				if( dist < -dl->intensity )
+					*dlightBits &= ~bit;
+				if( dist < dl->intensity )
+					*dlightBits1 |= bit;
+
+				checkBits &= ~bit;
+				if( !checkBits )
+					break;
 			}
 		}
+	}
 
-		shadowBits1 = 0;
-		if( shadowBits )
-		{
-			unsigned int checkBits = shadowBits;
+	*shadowBits1 = 0;
+	if( *shadowBits )
+	{
+		unsigned int checkBits = *shadowBits;
 
-			for( i = 0; i < rsc.numShadowGroups; i++ )
+		for( i = 0; i < rsc.numShadowGroups; i++ )
+		{
+			shadowGroup_t *group = rsc.shadowGroups + i;
+			bit = group->bit;
+			if( checkBits & bit )
 			{
-				shadowGroup_t *group = rsc.shadowGroups + i;
-				bit = group->bit;
-				if( checkBits & bit )
-				{
-					int clipped = BOX_ON_PLANE_SIDE( group->visMins, group->visMaxs, node->plane );
-					if( !(clipped & 1) )
-						shadowBits &= ~bit;
-					if( clipped & 2 )
-						shadowBits1 |= bit;
-
-					checkBits &= ~bit;
-					if( !checkBits )
-						break;
-				}
+				int clipped = BOX_ON_PLANE_SIDE( group->visMins, group->visMaxs, node->plane );
+				if( !(clipped & 1) )
+					*shadowBits &= ~bit;
+				if( clipped & 2 )
+					*shadowBits1 |= bit;
+
+				checkBits &= ~bit;
+				if( !checkBits )
+					break;
 			}
 		}
-
-		R_RecursiveWorldNode( node->children[0], clipFlags, dlightBits, shadowBits );
-
-		node = node->children[1];
-		dlightBits = dlightBits1;
-		shadowBits = shadowBits1;
 	}
+}
+
+/*
+* R_AddWorldLeaf
+*/
+static void R_AddWorldLeaf( mleaf_t *pleaf, unsigned int clipFlags, 
+	unsigned int dlightBits, unsigned int shadowBits )
+{
+	unsigned int i;
 
-	// if a leaf node, draw stuff
-	pleaf = ( mleaf_t * )node;
 	pleaf->visframe = rf.frameCount;
 
 	// add leaf bounds to view bounds
@@ -573,6 +609,224 @@ static void R_RecursiveWorldNode( mnode_t *node, unsigned int clipFlags,
 	rf.stats.c_world_leafs++;
 }
 
+/*
+* R_RecursiveWorldNode
+*/
+static void R_RecursiveWorldNode( mnode_t *node, unsigned int clipFlags, 
+	unsigned int dlightBits, unsigned int shadowBits )
+{
+	unsigned int dlightBits1;
+	unsigned int shadowBits1;
+
+	while( 1 )
+	{
+		if( !R_ClipWorldNode( node, &clipFlags ) )
+			return;
+
+		if( !node->plane )
+			break;
+
+		R_SplitWorldNodeLights( node, &dlightBits, &shadowBits, &dlightBits1, &shadowBits1 );
+
+		R_RecursiveWorldNode( node->children[0], clipFlags, dlightBits, shadowBits );
+
+		node = node->children[1];
+		dlightBits = dlightBits1;
+		shadowBits = shadowBits1;
+	}
+
+	// if a leaf node, draw stuff
+	R_AddWorldLeaf( ( mleaf_t * )node, clipFlags, dlightBits, shadowBits );
+}
+
+/*
+=============================================================
+
+PARALLEL WORLD TRAVERSAL
+
+The top few levels of the BSP tree are walked on the main thread and the
+subtrees below are handed to the job threads as tasks, in the order the
+serial walk would visit them. A task only reads the tree and the view and
+lists the visible leaves of its subtree together with their clip and light
+bits. The leaves are then added one task after another on the main thread,
+so the surfaces end up in the draw list in the same order as with the
+serial walk and nothing shared is written to from the job threads.
+
+A task with more visible leaves than it has space for gives up and its
+subtree is walked serially instead, its buffer grows for the next frame.
+
+=============================================================
+*/
+
+#define MAX_WORLD_TASKS			64
+#define MIN_WORLD_TASK_LEAFS	64
+
+typedef struct
+{
+	mleaf_t				*leaf;
+	unsigned int		clipFlags;
+	unsigned int		dlightBits;
+	unsigned int		shadowBits;
+} rvisleaf_t;
+
+typedef struct
+{
+	mnode_t				*node;
+	unsigned int		clipFlags;
+	unsigned int		dlightBits;
+	unsigned int		shadowBits;
+
+	rvisleaf_t			*leafs;
+	int					numLeafs, maxLeafs;
+	qboolean			overflow;
+} rworldtask_t;
+
+static rworldtask_t r_worldTasks[MAX_WORLD_TASKS];
+static int r_numWorldTasks;
+
+/*
+* R_InitWorldTasks
+*
+* The leaf buffers are freed along with the rest of the renderer memory
+*/
+void R_InitWorldTasks( void )
+{
+	memset( r_worldTasks, 0, sizeof( r_worldTasks ) );
+	r_numWorldTasks = 0;
+}
+
+/*
+* R_SplitWorldNode
+*/
+static void R_SplitWorldNode( mnode_t *node, unsigned int clipFlags, 
+	unsigned int dlightBits, unsigned int shadowBits, int depth )
+{
+	unsigned int dlightBits1;
+	unsigned int shadowBits1;
+	rworldtask_t *task;
+
+	while( 1 )
+	{
+		if( !R_ClipWorldNode( node, &clipFlags ) )
+			return;
+
+		// never more than 1 << depth tasks
+		if( !node->plane || depth <= 0 )
+			break;
+
+		R_SplitWorldNodeLights( node, &dlightBits, &shadowBits, &dlightBits1, &shadowBits1 );
+
+		R_SplitWorldNode( node->children[0], clipFlags, dlightBits, shadowBits, depth - 1 );
+
+		node = node->children[1];
+		dlightBits = dlightBits1;
+		shadowBits = shadowBits1;
+		depth--;
+	}
+
+	task = &r_worldTasks[r_numWorldTasks++];
+	task->node = node;
+	task->clipFlags = clipFlags;
+	task->dlightBits = dlightBits;
+	task->shadowBits = shadowBits;
+}
+
+/*
+* R_CollectWorldLeafs
+*/
+static void R_CollectWorldLeafs( rworldtask_t *task, mnode_t *node, unsigned int clipFlags, 
+	unsigned int dlightBits, unsigned int shadowBits )
+{
+	unsigned int dlightBits1;
+	unsigned int shadowBits1;
+	rvisleaf_t *visleaf;
+
+	while( 1 )
+	{
+		if( task->overflow )
+			return;
+
+		if( !R_ClipWorldNode( node, &clipFlags ) )
+			return;
+
+		if( !node->plane )
+			break;
+
+		R_SplitWorldNodeLights( node, &dlightBits, &shadowBits, &dlightBits1, &shadowBits1 );
+
+		R_CollectWorldLeafs( task, node->children[0], clipFlags, dlightBits, shadowBits );
+
+		node = node->children[1];
+		dlightBits = dlightBits1;
+		shadowBits = shadowBits1;
+	}
+
+	if( task->numLeafs == task->maxLeafs )
+	{
+		task->overflow = qtrue;
+		return;
+	}
+
+	visleaf = &task->leafs[task->numLeafs++];
+	visleaf->leaf = ( mleaf_t * )node;
+	visleaf->clipFlags = clipFlags;
+	visleaf->dlightBits = dlightBits;
+	visleaf->shadowBits = shadowBits;
+}
+
+/*
+* R_CollectWorldLeafsJob
+*/
+static void R_CollectWorldLeafsJob( void *arg, int first, int last )
+{
+	int i;
+	rworldtask_t *task;
+
+	for( i = first; i < last; i++ )
+	{
+		task = &r_worldTasks[i];
+		task->numLeafs = 0;
+		task->overflow = qfalse;
+		R_CollectWorldLeafs( task, task->node, task->clipFlags, task->dlightBits, task->shadowBits );
+	}
+}
+
+/*
+* R_ParallelWorldNode
+*/
+static void R_ParallelWorldNode( mnode_t *node, unsigned int clipFlags, 
+	unsigned int dlightBits, unsigned int shadowBits )
+{
+	int i, j, depth;
+	rworldtask_t *task;
+	rvisleaf_t *visleaf;
+
+	// a few tasks per thread
+	for( depth = 0; ( 1 << depth ) < ( R_NumJobThreads() + 1 ) * 4 && ( 1 << depth ) < MAX_WORLD_TASKS; depth++ );
+
+	r_numWorldTasks = 0;
+	R_SplitWorldNode( node, clipFlags, dlightBits, shadowBits, depth );
+
+	R_ParallelFor( r_numWorldTasks, 1, R_CollectWorldLeafsJob, NULL );
+
+	for( i = 0, task = r_worldTasks; i < r_numWorldTasks; i++, task++ )
+	{
+		if( task->overflow )
+		{
+			R_RecursiveWorldNode( task->node, task->clipFlags, task->dlightBits, task->shadowBits );
+
+			if( task->leafs )
+				R_Free( task->leafs );
+			task->maxLeafs = max( task->maxLeafs * 2, MIN_WORLD_TASK_LEAFS );
+			task->leafs = R_Malloc( task->maxLeafs * sizeof( rvisleaf_t ) );
+			continue;
+		}
+
+		for( j = 0, visleaf = task->leafs; j < task->numLeafs; j++, visleaf++ )
+			R_AddWorldLeaf( visleaf->leaf, visleaf->clipFlags, visleaf->dlightBits, visleaf->shadowBits );
+	}
+}
+
 //==================================================================================
 
 /*
@@ -622,7 +876,10 @@ void R_DrawWorld( void )
 	if( r_speeds->integer )
 		msec = ri.Sys_Milliseconds();
 
-	R_RecursiveWorldNode( rsh.worldBrushModel->nodes, clipFlags, dlightBits, shadowBits );
+	if( R_NumJobThreads() )
+		R_ParallelWorldNode( rsh.worldBrushModel->nodes, clipFlags, dlightBits, shadowBits );
+	else
+		R_RecursiveWorldNode( rsh.worldBrushModel->nodes, clipFlags, dlightBits, shadowBits );
 
 	if( r_speeds->integer )
 		rf.stats.t_world_node += ri.Sys_Milliseconds() - msec;
@@ -85,6 +85,8 @@ typedef struct
 	byte_vec4_t *colorsArray;
 	struct shader_s	*shader;
 	int fogNum;
+	elem_t *elems;
+	int numElems;
 } drawSurfacePoly_t;
 
 #endif // R_SURFACE_H
@@ -99,6 +99,7 @@ typedef struct
 	int num_entities;
 	int first_entity;                   // into the circular sv.client_entities[]
 	unsigned int sentTimeStamp;         // time at what this frame snap was sent to the clients
+	int deltaFrameNum;                  // the frame this one was delta'd from, -1 if none
 	unsigned int UcmdExecuted;
 	game_state_t gameState;
 } client_snapshot_t;
@@ -129,6 +130,7 @@ typedef struct client_s
 
 	qboolean reliable;                  // no need for acks, connection is reliable
 	qboolean mv;                        // send multiview data to the client
+	qboolean packedentities;            // packetentities go as a bitstream
 	qboolean individual_socket;         // client has it's own socket that has to be checked separately
 
 	socket_t socket;
@@ -172,6 +174,10 @@ typedef struct client_s
 
 	client_download_t download;
 
+	// the last demolist query, demoget numbers refer to its list
+	char demolist_sort[MAX_QPATH];
+	char demolist_filter[MAX_STRING_CHARS];
+
 	int challenge;                  // challenge of this user, randomly generated
 
 	netchan_t netchan;
@@ -191,22 +197,10 @@ typedef struct client_s
 
 //=============================================================================
 
-// MAX_CHALLENGES is made large to prevent a denial
-// of service attack that could cycle all of them
-// out before legitimate users connected
-#define	MAX_CHALLENGES	1024
-
 // MAX_SNAP_ENTITIES is the guess of what we consider maximum amount of entities
 // to be sent to a client into a snap. It's used for finding size of the backup storage
 #define MAX_SNAP_ENTITIES 64
 
-typedef struct
-{
-	netadr_t adr;
-	int challenge;
-	int time;
-} challenge_t;
-
 // for server side demo recording
 typedef struct
 {
@@ -222,6 +216,15 @@ typedef struct
 
 typedef server_static_demo_t demorec_t;
 
+// configstrings and baselines prebuilt for connecting clients
+typedef struct
+{
+	qboolean dirty;                     // rebuild before sending it again
+	size_t size;                        // uncompressed size
+	size_t compressedsize;
+	qbyte *data;                        // compressed, NULL if it didn't fit in a message
+} server_static_gamestate_t;
+
 #ifdef TCP_ALLOW_CONNECT
 #define MAX_INCOMING_CONNECTIONS 256
 typedef struct
@@ -271,13 +274,14 @@ typedef struct
 	client_t *clients;                  // [sv_maxclients->integer];
 	client_entities_t client_entities;
 
-	challenge_t challenges[MAX_CHALLENGES]; // to prevent invalid IPs from connecting
 #ifdef TCP_ALLOW_CONNECT
 	incoming_t incoming[MAX_INCOMING_CONNECTIONS]; // holds socket while tcp client is connecting
 #endif
 
 	server_static_demo_t demo;
 
+	server_static_gamestate_t gamestate;
+
 	purelist_t *purelist;				// pure file support
 
 	cmodel_state_t *cms;                // passed to CM-functions
@@ -325,8 +329,13 @@ extern cvar_t *sv_http_port;
 extern cvar_t *sv_http_upstream_baseurl;
 extern cvar_t *sv_http_upstream_ip;
 extern cvar_t *sv_http_upstream_realip_header;
+extern cvar_t *sv_http_frametimes;
 #endif
 
+extern cvar_t *sv_frametimes;
+extern cvar_t *sv_instances;
+extern cvar_t *sv_instances_maps;
+
 extern cvar_t *sv_skilllevel;
 extern cvar_t *sv_maxclients;
 extern cvar_t *sv_maxmvclients;
@@ -335,11 +344,14 @@ extern cvar_t *sv_enforcetime;
 extern cvar_t *sv_showRcon;
 extern cvar_t *sv_showChallenge;
 extern cvar_t *sv_showInfoQueries;
+extern cvar_t *sv_queryrate;			// info queries per second allowed from one address
+extern cvar_t *sv_queryburst;
 extern cvar_t *sv_highchars;
 
 //wsw : jal
 extern cvar_t *sv_maxrate;
 extern cvar_t *sv_compresspackets;
+extern cvar_t *sv_packedentities;
 extern cvar_t *sv_public;         // should heartbeats be sent
 
 // wsw : debug netcode
@@ -363,6 +375,10 @@ extern cvar_t *sv_lastAutoUpdate;
 extern cvar_t *sv_defaultmap;
 
 extern cvar_t *sv_demodir;
+extern cvar_t *sv_racedemos;
+extern cvar_t *sv_racedemos_buffer;
+
+extern cvar_t *sv_parallelthinks;
 
 extern cvar_t *sv_mm_authkey;
 extern cvar_t *sv_mm_loginonly;
@@ -400,6 +416,7 @@ void SV_UpdateActivity( void );
 void SV_ConnectionlessPacket( const socket_t *socket, const netadr_t *address, msg_t *msg );
 void SV_InitMaster( void );
 void SV_UpdateMaster( void );
+void SV_QueryStats_f( void );
 
 //
 // sv_init.c
@@ -464,6 +481,8 @@ qboolean SV_ClientConnect( const socket_t *socket, const netadr_t *address, clie
                            unsigned int ticket_id, int session_id );
 void SV_DropClient( client_t *drop, int type, const char *format, ... );
 void SV_ExecuteClientThinks( int clientNum );
+void SV_ExecuteClientThinksParallel( const int *clientNums, int numClients );
+void SV_ShutdownClientThinks( void );
 void SV_ClientResetCommandBuffers( client_t *client );
 qboolean SV_ClientAllowHttpRequest( int clientNum, const char *session );
 
@@ -515,6 +534,13 @@ void SV_DemoGet_f( client_t *client );
 
 qboolean SV_IsDemoDownloadRequest( const char *request );
 
+void SV_Demo_RecordRaceSnap( client_t *client );
+void SV_Demo_RaceRunFinished( edict_t *ent, int numSectors, const unsigned int *times );
+void SV_Demo_RaceDemosFrame( void );
+void SV_Demo_FlushRaceDemos( void );
+void SV_Demo_FreeRaceBuffer( client_t *client );
+void SV_Demo_ShutdownRaceDemos( void );
+
 //
 // sv_motd.c
 //
@@ -540,6 +566,36 @@ void SV_MM_SendQuery( stat_query_t *query );
 void SV_MM_GameState( qboolean state );
 void SV_MM_GetMatchUUID( void (*callback_fn)( const char *uuid ) );
 
+//
+// sv_instances.c
+//
+void SV_Instances_Init( void );
+void SV_Instances_Frame( void );
+void SV_Instances_Shutdown( void );
+void SV_Instances_SelectCM( const char *mapname );
+
+//
+// sv_frametimes.c
+//
+typedef enum
+{
+	SV_FRAMEPHASE_READPACKETS,
+	SV_FRAMEPHASE_RUNFRAME,
+	SV_FRAMEPHASE_SENDCLIENTMESSAGES,
+	SV_FRAMEPHASE_DEMOWRITESNAP,
+	SV_FRAMEPHASE_WEBFRAME,
+	SV_FRAMEPHASE_IDLE,
+	SV_FRAMEPHASE_BUSY,
+
+	SV_FRAMEPHASE_TOTAL
+} sv_framephase_t;
+
+quint64 SV_FrameTimes_Begin( void );
+void SV_FrameTimes_End( sv_framephase_t phase, quint64 start );
+void SV_FrameTimes_Commit( void );
+size_t SV_FrameTimes_WriteJSON( char *buf, size_t size );
+void SV_FrameTimes_f( void );
+
 // 
 // sv_web.c
 //
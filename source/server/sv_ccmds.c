@@ -833,6 +833,8 @@ void SV_InitOperatorCommands( void )
 	}
 
 	Cmd_AddCommand( "cvarcheck", SV_CvarCheck_f );
+	Cmd_AddCommand( "frametimes", SV_FrameTimes_f );
+	Cmd_AddCommand( "querystats", SV_QueryStats_f );
 
 	Cmd_SetCompletionFunc( "map", SV_MapComplete_f );
 	Cmd_SetCompletionFunc( "devmap", SV_MapComplete_f );
@@ -869,4 +871,6 @@ void SV_ShutdownOperatorCommands( void )
 	}
 
 	Cmd_RemoveCommand( "cvarcheck" );
+	Cmd_RemoveCommand( "frametimes" );
+	Cmd_RemoveCommand( "querystats" );
 }
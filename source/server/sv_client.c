@@ -228,6 +228,8 @@ void SV_DropClient( client_t *drop, int type, const char *format, ... )
 
 	SV_MM_ClientDisconnect( drop );
 
+	SV_Demo_FreeRaceBuffer( drop );
+
 	SNAP_FreeClientFrames( drop );
 
 	if( drop->download.name )
@@ -326,6 +328,9 @@ static void SV_New_f( client_t *client )
 			sv_bitflags |= SV_BITFLAGS_PURE;
 		if( client->reliable )
 			sv_bitflags |= SV_BITFLAGS_RELIABLE;
+		if( client->packedentities )
+			sv_bitflags |= SV_BITFLAGS_PACKEDENTITIES;
+		sv_bitflags |= SV_BITFLAGS_GAMESTATE;
 		if( SV_Web_Running() )
 		{
 			const char *baseurl = SV_Web_UpstreamBaseUrl();
@@ -476,6 +481,127 @@ static void SV_Baselines_f( client_t *client )
 	SV_SendMessageToClient( client, &tmpMessage );
 }
 
+/*
+* SV_UpdateGamestate
+* 
+* Serializes and compresses the configstrings and baselines once, connecting
+* clients get a copy of the blob until something changes
+*/
+static qboolean SV_UpdateGamestate( void )
+{
+	int i, length;
+	msg_t msg;
+	qbyte *data, *compressed;
+	entity_state_t nullstate;
+	entity_state_t *base;
+	server_static_gamestate_t *gamestate = &svs.gamestate;
+
+	if( !gamestate->dirty )
+		return gamestate->data != NULL;
+
+	gamestate->dirty = qfalse;
+	if( gamestate->data )
+	{
+		Mem_Free( gamestate->data );
+		gamestate->data = NULL;
+	}
+	gamestate->size = gamestate->compressedsize = 0;
+
+	data = Mem_TempMalloc( MAX_GAMESTATE_SIZE );
+	MSG_Init( &msg, data, MAX_GAMESTATE_SIZE );
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ )
+	{
+		if( !sv.configstrings[i][0] )
+			continue;
+		MSG_WriteShort( &msg, i );
+		MSG_WriteString( &msg, sv.configstrings[i] );
+	}
+	MSG_WriteShort( &msg, -1 );
+
+	memset( &nullstate, 0, sizeof( nullstate ) );
+
+	for( i = 0; i < MAX_EDICTS; i++ )
+	{
+		base = &sv.baselines[i];
+		if( base->modelindex || base->sound || base->effects )
+			MSG_WriteDeltaEntity( &nullstate, base, &msg, qtrue, qtrue );
+	}
+
+	// leave room in the message for the reliable commands
+	compressed = Mem_TempMalloc( MAX_MSGLEN / 2 );
+	length = Netchan_CompressChunk( data, msg.cursize, compressed, MAX_MSGLEN / 2 );
+	if( length > 0 )
+	{
+		gamestate->data = Mem_Alloc( sv_mempool, length );
+		memcpy( gamestate->data, compressed, length );
+		gamestate->size = msg.cursize;
+		gamestate->compressedsize = length;
+		Com_DPrintf( "Gamestate: %i bytes, %i compressed\n", (int)msg.cursize, length );
+	}
+	else
+	{
+		Com_DPrintf( "Gamestate: %i bytes don't fit in a message\n", (int)msg.cursize );
+	}
+
+	Mem_TempFree( compressed );
+	Mem_TempFree( data );
+
+	return gamestate->data != NULL;
+}
+
+/*
+* SV_Gamestate_f
+* 
+* Sends configstrings and baselines in one fragmented message
+*/
+static void SV_Gamestate_f( client_t *client )
+{
+	if( client->state == CS_CONNECTING )
+	{
+		Com_DPrintf( "Start Gamestate() from %s\n", client->name );
+		client->state = CS_CONNECTED;
+	}
+	else
+		Com_DPrintf( "Gamestate() from %s\n", client->name );
+
+	if( client->state != CS_CONNECTED )
+	{
+		Com_Printf( "gamestate not valid -- already spawned\n" );
+		return;
+	}
+
+	// handle the case of a level changing while a client was connecting
+	if( atoi( Cmd_Argv( 1 ) ) != svs.spawncount )
+	{
+		Com_Printf( "SV_Gamestate_f from different level\n" );
+		SV_SendServerCommand( client, "reconnect" );
+		return;
+	}
+
+	// too big, go through the configstrings and baselines commands
+	if( !SV_UpdateGamestate() )
+	{
+		SV_SendServerCommand( client, "cmd configstrings %i 0", svs.spawncount );
+		return;
+	}
+
+	SV_InitClientMessage( client, &tmpMessage, NULL, 0 );
+
+	MSG_WriteByte( &tmpMessage, svc_extension );
+	MSG_WriteByte( &tmpMessage, SVC_EXT_GAMESTATE );
+	MSG_WriteByte( &tmpMessage, 1 );	// version
+	MSG_WriteShort( &tmpMessage, 4 + svs.gamestate.compressedsize );
+	MSG_WriteLong( &tmpMessage, svs.gamestate.size );
+	MSG_WriteData( &tmpMessage, svs.gamestate.data, svs.gamestate.compressedsize );
+
+	// if the message is lost the client asks again when the precache command arrives
+	SV_SendServerCommand( client, "precache %i", svs.spawncount );
+
+	SV_AddReliableCommandsToMessage( client, &tmpMessage );
+	SV_SendMessageToClient( client, &tmpMessage );
+}
+
 /*
 * SV_Begin_f
 */
@@ -947,6 +1073,7 @@ ucmd_t ucmds[] =
 	{ "new", SV_New_f },
 	{ "configstrings", SV_Configstrings_f },
 	{ "baselines", SV_Baselines_f },
+	{ "gamestate", SV_Gamestate_f },
 	{ "begin", SV_Begin_f },
 	{ "disconnect", SV_Disconnect_f },
 	{ "usri", SV_UserinfoCommand_f },
@@ -1032,12 +1159,51 @@ usercmd_t *SV_FindNextUserCommand( client_t *client )
 }
 
 /*
-* SV_ExecuteClientThinks - Execute all pending usercmd_t
+* SV_PrepareNextUserCommand
+* 
+* Returns the next usercmd_t to execute with its timing filled in
 */
-void SV_ExecuteClientThinks( int clientNum )
+static usercmd_t *SV_PrepareNextUserCommand( client_t *client, int *timeDelta )
 {
 	unsigned int msec;
+	usercmd_t *ucmd;
+
+	ucmd = SV_FindNextUserCommand( client );
+	if( !ucmd )
+		return NULL;
+
+	msec = ucmd->serverTimeStamp - client->UcmdTime;
+	clamp( msec, 1, 200 );
+	ucmd->msec = msec;
+	// convert push fractions to push times
+	ucmd->forwardmove = ucmd->forwardfrac * msec;
+	ucmd->sidemove = ucmd->sidefrac * msec;
+	ucmd->upmove = ucmd->upfrac * msec;
+	*timeDelta = 0;
+	if( client->lastframe > 0 )
+		*timeDelta = -(int)( svs.gametime - ucmd->serverTimeStamp );
+
+	return ucmd;
+}
+
+/*
+* SV_ClampUserCommandTime
+*/
+static void SV_ClampUserCommandTime( client_t *client )
+{
 	unsigned int minUcmdTime;
+
+	// don't let client command time delay too far away in the past
+	minUcmdTime = ( svs.gametime > 999 ) ? ( svs.gametime - 999 ) : 0;
+	if( client->UcmdTime < minUcmdTime )
+		client->UcmdTime = minUcmdTime;
+}
+
+/*
+* SV_ExecuteClientThinks - Execute all pending usercmd_t
+*/
+void SV_ExecuteClientThinks( int clientNum )
+{
 	int timeDelta;
 	client_t *client;
 	usercmd_t *ucmd;
@@ -1052,24 +1218,10 @@ void SV_ExecuteClientThinks( int clientNum )
 	if( client->edict->r.svflags & SVF_FAKECLIENT )
 		return;
 
-	// don't let client command time delay too far away in the past
-	minUcmdTime = ( svs.gametime > 999 ) ? ( svs.gametime - 999 ) : 0;
-	if( client->UcmdTime < minUcmdTime )
-		client->UcmdTime = minUcmdTime;
+	SV_ClampUserCommandTime( client );
 
-	while( ( ucmd = SV_FindNextUserCommand( client ) ) != NULL )
+	while( ( ucmd = SV_PrepareNextUserCommand( client, &timeDelta ) ) != NULL )
 	{
-		msec = ucmd->serverTimeStamp - client->UcmdTime;
-		clamp( msec, 1, 200 );
-		ucmd->msec = msec;
-		// convert push fractions to push times
-		ucmd->forwardmove = ucmd->forwardfrac * msec;
-		ucmd->sidemove = ucmd->sidefrac * msec;
-		ucmd->upmove = ucmd->upfrac * msec;
-		timeDelta = 0;
-		if( client->lastframe > 0 )
-			timeDelta = -(int)( svs.gametime - ucmd->serverTimeStamp );
-
 		ge->ClientThink( client->edict, ucmd, timeDelta );
 
 		client->UcmdTime = ucmd->serverTimeStamp;
@@ -1079,6 +1231,222 @@ void SV_ExecuteClientThinks( int clientNum )
 	client->UcmdExecuted = client->UcmdReceived;
 }
 
+/*
+===========================================================================
+
+PARALLEL USER CMD EXECUTION
+
+The game hands over a list of players whose moves can't affect each other.
+Their pending usercmds are run on sv_parallelthinks worker threads plus the
+main thread, for as long as the game accepts them. Whatever is left over is
+executed by the regular SV_ExecuteClientThinks call later in the frame.
+
+===========================================================================
+*/
+
+#define SV_MAX_THINK_THREADS	16
+
+typedef struct
+{
+	qmutex_t *mutex;
+	qcondvar_t *wake;
+	qcondvar_t *done;
+	qthread_t *threads[SV_MAX_THINK_THREADS];
+	int numThreads;
+	int numRequested;           // sv_parallelthinks the threads were created for
+	qboolean shutdown;
+
+	int batch;                  // incremented for every set of clients
+	int busy;                   // threads that haven't finished the current batch
+
+	client_t *clients[MAX_CLIENTS];
+	int numClients;
+	volatile int nextClient;
+} sv_thinkpool_t;
+
+static sv_thinkpool_t sv_thinkpool;
+
+/*
+* SV_ExecuteClientThinksUntilRefused
+*/
+static void SV_ExecuteClientThinksUntilRefused( client_t *client )
+{
+	int timeDelta;
+	usercmd_t *ucmd;
+
+	SV_ClampUserCommandTime( client );
+
+	while( ( ucmd = SV_PrepareNextUserCommand( client, &timeDelta ) ) != NULL )
+	{
+		if( !ge->ClientThinkParallel( client->edict, ucmd, timeDelta ) )
+			break;
+
+		client->UcmdTime = ucmd->serverTimeStamp;
+	}
+}
+
+/*
+* SV_RunThinkBatch
+*/
+static void SV_RunThinkBatch( void )
+{
+	int i;
+
+	while( ( i = QAtomic_Add( &sv_thinkpool.nextClient, 1 ) - 1 ) < sv_thinkpool.numClients )
+		SV_ExecuteClientThinksUntilRefused( sv_thinkpool.clients[i] );
+}
+
+/*
+* SV_ThinkThread
+*/
+static void *SV_ThinkThread( void *param )
+{
+	int batch = 0;
+	sv_thinkpool_t *pool = ( sv_thinkpool_t * )param;
+
+	QMutex_Lock( pool->mutex );
+	while( 1 )
+	{
+		while( !pool->shutdown && pool->batch == batch )
+			QCondVar_Wait( pool->wake, pool->mutex );
+		if( pool->shutdown )
+			break;
+		batch = pool->batch;
+		QMutex_Unlock( pool->mutex );
+
+		SV_RunThinkBatch();
+
+		QMutex_Lock( pool->mutex );
+		if( --pool->busy == 0 )
+			QCondVar_Wake( pool->done );
+	}
+	QMutex_Unlock( pool->mutex );
+
+	return NULL;
+}
+
+/*
+* SV_ShutdownClientThinks
+*/
+void SV_ShutdownClientThinks( void )
+{
+	int i;
+	sv_thinkpool_t *pool = &sv_thinkpool;
+
+	if( !pool->mutex )
+		return;
+
+	QMutex_Lock( pool->mutex );
+	pool->shutdown = qtrue;
+	QCondVar_WakeAll( pool->wake );
+	QMutex_Unlock( pool->mutex );
+
+	for( i = 0; i < pool->numThreads; i++ )
+		QThread_Join( pool->threads[i] );
+
+	QCondVar_Destroy( &pool->wake );
+	QCondVar_Destroy( &pool->done );
+	QMutex_Destroy( &pool->mutex );
+	memset( pool, 0, sizeof( *pool ) );
+}
+
+/*
+* SV_InitClientThinks
+*/
+static qboolean SV_InitClientThinks( int numThreads )
+{
+	sv_thinkpool_t *pool = &sv_thinkpool;
+
+	if( pool->mutex && pool->numRequested == numThreads )
+		return qtrue;
+
+	SV_ShutdownClientThinks();
+	pool->numRequested = numThreads;
+	clamp( numThreads, 1, SV_MAX_THINK_THREADS );
+
+	pool->mutex = QMutex_Create();
+	pool->wake = QCondVar_Create();
+	pool->done = QCondVar_Create();
+	if( !pool->mutex || !pool->wake || !pool->done )
+	{
+		Com_Printf( S_COLOR_YELLOW "Failed to create client think threads\n" );
+		Cvar_ForceSet( "sv_parallelthinks", "0" );
+		QMutex_Destroy( &pool->mutex );
+		QCondVar_Destroy( &pool->wake );
+		QCondVar_Destroy( &pool->done );
+		return qfalse;
+	}
+
+	for( pool->numThreads = 0; pool->numThreads < numThreads; pool->numThreads++ )
+	{
+		pool->threads[pool->numThreads] = QThread_Create( SV_ThinkThread, pool );
+		if( !pool->threads[pool->numThreads] )
+			break;
+	}
+
+	if( !pool->numThreads )
+	{
+		Com_Printf( S_COLOR_YELLOW "Failed to create client think threads\n" );
+		Cvar_ForceSet( "sv_parallelthinks", "0" );
+		SV_ShutdownClientThinks();
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+* SV_ExecuteClientThinksParallel
+*/
+void SV_ExecuteClientThinksParallel( const int *clientNums, int numClients )
+{
+	int i;
+	client_t *client;
+	sv_thinkpool_t *pool = &sv_thinkpool;
+
+	if( sv_parallelthinks->integer <= 0 )
+	{
+		if( pool->mutex )
+			SV_ShutdownClientThinks();
+		return;
+	}
+
+	if( !SV_InitClientThinks( sv_parallelthinks->integer ) )
+		return;
+
+	pool->numClients = 0;
+	for( i = 0; i < numClients; i++ )
+	{
+		if( clientNums[i] < 0 || clientNums[i] >= sv_maxclients->integer )
+			continue;
+
+		client = svs.clients + clientNums[i];
+		if( client->state < CS_SPAWNED || ( client->edict->r.svflags & SVF_FAKECLIENT ) )
+			continue;
+
+		pool->clients[pool->numClients++] = client;
+	}
+
+	if( pool->numClients < 2 )
+		return;
+
+	pool->nextClient = 0;
+
+	QMutex_Lock( pool->mutex );
+	pool->busy = pool->numThreads;
+	pool->batch++;
+	QCondVar_WakeAll( pool->wake );
+	QMutex_Unlock( pool->mutex );
+
+	// the main thread takes its share too
+	SV_RunThinkBatch();
+
+	QMutex_Lock( pool->mutex );
+	while( pool->busy > 0 )
+		QCondVar_Wait( pool->done, pool->mutex );
+	QMutex_Unlock( pool->mutex );
+}
+
 /*
 * SV_ParseMoveCommand
 */
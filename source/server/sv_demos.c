@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "server.h"
+#include "zlib.h"
 
 #define SV_DEMO_DIR va( "demos/server%s%s", sv_demodir->string[0] ? "/" : "", sv_demodir->string[0] ? sv_demodir->string : "" )
 
@@ -373,6 +374,9 @@ void SV_Demo_Purge_f( void )
 
 /*
 * SV_DemoList_f
+* 
+* Lists the demos sorted by name or by the given sort key, which may be a
+* meta data key like "duration", and only those matching the filter
 */
 #define DEMOS_PER_VIEW	30
 void SV_DemoList_f( client_t *client )
@@ -383,29 +387,48 @@ void SV_DemoList_f( client_t *client )
 	char *s, *p;
 	size_t j, length, length_escaped, pos, extlen;
 	int numdemos, i, start = -1, end, k;
+	qboolean sortfilter = qfalse;
 
 	if( client->state < CS_SPAWNED )
 		return;
 
-	if( Cmd_Argc() > 2 )
+	// a new sort key or filter replaces the whole query, no arguments at all clear it
+	if( Cmd_Argc() == 1 )
 	{
-		SV_AddGameCommand( client, "pr \"Usage: demolist [starting position]\n\"" );
-		return;
+		client->demolist_sort[0] = '\0';
+		client->demolist_filter[0] = '\0';
 	}
 
-	if( Cmd_Argc() == 2 )
+	for( i = 1; i < Cmd_Argc(); i++ )
 	{
-		start = atoi( Cmd_Argv( 1 ) ) - 1;
-		if( start < 0 )
+		if( !Q_stricmp( Cmd_Argv( i ), "sort" ) && i + 1 < Cmd_Argc() )
+		{
+			if( !sortfilter )
+				client->demolist_filter[0] = '\0';
+			Q_strncpyz( client->demolist_sort, Cmd_Argv( ++i ), sizeof( client->demolist_sort ) );
+			sortfilter = qtrue;
+		}
+		else if( !Q_stricmp( Cmd_Argv( i ), "filter" ) && i + 1 < Cmd_Argc() )
+		{
+			if( !sortfilter )
+				client->demolist_sort[0] = '\0';
+			Q_strncpyz( client->demolist_filter, Cmd_Argv( ++i ), sizeof( client->demolist_filter ) );
+			sortfilter = qtrue;
+		}
+		else if( start < 0 && atoi( Cmd_Argv( i ) ) > 0 )
+		{
+			start = atoi( Cmd_Argv( i ) ) - 1;
+		}
+		else
 		{
-			SV_AddGameCommand( client, "pr \"Usage: demolist [starting position]\n\"" );
+			SV_AddGameCommand( client, "pr \"Usage: demolist [starting position] [sort <key>] [filter <text>]\n\"" );
 			return;
 		}
 	}
 
 	Q_strncpyz( message, "pr \"Available demos:\n----------------\n", sizeof( message ) );
 
-	numdemos = FS_GetFileList( SV_DEMO_DIR, APP_DEMO_EXTENSION_STR, NULL, 0, 0, 0 );
+	numdemos = DI_GetFileList( SV_DEMO_DIR, client->demolist_filter, client->demolist_sort, NULL, 0, 0, 0 );
 	if( numdemos )
 	{
 		if( start < 0 )
@@ -425,7 +448,7 @@ void SV_DemoList_f( client_t *client )
 		i = start;
 		do
 		{
-			if( ( k = FS_GetFileList( SV_DEMO_DIR, APP_DEMO_EXTENSION_STR, buffer, sizeof( buffer ), i, end ) ) == 0 )
+			if( ( k = DI_GetFileList( SV_DEMO_DIR, client->demolist_filter, client->demolist_sort, buffer, sizeof( buffer ), i, end ) ) == 0 )
 			{
 				i++;
 				continue;
@@ -484,6 +507,7 @@ void SV_DemoList_f( client_t *client )
 * 
 * Responds to clients demoget request with: demoget "filename"
 * If nothing is found, responds with demoget without filename, so client knowns it wasn't found
+* The number refers to the list of the client's last demolist query
 */
 void SV_DemoGet_f( client_t *client )
 {
@@ -505,7 +529,7 @@ void SV_DemoGet_f( client_t *client )
 
 	pos = pos_bak = msglen;
 
-	numdemos = FS_GetFileList( SV_DEMO_DIR, APP_DEMO_EXTENSION_STR, NULL, 0, 0, 0 );
+	numdemos = DI_GetFileList( SV_DEMO_DIR, client->demolist_filter, client->demolist_sort, NULL, 0, 0, 0 );
 	if( numdemos )
 	{
 		if( Cmd_Argv( 1 )[0] == '.' )
@@ -514,7 +538,7 @@ void SV_DemoGet_f( client_t *client )
 			num = atoi( Cmd_Argv( 1 ) ) - 1;
 		clamp( num, 0, numdemos - 1 );
 
-		numdemos = FS_GetFileList( SV_DEMO_DIR, APP_DEMO_EXTENSION_STR, buffer, sizeof( buffer ), num, num+1 );
+		numdemos = DI_GetFileList( SV_DEMO_DIR, client->demolist_filter, client->demolist_sort, buffer, sizeof( buffer ), num, num+1 );
 		if( numdemos )
 		{
 			s = buffer;
@@ -577,3 +601,491 @@ qboolean SV_IsDemoDownloadRequest( const char *request )
 
 	return qtrue;
 }
+
+/*
+=============================================================================
+
+RACE DEMOS
+
+With sv_racedemos set, every playing client keeps a ring of its own
+snapshots, written the same way as for the client itself but delta
+compressed against the previously stored snapshot, with an uncompressed
+keyframe every few seconds. When the game reports a finished run, the
+snapshots from the last keyframe before the start of the run until a
+moment after the finish are put behind the usual demo start messages and
+the file is compressed and written by a thread of its own.
+
+=============================================================================
+*/
+
+#define SV_RACEDEMO_KEYFRAME_MSEC	5000
+#define SV_RACEDEMO_PREROLL_MSEC	1000
+#define SV_RACEDEMO_POSTROLL_MSEC	1000
+#define SV_RACEDEMO_MAX_SECTORS		64
+#define SV_RACEDEMO_SNAP_AVG_SIZE	64		// to size the snapshot index
+
+typedef struct
+{
+	unsigned int gameTime;
+	size_t offset, size;
+	qboolean keyframe;
+} sv_racesnap_t;
+
+typedef struct
+{
+	qbyte *data;
+	size_t dataSize;
+
+	sv_racesnap_t *snaps;
+	int maxSnaps, firstSnap, numSnaps;
+
+	int spawncount;
+	unsigned int lastFrameNum;		// delta base of the next snapshot, 0 for a keyframe
+	unsigned int keyframeTime;
+
+	// a finished run waiting for the post-roll
+	qboolean pending;
+	unsigned int startTime, finishTime;
+	int numSectors;
+	unsigned int times[SV_RACEDEMO_MAX_SECTORS+1];
+	char playerName[MAX_NAME_BYTES];
+} sv_racebuffer_t;
+
+typedef struct sv_racedemowriter_s
+{
+	char *filename;
+	char *path, *tempPath;
+
+	qbyte *data;
+	size_t size, metaSize;
+
+	qthread_t *thread;
+	volatile int done;
+	qboolean ok;
+
+	struct sv_racedemowriter_s *next;
+} sv_racedemowriter_t;
+
+static sv_racebuffer_t sv_racebuffers[MAX_CLIENTS];
+static sv_racedemowriter_t *sv_racedemowriters;
+
+/*
+* SV_Demo_FreeRaceSnaps
+*/
+static void SV_Demo_FreeRaceSnaps( sv_racebuffer_t *rb )
+{
+	if( rb->data )
+		Mem_Free( rb->data );
+	if( rb->snaps )
+		Mem_Free( rb->snaps );
+	memset( rb, 0, sizeof( *rb ) );
+}
+
+/*
+* SV_Demo_AddRaceSnap
+*
+* Appends the message to the ring, dropping the oldest snapshots as needed
+*/
+static qboolean SV_Demo_AddRaceSnap( sv_racebuffer_t *rb, const msg_t *msg, qboolean keyframe )
+{
+	size_t offset;
+	sv_racesnap_t *snap, *first;
+
+	if( msg->cursize > rb->dataSize / 4 )
+		return qfalse;
+
+	offset = 0;
+	if( rb->numSnaps )
+	{
+		snap = &rb->snaps[( rb->firstSnap + rb->numSnaps - 1 ) % rb->maxSnaps];
+		offset = snap->offset + snap->size;
+		if( offset + msg->cursize > rb->dataSize )
+			offset = 0;
+	}
+
+	// make room in the data, the oldest snapshot is the one in the way
+	while( rb->numSnaps )
+	{
+		first = &rb->snaps[rb->firstSnap];
+		if( rb->numSnaps < rb->maxSnaps && ( first->offset >= offset + msg->cursize || first->offset + first->size <= offset ) )
+			break;
+		rb->firstSnap = ( rb->firstSnap + 1 ) % rb->maxSnaps;
+		rb->numSnaps--;
+	}
+
+	snap = &rb->snaps[( rb->firstSnap + rb->numSnaps ) % rb->maxSnaps];
+	snap->gameTime = svs.gametime;
+	snap->offset = offset;
+	snap->size = msg->cursize;
+	snap->keyframe = keyframe;
+	memcpy( rb->data + offset, msg->data, msg->cursize );
+	rb->numSnaps++;
+
+	return qtrue;
+}
+
+/*
+* SV_Demo_RecordRaceSnap
+*
+* Called right after the frame was written for the client itself
+*/
+void SV_Demo_RecordRaceSnap( client_t *client )
+{
+	int lastframe, suppressCount, deltaFrameNum;
+	unsigned int lastSentFrameNum, nodelta_frame;
+	qboolean nodelta, reliable, packedentities, keyframe;
+	msg_t msg;
+	qbyte msg_buffer[MAX_MSGLEN];
+	sv_racebuffer_t *rb = &sv_racebuffers[client - svs.clients];
+	client_snapshot_t *frame = &client->snapShots[sv.framenum & UPDATE_MASK];
+
+	if( !sv_racedemos->integer )
+	{
+		if( rb->data )
+			SV_Demo_FreeRaceSnaps( rb );
+		return;
+	}
+
+	if( rb->spawncount != svs.spawncount )
+	{
+		rb->spawncount = svs.spawncount;
+		rb->numSnaps = 0;
+		rb->lastFrameNum = 0;
+		rb->pending = qfalse;
+	}
+
+	// only players, not spectators
+	if( client->mv || client->tvclient || !client->edict || ( client->edict->r.svflags & SVF_NOCLIENT ) )
+	{
+		rb->lastFrameNum = 0;
+		return;
+	}
+
+	if( !rb->data )
+	{
+		rb->dataSize = max( sv_racedemos_buffer->integer, 256 ) * 1024;
+		rb->data = Mem_ZoneMalloc( rb->dataSize );
+		rb->maxSnaps = rb->dataSize / SV_RACEDEMO_SNAP_AVG_SIZE;
+		rb->snaps = Mem_ZoneMalloc( rb->maxSnaps * sizeof( *rb->snaps ) );
+		rb->spawncount = svs.spawncount;
+	}
+
+	keyframe = !rb->lastFrameNum || svs.gametime >= rb->keyframeTime + SV_RACEDEMO_KEYFRAME_MSEC;
+
+	// write the frame again, with our own delta base
+	lastframe = client->lastframe;
+	lastSentFrameNum = client->lastSentFrameNum;
+	suppressCount = client->suppressCount;
+	nodelta = client->nodelta;
+	nodelta_frame = client->nodelta_frame;
+	reliable = client->reliable;
+	packedentities = client->packedentities;
+	deltaFrameNum = frame->deltaFrameNum;
+
+	// demos always use the byte aligned entities
+	client->lastframe = rb->lastFrameNum;
+	client->nodelta = keyframe;
+	client->reliable = qtrue;
+	client->packedentities = qfalse;
+
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+	SV_WriteFrameSnapToClient( client, &msg );
+
+	client->lastframe = lastframe;
+	client->lastSentFrameNum = lastSentFrameNum;
+	client->suppressCount = suppressCount;
+	client->nodelta = nodelta;
+	client->nodelta_frame = nodelta_frame;
+	client->reliable = reliable;
+	client->packedentities = packedentities;
+	frame->deltaFrameNum = deltaFrameNum;
+
+	if( !SV_Demo_AddRaceSnap( rb, &msg, keyframe ) )
+	{
+		rb->lastFrameNum = 0;
+		return;
+	}
+
+	rb->lastFrameNum = sv.framenum;
+	if( keyframe )
+		rb->keyframeTime = svs.gametime;
+}
+
+/*
+* SV_Demo_RaceDemoWriterThread
+*/
+static void *SV_Demo_RaceDemoWriterThread( void *param )
+{
+	sv_racedemowriter_t *writer = param;
+	gzFile gzf;
+	int end;
+
+	writer->ok = qfalse;
+
+	gzf = gzopen( writer->tempPath, "wb" );
+	if( gzf )
+	{
+		// the meta data is kept uncompressed, like SNAP_BeginDemoRecording does
+		gzsetparams( gzf, 0, Z_DEFAULT_STRATEGY );
+		gzwrite( gzf, writer->data, writer->metaSize );
+		gzflush( gzf, Z_FINISH );
+		gzsetparams( gzf, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY );
+
+		end = LittleLong( -1 );
+		writer->ok = gzwrite( gzf, writer->data + writer->metaSize, writer->size - writer->metaSize ) > 0 
+			&& gzwrite( gzf, &end, 4 ) == 4;
+		if( gzclose( gzf ) != Z_OK )
+			writer->ok = qfalse;
+
+		if( writer->ok )
+			writer->ok = rename( writer->tempPath, writer->path ) == 0;
+		if( !writer->ok )
+			remove( writer->tempPath );
+	}
+
+	QAtomic_Add( &writer->done, 1 );
+	return NULL;
+}
+
+/*
+* SV_Demo_FreeRaceDemoWriter
+*/
+static void SV_Demo_FreeRaceDemoWriter( sv_racedemowriter_t *writer )
+{
+	if( writer->thread )
+		QThread_Join( writer->thread );
+
+	if( writer->ok )
+		Com_Printf( "Saved race demo: %s\n", writer->filename );
+	else
+		Com_Printf( "Error: Couldn't write race demo: %s\n", writer->filename );
+
+	Mem_ZoneFree( writer->data );
+	Mem_ZoneFree( writer->filename );
+	Mem_ZoneFree( writer->path );
+	Mem_ZoneFree( writer->tempPath );
+	Mem_ZoneFree( writer );
+}
+
+/*
+* SV_Demo_RaceDemoName
+*/
+static void SV_Demo_RaceDemoName( const sv_racebuffer_t *rb, char *name, size_t size )
+{
+	char player[MAX_NAME_BYTES], date[32];
+	const char *in;
+	char *out;
+	unsigned int racetime = rb->times[rb->numSectors];
+	time_t now = time( NULL );
+
+	// keep the file name plain
+	for( in = COM_RemoveColorTokens( rb->playerName ), out = player; *in && out < player + sizeof( player ) - 1; in++ )
+	{
+		if( isalnum( (unsigned char)*in ) || *in == '-' || *in == '_' )
+			*out++ = *in;
+	}
+	*out = '\0';
+
+	strftime( date, sizeof( date ), "%y%m%d-%H%M%S", localtime( &now ) );
+
+	Q_snprintfz( name, size, "%s_race_%02u-%02u-%03u_%s_%s", sv.mapname, racetime / 60000, ( racetime / 1000 ) % 60, 
+		racetime % 1000, player[0] ? player : "player", date );
+}
+
+/*
+* SV_Demo_ExtractRaceRun
+*
+* Builds the demo of the pending run and hands it to a writer thread
+*/
+static void SV_Demo_ExtractRaceRun( sv_racebuffer_t *rb )
+{
+	int i, first;
+	size_t size, metaSize, pos, length, meta_data_realsize;
+	qbyte *data;
+	char name[MAX_QPATH], sectors[MAX_STRING_CHARS];
+	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
+	const sv_racesnap_t *snap;
+	sv_racedemowriter_t *writer;
+
+	rb->pending = qfalse;
+
+	// the last keyframe before the start of the run
+	first = -1;
+	for( i = 0; i < rb->numSnaps; i++ )
+	{
+		snap = &rb->snaps[( rb->firstSnap + i ) % rb->maxSnaps];
+		if( snap->gameTime + SV_RACEDEMO_PREROLL_MSEC > rb->startTime )
+			break;
+		if( snap->keyframe )
+			first = i;
+	}
+
+	if( first < 0 )
+	{
+		Com_Printf( "Race run of %s" S_COLOR_WHITE " doesn't fit into sv_racedemos_buffer, no demo saved\n", rb->playerName );
+		return;
+	}
+
+	SV_Demo_RaceDemoName( rb, name, sizeof( name ) );
+
+	meta_data_realsize = SNAP_ClearDemoMeta( meta_data, sizeof( meta_data ) );
+	sectors[0] = '\0';
+	for( i = 0; i < rb->numSectors; i++ )
+		Q_strncatz( sectors, va( i ? " %u" : "%u", rb->times[i] ), sizeof( sectors ) );
+
+#define SV_SetRaceDemoMetaKeyValue(k,v) meta_data_realsize = SNAP_SetDemoMetaKeyValue(meta_data, sizeof(meta_data), meta_data_realsize, k, v)
+	SV_SetRaceDemoMetaKeyValue( "hostname", sv.configstrings[CS_HOSTNAME] );
+	SV_SetRaceDemoMetaKeyValue( "localtime", va( "%u", (unsigned)time( NULL ) ) );
+	SV_SetRaceDemoMetaKeyValue( "multipov", "0" );
+	SV_SetRaceDemoMetaKeyValue( "duration", va( "%u", (int)ceil( ( svs.gametime - rb->snaps[( rb->firstSnap + first ) % rb->maxSnaps].gameTime )/1000.0f ) ) );
+	SV_SetRaceDemoMetaKeyValue( "mapname", sv.configstrings[CS_MAPNAME] );
+	SV_SetRaceDemoMetaKeyValue( "gametype", sv.configstrings[CS_GAMETYPENAME] );
+	SV_SetRaceDemoMetaKeyValue( "levelname", sv.configstrings[CS_MESSAGE] );
+	SV_SetRaceDemoMetaKeyValue( "player", rb->playerName );
+	SV_SetRaceDemoMetaKeyValue( "racetime", va( "%u", rb->times[rb->numSectors] ) );
+	SV_SetRaceDemoMetaKeyValue( "checkpoints", sectors );
+#undef SV_SetRaceDemoMetaKeyValue
+
+	data = SNAP_BuildDemoStart( &size, &metaSize, meta_data, meta_data_realsize, svs.spawncount, svc.snapFrameTime, 
+		sv.mapname, SV_BITFLAGS_RELIABLE, svs.purelist, sv.configstrings[0], sv.baselines );
+
+	// append the snapshots
+	length = size;
+	for( i = first; i < rb->numSnaps; i++ )
+		length += 4 + rb->snaps[( rb->firstSnap + i ) % rb->maxSnaps].size;
+	data = Mem_Realloc( data, length );
+
+	for( i = first, pos = size; i < rb->numSnaps; i++ )
+	{
+		int len;
+
+		snap = &rb->snaps[( rb->firstSnap + i ) % rb->maxSnaps];
+		len = LittleLong( (int)snap->size );
+		memcpy( data + pos, &len, 4 );
+		memcpy( data + pos + 4, rb->data + snap->offset, snap->size );
+		pos += 4 + snap->size;
+	}
+
+	writer = Mem_ZoneMalloc( sizeof( *writer ) );
+	writer->data = data;
+	writer->size = length;
+	writer->metaSize = metaSize;
+	writer->filename = ZoneCopyString( va( "%s/%s%s", SV_DEMO_DIR, name, APP_DEMO_EXTENSION_STR ) );
+	writer->path = ZoneCopyString( va( "%s/%s/%s", FS_WriteDirectory(), FS_GameDirectory(), writer->filename ) );
+	writer->tempPath = ZoneCopyString( va( "%s.rec", writer->path ) );
+	FS_CreateAbsolutePath( writer->path );
+
+	writer->thread = QThread_Create( SV_Demo_RaceDemoWriterThread, writer );
+	if( !writer->thread )
+		SV_Demo_RaceDemoWriterThread( writer );
+
+	writer->next = sv_racedemowriters;
+	sv_racedemowriters = writer;
+}
+
+/*
+* SV_Demo_RaceRunFinished
+*/
+void SV_Demo_RaceRunFinished( edict_t *ent, int numSectors, const unsigned int *times )
+{
+	int p;
+	client_t *client;
+	sv_racebuffer_t *rb;
+
+	p = NUM_FOR_EDICT( ent );
+	if( p < 1 || p > sv_maxclients->integer )
+		return;
+
+	client = svs.clients + ( p-1 );
+	rb = &sv_racebuffers[p-1];
+	if( !rb->data || client->state < CS_SPAWNED || numSectors < 0 )
+		return;
+
+	if( rb->pending )
+		SV_Demo_ExtractRaceRun( rb );
+
+	rb->pending = qtrue;
+	rb->finishTime = svs.gametime;
+	rb->startTime = svs.gametime - min( svs.gametime, times[numSectors] );
+	rb->numSectors = min( numSectors, SV_RACEDEMO_MAX_SECTORS );
+	memcpy( rb->times, times, rb->numSectors * sizeof( *times ) );
+	rb->times[rb->numSectors] = times[numSectors];
+	Q_strncpyz( rb->playerName, client->name, sizeof( rb->playerName ) );
+}
+
+/*
+* SV_Demo_RaceDemosFrame
+*
+* Extracts runs past their post-roll and reaps the finished writers
+*/
+void SV_Demo_RaceDemosFrame( void )
+{
+	int i;
+	sv_racedemowriter_t *writer, **prev;
+
+	for( i = 0; i < sv_maxclients->integer; i++ )
+	{
+		if( sv_racebuffers[i].pending && svs.gametime >= sv_racebuffers[i].finishTime + SV_RACEDEMO_POSTROLL_MSEC )
+			SV_Demo_ExtractRaceRun( &sv_racebuffers[i] );
+	}
+
+	for( prev = &sv_racedemowriters; ( writer = *prev ) != NULL; )
+	{
+		if( !QAtomic_Add( &writer->done, 0 ) )
+		{
+			prev = &writer->next;
+			continue;
+		}
+
+		*prev = writer->next;
+		SV_Demo_FreeRaceDemoWriter( writer );
+	}
+}
+
+/*
+* SV_Demo_FlushRaceDemos
+*
+* Extracts the pending runs without waiting for the post-roll, before the map changes
+*/
+void SV_Demo_FlushRaceDemos( void )
+{
+	int i;
+
+	for( i = 0; i < MAX_CLIENTS; i++ )
+	{
+		if( sv_racebuffers[i].pending )
+			SV_Demo_ExtractRaceRun( &sv_racebuffers[i] );
+	}
+}
+
+/*
+* SV_Demo_FreeRaceBuffer
+*/
+void SV_Demo_FreeRaceBuffer( client_t *client )
+{
+	sv_racebuffer_t *rb = &sv_racebuffers[client - svs.clients];
+
+	if( rb->pending )
+		SV_Demo_ExtractRaceRun( rb );
+	SV_Demo_FreeRaceSnaps( rb );
+}
+
+/*
+* SV_Demo_ShutdownRaceDemos
+*/
+void SV_Demo_ShutdownRaceDemos( void )
+{
+	int i;
+	sv_racedemowriter_t *writer;
+
+	SV_Demo_FlushRaceDemos();
+
+	for( i = 0; i < MAX_CLIENTS; i++ )
+		SV_Demo_FreeRaceSnaps( &sv_racebuffers[i] );
+
+	while( ( writer = sv_racedemowriters ) != NULL )
+	{
+		sv_racedemowriters = writer->next;
+		SV_Demo_FreeRaceDemoWriter( writer );
+	}
+}
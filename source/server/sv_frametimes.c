@@ -0,0 +1,203 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "server.h"
+
+/*
+* Frame budget statistics
+*
+* SV_Frame is called many times between two snapshots, most of them only
+* read packets and sleep. The time spent in each phase is summed up until
+* the next snapshot is sent and then stored as one sample, so the numbers
+* describe what a snapshot frame costs. The last SV_FRAMETIMES_WINDOW
+* samples are kept for the p50/p99/max shown by "frametimes" and served
+* over HTTP as /frametimes when sv_http_frametimes is set.
+*/
+
+#define SV_FRAMETIMES_WINDOW	1024	// about 50 seconds at 20 snapshots a second
+
+typedef struct
+{
+	unsigned int count;
+	unsigned int p50, p99, max;
+	double avg;
+} sv_frametimes_stats_t;
+
+static const char *sv_framephase_names[SV_FRAMEPHASE_TOTAL] =
+{
+	"readpackets",
+	"runframe",
+	"sendclientmessages",
+	"demowritesnap",
+	"webframe",
+	"idle",
+	"busy"
+};
+
+static quint64 sv_frametimes_current[SV_FRAMEPHASE_TOTAL];
+static unsigned int sv_frametimes_samples[SV_FRAMEPHASE_TOTAL][SV_FRAMETIMES_WINDOW];
+static unsigned int sv_frametimes_numsamples;		// total committed, the window wraps
+
+/*
+* SV_FrameTimes_Begin
+*/
+quint64 SV_FrameTimes_Begin( void )
+{
+	if( !sv_frametimes->integer )
+		return 0;
+	return Sys_Microseconds();
+}
+
+/*
+* SV_FrameTimes_End
+*/
+void SV_FrameTimes_End( sv_framephase_t phase, quint64 start )
+{
+	if( !sv_frametimes->integer || !start )
+		return;
+	sv_frametimes_current[phase] += Sys_Microseconds() - start;
+}
+
+/*
+* SV_FrameTimes_Commit
+*
+* Stores the time accumulated since the previous snapshot
+*/
+void SV_FrameTimes_Commit( void )
+{
+	int i;
+	unsigned int slot;
+	quint64 busy;
+
+	if( !sv_frametimes->integer )
+		return;
+
+	// SV_FRAMEPHASE_BUSY has been accumulating whole SV_Frame calls
+	busy = sv_frametimes_current[SV_FRAMEPHASE_BUSY];
+	if( busy > sv_frametimes_current[SV_FRAMEPHASE_IDLE] )
+		busy -= sv_frametimes_current[SV_FRAMEPHASE_IDLE];
+	else
+		busy = 0;
+	sv_frametimes_current[SV_FRAMEPHASE_BUSY] = busy;
+
+	slot = sv_frametimes_numsamples % SV_FRAMETIMES_WINDOW;
+	for( i = 0; i < SV_FRAMEPHASE_TOTAL; i++ )
+	{
+		sv_frametimes_samples[i][slot] = (unsigned int)min( sv_frametimes_current[i], 0xFFFFFFFFu );
+		sv_frametimes_current[i] = 0;
+	}
+	sv_frametimes_numsamples++;
+}
+
+/*
+* SV_FrameTimes_Reset
+*/
+static void SV_FrameTimes_Reset( void )
+{
+	memset( sv_frametimes_current, 0, sizeof( sv_frametimes_current ) );
+	sv_frametimes_numsamples = 0;
+}
+
+/*
+* SV_FrameTimes_CompareSamples
+*/
+static int SV_FrameTimes_CompareSamples( const void *a, const void *b )
+{
+	unsigned int ua = *(const unsigned int *)a, ub = *(const unsigned int *)b;
+	return ua < ub ? -1 : ( ua > ub ? 1 : 0 );
+}
+
+/*
+* SV_FrameTimes_GetStats
+*/
+static void SV_FrameTimes_GetStats( sv_framephase_t phase, sv_frametimes_stats_t *stats )
+{
+	unsigned int i, count;
+	double total = 0;
+	unsigned int sorted[SV_FRAMETIMES_WINDOW];
+
+	memset( stats, 0, sizeof( *stats ) );
+
+	count = min( sv_frametimes_numsamples, SV_FRAMETIMES_WINDOW );
+	if( !count )
+		return;
+
+	memcpy( sorted, sv_frametimes_samples[phase], sizeof( sorted[0] ) * count );
+	qsort( sorted, count, sizeof( sorted[0] ), SV_FrameTimes_CompareSamples );
+
+	for( i = 0; i < count; i++ )
+		total += sorted[i];
+
+	stats->count = count;
+	stats->p50 = sorted[( count - 1 ) * 50 / 100];
+	stats->p99 = sorted[( count - 1 ) * 99 / 100];
+	stats->max = sorted[count - 1];
+	stats->avg = total / count;
+}
+
+/*
+* SV_FrameTimes_WriteJSON
+*
+* Writes the statistics of all phases in microseconds, returns the length
+*/
+size_t SV_FrameTimes_WriteJSON( char *buf, size_t size )
+{
+	int i;
+	sv_frametimes_stats_t stats;
+
+	Q_snprintfz( buf, size, "{\"window\":%u,\"phases\":{", SV_FRAMETIMES_WINDOW );
+	for( i = 0; i < SV_FRAMEPHASE_TOTAL; i++ )
+	{
+		SV_FrameTimes_GetStats( i, &stats );
+		Q_strncatz( buf, va( "%s\"%s\":{\"samples\":%u,\"avg\":%.0f,\"p50\":%u,\"p99\":%u,\"max\":%u}",
+			i ? "," : "", sv_framephase_names[i], stats.count, stats.avg, stats.p50, stats.p99, stats.max ), size );
+	}
+	Q_strncatz( buf, "}}\n", size );
+
+	return strlen( buf );
+}
+
+/*
+* SV_FrameTimes_f
+*/
+void SV_FrameTimes_f( void )
+{
+	int i;
+	sv_frametimes_stats_t stats;
+
+	if( !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		SV_FrameTimes_Reset();
+		Com_Printf( "Frame times reset\n" );
+		return;
+	}
+
+	if( !sv_frametimes->integer )
+	{
+		Com_Printf( "Frame timing is disabled, set sv_frametimes to 1\n" );
+		return;
+	}
+
+	Com_Printf( "Snapshot frame times in microseconds, last %u frames:\n", min( sv_frametimes_numsamples, SV_FRAMETIMES_WINDOW ) );
+	Com_Printf( "%-20s %8s %8s %8s %8s\n", "phase", "avg", "p50", "p99", "max" );
+	for( i = 0; i < SV_FRAMEPHASE_TOTAL; i++ )
+	{
+		SV_FrameTimes_GetStats( i, &stats );
+		Com_Printf( "%-20s %8.0f %8u %8u %8u\n", sv_framephase_names[i], stats.avg, stats.p50, stats.p99, stats.max );
+	}
+}
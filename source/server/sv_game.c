@@ -259,6 +259,7 @@ static void PF_ConfigString( int index, const char *val )
 
 	// change the string in sv
 	Q_strncpyz( sv.configstrings[index], val, sizeof( sv.configstrings[index] ) );
+	svs.gamestate.dirty = qtrue;
 
 	if( sv.state != ss_loading )
 		SV_SendServerCommand( NULL, "cs %i \"%s\"", index, val );
@@ -561,6 +562,7 @@ void SV_InitGameProgs( void )
 
 	import.ML_Update = ML_Update;
 	import.ML_GetMapByNum = ML_GetMapByNum;
+	import.ML_FindMap = ML_FindMap;
 	import.ML_FilenameExists = ML_FilenameExists;
 	import.ML_GetFullname = ML_GetFullname;
 
@@ -571,6 +573,7 @@ void SV_InitGameProgs( void )
 	import.DropClient = PF_DropClient;
 	import.GetClientState = PF_GetClientState;
 	import.ExecuteClientThinks = SV_ExecuteClientThinks;
+	import.ExecuteClientThinksParallel = SV_ExecuteClientThinksParallel;
 
 	import.LocateEntities = SV_LocateEntities;
 
@@ -580,6 +583,8 @@ void SV_InitGameProgs( void )
 	import.MM_SendQuery = SV_MM_SendQuery;
 	import.MM_GameState = SV_MM_GameState;
 
+	import.RaceRunFinished = SV_Demo_RaceRunFinished;
+
 	// clear module manifest string
 	assert( sizeof( manifest ) >= MAX_INFO_STRING );
 	memset( manifest, 0, sizeof( manifest ) );
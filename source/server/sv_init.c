@@ -53,6 +53,8 @@ static int SV_FindIndex( const char *name, int start, int max, qboolean create )
 
 	Q_strncpyz( sv.configstrings[start+i], name, sizeof( sv.configstrings[i] ) );
 
+	svs.gamestate.dirty = qtrue;
+
 	// send the update to everyone
 	if( sv.state != ss_loading )
 		SV_SendServerCommand( NULL, "cs %i \"%s\"", start+i, name );
@@ -251,6 +253,7 @@ static void SV_SpawnServer( const char *server, qboolean devmap )
 	Com_Printf( "SpawnServer: %s\n", server );
 
 	svs.spawncount++;   // any partially connected client will be restarted
+	svs.gamestate.dirty = qtrue;
 
 	Com_SetServerState( ss_dead );
 
@@ -268,6 +271,7 @@ static void SV_SpawnServer( const char *server, qboolean devmap )
 	sv.nextSnapTime = 1000;
 
 	Q_snprintfz( sv.configstrings[CS_WORLDMODEL], sizeof( sv.configstrings[CS_WORLDMODEL] ), "maps/%s.bsp", server );
+	SV_Instances_SelectCM( server );
 	CM_LoadMap( svs.cms, sv.configstrings[CS_WORLDMODEL], qfalse, &checksum );
 
 	Q_snprintfz( sv.configstrings[CS_MAPCHECKSUM], sizeof( sv.configstrings[CS_MAPCHECKSUM] ), "%i", checksum );
@@ -512,6 +516,8 @@ void SV_ShutdownGame( const char *finalmsg, qboolean reconnect )
 	if( svs.demo.file )
 		SV_Demo_Stop_f();
 
+	SV_Demo_ShutdownRaceDemos();
+
 	if( svs.clients )
 		SV_FinalMessage( finalmsg, reconnect );
 
@@ -565,6 +571,12 @@ void SV_ShutdownGame( const char *finalmsg, qboolean reconnect )
 		svs.motd = NULL;
 	}
 
+	if( svs.gamestate.data )
+	{
+		Mem_Free( svs.gamestate.data );
+		svs.gamestate.data = NULL;
+	}
+
 	if( sv_mempool )
 		Mem_EmptyPool( sv_mempool );
 
@@ -585,6 +597,8 @@ void SV_Map( const char *level, qboolean devmap )
 	if( svs.demo.file )
 		SV_Demo_Stop_f();
 
+	SV_Demo_FlushRaceDemos();
+
 	// skip the end-of-unit flag if necessary
 	if( level[0] == '*' )
 		level++;
@@ -0,0 +1,286 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "server.h"
+
+/*
+* Server instances
+*
+* With sv_instances N a dedicated server hosts N independent servers. Once
+* the filesystem, the map list and the collision models of the start map
+* and of the maps listed in sv_instances_maps are loaded, the process forks
+* N - 1 times. The instances share those pages until one of them writes to
+* them, everything created afterwards (game module, scripts, clients,
+* sockets) is private to each instance. Maps that aren't preloaded are
+* loaded privately by the instance that switches to them, and traces and
+* area portal changes still dirty some pages of the shared ones.
+* Instance i listens on the ports of instance 0 plus i and logs to its own
+* console log.
+*
+* The first process keeps reading the terminal and takes the others down
+* when it quits.
+*/
+
+#define SV_MAX_INSTANCES	64
+#define SV_MAX_INSTANCE_MAPS	32
+
+static int sv_instance;					// 0 in the first process
+static int sv_instance_pids[SV_MAX_INSTANCES];
+static int sv_numinstances;
+static unsigned int sv_instance_lastreap;
+
+static int sv_instance_nummaps;
+static char sv_instance_mapnames[SV_MAX_INSTANCE_MAPS][MAX_CONFIGSTRING_CHARS];
+static cmodel_state_t *sv_instance_cms[SV_MAX_INSTANCE_MAPS];
+
+/*
+* SV_Instances_PreloadMap
+*/
+static void SV_Instances_PreloadMap( const char *map )
+{
+	int i;
+	unsigned int checksum;
+	cmodel_state_t *cms;
+
+	if( !map[0] || sv_instance_nummaps == SV_MAX_INSTANCE_MAPS )
+		return;
+
+	for( i = 0; i < sv_instance_nummaps; i++ )
+	{
+		if( !Q_stricmp( sv_instance_mapnames[i], map ) )
+			return;
+	}
+
+	// CM_LoadMap drops to the console on errors, which is not an option yet
+	Q_snprintfz( sv_instance_mapnames[sv_instance_nummaps], sizeof( sv_instance_mapnames[0] ), "maps/%s.bsp", map );
+	if( FS_FOpenFile( sv_instance_mapnames[sv_instance_nummaps], NULL, FS_READ ) == -1 )
+	{
+		Com_Printf( "Couldn't preload %s for the server instances\n", map );
+		return;
+	}
+
+	cms = CM_New( NULL );
+	CM_AddReference( cms );
+	CM_LoadMap( cms, sv_instance_mapnames[sv_instance_nummaps], qfalse, &checksum );
+
+	Q_strncpyz( sv_instance_mapnames[sv_instance_nummaps], map, sizeof( sv_instance_mapnames[0] ) );
+	sv_instance_cms[sv_instance_nummaps++] = cms;
+}
+
+/*
+* SV_Instances_PreloadMaps
+*
+* Loads the collision models of the start map and of the map pool
+*/
+static void SV_Instances_PreloadMaps( void )
+{
+	int i;
+	const char *map = sv_defaultmap->string, *list, *token;
+
+	// a map given on the command line is started instead of the default one
+	for( i = 1; i < COM_Argc() - 1; i++ )
+	{
+		if( !Q_stricmp( COM_Argv( i ), "+map" ) || !Q_stricmp( COM_Argv( i ), "+devmap" ) || !Q_stricmp( COM_Argv( i ), "+gamemap" ) )
+			map = COM_Argv( i + 1 );
+	}
+
+	SV_Instances_PreloadMap( map );
+
+	list = sv_instances_maps->string;
+	while( list )
+	{
+		token = COM_Parse( &list );
+		if( !token[0] )
+			break;
+		SV_Instances_PreloadMap( token );
+	}
+
+	if( sv_instance_nummaps )
+		Com_Printf( "Preloaded %i maps for the server instances\n", sv_instance_nummaps );
+}
+
+/*
+* SV_Instances_OffsetPort
+*/
+static void SV_Instances_OffsetPort( const char *name )
+{
+	cvar_t *var = Cvar_Find( name );
+
+	if( var && var->integer )
+		Cvar_ForceSet( name, va( "%i", var->integer + sv_instance ) );
+}
+
+/*
+* SV_Instances_SetupChild
+*/
+static void SV_Instances_SetupChild( void )
+{
+	char logname[MAX_QPATH];
+	cvar_t *logconsole;
+
+	sv_numinstances = 0;
+
+	SV_Instances_OffsetPort( "sv_port" );
+	SV_Instances_OffsetPort( "sv_port6" );
+#ifdef HTTP_SUPPORT
+	SV_Instances_OffsetPort( "sv_http_port" );
+#endif
+
+	logconsole = Cvar_Find( "logconsole" );
+	if( logconsole && logconsole->string[0] )
+	{
+		Q_strncpyz( logname, logconsole->string, sizeof( logname ) );
+		COM_StripExtension( logname );
+		Q_strncatz( logname, va( "_%i.log", sv_instance ), sizeof( logname ) );
+		Cvar_ForceSet( "logconsole", logname );
+	}
+}
+
+/*
+* SV_Instances_Init
+*
+* Called at the end of SV_Init, forks the other instances
+*/
+void SV_Instances_Init( void )
+{
+	int i, pid, count;
+	cvar_t *logconsole;
+
+	sv_instance = 0;
+	sv_numinstances = 0;
+	sv_instance_nummaps = 0;
+
+	count = sv_instances->integer;
+	if( !dedicated->integer || count <= 1 )
+		return;
+	if( count > SV_MAX_INSTANCES )
+		count = SV_MAX_INSTANCES;
+
+	SV_Instances_PreloadMaps();
+
+	// the log writer thread doesn't survive fork, every instance starts its own
+	Log_Shutdown();
+
+	for( i = 1; i < count; i++ )
+	{
+		pid = Sys_ForkInstance();
+		if( pid < 0 )
+		{
+			Com_Printf( "Couldn't start server instance %i\n", i );
+			break;
+		}
+
+		if( pid == 0 )
+		{
+			sv_instance = i;
+			SV_Instances_SetupChild();
+			return;
+		}
+
+		sv_instance_pids[sv_numinstances++] = pid;
+	}
+
+	logconsole = Cvar_Find( "logconsole" );
+	if( logconsole )
+		Cvar_SetModified( logconsole );
+
+	Com_Printf( "Started %i server instances\n", sv_numinstances + 1 );
+}
+
+/*
+* SV_Instances_Frame
+*
+* Reports instances that went down
+*/
+void SV_Instances_Frame( void )
+{
+	int i, pid;
+
+	if( !sv_numinstances || Sys_Milliseconds() - sv_instance_lastreap < 1000 )
+		return;
+	sv_instance_lastreap = Sys_Milliseconds();
+
+	while( ( pid = Sys_ReapInstance() ) > 0 )
+	{
+		for( i = 0; i < sv_numinstances; i++ )
+		{
+			if( sv_instance_pids[i] != pid )
+				continue;
+
+			Com_Printf( "Server instance %i (pid %i) exited\n", i + 1, pid );
+			sv_instance_pids[i] = 0;
+			break;
+		}
+	}
+}
+
+/*
+* SV_Instances_SelectCM
+*
+* Points svs.cms at the preloaded collision model of the map, or at a private
+* one when the map isn't preloaded, before SV_SpawnServer loads the map
+*/
+void SV_Instances_SelectCM( const char *mapname )
+{
+	int i;
+	qboolean shared = qfalse;
+	cmodel_state_t *cms = NULL;
+
+	for( i = 0; i < sv_instance_nummaps; i++ )
+	{
+		if( svs.cms == sv_instance_cms[i] )
+			shared = qtrue;
+		if( !Q_stricmp( sv_instance_mapnames[i], mapname ) )
+			cms = sv_instance_cms[i];
+	}
+
+	if( !cms )
+	{
+		// never load another map over a shared one
+		if( !shared )
+			return;
+		cms = CM_New( NULL );
+	}
+
+	if( cms == svs.cms )
+		return;
+
+	CM_AddReference( cms );
+	Com_SetServerCM( NULL, 0 );
+	CM_ReleaseReference( svs.cms );
+	svs.cms = cms;
+}
+
+/*
+* SV_Instances_Shutdown
+*/
+void SV_Instances_Shutdown( void )
+{
+	int i;
+
+	for( i = 0; i < sv_numinstances; i++ )
+	{
+		if( sv_instance_pids[i] )
+			Sys_KillInstance( sv_instance_pids[i] );
+	}
+	sv_numinstances = 0;
+
+	for( i = 0; i < sv_instance_nummaps; i++ )
+		CM_ReleaseReference( sv_instance_cms[i] );
+	sv_instance_nummaps = 0;
+}
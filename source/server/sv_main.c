@@ -61,12 +61,19 @@ cvar_t *sv_http_port;
 cvar_t *sv_http_upstream_baseurl;
 cvar_t *sv_http_upstream_ip;
 cvar_t *sv_http_upstream_realip_header;
+cvar_t *sv_http_frametimes;
 #endif
 
+cvar_t *sv_frametimes;
+cvar_t *sv_instances;
+cvar_t *sv_instances_maps;	// maps whose collision models the instances share
+
 cvar_t *sv_showclamp;
 cvar_t *sv_showRcon;
 cvar_t *sv_showChallenge;
 cvar_t *sv_showInfoQueries;
+cvar_t *sv_queryrate;
+cvar_t *sv_queryburst;
 cvar_t *sv_highchars;
 
 cvar_t *sv_hostname;
@@ -81,6 +88,7 @@ cvar_t *sv_reconnectlimit; // minimum seconds between connect messages
 
 cvar_t *sv_maxrate;
 cvar_t *sv_compresspackets;
+cvar_t *sv_packedentities;
 cvar_t *sv_masterservers;
 cvar_t *sv_skilllevel;
 
@@ -95,6 +103,10 @@ cvar_t *sv_autoUpdate;
 cvar_t *sv_lastAutoUpdate;
 
 cvar_t *sv_demodir;
+cvar_t *sv_racedemos;
+cvar_t *sv_racedemos_buffer;
+
+cvar_t *sv_parallelthinks;
 
 //============================================================================
 
@@ -459,6 +471,7 @@ static qboolean SV_RunGameFrame( int msec )
 	qboolean refreshSnapshot;
 	qboolean refreshGameModule;
 	qboolean sentFragments;
+	quint64 frametime;
 
 	accTime += msec;
 
@@ -502,7 +515,9 @@ static qboolean SV_RunGameFrame( int msec )
 			}
 			opened_sockets[open_ind] = NULL;
 
+			frametime = SV_FrameTimes_Begin();
 			NET_Sleep( sleeptime, opened_sockets );
+			SV_FrameTimes_End( SV_FRAMEPHASE_IDLE, frametime );
 		}
 	}
 
@@ -529,7 +544,9 @@ static qboolean SV_RunGameFrame( int msec )
 		if( host_speeds->integer )
 			time_before_game = Sys_Milliseconds();
 
+		frametime = SV_FrameTimes_Begin();
 		ge->RunFrame( moduleTime, svs.gametime );
+		SV_FrameTimes_End( SV_FRAMEPHASE_RUNFRAME, frametime );
 
 		if( host_speeds->integer )
 			time_after_game = Sys_Milliseconds();
@@ -684,6 +701,7 @@ static void SV_CheckAutoUpdate( void )
 static void SV_CheckMatchUUID_Callback( const char *uuid )
 {
 	Q_strncpyz( sv.configstrings[CS_MATCHUUID], uuid, sizeof( sv.configstrings[0] ) );
+	svs.gamestate.dirty = qtrue;
 }
 
 /*
@@ -707,9 +725,13 @@ static void SV_CheckMatchUUID( void )
 void SV_Frame( int realmsec, int gamemsec )
 {
 	const unsigned int wrappingPoint = 0x70000000;
+	quint64 framestart, phasestart;
+	qboolean snapFrame;
 
 	time_before_game = time_after_game = 0;
 
+	SV_Instances_Frame();
+
 	// if server is not active, do nothing
 	if( !svs.initialized )
 	{
@@ -728,20 +750,30 @@ void SV_Frame( int realmsec, int gamemsec )
 		return;
 	}
 
+	framestart = SV_FrameTimes_Begin();
+
 	// check timeouts
 	SV_CheckTimeouts();
 
 	// get packets from clients
+	phasestart = SV_FrameTimes_Begin();
 	SV_ReadPackets();
+	SV_FrameTimes_End( SV_FRAMEPHASE_READPACKETS, phasestart );
 
 	// let everything in the world think and move
-	if( SV_RunGameFrame( gamemsec ) )
+	snapFrame = SV_RunGameFrame( gamemsec );
+	if( snapFrame )
 	{
 		// send messages back to the clients that had packets read this frame
+		phasestart = SV_FrameTimes_Begin();
 		SV_SendClientMessages();
+		SV_FrameTimes_End( SV_FRAMEPHASE_SENDCLIENTMESSAGES, phasestart );
 
 		// write snap to server demo file
+		phasestart = SV_FrameTimes_Begin();
 		SV_Demo_WriteSnap();
+		SV_Demo_RaceDemosFrame();
+		SV_FrameTimes_End( SV_FRAMEPHASE_DEMOWRITESNAP, phasestart );
 
 		// run matchmaker stuff
 		SV_CheckMatchUUID();
@@ -756,9 +788,15 @@ void SV_Frame( int realmsec, int gamemsec )
 	}
 
 	// handle HTTP connections
+	phasestart = SV_FrameTimes_Begin();
 	SV_Web_Frame();
+	SV_FrameTimes_End( SV_FRAMEPHASE_WEBFRAME, phasestart );
 
 	SV_CheckAutoUpdate();
+
+	SV_FrameTimes_End( SV_FRAMEPHASE_BUSY, framestart );
+	if( snapFrame )
+		SV_FrameTimes_Commit();
 }
 
 //============================================================================
@@ -900,8 +938,13 @@ void SV_Init( void )
 	sv_http_upstream_baseurl =	Cvar_Get( "sv_http_upstream_baseurl", "", CVAR_ARCHIVE | CVAR_LATCH );
 	sv_http_upstream_realip_header = Cvar_Get( "sv_http_upstream_realip_header", "", CVAR_ARCHIVE );
 	sv_http_upstream_ip = Cvar_Get( "sv_http_upstream_ip", "", CVAR_ARCHIVE );
+	sv_http_frametimes = Cvar_Get( "sv_http_frametimes", "0", CVAR_ARCHIVE );
 #endif
 
+	sv_frametimes =		    Cvar_Get( "sv_frametimes", "1", CVAR_ARCHIVE );
+	sv_instances =		    Cvar_Get( "sv_instances", "1", CVAR_LATCH );
+	sv_instances_maps =	    Cvar_Get( "sv_instances_maps", "", CVAR_LATCH );
+
 	rcon_password =		    Cvar_Get( "rcon_password", "", 0 );
 	sv_hostname =		    Cvar_Get( "sv_hostname", APPLICATION " server", CVAR_SERVERINFO | CVAR_ARCHIVE );
 	sv_timeout =		    Cvar_Get( "sv_timeout", "125", 0 );
@@ -911,6 +954,8 @@ void SV_Init( void )
 	sv_showRcon =		    Cvar_Get( "sv_showRcon", "1", 0 );
 	sv_showChallenge =	    Cvar_Get( "sv_showChallenge", "0", 0 );
 	sv_showInfoQueries =	Cvar_Get( "sv_showInfoQueries", "0", 0 );
+	sv_queryrate =			Cvar_Get( "sv_queryrate", "4", CVAR_ARCHIVE );
+	sv_queryburst =			Cvar_Get( "sv_queryburst", "10", CVAR_ARCHIVE );
 	sv_highchars =			Cvar_Get( "sv_highchars", "1", 0 );
 
 	sv_uploads_http	=       Cvar_Get( "sv_uploads_http", "1", CVAR_READONLY );
@@ -962,9 +1007,19 @@ void SV_Init( void )
 		Cvar_ForceSet( "sv_demodir", "" );
 	}
 
+	// keep the recent snapshots of each player to save demos of finished race runs,
+	// the buffer size is in KB per player
+	sv_racedemos = Cvar_Get( "sv_racedemos", "0", CVAR_ARCHIVE );
+	sv_racedemos_buffer = Cvar_Get( "sv_racedemos_buffer", "4096", CVAR_ARCHIVE );
+
+	// extra threads running usercmds of players that can't interact, 0 = disabled
+	sv_parallelthinks = Cvar_Get( "sv_parallelthinks", "0", CVAR_ARCHIVE );
+
 	// wsw : jal : cap client's exceding server rules
 	sv_maxrate =		    Cvar_Get( "sv_maxrate", "0", CVAR_DEVELOPER );
 	sv_compresspackets =	    Cvar_Get( "sv_compresspackets", "1", CVAR_DEVELOPER );
+	// bitstream packetentities for clients that ask for them
+	sv_packedentities =	    Cvar_Get( "sv_packedentities", "1", CVAR_ARCHIVE );
 	sv_skilllevel =		    Cvar_Get( "sv_skilllevel", "1", CVAR_SERVERINFO|CVAR_ARCHIVE|CVAR_LATCH );
 
 	if( sv_skilllevel->integer > 2 )
@@ -1018,6 +1073,11 @@ void SV_Init( void )
 
 	ML_Init();
 
+	DI_Init();
+
+	// must come before any server socket is opened
+	SV_Instances_Init();
+
 	SV_Web_Init();
 
 	sv_initialized = qtrue;
@@ -1034,9 +1094,12 @@ void SV_Shutdown( const char *finalmsg )
 		return;
 
 	SV_Web_Shutdown();
+	DI_Shutdown();
 	ML_Shutdown();
 	SV_MM_Shutdown( qtrue );
 	SV_ShutdownGame( finalmsg, qfalse );
+	SV_ShutdownClientThinks();
+	SV_Instances_Shutdown();
 
 	SV_ShutdownOperatorCommands();
 
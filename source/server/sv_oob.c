@@ -178,21 +178,209 @@ void SV_MasterHeartbeat( void )
 
 //============================================================================
 
+#define MAX_LONGINFOSTRING ( MAX_MSGLEN - 16 )
+
+#define QUERY_BUCKETS	1024	// power of two
+
+// token bucket of an address sending info queries
+typedef struct
+{
+	netadr_t address;
+	unsigned int time;					// last refill
+	float tokens;						// queries it may still send
+} query_bucket_t;
+
+// what a cached reply was built from
+typedef struct
+{
+	qboolean valid;
+	int serverinfo_modcount;
+	unsigned int players;				// checksum of the player list
+	int flags;							// anything else that goes into the string
+} info_key_t;
+
+static query_bucket_t query_buckets[QUERY_BUCKETS];
+static qboolean query_key_initialized;
+static quint64 query_key[2];			// keeps slot collisions from being found offline
+
+static struct
+{
+	unsigned int queries;
+	unsigned int dropped;
+	unsigned int cached;
+	unsigned int rebuilt;
+} query_stats;
+
+static info_key_t info_key, status_key, shortinfo_key;
+static char info_string[MAX_LONGINFOSTRING];
+static char status_string[MAX_LONGINFOSTRING];
+
+static quint64 SV_SipHash( const quint64 key[2], const qbyte *data, size_t len );
+static void SV_NewChallengeSecret( quint64 key[2] );
+
 /*
-* SV_LongInfoString
-* Builds the string that is sent as heartbeats and status replies
+* SV_QueryBucket
 */
-static char *SV_LongInfoString( qboolean fullStatus )
+static query_bucket_t *SV_QueryBucket( const netadr_t *address )
+{
+	const qbyte *ip;
+	size_t len;
+
+	if( !query_key_initialized )
+	{
+		SV_NewChallengeSecret( query_key );
+		query_key_initialized = qtrue;
+	}
+
+	if( address->type == NA_IP6 )
+	{
+		ip = address->address.ipv6.ip;
+		len = sizeof( address->address.ipv6.ip );
+	}
+	else
+	{
+		ip = address->address.ipv4.ip;
+		len = sizeof( address->address.ipv4.ip );
+	}
+
+	return &query_buckets[SV_SipHash( query_key, ip, len ) & ( QUERY_BUCKETS - 1 )];
+}
+
+/*
+* SV_QueryAllowed
+* 
+* Token bucket per source address, so floods of queries (spoofed or not)
+* can't make us send more than sv_queryrate replies a second to anyone
+*/
+static qboolean SV_QueryAllowed( const netadr_t *address )
+{
+	query_bucket_t *bucket;
+	float burst;
+
+	query_stats.queries++;
+
+	if( sv_queryrate->value <= 0 || address->type == NA_LOOPBACK || NET_IsLANAddress( address ) )
+		return qtrue;
+
+	burst = max( sv_queryburst->integer, 1 );
+
+	// svs.realtime restarts at each map
+	bucket = SV_QueryBucket( address );
+	if( svs.realtime < bucket->time )
+		bucket->tokens = burst;
+	else
+		bucket->tokens = min( bucket->tokens + ( svs.realtime - bucket->time ) * sv_queryrate->value * 0.001f, burst );
+	bucket->time = svs.realtime;
+
+	// an address that collides with the owner takes the slot over as it is,
+	// so alternating between the two doesn't refill it
+	if( !NET_CompareBaseAddress( &bucket->address, address ) )
+		bucket->address = *address;
+
+	if( bucket->tokens < 1 )
+	{
+		query_stats.dropped++;
+		return qfalse;
+	}
+
+	bucket->tokens -= 1;
+	return qtrue;
+}
+
+/*
+* SV_QueryStats_f
+*/
+void SV_QueryStats_f( void )
+{
+	int i, sources;
+
+	sources = 0;
+	for( i = 0; i < QUERY_BUCKETS; i++ )
+	{
+		if( query_buckets[i].address.type != NA_NOTRANSMIT && svs.realtime - query_buckets[i].time < 60000 )
+			sources++;
+	}
+
+	Com_Printf( "info queries: %u\n", query_stats.queries );
+	Com_Printf( "rate limited: %u\n", query_stats.dropped );
+	Com_Printf( "cached replies: %u\n", query_stats.cached );
+	Com_Printf( "rebuilt replies: %u\n", query_stats.rebuilt );
+	Com_Printf( "sources in the last minute: %i\n", sources );
+	Com_Printf( "rate: %g/s, burst: %i\n", sv_queryrate->value, sv_queryburst->integer );
+
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+		memset( &query_stats, 0, sizeof( query_stats ) );
+}
+
+/*
+* SV_PlayerListChecksum
+* 
+* Changes whenever a reply would list different players
+*/
+static unsigned int SV_PlayerListChecksum( qboolean fullStatus )
+{
+	int i;
+	const char *s;
+	client_t *cl;
+	unsigned int hash = 2166136261u;
+
+	for( i = 0; i < sv_maxclients->integer; i++ )
+	{
+		cl = &svs.clients[i];
+		if( cl->state < CS_CONNECTED )
+			continue;
+
+		hash = ( hash ^ i ) * 16777619u;
+		if( cl->edict->r.svflags & SVF_FAKECLIENT || cl->tvclient )
+			hash = ( hash ^ 0xff ) * 16777619u;
+
+		if( fullStatus )
+		{
+			hash = ( hash ^ cl->edict->r.client->r.frags ) * 16777619u;
+			hash = ( hash ^ cl->ping ) * 16777619u;
+			hash = ( hash ^ cl->edict->s.team ) * 16777619u;
+			for( s = cl->name; *s; s++ )
+				hash = ( hash ^ (qbyte)*s ) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+/*
+* SV_InfoKeyMatches
+* 
+* Checks whether a cached reply is still good, or takes the new key
+*/
+static qboolean SV_InfoKeyMatches( info_key_t *key, unsigned int players, int flags )
+{
+	if( key->valid && key->serverinfo_modcount == serverinfo_modcount && key->players == players && key->flags == flags )
+	{
+		query_stats.cached++;
+		return qtrue;
+	}
+
+	key->valid = qtrue;
+	key->serverinfo_modcount = serverinfo_modcount;
+	key->players = players;
+	key->flags = flags;
+	query_stats.rebuilt++;
+	return qfalse;
+}
+
+/*
+* SV_BuildLongInfoString
+*/
+static void SV_BuildLongInfoString( char *status, size_t size, qboolean fullStatus )
 {
 	char tempstr[1024] = { 0 };
 	const char *gametype;
-	static char status[MAX_MSGLEN - 16];
 	int i, bots, count;
 	client_t *cl;
 	size_t statusLength;
 	size_t tempstrLength;
 
-	Q_strncpyz( status, Cvar_Serverinfo(), sizeof( status ) );
+	Q_strncpyz( status, Cvar_Serverinfo(), size );
 
 	// convert "g_gametype" to "gametype"
 	gametype = Info_ValueForKey( status, "g_gametype" );
@@ -221,9 +409,9 @@ static char *SV_LongInfoString( qboolean fullStatus )
 		Q_snprintfz( tempstr, sizeof( tempstr ), "\\bots\\%i", bots );
 	Q_snprintfz( tempstr + strlen( tempstr ), sizeof( tempstr ) - strlen( tempstr ), "\\clients\\%i%s", count, fullStatus ? "\n" : "" );
 	tempstrLength = strlen( tempstr );
-	if( statusLength + tempstrLength >= sizeof( status ) )
-		return status; // can't hold any more
-	Q_strncpyz( status + statusLength, tempstr, sizeof( status ) - statusLength );
+	if( statusLength + tempstrLength >= size )
+		return; // can't hold any more
+	Q_strncpyz( status + statusLength, tempstr, size - statusLength );
 	statusLength += tempstrLength;
 
 	if ( fullStatus )
@@ -236,13 +424,27 @@ static char *SV_LongInfoString( qboolean fullStatus )
 				Q_snprintfz( tempstr, sizeof( tempstr ), "%i %i \"%s\" %i\n",
 					cl->edict->r.client->r.frags, cl->ping, cl->name, cl->edict->s.team );
 				tempstrLength = strlen( tempstr );
-				if( statusLength + tempstrLength >= sizeof( status ) )
+				if( statusLength + tempstrLength >= size )
 					break; // can't hold any more
-				Q_strncpyz( status + statusLength, tempstr, sizeof( status ) - statusLength );
+				Q_strncpyz( status + statusLength, tempstr, size - statusLength );
 				statusLength += tempstrLength;
 			}
 		}
 	}
+}
+
+/*
+* SV_LongInfoString
+* Returns the string that is sent as status replies, rebuilt only
+* when the serverinfo or the player list have changed
+*/
+static char *SV_LongInfoString( qboolean fullStatus )
+{
+	info_key_t *key = fullStatus ? &status_key : &info_key;
+	char *status = fullStatus ? status_string : info_string;
+
+	if( !SV_InfoKeyMatches( key, SV_PlayerListChecksum( fullStatus ), 0 ) )
+		SV_BuildLongInfoString( status, MAX_LONGINFOSTRING, fullStatus );
 
 	return status;
 }
@@ -259,9 +461,16 @@ static char *SV_ShortInfoString( void )
 	char hostname[64];
 	char entry[20];
 	size_t len;
-	int i, count, bots;
+	int i, count, bots, flags;
 	const char *password;
 
+	// the string also has some state that isn't in the serverinfo
+	password = Cvar_String( "password" );
+	flags = ( password[0] != '\0' ? 1 : 0 ) | ( SV_MM_Initialized() ? 2 : 0 ) |
+		( Cvar_Value( "g_instagib" ) ? 4 : 0 ) | ( Cvar_Value( "g_race_gametype" ) ? 8 : 0 );
+	if( SV_InfoKeyMatches( &shortinfo_key, SV_PlayerListChecksum( qfalse ), flags ) )
+		return string;
+
 	bots = 0;
 	count = 0;
 	for( i = 0; i < sv_maxclients->integer; i++ )
@@ -322,7 +531,6 @@ static char *SV_ShortInfoString( void )
 		len = strlen( string );
 	}
 
-	password = Cvar_String( "password" );
 	if( password[0] != '\0' )
 	{
 		Q_snprintfz( entry, sizeof( entry ), "p\\\\1\\\\" );
@@ -391,6 +599,9 @@ static void SVC_Ack( const socket_t *socket, const netadr_t *address )
 */
 static void SVC_Ping( const socket_t *socket, const netadr_t *address )
 {
+	if( !SV_QueryAllowed( address ) )
+		return;
+
 	// send any arguments back with ack
 	Netchan_OutOfBandPrint( socket, address, "ack %s", Cmd_Args() );
 }
@@ -407,6 +618,9 @@ static void SVC_InfoResponse( const socket_t *socket, const netadr_t *address )
 	char *string;
 	qboolean allow_empty = qfalse, allow_full = qfalse;
 
+	if( !SV_QueryAllowed( address ) )
+		return;
+
 	if( sv_showInfoQueries->integer )
 		Com_Printf( "Info Packet %s\n", NET_AddressToString( address ) );
 
@@ -471,6 +685,9 @@ static void SVC_SendInfoString( const socket_t *socket, const netadr_t *address,
 {
 	char *string;
 
+	if( !SV_QueryAllowed( address ) )
+		return;
+
 	if( sv_showInfoQueries->integer )
 		Com_Printf( "%s Packet %s\n", requestType, NET_AddressToString( address ) );
 
@@ -513,6 +730,154 @@ static void SVC_GetStatusResponse( const socket_t *socket, const netadr_t *addre
 }
 
 
+#define CHALLENGE_SECRET_MSEC	30000	// a challenge is good for one to two of these
+
+#define SIPROUND \
+	do { \
+		v0 += v1; v1 = ( v1 << 13 ) | ( v1 >> 51 ); v1 ^= v0; v0 = ( v0 << 32 ) | ( v0 >> 32 ); \
+		v2 += v3; v3 = ( v3 << 16 ) | ( v3 >> 48 ); v3 ^= v2; \
+		v0 += v3; v3 = ( v3 << 21 ) | ( v3 >> 43 ); v3 ^= v0; \
+		v2 += v1; v1 = ( v1 << 17 ) | ( v1 >> 47 ); v1 ^= v2; v2 = ( v2 << 32 ) | ( v2 >> 32 ); \
+	} while( 0 )
+
+static struct
+{
+	qboolean initialized;
+	unsigned int time;					// when the current secret was made
+	quint64 keys[2][2];					// current and previous secret
+} challenge_secret;
+
+/*
+* SV_SipHash
+* 
+* SipHash-2-4, a keyed hash that can't be forged without the key
+*/
+static quint64 SV_SipHash( const quint64 key[2], const qbyte *data, size_t len )
+{
+	quint64 v0 = 0x736f6d6570736575ULL ^ key[0];
+	quint64 v1 = 0x646f72616e646f6dULL ^ key[1];
+	quint64 v2 = 0x6c7967656e657261ULL ^ key[0];
+	quint64 v3 = 0x7465646279746573ULL ^ key[1];
+	quint64 m;
+	size_t i, left = len & 7;
+	const qbyte *end = data + len - left;
+
+	for( ; data < end; data += 8 )
+	{
+		for( m = 0, i = 0; i < 8; i++ )
+			m |= (quint64)data[i] << ( i * 8 );
+		v3 ^= m;
+		SIPROUND;
+		SIPROUND;
+		v0 ^= m;
+	}
+
+	for( m = (quint64)len << 56, i = 0; i < left; i++ )
+		m |= (quint64)data[i] << ( i * 8 );
+	v3 ^= m;
+	SIPROUND;
+	SIPROUND;
+	v0 ^= m;
+
+	v2 ^= 0xff;
+	SIPROUND;
+	SIPROUND;
+	SIPROUND;
+	SIPROUND;
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*
+* SV_NewChallengeSecret
+* 
+* Timing and the previous secret are all we have for entropy, it only
+* has to keep challenges from being guessed for a minute
+*/
+static void SV_NewChallengeSecret( quint64 key[2] )
+{
+	quint64 seed[4];
+	quint64 *prev = challenge_secret.keys[0];
+
+	seed[0] = Sys_Microseconds();
+	seed[1] = (quint64)time( NULL );
+	seed[2] = ( (quint64)rand() << 32 ) ^ (quint64)rand();
+	seed[3] = (quint64)(size_t)&seed;
+
+	key[0] = SV_SipHash( prev, (qbyte *)seed, sizeof( seed ) );
+	seed[0] ^= key[0];
+	key[1] = SV_SipHash( prev, (qbyte *)seed, sizeof( seed ) );
+}
+
+/*
+* SV_UpdateChallengeSecret
+*/
+static void SV_UpdateChallengeSecret( void )
+{
+	unsigned int now = Sys_Milliseconds();
+	unsigned int age = now - challenge_secret.time;
+
+	if( challenge_secret.initialized && age < CHALLENGE_SECRET_MSEC )
+		return;
+
+	if( challenge_secret.initialized && age < CHALLENGE_SECRET_MSEC * 2 )
+	{
+		challenge_secret.keys[1][0] = challenge_secret.keys[0][0];
+		challenge_secret.keys[1][1] = challenge_secret.keys[0][1];
+	}
+	else
+	{
+		SV_NewChallengeSecret( challenge_secret.keys[1] );
+	}
+
+	SV_NewChallengeSecret( challenge_secret.keys[0] );
+	challenge_secret.time = now;
+	challenge_secret.initialized = qtrue;
+}
+
+/*
+* SV_Challenge
+* 
+* The challenge for an address under one of the secrets, no state is kept
+*/
+static int SV_Challenge( const netadr_t *address, const quint64 key[2] )
+{
+	qbyte data[1 + 16];
+	size_t len;
+	int challenge;
+
+	data[0] = (qbyte)address->type;
+	if( address->type == NA_IP6 )
+	{
+		memcpy( data + 1, address->address.ipv6.ip, 16 );
+		len = 1 + 16;
+	}
+	else if( address->type == NA_IP )
+	{
+		memcpy( data + 1, address->address.ipv4.ip, 4 );
+		len = 1 + 4;
+	}
+	else
+	{
+		len = 1;
+	}
+
+	// clients read it back with atoi, and 0 is what they send without one
+	challenge = (int)( SV_SipHash( key, data, len ) & 0x7fffffff );
+	return challenge ? challenge : 1;
+}
+
+/*
+* SV_ChallengeValid
+*/
+static qboolean SV_ChallengeValid( const netadr_t *address, int challenge )
+{
+	SV_UpdateChallengeSecret();
+
+	return ( challenge == SV_Challenge( address, challenge_secret.keys[0] ) ||
+		challenge == SV_Challenge( address, challenge_secret.keys[1] ) ) ? qtrue : qfalse;
+}
+
 /*
 * SVC_GetChallenge
 * 
@@ -521,41 +886,19 @@ static void SVC_GetStatusResponse( const socket_t *socket, const netadr_t *addre
 * We do this to prevent denial of service attacks that
 * flood the server with invalid connection IPs.  With a
 * challenge, they must give a valid IP address.
+* 
+* Challenges are a keyed hash of the address with a secret that
+* rotates, so a flood of requests costs a hash each and can't push
+* out the challenges of other players.
 */
 static void SVC_GetChallenge( const socket_t *socket, const netadr_t *address )
 {
-	int i;
-	int oldest;
-	int oldestTime;
-
-	oldest = 0;
-	oldestTime = 0x7fffffff;
-
 	if( sv_showChallenge->integer )
 		Com_Printf( "Challenge Packet %s\n", NET_AddressToString( address ) );
 
-	// see if we already have a challenge for this ip
-	for( i = 0; i < MAX_CHALLENGES; i++ )
-	{
-		if( NET_CompareBaseAddress( address, &svs.challenges[i].adr ) )
-			break;
-		if( svs.challenges[i].time < oldestTime )
-		{
-			oldestTime = svs.challenges[i].time;
-			oldest = i;
-		}
-	}
-
-	if( i == MAX_CHALLENGES )
-	{
-		// overwrite the oldest
-		svs.challenges[oldest].challenge = rand() & 0x7fff;
-		svs.challenges[oldest].adr = *address;
-		svs.challenges[oldest].time = Sys_Milliseconds();
-		i = oldest;
-	}
+	SV_UpdateChallengeSecret();
 
-	Netchan_OutOfBandPrint( socket, address, "challenge %i", svs.challenges[i].challenge );
+	Netchan_OutOfBandPrint( socket, address, "challenge %i", SV_Challenge( address, challenge_secret.keys[0] ) );
 }
 
 
@@ -575,7 +918,7 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 	int session_id;
 	char *session_id_str;
 	unsigned int ticket_id;
-	qboolean tv_client;
+	qboolean tv_client, packed_entities;
 
 	Com_DPrintf( "SVC_DirectConnect (%s)\n", Cmd_Args() );
 
@@ -598,7 +941,8 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 
 	game_port = atoi( Cmd_Argv( 2 ) );
 	challenge = atoi( Cmd_Argv( 3 ) );
-	tv_client = ( atoi( Cmd_Argv( 5 ) ) & 1 ? qtrue : qfalse );
+	tv_client = ( atoi( Cmd_Argv( 5 ) ) & CONNECT_FLAG_TVCLIENT ? qtrue : qfalse );
+	packed_entities = ( atoi( Cmd_Argv( 5 ) ) & CONNECT_FLAG_PACKEDENTITIES ? qtrue : qfalse );
 
 	if( !Info_Validate( Cmd_Argv( 4 ) ) )
 	{
@@ -664,25 +1008,9 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 #endif
 
 	// see if the challenge is valid
-	for( i = 0; i < MAX_CHALLENGES; i++ )
+	if( !SV_ChallengeValid( address, challenge ) )
 	{
-		if( NET_CompareBaseAddress( address, &svs.challenges[i].adr ) )
-		{
-			if( challenge == svs.challenges[i].challenge )
-			{
-				svs.challenges[i].challenge = 0; // wsw : r1q2 : reset challenge
-				svs.challenges[i].time = 0;
-				NET_InitAddress( &svs.challenges[i].adr, NA_NOTRANSMIT );
-				break; // good
-			}
-			Netchan_OutOfBandPrint( socket, address, "reject\n%i\n%i\nBad challenge\n",
-				DROP_TYPE_GENERAL, DROP_FLAG_AUTORECONNECT );
-			return;
-		}
-	}
-	if( i == MAX_CHALLENGES )
-	{
-		Netchan_OutOfBandPrint( socket, address, "reject\n%i\n%i\nNo challenge for address\n",
+		Netchan_OutOfBandPrint( socket, address, "reject\n%i\n%i\nBad challenge\n",
 			DROP_TYPE_GENERAL, DROP_FLAG_AUTORECONNECT );
 		return;
 	}
@@ -786,6 +1114,9 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 		return;
 	}
 
+	// the serverdata tells the client whether it got packed entities
+	newcl->packedentities = ( packed_entities && sv_packedentities->integer ) ? qtrue : qfalse;
+
 	// send the connect packet to the client
 	Netchan_OutOfBandPrint( socket, address, "client_connect\n%s", newcl->session );
 
@@ -418,6 +418,8 @@ static qboolean SV_SendClientDatagram( client_t *client )
 
 	SV_WriteFrameSnapToClient( client, &tmpMessage );
 
+	SV_Demo_RecordRaceSnap( client );
+
 	return SV_SendMessageToClient( client, &tmpMessage );
 }
 
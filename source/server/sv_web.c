@@ -700,6 +700,20 @@ static void SV_Web_RouteRequest( const sv_http_request_t *request, sv_http_respo
 		else {
 			response->code = HTTP_RESP_NOT_FOUND;
 		}
+	} else if( !Q_stricmp( resource, "frametimes" ) ) {
+		static char frametimes_json[0x1000];
+
+		if( !sv_http_frametimes->integer || !sv_frametimes->integer ) {
+			response->code = HTTP_RESP_FORBIDDEN;
+		}
+		else if( request->method == HTTP_METHOD_GET || request->method == HTTP_METHOD_HEAD ) {
+			*content_length = SV_FrameTimes_WriteJSON( frametimes_json, sizeof( frametimes_json ) );
+			*content = frametimes_json;
+			response->code = HTTP_RESP_OK;
+		}
+		else {
+			response->code = HTTP_RESP_BAD_REQUEST;
+		}
 	} else if( !Q_strnicmp( resource, "files/", 6 ) ) {
 		const char *filename, *extension;
 		
@@ -77,6 +77,7 @@ cvar_t *s_swapstereo;
 cvar_t *s_vorbis;
 cvar_t *s_pseudoAcoustics;
 cvar_t *s_separationDelay;
+cvar_t *s_mixthread;
 
 static int s_attenuation_model = 0;
 static float s_attenuation_maxdistance = 0;
@@ -102,6 +103,89 @@ static void S_NextBackgroundTrack( void );
 static void S_PauseBackgroundTrack( void );
 
 static void S_ClearRawSounds( void );
+static void S_StartMixerThread( qboolean verbose );
+static void S_TrackEntity( int entnum, unsigned int msec );
+static void S_GetEntityOrigin( int entnum, vec3_t origin );
+static void S_SendEntityOrigin( int entnum );
+static void S_SendEntityOrigins( void );
+
+// commands for the mixer thread
+enum
+{
+	SND_CMD_STARTSOUND,
+	SND_CMD_ADDLOOPSOUND,
+	SND_CMD_ENTITYORIGIN,
+	SND_CMD_UPDATE,
+	SND_CMD_RAWSAMPLES,
+	SND_CMD_ATTENUATIONMODEL
+};
+
+typedef struct
+{
+	sfx_t *sfx;
+	vec3_t origin;
+	qboolean fixed_origin;
+	int entnum;
+	int entchannel;
+	float fvol;
+	float attenuation;
+} sndcmd_startsound_t;
+
+typedef struct
+{
+	sfx_t *sfx;
+	vec3_t origin;
+	float volume;
+	float attenuation;
+} sndcmd_loopsound_t;
+
+typedef struct
+{
+	int entnum;
+	vec3_t origin;
+} sndcmd_entityorigin_t;
+
+typedef struct
+{
+	vec3_t origin;
+	vec3_t velocity;
+	mat3_t axis;
+} sndcmd_update_t;
+
+typedef struct
+{
+	int entnum;
+	float fvol;
+	float attenuation;
+	vec3_t origin;
+	unsigned int samples;
+	unsigned int rate;
+	unsigned short width;
+	unsigned short channels;
+	qboolean music;
+} sndcmd_rawsamples_t;		// followed by the samples
+
+typedef struct
+{
+	int model;
+	float maxdistance;
+	float refdistance;
+} sndcmd_attenuationmodel_t;
+
+// the mixer can't ask the client where entities are, the main thread
+// sends the origins of the entities that have sounds playing
+static int s_maxEntities;
+static unsigned int *s_entityExpire;		// main thread, when to stop sending
+static vec3_t *s_entityOrigins;				// mixer thread
+
+// the main thread's idea of how far the raw sounds have been filled
+typedef struct
+{
+	int entnum;
+	unsigned int rawend;
+} rawsoundmirror_t;
+
+static rawsoundmirror_t s_rawMirror[MAX_RAW_SOUNDS];
 
 // highfrequency attenuation parameters
 // 340/0.15 (speed of sound/width of head) gives us 2267hz
@@ -228,6 +312,7 @@ qboolean S_Init( void *hwnd, int maxEntities, qboolean verbose )
 	s_vorbis = trap_Cvar_Get( "s_vorbis", "1", CVAR_ARCHIVE );
 	s_pseudoAcoustics = trap_Cvar_Get( "s_pseudoAcoustics", "0", CVAR_ARCHIVE );
 	s_separationDelay = trap_Cvar_Get( "s_separationDelay", "1.0", CVAR_ARCHIVE );
+	s_mixthread = trap_Cvar_Get( "s_mixthread", "0", CVAR_ARCHIVE|CVAR_LATCH_SOUND );
 
 #ifdef ENABLE_PLAY
 	trap_Cmd_AddCommand( "play", S_Play );
@@ -240,6 +325,7 @@ qboolean S_Init( void *hwnd, int maxEntities, qboolean verbose )
 	trap_Cmd_AddCommand( "pausemusic", S_PauseBackgroundTrack );
 	trap_Cmd_AddCommand( "soundlist", S_SoundList );
 	trap_Cmd_AddCommand( "soundinfo", S_SoundInfo_f );
+	trap_Cmd_AddCommand( "mixbench", S_MixBench_f );
 
 	s_bgTrack = s_bgTrackHead = NULL;
 	s_bgTrackPaused = qfalse;
@@ -275,6 +361,10 @@ qboolean S_Init( void *hwnd, int maxEntities, qboolean verbose )
 
 	S_StopAllSounds();
 
+	s_maxEntities = maxEntities;
+	if( s_mixthread->integer )
+		S_StartMixerThread( verbose );
+
 	return qtrue;
 }
 
@@ -288,6 +378,8 @@ qboolean S_Init( void *hwnd, int maxEntities, qboolean verbose )
 */
 void S_Shutdown( qboolean verbose )
 {
+	S_ShutdownMixerThread();
+
 	S_StopAviDemo();
 
 	// free all sounds
@@ -307,9 +399,13 @@ void S_Shutdown( qboolean verbose )
 	trap_Cmd_RemoveCommand( "pausemusic" );
 	trap_Cmd_RemoveCommand( "soundlist" );
 	trap_Cmd_RemoveCommand( "soundinfo" );
+	trap_Cmd_RemoveCommand( "mixbench" );
 
 	S_MemFreePool( &soundpool );
 
+	s_entityExpire = NULL;
+	s_entityOrigins = NULL;
+
 	s_registering = qfalse;
 
 	num_sfx = 0;
@@ -411,6 +507,8 @@ void S_FreeSounds( void )
 	int i;
 	sfx_t *sfx;
 
+	S_LockMixer();
+
 	// free all sounds
 	for( i = 0, sfx = known_sfx; i < num_sfx; i++, sfx++ )
 	{
@@ -431,6 +529,8 @@ void S_FreeSounds( void )
 	}
 	memset( raw_sounds, 0, sizeof( raw_sounds ) );
 
+	S_UnlockMixer();
+
 	S_StopBackgroundTrack();
 }
 
@@ -444,6 +544,8 @@ void S_EndRegistration( void )
 
 	s_registering = qfalse;
 
+	S_LockMixer();
+
 	// free any sounds not from this registration sequence
 	for( i = 0, sfx = known_sfx; i < num_sfx; i++, sfx++ ) {
 		if( !sfx->name[0] ) {
@@ -473,6 +575,8 @@ void S_EndRegistration( void )
 			S_LoadSound( sfx );
 		}
 	}
+
+	S_UnlockMixer();
 }
 
 /*
@@ -539,6 +643,17 @@ channel_t *S_PickChannel( int entnum, int entchannel )
 */
 void S_SetAttenuationModel( int model, float maxdistance, float refdistance )
 {
+	if( S_QueueMixerCmds() )
+	{
+		sndcmd_attenuationmodel_t *cmd = S_AllocMixerCmd( SND_CMD_ATTENUATIONMODEL, sizeof( *cmd ) );
+
+		cmd->model = model;
+		cmd->maxdistance = maxdistance;
+		cmd->refdistance = refdistance;
+		S_SubmitMixerCmd();
+		return;
+	}
+
 	s_attenuation_model = model;
 	s_attenuation_maxdistance = maxdistance;
 	s_attenuation_refdistance = refdistance;
@@ -729,6 +844,8 @@ void S_Spatialize( channel_t *ch )
 
 	if( ch->fixed_origin )
 		VectorCopy( ch->origin, origin );
+	else if( S_MixerThreadActive() )
+		S_GetEntityOrigin( ch->entnum, origin );
 	else
 		trap_GetEntitySpatilization( ch->entnum, origin, velocity );
 
@@ -789,7 +906,7 @@ void S_IssuePlaysound( playsound_t *ps )
 	channel_t *ch;
 	sfxcache_t *sc;
 
-	if( s_show->integer )
+	if( s_show->integer && !S_MixerThreadActive() )
 		Com_Printf( "Issue %i\n", ps->begin );
 	// pick a channel to play on
 	ch = S_PickChannel( ps->entnum, ps->entchannel );
@@ -798,7 +915,7 @@ void S_IssuePlaysound( playsound_t *ps )
 		S_FreePlaysound( ps );
 		return;
 	}
-	sc = S_LoadSound( ps->sfx );
+	sc = S_MixerSound( ps->sfx );
 	if( !sc )
 	{
 		S_FreePlaysound( ps );
@@ -850,22 +967,13 @@ void S_ClearPlaysounds( void )
 // =======================================================================
 
 /*
-* S_StartSound
+* S_AddPlaysound
 */
-static void S_StartSound( sfx_t *sfx, const vec3_t origin, int entnum, int entchannel, float fvol, float attenuation )
+static void S_AddPlaysound( sfx_t *sfx, const vec3_t origin, int entnum, int entchannel, float fvol, float attenuation )
 {
-	sfxcache_t *sc;
 	int vol;
 	playsound_t *ps, *sort;
 
-	if( !sfx )
-		return;
-
-	// make sure the sound is loaded
-	sc = S_LoadSound( sfx );
-	if( !sc )
-		return; // couldn't load the sound's data
-
 	vol = fvol*255;
 
 	// make the playsound_t
@@ -902,6 +1010,53 @@ static void S_StartSound( sfx_t *sfx, const vec3_t origin, int entnum, int entch
 	ps->prev->next = ps;
 }
 
+/*
+* S_StartSound
+*/
+static void S_StartSound( sfx_t *sfx, const vec3_t origin, int entnum, int entchannel, float fvol, float attenuation )
+{
+	sfxcache_t *sc;
+	sndcmd_startsound_t *cmd;
+
+	if( !sfx )
+		return;
+
+	// make sure the sound is loaded
+	sc = S_LoadSound( sfx );
+	if( !sc )
+		return; // couldn't load the sound's data
+
+	if( !S_QueueMixerCmds() )
+	{
+		S_AddPlaysound( sfx, origin, entnum, entchannel, fvol, attenuation );
+		return;
+	}
+
+	// S_PickChannel would drop to console from the mixer thread
+	if( entchannel < 0 )
+		S_Error( "S_StartSound: entchannel < 0" );
+
+	if( !origin )
+	{
+		// keep the entity's origin coming for as long as the sound plays
+		if( sc->loopstart < sc->length )
+			S_TrackEntity( entnum, 0 );
+		else
+			S_TrackEntity( entnum, sc->length * dma.msec_per_sample + 1000 );
+	}
+
+	cmd = S_AllocMixerCmd( SND_CMD_STARTSOUND, sizeof( *cmd ) );
+	cmd->sfx = sfx;
+	if( origin )
+		VectorCopy( origin, cmd->origin );
+	cmd->fixed_origin = origin != NULL;
+	cmd->entnum = entnum;
+	cmd->entchannel = entchannel;
+	cmd->fvol = fvol;
+	cmd->attenuation = attenuation;
+	S_SubmitMixerCmd();
+}
+
 /*
 * S_StartFixedSound
 */
@@ -944,9 +1099,9 @@ void S_StartLocalSound( const char *sound )
 }
 
 /*
-* S_Clear
+* S_ClearBuffer
 */
-void S_Clear( void )
+static void S_ClearBuffer( void )
 {
 	int clear;
 
@@ -963,15 +1118,32 @@ void S_Clear( void )
 	SNDDMA_Submit();
 }
 
+/*
+* S_Clear
+*/
+void S_Clear( void )
+{
+	S_LockMixer();
+	S_ClearBuffer();
+	S_UnlockMixer();
+}
+
 /*
 * S_StopAllSounds
 */
 void S_StopAllSounds( void )
 {
+	S_LockMixer();
+
 	// clear all the playsounds and channels
 	S_ClearPlaysounds();
 
-	S_Clear();
+	S_ClearBuffer();
+
+	S_UnlockMixer();
+
+	if( s_entityExpire )
+		memset( s_entityExpire, 0, s_maxEntities * sizeof( *s_entityExpire ) );
 
 	S_StopBackgroundTrack();
 }
@@ -981,7 +1153,22 @@ void S_StopAllSounds( void )
 */
 void S_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation )
 {
-	if( !sfx || num_loopsfx >= MAX_LOOPSFX )
+	if( !sfx )
+		return;
+
+	if( S_QueueMixerCmds() )
+	{
+		sndcmd_loopsound_t *cmd = S_AllocMixerCmd( SND_CMD_ADDLOOPSOUND, sizeof( *cmd ) );
+
+		cmd->sfx = sfx;
+		cmd->volume = 255.0 * fvol;
+		cmd->attenuation = attenuation;
+		trap_GetEntitySpatilization( entnum, cmd->origin, NULL );
+		S_SubmitMixerCmd();
+		return;
+	}
+
+	if( num_loopsfx >= MAX_LOOPSFX )
 		return;
 
 	loop_sfx[num_loopsfx].sfx = sfx;
@@ -1062,6 +1249,7 @@ static void S_AddLoopSounds( void )
 
 #define S_RAW_SOUND_IDLE_SEC			10	// time interval for idling raw sound before it's freed
 #define S_RAW_SOUND_BGTRACK				-1
+#define S_RAW_SOUND_UNUSED				-2	// preallocated for the mixer thread
 #define S_RAW_SAMPLES_PRECISION_BITS	14
 
 /*
@@ -1257,27 +1445,164 @@ static unsigned int S_RawSamplesStereo( portable_samplepair_t *rawsamples, unsig
 }
 
 /*
-* S_RawSamples
+* S_AddRawSamples
 */
-void S_RawSamples( unsigned int samples, unsigned int rate, unsigned short width, 
+static void S_AddRawSamples( int entnum, float fvol, float attenuation, const vec3_t origin,
+	unsigned int samples, unsigned int rate, unsigned short width,
 	unsigned short channels, const qbyte *data, qboolean music )
 {
 	int snd_vol;
 	rawsound_t *rawsound;
-	
-	snd_vol = (int)( ( music ? s_musicvolume->value : s_volume->value ) * 255 );
-	if( snd_vol < 0 )
-		snd_vol = 0;
 
-	rawsound = S_FindRawSound( S_RAW_SOUND_BGTRACK, qtrue );
+	rawsound = S_FindRawSound( entnum, qtrue );
 	if( !rawsound ) {
 		return;
 	}
 
-	rawsound->volume = snd_vol;
-	rawsound->attenuation = ATTN_NONE;
-	rawsound->rawend = S_RawSamplesStereo( rawsound->rawsamples, rawsound->rawend, 
-		samples, rate, width, channels, data );
+	if( entnum == S_RAW_SOUND_BGTRACK ) {
+		snd_vol = (int)( ( music ? s_musicvolume->value : s_volume->value ) * 255 );
+		if( snd_vol < 0 )
+			snd_vol = 0;
+
+		rawsound->volume = snd_vol;
+		rawsound->attenuation = ATTN_NONE;
+		rawsound->rawend = S_RawSamplesStereo( rawsound->rawsamples, rawsound->rawend, 
+			samples, rate, width, channels, data );
+	}
+	else {
+		rawsound->volume = fvol * 255;
+		rawsound->attenuation = attenuation;
+		rawsound->rawend = S_RawSamplesMono( rawsound->rawsamples, rawsound->rawend, 
+			samples, rate, width, channels, data );
+		VectorCopy( origin, rawsound->origin );
+	}
+}
+
+/*
+* S_FindRawSoundMirror
+*
+* S_FindRawSound for the main thread's copy of the raw sounds
+*/
+static rawsoundmirror_t *S_FindRawSoundMirror( int entnum, qboolean addNew )
+{
+	int i, best, best_time, time;
+	rawsoundmirror_t *mirror;
+
+	best = 0;
+	best_time = 0x7fffffff;
+	for( i = 0, mirror = s_rawMirror; i < MAX_RAW_SOUNDS; i++, mirror++ ) {
+		if( mirror->entnum == entnum ) {
+			return mirror;
+		}
+
+		time = mirror->rawend - paintedtime;
+		if( time < best_time ) {
+			best = i;
+			best_time = time;
+		}
+	}
+
+	if( !addNew ) {
+		return NULL;
+	}
+
+	mirror = &s_rawMirror[best];
+	mirror->entnum = entnum;
+	mirror->rawend = 0;
+	return mirror;
+}
+
+/*
+* S_QueueRawSamples
+*
+* Sends the samples to the mixer and works out where they are going to end
+* the way S_RawSamplesMono and S_RawSamplesStereo do. Returns qfalse when
+* they're too many to be queued
+*/
+static qboolean S_QueueRawSamples( int entnum, float fvol, float attenuation, const vec3_t origin,
+	unsigned int samples, unsigned int rate, unsigned short width,
+	unsigned short channels, const qbyte *data, qboolean music )
+{
+	size_t size;
+	unsigned int fracstep, painted;
+	sndcmd_rawsamples_t *cmd;
+	rawsoundmirror_t *mirror;
+
+	size = samples * width * channels;
+	cmd = S_AllocMixerCmd( SND_CMD_RAWSAMPLES, sizeof( *cmd ) + size );
+	if( !cmd ) {
+		return qfalse;
+	}
+
+	cmd->entnum = entnum;
+	cmd->fvol = fvol;
+	cmd->attenuation = attenuation;
+	VectorCopy( origin, cmd->origin );
+	cmd->samples = samples;
+	cmd->rate = rate;
+	cmd->width = width;
+	cmd->channels = channels;
+	cmd->music = music;
+	memcpy( cmd + 1, data, size );
+	S_SubmitMixerCmd();
+
+	fracstep = ( (double) rate / (double) dma.speed ) * (double)(1 << S_RAW_SAMPLES_PRECISION_BITS);
+	if( !fracstep ) {
+		return qtrue;
+	}
+
+	painted = paintedtime;
+	mirror = S_FindRawSoundMirror( entnum, qtrue );
+	if( mirror->rawend < painted || (int)( mirror->rawend - painted ) > MAX_RAW_SAMPLES ) {
+		mirror->rawend = painted;
+	}
+	mirror->rawend += ( ( (quint64)samples << S_RAW_SAMPLES_PRECISION_BITS ) + fracstep - 1 ) / fracstep;
+	return qtrue;
+}
+
+/*
+* S_RawSamplesLength
+*/
+static unsigned int S_RawSamplesLength( int entnum )
+{
+	unsigned int rawend, painted;
+
+	painted = paintedtime;
+	if( S_QueueMixerCmds() ) {
+		rawsoundmirror_t *mirror = S_FindRawSoundMirror( entnum, qfalse );
+		if( !mirror ) {
+			return 0;
+		}
+		rawend = mirror->rawend;
+	}
+	else {
+		rawsound_t *rawsound = S_FindRawSound( entnum, qfalse );
+		if( !rawsound ) {
+			return 0;
+		}
+		rawend = rawsound->rawend;
+	}
+
+	return rawend <= painted 
+		? 0 
+		: (float)(rawend - painted) * dma.msec_per_sample;
+}
+
+/*
+* S_RawSamples
+*/
+void S_RawSamples( unsigned int samples, unsigned int rate, unsigned short width, 
+	unsigned short channels, const qbyte *data, qboolean music )
+{
+	if( S_QueueMixerCmds() && S_QueueRawSamples( S_RAW_SOUND_BGTRACK, 0, ATTN_NONE, vec3_origin, 
+		samples, rate, width, channels, data, music ) ) {
+		return;
+	}
+
+	S_LockMixer();
+	S_AddRawSamples( S_RAW_SOUND_BGTRACK, 0, ATTN_NONE, vec3_origin, 
+		samples, rate, width, channels, data, music );
+	S_UnlockMixer();
 }
 
 /*
@@ -1287,22 +1612,22 @@ void S_PositionedRawSamples( int entnum, float fvol, float attenuation,
 		unsigned int samples, unsigned int rate, 
 		unsigned short width, unsigned short channels, const qbyte *data )
 {
-	rawsound_t *rawsound;
-	
+	vec3_t origin;
+
 	if( entnum < 0 )
 		entnum = 0;
 
-	rawsound = S_FindRawSound( entnum, qtrue );
-	if( !rawsound ) {
+	trap_GetEntitySpatilization( entnum, origin, NULL );
+
+	if( S_QueueMixerCmds() && S_QueueRawSamples( entnum, fvol, attenuation, origin, 
+		samples, rate, width, channels, data, qfalse ) ) {
 		return;
 	}
 
-	rawsound->volume = fvol * 255;
-	rawsound->attenuation = attenuation;
-	rawsound->rawend = S_RawSamplesMono( rawsound->rawsamples, rawsound->rawend, 
-		samples, rate, width, channels, data );
-
-	trap_GetEntitySpatilization( entnum, rawsound->origin, NULL );
+	S_LockMixer();
+	S_AddRawSamples( entnum, fvol, attenuation, origin, 
+		samples, rate, width, channels, data, qfalse );
+	S_UnlockMixer();
 }
 
 /*
@@ -1310,16 +1635,7 @@ void S_PositionedRawSamples( int entnum, float fvol, float attenuation,
 */
 unsigned int S_GetRawSamplesLength( void ) 
 {
-	rawsound_t *rawsound;
-	
-	rawsound = S_FindRawSound( S_RAW_SOUND_BGTRACK, qfalse );
-	if( !rawsound ) {
-		return 0;
-	}
-
-	return rawsound->rawend <= paintedtime 
-		? 0 
-		: (float)(rawsound->rawend - paintedtime) * dma.msec_per_sample;
+	return S_RawSamplesLength( S_RAW_SOUND_BGTRACK );
 }
 
 /*
@@ -1327,19 +1643,10 @@ unsigned int S_GetRawSamplesLength( void )
 */
 unsigned int S_GetPositionedRawSamplesLength( int entnum ) 
 {
-	rawsound_t *rawsound;
-	
 	if( entnum < 0 )
 		entnum = 0;
 
-	rawsound = S_FindRawSound( entnum, qfalse );
-	if( !rawsound ) {
-		return 0;
-	}
-
-	return rawsound->rawend <= paintedtime 
-		? 0 
-		: (float)(rawsound->rawend - paintedtime) * dma.msec_per_sample;
+	return S_RawSamplesLength( entnum );
 }
 
 /*
@@ -1351,6 +1658,11 @@ static void S_FreeIdleRawSounds( void )
 {
 	int i;
 
+	// the mixer thread keeps all of them
+	if( S_MixerThreadActive() ) {
+		return;
+	}
+
 	for( i = 0; i < MAX_RAW_SOUNDS; i++ ) {
 		rawsound_t *rawsound = raw_sounds[i];
 
@@ -2176,7 +2488,16 @@ static void GetSoundtime( void )
 			// time to chop things off to avoid 32 bit limits
 			buffers = 0;
 			paintedtime = fullsamples;
-			S_StopAllSounds();
+			if( S_MixerThreadActive() )
+			{
+				// the music belongs to the main thread
+				S_ClearPlaysounds();
+				S_ClearBuffer();
+			}
+			else
+			{
+				S_StopAllSounds();
+			}
 		}
 	}
 	oldsamplepos = samplepos;
@@ -2225,9 +2546,9 @@ static void S_Update_( qboolean avidump )
 }
 
 /*
-* S_Update
+* S_UpdateListener
 */
-void S_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, qboolean avidump )
+static void S_UpdateListener( const vec3_t origin, const vec3_t velocity, const mat3_t axis )
 {
 	int i;
 	int total;
@@ -2269,7 +2590,7 @@ void S_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, qb
 	//
 	// debugging output
 	//
-	if( s_show->integer )
+	if( s_show->integer && !S_MixerThreadActive() )
 	{
 		total = 0;
 		ch = channels;
@@ -2282,11 +2603,43 @@ void S_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, qb
 
 			Com_Printf( "----(%i)---- painted: %i\n", total, paintedtime );
 	}
+}
+
+/*
+* S_Update
+*/
+void S_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, qboolean avidump )
+{
+	// the mixer thread paints on its own, except for avi dumps which
+	// need to be in step with the frames
+	if( S_QueueMixerCmds() && !avidump )
+	{
+		sndcmd_update_t *cmd;
+
+		S_SendEntityOrigins();
+
+		cmd = S_AllocMixerCmd( SND_CMD_UPDATE, sizeof( *cmd ) );
+		VectorCopy( origin, cmd->origin );
+		VectorCopy( velocity, cmd->velocity );
+		Matrix3_Copy( axis, cmd->axis );
+		S_SubmitMixerCmd();
+
+		S_UpdateBackgroundTrack();
+		return;
+	}
+
+	S_LockMixer();
+
+	S_SendEntityOrigins();
+
+	S_UpdateListener( origin, velocity, axis );
 
 	// mix some sound
 	S_UpdateBackgroundTrack();
 
 	S_Update_( avidump );
+
+	S_UnlockMixer();
 }
 
 /*
@@ -2298,6 +2651,8 @@ void S_BeginAviDemo( void )
 	char *checkname;
 	const char *filename = "wavdump";
 
+	S_LockMixer();
+
 	if( s_aviDumpFile )
 		S_StopAviDemo();
 
@@ -2346,6 +2701,8 @@ void S_BeginAviDemo( void )
 	}
 
 	S_Free( checkname );
+
+	S_UnlockMixer();
 }
 
 /*
@@ -2353,6 +2710,8 @@ void S_BeginAviDemo( void )
 */
 void S_StopAviDemo( void )
 {
+	S_LockMixer();
+
 	if( s_aviDumpFile )
 	{
 		// don't leave empty files
@@ -2387,6 +2746,228 @@ void S_StopAviDemo( void )
 		S_Free( s_aviDumpFileName );
 		s_aviDumpFileName = NULL;
 	}
+
+	S_UnlockMixer();
+}
+
+/*
+===============================================================================
+
+mixer thread
+
+===============================================================================
+*/
+
+/*
+* S_StartMixerThread
+*/
+static void S_StartMixerThread( qboolean verbose )
+{
+	int i;
+
+	// the thread must not allocate memory, give it all the raw sounds
+	// it could ever need right away
+	for( i = 0; i < MAX_RAW_SOUNDS; i++ ) {
+		if( !raw_sounds[i] ) {
+			raw_sounds[i] = S_Malloc( sizeof( rawsound_t ) + sizeof( portable_samplepair_t ) * MAX_RAW_SAMPLES );
+			raw_sounds[i]->entnum = S_RAW_SOUND_UNUSED;
+		}
+		s_rawMirror[i].entnum = raw_sounds[i]->entnum;
+		s_rawMirror[i].rawend = raw_sounds[i]->rawend;
+	}
+
+	s_entityExpire = S_Malloc( s_maxEntities * sizeof( *s_entityExpire ) );
+	s_entityOrigins = S_Malloc( s_maxEntities * sizeof( *s_entityOrigins ) );
+
+	if( !S_InitMixerThread() )
+	{
+		Com_Printf( "Couldn't start the mixer thread\n" );
+		return;
+	}
+
+	if( verbose )
+		Com_Printf( "Mixing on a separate thread\n" );
+}
+
+/*
+* S_TrackEntity
+*
+* Sends the entity's origin to the mixer for the next msec milliseconds,
+* forever when 0
+*/
+static void S_TrackEntity( int entnum, unsigned int msec )
+{
+	unsigned int expire;
+
+	if( entnum < 0 || entnum >= s_maxEntities )
+		return;
+
+	expire = msec ? trap_Milliseconds() + msec : UINT_MAX;
+	if( expire > s_entityExpire[entnum] || !s_entityExpire[entnum] )
+		s_entityExpire[entnum] = expire;
+
+	S_SendEntityOrigin( entnum );
+}
+
+/*
+* S_SendEntityOrigin
+*/
+static void S_SendEntityOrigin( int entnum )
+{
+	vec3_t origin;
+	sndcmd_entityorigin_t *cmd;
+
+	trap_GetEntitySpatilization( entnum, origin, NULL );
+
+	if( !S_QueueMixerCmds() )
+	{
+		VectorCopy( origin, s_entityOrigins[entnum] );
+		return;
+	}
+
+	cmd = S_AllocMixerCmd( SND_CMD_ENTITYORIGIN, sizeof( *cmd ) );
+	cmd->entnum = entnum;
+	VectorCopy( origin, cmd->origin );
+	S_SubmitMixerCmd();
+}
+
+/*
+* S_SendEntityOrigins
+*/
+static void S_SendEntityOrigins( void )
+{
+	int i;
+	unsigned int now;
+
+	if( !S_MixerThreadActive() )
+		return;
+
+	now = trap_Milliseconds();
+	for( i = 0; i < s_maxEntities; i++ )
+	{
+		if( !s_entityExpire[i] )
+			continue;
+		if( s_entityExpire[i] < now )
+		{
+			s_entityExpire[i] = 0;
+			continue;
+		}
+		S_SendEntityOrigin( i );
+	}
+}
+
+/*
+* S_GetEntityOrigin
+*
+* The last origin of the entity the mixer thread has been told about
+*/
+static void S_GetEntityOrigin( int entnum, vec3_t origin )
+{
+	if( entnum < 0 || entnum >= s_maxEntities )
+		VectorClear( origin );
+	else
+		VectorCopy( s_entityOrigins[entnum], origin );
+}
+
+/*
+* S_ExecuteMixerCmd
+*/
+void S_ExecuteMixerCmd( int id, const void *data )
+{
+	switch( id )
+	{
+	case SND_CMD_STARTSOUND:
+		{
+			const sndcmd_startsound_t *cmd = data;
+			S_AddPlaysound( cmd->sfx, cmd->fixed_origin ? cmd->origin : NULL, cmd->entnum, cmd->entchannel, cmd->fvol, cmd->attenuation );
+		}
+		break;
+
+	case SND_CMD_ADDLOOPSOUND:
+		{
+			const sndcmd_loopsound_t *cmd = data;
+
+			if( num_loopsfx >= MAX_LOOPSFX )
+				break;
+			loop_sfx[num_loopsfx].sfx = cmd->sfx;
+			loop_sfx[num_loopsfx].volume = cmd->volume;
+			loop_sfx[num_loopsfx].attenuation = cmd->attenuation;
+			VectorCopy( cmd->origin, loop_sfx[num_loopsfx].origin );
+			num_loopsfx++;
+		}
+		break;
+
+	case SND_CMD_ENTITYORIGIN:
+		{
+			const sndcmd_entityorigin_t *cmd = data;
+			VectorCopy( cmd->origin, s_entityOrigins[cmd->entnum] );
+		}
+		break;
+
+	case SND_CMD_UPDATE:
+		{
+			const sndcmd_update_t *cmd = data;
+			S_UpdateListener( cmd->origin, cmd->velocity, cmd->axis );
+		}
+		break;
+
+	case SND_CMD_RAWSAMPLES:
+		{
+			const sndcmd_rawsamples_t *cmd = data;
+			S_AddRawSamples( cmd->entnum, cmd->fvol, cmd->attenuation, cmd->origin,
+				cmd->samples, cmd->rate, cmd->width, cmd->channels, ( const qbyte * )( cmd + 1 ), cmd->music );
+		}
+		break;
+
+	case SND_CMD_ATTENUATIONMODEL:
+		{
+			const sndcmd_attenuationmodel_t *cmd = data;
+			s_attenuation_model = cmd->model;
+			s_attenuation_maxdistance = cmd->maxdistance;
+			s_attenuation_refdistance = cmd->refdistance;
+		}
+		break;
+
+	default:
+		assert( 0 );
+		break;
+	}
+}
+
+/*
+* S_MixerUpdate
+*
+* Called by the mixer thread on each pass
+*/
+void S_MixerUpdate( void )
+{
+	// avi dumps are painted by S_Update
+	if( s_aviDumpFile )
+		return;
+
+	S_Update_( qfalse );
+}
+
+/*
+* S_MixerUnlocked
+*
+* The main thread is done with the mixer data, catch up with what has
+* happened to the raw sounds
+*/
+void S_MixerUnlocked( void )
+{
+	int i;
+
+	for( i = 0; i < MAX_RAW_SOUNDS; i++ ) {
+		if( raw_sounds[i] ) {
+			s_rawMirror[i].entnum = raw_sounds[i]->entnum;
+			s_rawMirror[i].rawend = raw_sounds[i]->rawend;
+		}
+		else {
+			s_rawMirror[i].entnum = S_RAW_SOUND_UNUSED;
+			s_rawMirror[i].rawend = 0;
+		}
+	}
 }
 
 /*
@@ -257,6 +257,7 @@ extern cvar_t *s_testsound;
 extern cvar_t *s_swapstereo;
 extern cvar_t *s_vorbis;
 extern cvar_t *s_pseudoAcoustics;
+extern cvar_t *s_mixthread;
 
 extern struct mempool_s *soundpool;
 
@@ -280,6 +281,8 @@ void S_IssuePlaysound( playsound_t *ps );
 
 int S_PaintChannels( unsigned int endtime, int dumpfile );
 
+void S_MixBench_f( void );
+
 // picks a channel based on priorities, empty slots, number of channels
 channel_t *S_PickChannel( int entnum, int entchannel );
 
@@ -289,6 +292,33 @@ void S_Spatialize( channel_t *ch );
 void S_BeginAviDemo( void );
 void S_StopAviDemo( void );
 
+// mixer thread
+qboolean S_InitMixerThread( void );
+void S_ShutdownMixerThread( void );
+qboolean S_MixerThreadActive( void );
+qboolean S_QueueMixerCmds( void );
+void S_LockMixer( void );
+void S_UnlockMixer( void );
+void *S_AllocMixerCmd( int id, size_t size );
+void S_SubmitMixerCmd( void );
+
+void S_ExecuteMixerCmd( int id, const void *data );
+void S_MixerUpdate( void );
+void S_MixerUnlocked( void );
+
+/*
+* S_MixerSound
+*
+* The data of a sound that is being mixed. The mixer thread can't load
+* anything, sounds are loaded by the main thread before they're started
+*/
+static inline sfxcache_t *S_MixerSound( sfx_t *sfx )
+{
+	if( S_MixerThreadActive() )
+		return sfx->cache;
+	return S_LoadSound( sfx );
+}
+
 //====================================================================
 
 // Lowpass code ripped from OpenAL software implementation
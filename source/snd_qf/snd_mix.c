@@ -21,12 +21,129 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "snd_local.h"
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+# define SND_SSE2
+# include <emmintrin.h>
+#endif
+
 #define	PAINTBUFFER_SIZE    2048
 static portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 static int snd_scaletable[32][256];
 static int *snd_p, snd_linear_count, snd_vol, music_vol;
 static short *snd_out;
 
+#ifdef SND_SSE2
+static qboolean snd_sse2 = qtrue;		// cleared by mixbench to time the portable code
+
+/*
+* S_MulShift8_SSE2
+*
+* ( s * v ) >> 8 of eight 16-bit samples and eight volumes in the 0-65535
+* range, as two vectors of four 32-bit integers
+*/
+static inline void S_MulShift8_SSE2( __m128i s, __m128i v, __m128i *lo, __m128i *hi )
+{
+	__m128i l, h;
+
+	l = _mm_mullo_epi16( s, v );
+	// mulhi takes volumes above 32767 for negative numbers, which is off by the sample
+	h = _mm_add_epi16( _mm_mulhi_epi16( s, v ), _mm_and_si128( s, _mm_srai_epi16( v, 15 ) ) );
+
+	*lo = _mm_srai_epi32( _mm_unpacklo_epi16( l, h ), 8 );
+	*hi = _mm_srai_epi32( _mm_unpackhi_epi16( l, h ), 8 );
+}
+
+/*
+* S_AddToPaintBuffer_SSE2
+*/
+static inline void S_AddToPaintBuffer_SSE2( portable_samplepair_t *samp, __m128i lo, __m128i hi )
+{
+	__m128i *p = ( __m128i * )samp;
+
+	_mm_storeu_si128( p, _mm_add_epi32( _mm_loadu_si128( p ), lo ) );
+	_mm_storeu_si128( p + 1, _mm_add_epi32( _mm_loadu_si128( p + 1 ), hi ) );
+}
+
+/*
+* S_PaintStereo16_SSE2
+*
+* Paints count samples, returns how many are left for the portable code
+*/
+static unsigned int S_PaintStereo16_SSE2( portable_samplepair_t *samp, const signed short *sfx, unsigned int count, int leftvol, int rightvol )
+{
+	unsigned int i;
+	__m128i v, lo, hi;
+
+	if( (unsigned)leftvol > 0xffff || (unsigned)rightvol > 0xffff )
+		return count;
+
+	v = _mm_set_epi16( (short)rightvol, (short)leftvol, (short)rightvol, (short)leftvol, 
+		(short)rightvol, (short)leftvol, (short)rightvol, (short)leftvol );
+
+	for( i = 0; i + 4 <= count; i += 4 )
+	{
+		S_MulShift8_SSE2( _mm_loadu_si128( ( const __m128i * )( sfx + i * 2 ) ), v, &lo, &hi );
+		S_AddToPaintBuffer_SSE2( samp + i, lo, hi );
+	}
+
+	return count - i;
+}
+
+/*
+* S_PaintMono16_SSE2
+*/
+static unsigned int S_PaintMono16_SSE2( portable_samplepair_t *samp, const signed short *sfx, unsigned int count, int leftvol, int rightvol )
+{
+	unsigned int i;
+	__m128i s, v, lo, hi;
+
+	if( (unsigned)leftvol > 0xffff || (unsigned)rightvol > 0xffff )
+		return count;
+
+	v = _mm_set_epi16( (short)rightvol, (short)leftvol, (short)rightvol, (short)leftvol, 
+		(short)rightvol, (short)leftvol, (short)rightvol, (short)leftvol );
+
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		s = _mm_loadu_si128( ( const __m128i * )( sfx + i ) );
+
+		S_MulShift8_SSE2( _mm_unpacklo_epi16( s, s ), v, &lo, &hi );
+		S_AddToPaintBuffer_SSE2( samp + i, lo, hi );
+
+		S_MulShift8_SSE2( _mm_unpackhi_epi16( s, s ), v, &lo, &hi );
+		S_AddToPaintBuffer_SSE2( samp + i + 4, lo, hi );
+	}
+
+	return count - i;
+}
+
+/*
+* S_PaintRawSamples_SSE2
+*/
+static unsigned int S_PaintRawSamples_SSE2( portable_samplepair_t *samp, const portable_samplepair_t *raw, unsigned int count, int leftvol, int rightvol )
+{
+	unsigned int i;
+	__m128i r, even, odd;
+	__m128i *p;
+	const __m128i vl = _mm_set1_epi32( leftvol ), vr = _mm_set1_epi32( rightvol );
+
+	// there's no 32-bit multiply before SSE4.1, the left and right halves
+	// of the pairs go through the 32x32->64 bit one separately
+	for( i = 0; i + 2 <= count; i += 2 )
+	{
+		r = _mm_loadu_si128( ( const __m128i * )( raw + i ) );
+		even = _mm_mul_epu32( r, vl );
+		odd = _mm_mul_epu32( _mm_srli_epi64( r, 32 ), vr );
+
+		p = ( __m128i * )( samp + i );
+		_mm_storeu_si128( p, _mm_add_epi32( _mm_loadu_si128( p ), 
+			_mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) ) ) );
+	}
+
+	return count - i;
+}
+#endif // SND_SSE2
+
 #if !defined ( id386 ) || defined ( __MACOSX__ )
 #ifdef _WIN32
 #pragma warning( push )
@@ -37,7 +154,21 @@ static void S_WriteLinearBlastStereo16( void )
 	int i;
 	int val;
 
-	for( i = 0; i < snd_linear_count; i += 2 )
+	i = 0;
+#ifdef SND_SSE2
+	if( snd_sse2 )
+	{
+		// packs saturates just like the bound below
+		for( ; i + 8 <= snd_linear_count; i += 8 )
+		{
+			__m128i a = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( snd_p + i ) ), 8 );
+			__m128i b = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( snd_p + i + 4 ) ), 8 );
+			_mm_storeu_si128( ( __m128i * )( snd_out + i ), _mm_packs_epi32( a, b ) );
+		}
+	}
+#endif
+
+	for( ; i < snd_linear_count; i += 2 )
 	{
 		val = snd_p[i]>>8;
 		snd_out[i] = bound( (short)0x8000, val, 0x7fff );
@@ -52,7 +183,22 @@ static void S_WriteSwappedLinearBlastStereo16( void )
 	int i;
 	int val;
 
-	for( i = 0; i < snd_linear_count; i += 2 )
+	i = 0;
+#ifdef SND_SSE2
+	if( snd_sse2 )
+	{
+		for( ; i + 8 <= snd_linear_count; i += 8 )
+		{
+			__m128i a = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( snd_p + i ) ), 8 );
+			__m128i b = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( snd_p + i + 4 ) ), 8 );
+			a = _mm_shuffle_epi32( a, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+			b = _mm_shuffle_epi32( b, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+			_mm_storeu_si128( ( __m128i * )( snd_out + i ), _mm_packs_epi32( a, b ) );
+		}
+	}
+#endif
+
+	for( ; i < snd_linear_count; i += 2 )
 	{
 		val = snd_p[i+1]>>8;
 		snd_out[i] = bound( (short)0x8000, val, 0x7fff );
@@ -418,6 +564,7 @@ CHANNEL MIXING
 ===============================================================================
 */
 
+static void S_PaintRawSamples( portable_samplepair_t *samp, const portable_samplepair_t *raw, unsigned int count, int leftvol, int rightvol );
 static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
 static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
 static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
@@ -468,8 +615,7 @@ int S_PaintChannels( unsigned int endtime, int dumpfile )
 		// paint in the raw samples
 		for( i = 0; i < MAX_RAW_SOUNDS; i++ ) {
 			// copy from the streaming sound source
-			int s;
-			unsigned j, stop;
+			unsigned j, s, stop, run;
 			rawsound_t *rawsound = raw_sounds[i];
 
 			if( !rawsound ) {
@@ -481,11 +627,13 @@ int S_PaintChannels( unsigned int endtime, int dumpfile )
 			}
 
 			stop = ( end < rawsound->rawend ) ? end : rawsound->rawend;
-			for( j = paintedtime; j < stop; j++ )
+			for( j = paintedtime; j < stop; j += run )
 			{
+				// up to where the ring wraps
 				s = j&( MAX_RAW_SAMPLES-1 );
-				paintbuffer[j-paintedtime].left += rawsound->rawsamples[s].left * rawsound->left_volume;
-				paintbuffer[j-paintedtime].right += rawsound->rawsamples[s].right * rawsound->right_volume;
+				run = min( stop - j, MAX_RAW_SAMPLES - s );
+				S_PaintRawSamples( &paintbuffer[j-paintedtime], &rawsound->rawsamples[s], run, 
+					rawsound->left_volume, rawsound->right_volume );
 			}
 		}
 
@@ -510,7 +658,7 @@ int S_PaintChannels( unsigned int endtime, int dumpfile )
 				if( ch->end < end )
 					count = ch->end > ltime ? ch->end - ltime : 0;
 
-				sc = S_LoadSound( ch->sfx );
+				sc = S_MixerSound( ch->sfx );
 				if( !sc )
 					break;
 
@@ -581,6 +729,23 @@ void S_InitScaletable( void )
 	}
 }
 
+static void S_PaintRawSamples( portable_samplepair_t *samp, const portable_samplepair_t *raw, unsigned int count, int leftvol, int rightvol )
+{
+	unsigned int i;
+
+	i = 0;
+#ifdef SND_SSE2
+	if( snd_sse2 )
+		i = count - S_PaintRawSamples_SSE2( samp, raw, count, leftvol, rightvol );
+#endif
+
+	for( ; i < count; i++ )
+	{
+		samp[i].left += raw[i].left * leftvol;
+		samp[i].right += raw[i].right * rightvol;
+	}
+}
+
 static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, unsigned int count, int offset )
 {
 	unsigned int i;
@@ -652,8 +817,18 @@ static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, unsigned int co
 	if( sc->channels == 2 )
 	{
 		sfx = (signed short *)sc->data + ch->pos * 2;
+		i = 0;
 
-		for( i = 0; i < count; i++, samp++ )
+#ifdef SND_SSE2
+		if( snd_sse2 )
+		{
+			i = count - S_PaintStereo16_SSE2( samp, sfx, count, leftvol, rightvol );
+			samp += i;
+			sfx += i * 2;
+		}
+#endif
+
+		for( ; i < count; i++, samp++ )
 		{
 			samp->left += ( *sfx++ * leftvol ) >> 8;
 			samp->right += ( *sfx++ * rightvol ) >> 8;
@@ -662,8 +837,18 @@ static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, unsigned int co
 	else
 	{
 		sfx = (signed short *)sc->data + ch->pos;
+		i = 0;
 
-		for( i = 0; i < count; i++, samp++ )
+#ifdef SND_SSE2
+		if( snd_sse2 )
+		{
+			i = count - S_PaintMono16_SSE2( samp, sfx, count, leftvol, rightvol );
+			samp += i;
+			sfx += i;
+		}
+#endif
+
+		for( ; i < count; i++, samp++ )
 		{
 			j = *sfx++;
 			samp->left += ( j * leftvol ) >> 8;
@@ -777,8 +962,18 @@ static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, unsigned int
 	if( sc->channels == 2 )
 	{
 		sfx = (signed short *)sc->data + ch->pos * 2;
+		i = 0;
 
-		for( i = 0; i < count; i++, samp++ )
+#ifdef SND_SSE2
+		if( snd_sse2 )
+		{
+			i = count - S_PaintStereo16_SSE2( samp, sfx, count, leftvol, rightvol );
+			samp += i;
+			sfx += i * 2;
+		}
+#endif
+
+		for( ; i < count; i++, samp++ )
 		{
 			samp->left += ( *sfx++ * leftvol ) >> 8;
 			samp->right += ( *sfx++ * rightvol ) >> 8;
@@ -826,3 +1021,155 @@ static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, unsigned int
 
 	ch->pos += count;
 }
+
+/*
+===============================================================================
+
+BENCHMARK
+
+===============================================================================
+*/
+
+#define MIXBENCH_SPEED		44100
+#define MIXBENCH_SAMPLES	0x10000		// scratch DMA buffer, in mono samples
+
+/*
+* S_MixBench_f
+*
+* Mixes a fixed set of looping channels for a number of seconds into a
+* scratch buffer instead of the device, with the portable code and then
+* with the SIMD one when it's available
+*/
+void S_MixBench_f( void )
+{
+	int i, k, pass, numpasses;
+	int seconds, numchannels;
+	unsigned int seed, checksum[2];
+	quint64 usec[2];
+	sfx_t sfx[3];
+	sfxcache_t *sc;
+	channel_t *ch, *savedchannels;
+	rawsound_t *savedraw[MAX_RAW_SOUNDS];
+	playsound_t savedpending;
+	unsigned int savedpaintedtime;
+	dma_t saveddma;
+	qbyte *buffer;
+
+	if( !s_volume->value )
+	{
+		Com_Printf( "mixbench: s_volume is 0, nothing would be mixed\n" );
+		return;
+	}
+
+	seconds = trap_Cmd_Argc() > 1 ? atoi( trap_Cmd_Argv( 1 ) ) : 10;
+	clamp( seconds, 1, 600 );
+	numchannels = trap_Cmd_Argc() > 2 ? atoi( trap_Cmd_Argv( 2 ) ) : 32;
+	clamp( numchannels, 1, MAX_CHANNELS );
+
+	// one second of noise in each format the channels can have
+	memset( sfx, 0, sizeof( sfx ) );
+	for( i = 0, seed = 0x1234567; i < 3; i++ )
+	{
+		int size;
+
+		Q_snprintfz( sfx[i].name, sizeof( sfx[i].name ), "*mixbench%i", i );
+		size = MIXBENCH_SPEED * ( i == 1 ? 2 : 1 ) * ( i == 2 ? 1 : 2 );
+		sc = sfx[i].cache = S_Malloc( sizeof( sfxcache_t ) + size );
+		sc->length = MIXBENCH_SPEED;
+		sc->loopstart = sc->length;
+		sc->speed = MIXBENCH_SPEED;
+		sc->channels = i == 1 ? 2 : 1;
+		sc->width = i == 2 ? 1 : 2;
+		for( k = 0; k < size; k++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			sc->data[k] = seed >> 16;
+		}
+	}
+
+	savedchannels = S_Malloc( sizeof( channels ) );
+	buffer = S_Malloc( MIXBENCH_SAMPLES * 2 );
+
+	S_LockMixer();
+	SNDDMA_BeginPainting();
+
+	memcpy( savedchannels, channels, sizeof( channels ) );
+	memcpy( savedraw, raw_sounds, sizeof( raw_sounds ) );
+	savedpending = s_pendingplays;
+	savedpaintedtime = paintedtime;
+	saveddma = dma;
+
+	memset( raw_sounds, 0, sizeof( raw_sounds ) );
+	s_pendingplays.next = s_pendingplays.prev = &s_pendingplays;
+
+	dma.channels = 2;
+	dma.samples = MIXBENCH_SAMPLES;
+	dma.submission_chunk = 1;
+	dma.samplebits = 16;
+	dma.speed = MIXBENCH_SPEED;
+	dma.buffer = buffer;
+
+	numpasses = 1;
+#ifdef SND_SSE2
+	numpasses = 2;
+#endif
+
+	for( pass = 0; pass < numpasses; pass++ )
+	{
+#ifdef SND_SSE2
+		snd_sse2 = pass ? qtrue : qfalse;
+#endif
+
+		memset( channels, 0, sizeof( channels ) );
+		for( i = 0, ch = channels; i < numchannels; i++, ch++ )
+		{
+			ch->sfx = &sfx[i % 3];
+			ch->leftvol = 32 + ( i * 53 ) % 224;
+			ch->rightvol = 255 - ( i * 31 ) % 224;
+			ch->entnum = i + 1;
+			ch->autosound = qtrue;
+			ch->pos = ( i * 1237 ) % MIXBENCH_SPEED;
+			ch->end = MIXBENCH_SPEED - ch->pos;
+		}
+
+		memset( buffer, 0, MIXBENCH_SAMPLES * 2 );
+		paintedtime = 0;
+
+		usec[pass] = trap_Microseconds();
+		S_PaintChannels( seconds * MIXBENCH_SPEED, 0 );
+		usec[pass] = trap_Microseconds() - usec[pass];
+
+		for( k = 0, checksum[pass] = 0; k < MIXBENCH_SAMPLES * 2; k++ )
+			checksum[pass] = checksum[pass] * 31 + buffer[k];
+	}
+
+#ifdef SND_SSE2
+	snd_sse2 = qtrue;
+#endif
+
+	dma = saveddma;
+	paintedtime = savedpaintedtime;
+	s_pendingplays = savedpending;
+	memcpy( raw_sounds, savedraw, sizeof( raw_sounds ) );
+	memcpy( channels, savedchannels, sizeof( channels ) );
+
+	SNDDMA_Submit();
+	S_UnlockMixer();
+
+	S_Free( buffer );
+	S_Free( savedchannels );
+	for( i = 0; i < 3; i++ )
+		S_Free( sfx[i].cache );
+
+	Com_Printf( "mixbench: %i channels, %i seconds at %i Hz%s\n", numchannels, seconds, MIXBENCH_SPEED, 
+		s_pseudoAcoustics->integer ? ", pseudo acoustics" : "" );
+	for( pass = 0; pass < numpasses; pass++ )
+	{
+		Com_Printf( "%-8s %8.2f msec, %6.0fx realtime", pass ? "sse2" : "portable", usec[pass] / 1000.0, 
+			seconds * 1000000.0 / max( usec[pass], 1 ) );
+		if( pass )
+			Com_Printf( ", %.2fx faster, output %s", (double)usec[0] / max( usec[pass], 1 ), 
+				checksum[pass] == checksum[0] ? "matches" : "differs" );
+		Com_Printf( "\n" );
+	}
+}
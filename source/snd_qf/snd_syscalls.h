@@ -166,6 +166,16 @@ static inline unsigned int trap_Milliseconds( void )
 	return SOUND_IMPORT.Milliseconds();
 }
 
+static inline quint64 trap_Microseconds( void )
+{
+	return SOUND_IMPORT.Microseconds();
+}
+
+static inline void trap_Sleep( unsigned int millis )
+{
+	SOUND_IMPORT.Sleep( millis );
+}
+
 static inline void trap_PageInMemory( qbyte *buffer, int size )
 {
 	SOUND_IMPORT.PageInMemory( buffer, size );
@@ -210,3 +220,38 @@ static inline void trap_UnloadLibrary( void **lib )
 {
 	SOUND_IMPORT.UnloadLibrary( lib );
 }
+
+static inline struct qthread_s *trap_Thread_Create( void *( *routine )( void * ), void *param )
+{
+	return SOUND_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread )
+{
+	SOUND_IMPORT.Thread_Join( thread );
+}
+
+static inline struct qmutex_s *trap_Mutex_Create( void )
+{
+	return SOUND_IMPORT.Mutex_Create();
+}
+
+static inline void trap_Mutex_Destroy( struct qmutex_s **pmutex )
+{
+	SOUND_IMPORT.Mutex_Destroy( pmutex );
+}
+
+static inline void trap_Mutex_Lock( struct qmutex_s *mutex )
+{
+	SOUND_IMPORT.Mutex_Lock( mutex );
+}
+
+static inline void trap_Mutex_Unlock( struct qmutex_s *mutex )
+{
+	SOUND_IMPORT.Mutex_Unlock( mutex );
+}
+
+static inline int trap_Atomic_Add( volatile int *value, int add )
+{
+	return SOUND_IMPORT.Atomic_Add( value, add );
+}
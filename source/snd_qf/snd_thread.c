@@ -0,0 +1,284 @@
+/*
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// snd_thread.c -- mixing on a thread of its own
+
+#include "snd_local.h"
+
+/*
+* With s_mixthread set, channels, playsounds, raw sounds and the paint
+* position belong to the mixer thread, which wakes up every few msecs to
+* mix ahead of the DMA position. The main thread doesn't touch them: it
+* writes commands into a single producer, single consumer ring and the
+* mixer executes them before painting.
+*
+* Commands are variable sized, a header followed by the payload, and never
+* wrap around the end of the ring: when one doesn't fit, a wrap marker is
+* left and the command goes to the start. Each side only ever writes its
+* own position, the atomic add on publishing also orders the payload
+* before it.
+*
+* Anything rare or heavy (registration, stopping all sounds, avi dumps)
+* takes the mixer lock instead, which keeps the thread out while the main
+* thread works on its data directly.
+*/
+
+#define SND_CMDQUEUE_SIZE		0x40000
+#define SND_CMDQUEUE_ALIGN		8
+#define SND_CMD_WRAP			-1
+
+#define SND_MIXTHREAD_MSEC		4
+
+typedef struct
+{
+	int id;
+	int size;		// header included
+} sndcmdheader_t;
+
+static qbyte *s_cmdQueue;
+static volatile int s_cmdRead, s_cmdWrite;
+static int s_cmdPending, s_cmdPendingSize;
+
+static struct qthread_s *s_mixerThread;
+static struct qmutex_s *s_mixerMutex;
+static volatile int s_mixerQuit;
+static int s_mixerLockDepth;
+
+/*
+* S_ReadMixerCmds
+*
+* Executes everything in the queue. Called with the mixer lock held
+*/
+static void S_ReadMixerCmds( void )
+{
+	int read, write;
+	sndcmdheader_t *cmd;
+
+	read = s_cmdRead;
+	write = trap_Atomic_Add( &s_cmdWrite, 0 );
+
+	while( read != write )
+	{
+		cmd = ( sndcmdheader_t * )( s_cmdQueue + read );
+		if( cmd->id == SND_CMD_WRAP )
+		{
+			read = 0;
+			continue;
+		}
+
+		S_ExecuteMixerCmd( cmd->id, cmd + 1 );
+
+		read += cmd->size;
+		if( read == SND_CMDQUEUE_SIZE )
+			read = 0;
+
+		// let the main thread reuse the space
+		trap_Atomic_Add( &s_cmdRead, read - s_cmdRead );
+	}
+}
+
+/*
+* S_MixerThreadProc
+*/
+static void *S_MixerThreadProc( void *param )
+{
+	while( !s_mixerQuit )
+	{
+		trap_Mutex_Lock( s_mixerMutex );
+		S_ReadMixerCmds();
+		S_MixerUpdate();
+		trap_Mutex_Unlock( s_mixerMutex );
+
+		trap_Sleep( SND_MIXTHREAD_MSEC );
+	}
+
+	return NULL;
+}
+
+/*
+* S_InitMixerThread
+*/
+qboolean S_InitMixerThread( void )
+{
+	s_cmdQueue = S_Malloc( SND_CMDQUEUE_SIZE );
+	s_cmdRead = s_cmdWrite = 0;
+	s_mixerQuit = 0;
+	s_mixerLockDepth = 0;
+
+	s_mixerMutex = trap_Mutex_Create();
+	if( !s_mixerMutex )
+	{
+		S_Free( s_cmdQueue );
+		s_cmdQueue = NULL;
+		return qfalse;
+	}
+
+	s_mixerThread = trap_Thread_Create( S_MixerThreadProc, NULL );
+	if( !s_mixerThread )
+	{
+		trap_Mutex_Destroy( &s_mixerMutex );
+		S_Free( s_cmdQueue );
+		s_cmdQueue = NULL;
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+* S_ShutdownMixerThread
+*
+* Stops the thread and runs the commands it hasn't got to yet
+*/
+void S_ShutdownMixerThread( void )
+{
+	if( !s_mixerThread )
+		return;
+
+	s_mixerQuit = 1;
+	trap_Thread_Join( s_mixerThread );
+	s_mixerThread = NULL;
+
+	S_ReadMixerCmds();
+
+	trap_Mutex_Destroy( &s_mixerMutex );
+	S_Free( s_cmdQueue );
+	s_cmdQueue = NULL;
+}
+
+/*
+* S_MixerThreadActive
+*/
+qboolean S_MixerThreadActive( void )
+{
+	return s_mixerThread != NULL;
+}
+
+/*
+* S_QueueMixerCmds
+*
+* Whether the main thread should send commands instead of working on the
+* mixer data directly
+*/
+qboolean S_QueueMixerCmds( void )
+{
+	return s_mixerThread != NULL && !s_mixerLockDepth;
+}
+
+/*
+* S_LockMixer
+*
+* Waits for the mixer to finish its pass and runs the pending commands.
+* May be nested, does nothing without the thread
+*/
+void S_LockMixer( void )
+{
+	if( !s_mixerThread )
+		return;
+	if( s_mixerLockDepth++ )
+		return;
+
+	trap_Mutex_Lock( s_mixerMutex );
+	S_ReadMixerCmds();
+}
+
+/*
+* S_UnlockMixer
+*/
+void S_UnlockMixer( void )
+{
+	if( !s_mixerThread )
+		return;
+	if( --s_mixerLockDepth )
+		return;
+
+	S_MixerUnlocked();
+	trap_Mutex_Unlock( s_mixerMutex );
+}
+
+/*
+* S_AllocMixerCmd
+*
+* Reserves space for a command of the given payload size, waiting for the
+* mixer when the queue is full. Returns NULL for commands that would take
+* more than half of the queue, those have to take the lock instead
+*/
+void *S_AllocMixerCmd( int id, size_t size )
+{
+	int read, write, total;
+	sndcmdheader_t *cmd;
+
+	assert( S_QueueMixerCmds() );
+
+	total = ( sizeof( sndcmdheader_t ) + size + SND_CMDQUEUE_ALIGN - 1 ) & ~( SND_CMDQUEUE_ALIGN - 1 );
+	if( total > SND_CMDQUEUE_SIZE / 2 )
+		return NULL;
+
+	write = s_cmdWrite;
+	while( 1 )
+	{
+		read = trap_Atomic_Add( &s_cmdRead, 0 );
+
+		// the write position never catches up with the read position,
+		// equal positions mean the queue is empty
+		if( write >= read )
+		{
+			if( write + total < SND_CMDQUEUE_SIZE || ( write + total == SND_CMDQUEUE_SIZE && read ) )
+				break;
+			if( total < read )
+			{
+				// doesn't fit at the end, start over
+				cmd = ( sndcmdheader_t * )( s_cmdQueue + write );
+				cmd->id = SND_CMD_WRAP;
+				cmd->size = SND_CMDQUEUE_SIZE - write;
+				write = 0;
+				break;
+			}
+		}
+		else if( write + total < read )
+		{
+			break;
+		}
+
+		trap_Sleep( 1 );
+	}
+
+	cmd = ( sndcmdheader_t * )( s_cmdQueue + write );
+	cmd->id = id;
+	cmd->size = total;
+
+	s_cmdPending = write;
+	s_cmdPendingSize = total;
+
+	return cmd + 1;
+}
+
+/*
+* S_SubmitMixerCmd
+*
+* Hands the command from the last S_AllocMixerCmd to the mixer
+*/
+void S_SubmitMixerCmd( void )
+{
+	int write;
+
+	write = s_cmdPending + s_cmdPendingSize;
+	if( write == SND_CMDQUEUE_SIZE )
+		write = 0;
+
+	trap_Atomic_Add( &s_cmdWrite, write - s_cmdWrite );
+}
@@ -101,6 +101,7 @@ typedef struct
 	int num_entities;
 	int first_entity;                   // into the circular sv_packet_entities[]
 	unsigned int sentTimeStamp;         // time at what this frame snap was sent to the clients
+	int deltaFrameNum;                  // the frame this one was delta'd from, -1 if none
 	unsigned int UcmdExecuted;
 	game_state_t gameState;
 } client_snapshot_t;
@@ -143,6 +144,7 @@ typedef struct client_s
 
 	qboolean reliable;                  // no need for acks, upstream is reliable
 	qboolean mv;                        // send multiview data to the client
+	qboolean packedentities;            // packetentities go as a bitstream, never negotiated here
 	qboolean individual_socket;         // client has it's own socket that has to be checked separately
 
 	socket_t socket;
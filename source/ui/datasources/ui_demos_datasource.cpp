@@ -28,6 +28,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define FIELD_PATH			"path"
 #define FIELD_ISDIR			"is_dir"
 
+// table name options, e.g. "server/?sort=-date;filter=wca1 player:bob"
+#define TABLE_OPTIONS		'?'
+#define TABLE_SEPARATOR		';'
+#define OPTION_SORT			"sort="
+#define OPTION_FILTER		"filter="
+
 // fixed paths
 #define PATH_ROOT		"demos"
 #define PATH_PARENT		".."
@@ -38,12 +44,13 @@ namespace WSWUI
 typedef std::vector<std::string> DirList;
 
 DemoCollection::DemoCollection( void ) :
-	path( "" ), demoExtension( "" ), defaultItemName( "" ), numDirectories( 0 )
+	path( "" ), demoExtension( "" ), sort( "" ), filter( "" ), defaultItemName( "" ), numDirectories( 0 )
 {
 }
 
-DemoCollection::DemoCollection( const std::string &path, const std::string &demoExtension ) :
-	path( path ), demoExtension( demoExtension ), defaultItemName( "" ), numDirectories( 0 )
+DemoCollection::DemoCollection( const std::string &path, const std::string &demoExtension,
+	const std::string &sort, const std::string &filter ) :
+	path( path ), demoExtension( demoExtension ), sort( sort ), filter( filter ), defaultItemName( "" ), numDirectories( 0 )
 {
 	PopulateList();
 }
@@ -77,7 +84,28 @@ void DemoCollection::PopulateList( void )
 	// populate directories
 	numDirectories = demoList.size();
 
-	getFileList( demoList, fullPath, demoExtension.c_str(), true );
+	// the demos come sorted and filtered from the demo index
+	int i, k;
+	char listbuf[1024];
+	const char *ptr;
+	int numDemos = trap::DI_GetFileList( fullPath.c_str(), filter.c_str(), sort.c_str(), NULL, 0, 0, 0 );
+
+	for( i = 0; i < numDemos; ) {
+		k = trap::DI_GetFileList( fullPath.c_str(), filter.c_str(), sort.c_str(), listbuf, sizeof( listbuf ), i, numDemos );
+		if( !k ) {
+			// the name doesn't fit into the buffer
+			i++;
+			continue;
+		}
+
+		i += k;
+		for( ptr = listbuf; k > 0; k--, ptr += strlen( ptr ) + 1 ) {
+			demoList.push_back( ptr );
+		}
+	}
+
+	metaData.clear();
+	metaData.resize( demoList.size() );
 }
 
 bool DemoCollection::IsRoot( void ) const 
@@ -112,6 +140,17 @@ std::string DemoCollection::GetItemPath( const int index ) const
 	return (IsRoot() ? "" : path + "/") + demoList[index];
 }
 
+const std::string DemoCollection::GetItemMeta( int index, const std::string &key ) const
+{
+	assert( index >= 0 && index < int(metaData.size()) );
+
+	DemoMetaData::const_iterator it = metaData[index].find( key );
+	if( it == metaData[index].end() ) {
+		return "";
+	}
+	return it->second;
+}
+
 std::string DemoCollection::GetPathToParentDir( void ) const
 {
 	if( IsRoot() ) {
@@ -135,8 +174,9 @@ DemosDataSourceHelper::DemosDataSourceHelper( void ) :
 {
 }
 
-DemosDataSourceHelper::DemosDataSourceHelper( const std::string &path, const std::string &demoExtension ) :
-	DemoCollection( path, demoExtension ), updateIndex( 0 )
+DemosDataSourceHelper::DemosDataSourceHelper( const std::string &path, const std::string &demoExtension,
+	const std::string &sort, const std::string &filter ) :
+	DemoCollection( path, demoExtension, sort, filter ), updateIndex( 0 )
 {
 }
 
@@ -146,7 +186,12 @@ bool DemosDataSourceHelper::UpdateFrame( int *firstRowAdded, int *numRowsAdded )
 		return false;
 	}
 
-	// add 1 row at a time
+	// add 1 row at a time, the meta data is cached by the demo index
+	if( updateIndex >= numDirectories ) {
+		DemoInfo demoInfo( GetItemPath( int( updateIndex ) ).c_str() );
+		metaData[updateIndex] = demoInfo.getMetaData();
+	}
+
 	*firstRowAdded = int( updateIndex );
 	*numRowsAdded = 1;
 	updateIndex++;
@@ -214,6 +259,9 @@ void DemosDataSource::GetRow( StringList& row, const String& table, int row_inde
 			row.push_back( demoPath.GetItemPath( row_index ).c_str() );
 		} else if( col == FIELD_ISDIR ) {
 			row.push_back( row_index < numDirectories ? "1" : "0" );
+		} else {
+			// anything else is a meta data key
+			row.push_back( demoPath.GetItemMeta( row_index, col.CString() ).c_str() );
 		}
 	}
 }
@@ -223,10 +271,33 @@ int DemosDataSource::GetNumRows( const String& table )
 	// table name represents a relative demo path with a trailing "/":
 	// "/" represents the root path inside the demo directory
 	// "tutorials/" represents tutorials subdirectory, etc
+	// the path may be followed by options for the demo index:
+	// "tutorials/?sort=-date;filter=wca1" lists the tutorials on wca1, newest first
 
 	// if we haven't yet traversed the queried path, do it now
 	if( demoPaths.find( table ) == demoPaths.end() ) {
 		std::string pathStr( table.CString() );
+		std::string sortStr, filterStr;
+
+		std::string::size_type options = pathStr.find( TABLE_OPTIONS );
+		if( options != std::string::npos ) {
+			std::string optionsStr = pathStr.substr( options + 1 );
+			pathStr = pathStr.substr( 0, options );
+
+			std::string::size_type start = 0, end;
+			do {
+				end = optionsStr.find( TABLE_SEPARATOR, start );
+				std::string option = optionsStr.substr( start, end == std::string::npos ? std::string::npos : end - start );
+
+				if( !option.compare( 0, strlen( OPTION_SORT ), OPTION_SORT ) ) {
+					sortStr = option.substr( strlen( OPTION_SORT ) );
+				} else if( !option.compare( 0, strlen( OPTION_FILTER ), OPTION_FILTER ) ) {
+					filterStr = option.substr( strlen( OPTION_FILTER ) );
+				}
+
+				start = end + 1;
+			} while( end != std::string::npos );
+		}
 
 		// chop off the trailing "/"
 		if( pathStr.find_last_of( "/" ) + 1 == pathStr.length() ) {
@@ -234,7 +305,7 @@ int DemosDataSource::GetNumRows( const String& table )
 		}
 
 		// the helper will start sending updates the next frame
-		demoPaths[table] = DemosDataSourceHelper( pathStr, demoExtension );
+		demoPaths[table] = DemosDataSourceHelper( pathStr, demoExtension, sortStr, filterStr );
 	}
 
 	const DemosDataSourceHelper &demoPath = demoPaths[table];
@@ -32,7 +32,8 @@ class DemoCollection
 {
 public:
 	DemoCollection( void );
-	DemoCollection( const std::string &path, const std::string &demoExtension );
+	DemoCollection( const std::string &path, const std::string &demoExtension,
+		const std::string &sort = "", const std::string &filter = "" );
 	~DemoCollection( void );
 
 	/// Returns total number of items (subdirectories and files) in the path
@@ -47,18 +48,27 @@ public:
 	/// Relative filesystem path to an item
 	std::string GetItemPath( int index ) const;
 
+	/// Meta data value of a demo, empty for directories and demos not updated yet
+	const std::string GetItemMeta( int index, const std::string &key ) const;
+
 protected:
 	typedef std::vector<std::string> DemoList;
 
 	/// current path, relative to the demo directory
 	std::string path;
 	std::string demoExtension;
+
+	/// demo index sort key and filter
+	std::string sort, filter;
 	std::string defaultItemName;
 
 	/// list of path items
 	DemoList demoList;
 	DemoList::size_type numDirectories;
 
+	/// meta data of the demos, by item index
+	std::vector<DemoMetaData> metaData;
+
 	/// Fills the demoList
 	void PopulateList( void );
 
@@ -75,7 +85,8 @@ class DemosDataSourceHelper : public DemoCollection
 {
 public:
 	DemosDataSourceHelper( void );
-	DemosDataSourceHelper( const std::string &path, const std::string &demoExtension );
+	DemosDataSourceHelper( const std::string &path, const std::string &demoExtension,
+		const std::string &sort = "", const std::string &filter = "" );
 
 	/// Returns the number of rows the parent DataSource object
 	/// should return to its listeners
@@ -30,6 +30,8 @@ void PolyAllocator::assignPointers( poly_t *p, unsigned char *b )
 	p->normals = ( vec4_t* )( p->verts + p->numverts );
 	p->stcoords = ( vec2_t* )( p->normals + p->numverts );
 	p->colors = ( byte_vec4_t* )( p->stcoords + p->numverts );
+	p->elems = NULL;
+	p->numelems = 0;
 }
 
 size_t PolyAllocator::sizeForPolyData( int numverts, int numelems )
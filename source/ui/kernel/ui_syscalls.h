@@ -228,6 +228,10 @@ namespace trap
 			return UI_IMPORT.CL_ReadDemoMetaData( demopath, meta_data, meta_data_size );
 		}
 
+		inline int DI_GetFileList( const char *dir, const char *filter, const char *sort, char *buf, size_t bufsize, int start, int end ) {
+			return UI_IMPORT.DI_GetFileList( dir, filter, sort, buf, bufsize, start, end );
+		}
+
 		inline int CL_PlayerNum( void ) {
 			return UI_IMPORT.CL_PlayerNum();
 		}
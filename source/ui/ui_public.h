@@ -21,7 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef __UI_PUBLIC_H__
 #define __UI_PUBLIC_H__
 
-#define	UI_API_VERSION	    43
+#define	UI_API_VERSION	    45
 
 typedef size_t (*ui_async_stream_read_cb_t)(const void *buf, size_t numb, float percentage, 
 	int status, const char *contentType, void *privatep);
@@ -120,6 +120,7 @@ typedef struct
 	void ( *CL_FreeClipboardData )( char *data );
 	void ( *CL_OpenURLInBrowser )( const char *url );
 	size_t ( *CL_ReadDemoMetaData )( const char *demopath, char *meta_data, size_t meta_data_size );
+	int ( *DI_GetFileList )( const char *dir, const char *filter, const char *sort, char *buf, size_t bufsize, int start, int end );
 	int ( *CL_PlayerNum )( void );
 
 	const char *( *Key_GetBindingBuf )( int binding );
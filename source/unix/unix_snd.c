@@ -73,6 +73,8 @@ cvar_t *s_channels = NULL;
 
 void S_Activate( qboolean active )
 {
+	S_LockMixer();
+
 	if( active )
 		SNDDMA_Submit();
 	else
@@ -81,6 +83,8 @@ void S_Activate( qboolean active )
 	S_ClearSoundTime();
 	S_ClearPaintBuffer();
 	S_ClearPlaysounds();
+
+	S_UnlockMixer();
 }
 
 /* The audio callback. All the magic happens here. */
@@ -29,6 +29,7 @@ FIXME:  This will be remidied once a native Mac port is complete
 #include <stdlib.h>
 #include <limits.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -42,6 +43,9 @@ FIXME:  This will be remidied once a native Mac port is complete
 #include <sys/mman.h>
 #include <errno.h>
 #include <locale.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
 
 #if defined ( __FreeBSD__ )
 #include <machine/param.h>
@@ -256,10 +260,22 @@ void Sys_Error( const char *format, ... )
 
 /*
 * Sys_Microseconds
+*
+* Monotonic where available, so frame timing isn't thrown off by clock adjustments
 */
 static unsigned long sys_secbase;
 quint64 Sys_Microseconds( void )
 {
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	if( !sys_secbase )
+		sys_secbase = ts.tv_sec;
+
+	return (quint64)( ts.tv_sec - sys_secbase )*1000000 + ts.tv_nsec / 1000;
+#else
 	struct timeval tp;
 	struct timezone tzp;
 
@@ -273,6 +289,7 @@ quint64 Sys_Microseconds( void )
 
 	// TODO handle the wrap
 	return (quint64)( tp.tv_sec - sys_secbase )*1000000 + tp.tv_usec;
+#endif
 }
 
 /*
@@ -313,6 +330,62 @@ void Sys_Sleep( unsigned int millis )
 	usleep( millis * 1000 );
 }
 
+/*
+* Sys_NumberOfProcessors
+*/
+int Sys_NumberOfProcessors( void )
+{
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	return count > 0 ? (int)count : 1;
+}
+
+/*
+* Sys_ForkInstance
+*
+* Returns the new process id in the parent, 0 in the child and -1 on failure
+*/
+int Sys_ForkInstance( void )
+{
+	pid_t parent = getpid();
+	pid_t pid = fork();
+
+	if( pid == 0 )
+	{
+#ifdef __linux__
+		// go down with the parent
+		prctl( PR_SET_PDEATHSIG, SIGTERM );
+		if( getppid() != parent )
+			_exit( 0 );
+#endif
+		// only the parent reads the terminal
+		stdin_active = qfalse;
+	}
+
+	return (int)pid;
+}
+
+/*
+* Sys_ReapInstance
+*
+* Returns the id of a child process that exited, 0 if none did
+*/
+int Sys_ReapInstance( void )
+{
+	int status;
+	pid_t pid = waitpid( -1, &status, WNOHANG );
+
+	return pid > 0 ? (int)pid : 0;
+}
+
+/*
+* Sys_KillInstance
+*/
+void Sys_KillInstance( int pid )
+{
+	kill( (pid_t)pid, SIGTERM );
+	waitpid( (pid_t)pid, NULL, 0 );
+}
+
 static void floating_point_exception_handler( int whatever )
 {
 	signal( SIGFPE, floating_point_exception_handler );
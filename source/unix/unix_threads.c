@@ -30,6 +30,10 @@ struct qmutex_s {
 	pthread_mutex_t m;
 };
 
+struct qcondvar_s {
+	pthread_cond_t c;
+};
+
 /*
 * Sys_Mutex_Create
 */
@@ -78,6 +82,77 @@ void Sys_Mutex_Unlock( qmutex_t *mutex )
 	pthread_mutex_unlock( &mutex->m );
 }
 
+/*
+* Sys_CondVar_Create
+*/
+int Sys_CondVar_Create( qcondvar_t **pcond )
+{
+	int res;
+	qcondvar_t *cond;
+
+	cond = ( qcondvar_t * )malloc( sizeof( *cond ) );
+	res = pthread_cond_init( &cond->c, NULL );
+	if( res != 0 ) {
+		free( cond );
+		return res;
+	}
+
+	*pcond = cond;
+	return 0;
+}
+
+/*
+* Sys_CondVar_Destroy
+*/
+void Sys_CondVar_Destroy( qcondvar_t *cond )
+{
+	if( !cond ) {
+		return;
+	}
+	pthread_cond_destroy( &cond->c );
+	free( cond );
+}
+
+/*
+* Sys_CondVar_Wait
+*/
+void Sys_CondVar_Wait( qcondvar_t *cond, qmutex_t *mutex )
+{
+	pthread_cond_wait( &cond->c, &mutex->m );
+}
+
+/*
+* Sys_CondVar_Wake
+*/
+void Sys_CondVar_Wake( qcondvar_t *cond )
+{
+	pthread_cond_signal( &cond->c );
+}
+
+/*
+* Sys_CondVar_WakeAll
+*/
+void Sys_CondVar_WakeAll( qcondvar_t *cond )
+{
+	pthread_cond_broadcast( &cond->c );
+}
+
+/*
+* Sys_Atomic_Add
+*/
+int Sys_Atomic_Add( volatile int *value, int add )
+{
+	return __sync_add_and_fetch( value, add );
+}
+
+/*
+* Sys_Atomic_CAS
+*/
+qboolean Sys_Atomic_CAS( volatile int *value, int oldval, int newval )
+{
+	return __sync_bool_compare_and_swap( value, oldval, newval ) ? qtrue : qfalse;
+}
+
 /*
 * Sys_Thread_Create
 */
@@ -837,10 +837,14 @@ void S_Activate( qboolean active )
 	if( !pDS )
 		return;
 
+	S_LockMixer();
+
 	// just set the priority for directsound
 	if( pDS->lpVtbl->SetCooperativeLevel( pDS, cl_hwnd, DSSCL_PRIORITY ) != DS_OK )
 	{
 		Com_Printf( "DirectSound SetCooperativeLevel failed\n" );
 		SNDDMA_Shutdown( qfalse );
 	}
+
+	S_UnlockMixer();
 }
@@ -164,7 +164,7 @@ static quint64 Sys_Microseconds_QPC( void )
 	static qboolean first = qtrue;
 	static qint64 p_start;
 
-	qint64 p_now;
+	qint64 p_now, p_elapsed;
 	QueryPerformanceCounter( (LARGE_INTEGER *) &p_now );
 
 	if( first )
@@ -173,7 +173,9 @@ static quint64 Sys_Microseconds_QPC( void )
 		p_start = p_now;
 	}
 
-	return ( ( p_now - p_start ) * 1000000 ) / freq;
+	// split so the multiplication doesn't overflow on long running servers
+	p_elapsed = p_now - p_start;
+	return ( p_elapsed / freq ) * 1000000 + ( ( p_elapsed % freq ) * 1000000 ) / freq;
 }
 
 unsigned int Sys_Milliseconds( void )
@@ -197,6 +199,42 @@ void Sys_Sleep( unsigned int millis )
 	Sleep( millis );
 }
 
+/*
+* Sys_NumberOfProcessors
+*/
+int Sys_NumberOfProcessors( void )
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+/*
+* Sys_ForkInstance
+*
+* Windows can't fork, every server instance is a process of its own
+*/
+int Sys_ForkInstance( void )
+{
+	return -1;
+}
+
+/*
+* Sys_ReapInstance
+*/
+int Sys_ReapInstance( void )
+{
+	return 0;
+}
+
+/*
+* Sys_KillInstance
+*/
+void Sys_KillInstance( int pid )
+{
+}
+
 /*
 * Sys_GetSymbol
 */
@@ -27,7 +27,11 @@ struct qthread_s {
 };
 
 struct qmutex_s {
-	HANDLE h;
+	CRITICAL_SECTION h;
+};
+
+struct qcondvar_s {
+	CONDITION_VARIABLE c;
 };
 
 /*
@@ -37,13 +41,12 @@ int Sys_Mutex_Create( qmutex_t **pmutex )
 {
 	qmutex_t *mutex;
 
-	HANDLE h = CreateMutex( NULL, FALSE, NULL );
-	if( h == NULL ) {
+	mutex = ( qmutex_t * )malloc( sizeof( *mutex ) );
+	if( !mutex ) {
 		return 1;
 	}
-	
-	mutex = ( qmutex_t * )malloc( sizeof( *mutex ) );
-	mutex->h = h;
+	InitializeCriticalSection( &mutex->h );
+
 	*pmutex = mutex;
 	return 0;
 }
@@ -56,7 +59,7 @@ void Sys_Mutex_Destroy( qmutex_t *mutex )
 	if( !mutex ) {
 		return;
 	}
-	CloseHandle( mutex->h );
+	DeleteCriticalSection( &mutex->h );
 	free( mutex );
 }
 
@@ -65,7 +68,7 @@ void Sys_Mutex_Destroy( qmutex_t *mutex )
 */
 void Sys_Mutex_Lock( qmutex_t *mutex )
 {
-	WaitForSingleObject( mutex->h, INFINITE );
+	EnterCriticalSection( &mutex->h );
 }
 
 /*
@@ -73,7 +76,72 @@ void Sys_Mutex_Lock( qmutex_t *mutex )
 */
 void Sys_Mutex_Unlock( qmutex_t *mutex )
 {
-	ReleaseMutex( mutex->h );
+	LeaveCriticalSection( &mutex->h );
+}
+
+/*
+* Sys_CondVar_Create
+*/
+int Sys_CondVar_Create( qcondvar_t **pcond )
+{
+	qcondvar_t *cond;
+
+	cond = ( qcondvar_t * )malloc( sizeof( *cond ) );
+	if( !cond ) {
+		return 1;
+	}
+	InitializeConditionVariable( &cond->c );
+
+	*pcond = cond;
+	return 0;
+}
+
+/*
+* Sys_CondVar_Destroy
+*/
+void Sys_CondVar_Destroy( qcondvar_t *cond )
+{
+	free( cond );
+}
+
+/*
+* Sys_CondVar_Wait
+*/
+void Sys_CondVar_Wait( qcondvar_t *cond, qmutex_t *mutex )
+{
+	SleepConditionVariableCS( &cond->c, &mutex->h, INFINITE );
+}
+
+/*
+* Sys_CondVar_Wake
+*/
+void Sys_CondVar_Wake( qcondvar_t *cond )
+{
+	WakeConditionVariable( &cond->c );
+}
+
+/*
+* Sys_CondVar_WakeAll
+*/
+void Sys_CondVar_WakeAll( qcondvar_t *cond )
+{
+	WakeAllConditionVariable( &cond->c );
+}
+
+/*
+* Sys_Atomic_Add
+*/
+int Sys_Atomic_Add( volatile int *value, int add )
+{
+	return InterlockedExchangeAdd( (volatile LONG *)value, add ) + add;
+}
+
+/*
+* Sys_Atomic_CAS
+*/
+qboolean Sys_Atomic_CAS( volatile int *value, int oldval, int newval )
+{
+	return InterlockedCompareExchange( (volatile LONG *)value, newval, oldval ) == oldval ? qtrue : qfalse;
 }
 
 /*
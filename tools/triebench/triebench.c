@@ -0,0 +1,207 @@
+/*
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+* triebench - times the qalgo trie on a map list sized like a big race server.
+*
+* Usage: triebench [maplist.txt]
+*
+* Without an argument 5000 synthetic map names are used, otherwise one map
+* name per line is read from the file. The same program is linked against
+* the current and the legacy trie, the printed checksums must match.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "../../source/qalgo/q_trie.h"
+
+#define NUM_SYNTHETIC_MAPS	5000
+#define MAX_NAME_LEN		64
+#define REPEATS				20
+
+static char **names, **misses;
+static int num_names;
+
+static const char *prefixes[] = { "race_", "cw_", "df_", "ctf_", "wdm", "wca", "bomb_", "dm_", "q3dm", "sp" };
+static const char *words[] = { "arena", "bunker", "canyon", "dust", "echo", "forge", "gate", "haven",
+	"ice", "jump", "keep", "lava", "mill", "nexus", "orbit", "pit", "quarry", "rift", "storm", "tower" };
+
+static double Sys_Milliseconds( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void AddName( const char *name )
+{
+	names = (char **)realloc( names, sizeof( char * ) * ( num_names + 1 ) );
+	names[num_names++] = strdup( name );
+}
+
+static void LoadNames( const char *filename )
+{
+	char line[256];
+	size_t len;
+	FILE *f = fopen( filename, "r" );
+
+	if( !f )
+	{
+		fprintf( stderr, "Couldn't open %s\n", filename );
+		exit( 1 );
+	}
+
+	while( fgets( line, sizeof( line ), f ) )
+	{
+		len = strlen( line );
+		while( len && isspace( (unsigned char)line[len-1] ) )
+			line[--len] = '\0';
+		if( len )
+			AddName( line );
+	}
+	fclose( f );
+}
+
+static void GenerateNames( void )
+{
+	int i;
+	unsigned int seed = 1;
+	char name[MAX_NAME_LEN];
+
+	for( i = 0; i < NUM_SYNTHETIC_MAPS; i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		snprintf( name, sizeof( name ), "%s%s%s%d",
+			prefixes[( seed >> 16 ) % ( sizeof( prefixes ) / sizeof( prefixes[0] ) )],
+			words[( seed >> 8 ) % ( sizeof( words ) / sizeof( words[0] ) )],
+			( seed & 1 ) ? "_" : "", i );
+		AddName( name );
+	}
+}
+
+static unsigned int HashString( unsigned int hash, const char *s )
+{
+	while( *s )
+		hash = hash * 31 + tolower( (unsigned char)*s++ );
+	return hash;
+}
+
+int main( int argc, char **argv )
+{
+	int i, r, found;
+	unsigned int checksum, matches;
+	double t, t_insert = 0, t_exact = 0, t_prefix = 0, t_count = 0, t_dump = 0, t_remove = 0;
+	char prefix[MAX_NAME_LEN];
+	void *data;
+	trie_t *trie;
+	trie_dump_t *dump;
+
+	if( argc > 1 )
+		LoadNames( argv[1] );
+	else
+		GenerateNames();
+
+	// names that share all but the last letter with a stored key
+	misses = (char **)malloc( sizeof( char * ) * num_names );
+	for( i = 0; i < num_names; i++ )
+	{
+		misses[i] = (char *)malloc( strlen( names[i] ) + 2 );
+		sprintf( misses[i], "%sx", names[i] );
+	}
+
+	checksum = 0;
+	for( r = 0; r < REPEATS; r++ )
+	{
+		Trie_Create( TRIE_CASE_INSENSITIVE, &trie );
+
+		t = Sys_Milliseconds();
+		for( i = 0; i < num_names; i++ )
+			Trie_Insert( trie, names[i], names[i] );
+		t_insert += Sys_Milliseconds() - t;
+
+		t = Sys_Milliseconds();
+		found = 0;
+		for( i = 0; i < num_names; i++ )
+		{
+			if( Trie_Find( trie, names[i], TRIE_EXACT_MATCH, &data ) == TRIE_OK )
+				found++;
+			if( Trie_Find( trie, misses[i], TRIE_EXACT_MATCH, &data ) == TRIE_OK )
+				found++;
+		}
+		t_exact += Sys_Milliseconds() - t;
+
+		t = Sys_Milliseconds();
+		for( i = 0; i < num_names; i++ )
+		{
+			// what the console does on tab completion
+			snprintf( prefix, sizeof( prefix ), "%.4s", names[i] );
+			if( Trie_Find( trie, prefix, TRIE_PREFIX_MATCH, &data ) == TRIE_OK )
+				found++;
+		}
+		t_prefix += Sys_Milliseconds() - t;
+
+		t = Sys_Milliseconds();
+		for( i = 0; i < (int)( sizeof( prefixes ) / sizeof( prefixes[0] ) ); i++ )
+		{
+			Trie_NoOfMatches( trie, prefixes[i], &matches );
+			found += matches;
+		}
+		t_count += Sys_Milliseconds() - t;
+
+		t = Sys_Milliseconds();
+		Trie_Dump( trie, "", TRIE_DUMP_BOTH, &dump );
+		if( !r )
+		{
+			for( i = 0; i < (int)dump->size; i++ )
+				checksum = HashString( checksum, dump->key_value_vector[i].key );
+			checksum += found;
+		}
+		Trie_FreeDump( dump );
+		t_dump += Sys_Milliseconds() - t;
+
+		t = Sys_Milliseconds();
+		for( i = 0; i < num_names; i += 2 )
+			Trie_Remove( trie, names[i], &data );
+		for( i = 1; i < num_names; i += 2 )
+			Trie_Remove( trie, names[i], &data );
+		t_remove += Sys_Milliseconds() - t;
+
+		Trie_GetSize( trie, &matches );
+		if( matches )
+		{
+			fprintf( stderr, "%u keys left after removal\n", matches );
+			return 1;
+		}
+		Trie_Destroy( trie );
+	}
+
+	printf( "%d keys, %d repeats, checksum %08x\n", num_names, REPEATS, checksum );
+	printf( "insert        %8.3f ms\n", t_insert / REPEATS );
+	printf( "find exact    %8.3f ms\n", t_exact / REPEATS );
+	printf( "find prefix   %8.3f ms\n", t_prefix / REPEATS );
+	printf( "count prefix  %8.3f ms\n", t_count / REPEATS );
+	printf( "dump          %8.3f ms\n", t_dump / REPEATS );
+	printf( "remove        %8.3f ms\n", t_remove / REPEATS );
+
+	return 0;
+}